@@ -85,6 +85,7 @@ int main(int argc, const char **argv) {
     double t_debt = 0.0;
     double fps_t0 = 0.0;
     double fps_max = 0.0;
+    double render_secs = 0.0;
     double dt;
     long long frame_count = 0;
 
@@ -101,8 +102,12 @@ int main(int argc, const char **argv) {
             setup_window();
         }
 
+        double render_t0 = glfwGetTime();
         ltLuaRender();
+        render_secs = glfwGetTime() - render_t0;
+        ltProfileBegin("swap");
         glfwSwapBuffers();
+        ltProfileEnd();
 
 #ifdef LTOSX
         // There seems to be a bug on Mac OS X where the framerate skyrockets when the
@@ -130,6 +135,10 @@ int main(int argc, const char **argv) {
             }
         }
 
+        // Collect garbage in whatever is left of this frame, allowing
+        // for the next render.
+        ltLuaStepGC(1.0/60.0 - (glfwGetTime() - t) - render_secs);
+
 #ifdef LTOSX
         // Sleep for a bit to try and avoid the skyrocketing framerate
         // problem described above.
@@ -148,7 +157,11 @@ int main(int argc, const char **argv) {
 #ifdef FPS
         if (t - fps_t0 >= 2.0) {
             double fps = (double)frame_count / (t - fps_t0);
-            ltLog("%0.02ffps (%0.003fs max) | %6d objs %4d actions", fps, fps_max, ltNumLiveObjects(), ltNumScheduledActions());
+            LTPoolStats pool;
+            ltPoolGetStats(&pool);
+            ltLog("%0.02ffps (%0.003fs max) | %6d objs %4d actions | pool %d live %d peak | %d draws %d verts",
+                fps, fps_max, ltNumLiveObjects(), ltNumScheduledActions(), pool.live, pool.peak,
+                lt_gl_counters.draw_calls, lt_gl_counters.vertices);
             fps_t0 = t0;
             fps_max = 0.0;
             frame_count = 0;
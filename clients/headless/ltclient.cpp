@@ -0,0 +1,264 @@
+// Headless client.  Runs a game for a fixed number of frames with a
+// fixed time step and no window, then prints how long each phase took
+// and what the game asked of GL.  Link against a liblt built with
+// LTNULLGL (make headless) to run without a display or GPU.
+//
+// Usage: ltheadless [-frames N] [-dt secs] [-size WxH] [-gllog file]
+//                   [-trace file] [-noindex] [-texbudget bytes]
+//                   [-texformat format] [-dither kind] [dir]
+//
+// -noindex checks each resource path on the filesystem instead of
+// through the resource directory index (see ltresource.h), for
+// comparing the number of checks.  -texbudget sets the texture memory
+// budget for atlases (see ltimage.h) before the game starts.
+// -texformat and -dither set the atlas format and dithering used when
+// lt.LoadImages isn't given them (e.g. -texformat auto -dither diffuse).
+#include <stdio.h>
+#include <string.h>
+
+#include "lt.h"
+
+#ifndef LTNULLGL
+#error The headless client needs a liblt built with LTNULLGL
+#endif
+
+#define NUM_PHASES 3
+
+static const char *phase_names[NUM_PHASES] = {"render", "advance", "gc"};
+
+struct PhaseTimes {
+    LTdouble total;
+    LTdouble max;
+};
+
+static const char *dir = "data";
+static int num_frames = 600;
+static LTdouble step = 0.0;
+static int window_width = 0;
+static int window_height = 0;
+static const char *gl_log_path = NULL;
+static const char *trace_path = NULL;
+static bool resource_index = true;
+static int texture_budget = 0;
+static LTTextureFormat atlas_format = LT_TEXTURE_FORMAT_RGBA8888;
+static LTDither atlas_dither = LT_DITHER_NONE;
+
+static bool process_args(int argc, const char **argv);
+static void add_time(PhaseTimes *phase, LTdouble t);
+
+int main(int argc, const char **argv) {
+    if (!process_args(argc, argv)) {
+        fprintf(stderr, "Usage: %s [-frames N] [-dt secs] [-size WxH] [-gllog file] [-trace file] [-noindex] [-texbudget bytes] [-texformat format] [-dither kind] [dir]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *gl_log = NULL;
+    if (gl_log_path != NULL) {
+        gl_log = fopen(gl_log_path, "w");
+        if (gl_log == NULL) {
+            fprintf(stderr, "Unable to open %s: %s\n", gl_log_path, strerror(errno));
+            return 1;
+        }
+        ltNullGLSetLog(gl_log);
+    }
+    if (trace_path != NULL) {
+        ltSetProfilerEnabled(true);
+    }
+    ltSetResourceIndexEnabled(resource_index);
+    ltSetTextureBudget(texture_budget);
+    ltSetDefaultAtlasFormat(atlas_format, atlas_dither);
+
+    // There may be no sound device either.  OpenAL Soft's null output
+    // lets samples load as normal.
+    setenv("ALSOFT_DRIVERS", "null", 0);
+
+    LTdouble setup_t0 = ltGetTime();
+    ltSetResourcePrefix(dir);
+    ltLuaSetup();
+    if (window_width == 0) {
+        LTfloat w, h;
+        ltGetDesignScreenSize(&w, &h);
+        window_width = (int)w;
+        window_height = (int)h;
+    }
+    ltLuaResizeWindow(window_width, window_height);
+    if (step <= 0.0) {
+        step = lt_fixed_update_time > 0.0 ? lt_fixed_update_time : 1.0 / 60.0;
+    }
+    LTdouble setup_secs = ltGetTime() - setup_t0;
+
+    PhaseTimes phases[NUM_PHASES];
+    memset(phases, 0, sizeof(phases));
+    PhaseTimes frames;
+    memset(&frames, 0, sizeof(frames));
+    LTNullGLStats gl_max;
+    memset(&gl_max, 0, sizeof(gl_max));
+    LTNullGLStats gl_total;
+    memset(&gl_total, 0, sizeof(gl_total));
+    // Requests made of ltopengl.cpp, whether issued or filtered out by
+    // its state cache.
+    LTGLCounters requests_max;
+    memset(&requests_max, 0, sizeof(requests_max));
+    LTGLCounters requests_total;
+    memset(&requests_total, 0, sizeof(requests_total));
+
+    int frame = 0;
+    while (frame < num_frames && !lt_quit) {
+        if (gl_log != NULL) {
+            fprintf(gl_log, "# frame %d\n", frame);
+        }
+        ltNullGLResetStats();
+        LTdouble t0 = ltGetTime();
+        ltLuaRender();
+        LTdouble t1 = ltGetTime();
+        ltLuaAdvance(step);
+        LTdouble t2 = ltGetTime();
+        ltLuaStepGC(step - (t2 - t0));
+        LTdouble t3 = ltGetTime();
+
+        add_time(&phases[0], t1 - t0);
+        add_time(&phases[1], t2 - t1);
+        add_time(&phases[2], t3 - t2);
+        add_time(&frames, t3 - t0);
+
+        LTNullGLStats gl;
+        ltNullGLGetStats(&gl);
+        gl_total.calls += gl.calls;
+        gl_total.draw_calls += gl.draw_calls;
+        gl_total.vertices += gl.vertices;
+        gl_total.state_changes += gl.state_changes;
+        gl_total.buffer_bytes += gl.buffer_bytes;
+        gl_total.texture_bytes += gl.texture_bytes;
+        if (gl.calls > gl_max.calls) gl_max.calls = gl.calls;
+        if (gl.draw_calls > gl_max.draw_calls) gl_max.draw_calls = gl.draw_calls;
+        if (gl.vertices > gl_max.vertices) gl_max.vertices = gl.vertices;
+        if (gl.state_changes > gl_max.state_changes) gl_max.state_changes = gl.state_changes;
+        if (gl.buffer_bytes > gl_max.buffer_bytes) gl_max.buffer_bytes = gl.buffer_bytes;
+        if (gl.texture_bytes > gl_max.texture_bytes) gl_max.texture_bytes = gl.texture_bytes;
+
+        // Reset by ltLuaRender, so this covers the whole frame.
+        LTGLCounters req = lt_gl_counters;
+        requests_total.issued_calls += req.issued_calls;
+        requests_total.filtered_calls += req.filtered_calls;
+        requests_total.cull_tests += req.cull_tests;
+        requests_total.culled += req.culled;
+        if (req.issued_calls > requests_max.issued_calls) requests_max.issued_calls = req.issued_calls;
+        if (req.filtered_calls > requests_max.filtered_calls) requests_max.filtered_calls = req.filtered_calls;
+        if (req.cull_tests > requests_max.cull_tests) requests_max.cull_tests = req.cull_tests;
+        if (req.culled > requests_max.culled) requests_max.culled = req.culled;
+
+        frame++;
+#ifdef LTDEVMODE
+        ltClientStep();
+#endif
+    }
+
+    if (trace_path != NULL && !ltProfileWriteTrace(trace_path)) {
+        fprintf(stderr, "Unable to write %s\n", trace_path);
+    }
+
+    printf("%d frames of %gs, %dx%d, setup %.3f ms\n", frame, step, window_width, window_height,
+        setup_secs * 1000.0);
+    if (frame > 0) {
+        printf("%-10s %12s %12s %12s\n", "phase", "total ms", "mean ms", "max ms");
+        for (int i = 0; i < NUM_PHASES; i++) {
+            printf("%-10s %12.3f %12.4f %12.4f\n", phase_names[i],
+                phases[i].total * 1000.0, phases[i].total * 1000.0 / frame, phases[i].max * 1000.0);
+        }
+        printf("%-10s %12.3f %12.4f %12.4f\n", "frame",
+            frames.total * 1000.0, frames.total * 1000.0 / frame, frames.max * 1000.0);
+        printf("%-10s %12s %12s\n", "gl", "mean/frame", "max/frame");
+        printf("%-10s %12.1f %12d\n", "calls", (double)gl_total.calls / frame, gl_max.calls);
+        printf("%-10s %12.1f %12d\n", "draws", (double)gl_total.draw_calls / frame, gl_max.draw_calls);
+        printf("%-10s %12.1f %12d\n", "vertices", (double)gl_total.vertices / frame, gl_max.vertices);
+        printf("%-10s %12.1f %12d\n", "state", (double)gl_total.state_changes / frame, gl_max.state_changes);
+        printf("%-10s %12.1f %12d\n", "buf bytes", (double)gl_total.buffer_bytes / frame, gl_max.buffer_bytes);
+        printf("%-10s %12.1f %12d\n", "tex bytes", (double)gl_total.texture_bytes / frame, gl_max.texture_bytes);
+        printf("%-10s %12.1f %12d\n", "issued", (double)requests_total.issued_calls / frame,
+            requests_max.issued_calls);
+        printf("%-10s %12.1f %12d\n", "filtered", (double)requests_total.filtered_calls / frame,
+            requests_max.filtered_calls);
+        printf("%-10s %12.1f %12d\n", "cull tests", (double)requests_total.cull_tests / frame,
+            requests_max.cull_tests);
+        printf("%-10s %12.1f %12d\n", "culled", (double)requests_total.culled / frame,
+            requests_max.culled);
+    }
+    LTResourceStats rs;
+    ltGetResourceStats(&rs);
+    printf("resources: %d exists calls, %d file checks, %d directory reads\n",
+        rs.exists_calls, rs.file_checks, rs.dir_reads);
+    LTTextureStats ts;
+    ltGetTextureStats(&ts);
+    printf("textures: %d/%d atlases resident, %d/%d bytes (peak %d), %d evictions, %d reloads (%.3f ms)\n",
+        ts.resident, ts.atlases, ts.resident_bytes, ts.bytes, ts.peak_resident_bytes,
+        ts.evictions, ts.reloads, ts.reload_time * 1000.0);
+    printf("texture formats: %d conversions (%.3f ms), %d bytes saved\n",
+        ts.converted, ts.convert_time * 1000.0, ts.saved_bytes);
+
+    ltLuaTeardown();
+    ltNullGLSetLog(NULL);
+    if (gl_log != NULL) {
+        fclose(gl_log);
+    }
+    if (ltNumLiveObjects() != 0) {
+        fprintf(stderr, "ERROR: num live objects not zero (%d in fact)\n", ltNumLiveObjects());
+    }
+    return 0;
+}
+
+static void add_time(PhaseTimes *phase, LTdouble t) {
+    phase->total += t;
+    if (t > phase->max) {
+        phase->max = t;
+    }
+}
+
+static bool process_args(int argc, const char **argv) {
+    for (int i = 1; i < argc; i++) {
+        bool has_val = i + 1 < argc;
+        if (strcmp(argv[i], "-frames") == 0 && has_val) {
+            num_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-dt") == 0 && has_val) {
+            step = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-size") == 0 && has_val) {
+            if (sscanf(argv[++i], "%dx%d", &window_width, &window_height) != 2
+                || window_width <= 0 || window_height <= 0)
+            {
+                return false;
+            }
+        } else if (strcmp(argv[i], "-gllog") == 0 && has_val) {
+            gl_log_path = argv[++i];
+        } else if (strcmp(argv[i], "-trace") == 0 && has_val) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "-noindex") == 0) {
+            resource_index = false;
+        } else if (strcmp(argv[i], "-texbudget") == 0 && has_val) {
+            texture_budget = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-texformat") == 0 && has_val) {
+            const char *name = argv[++i];
+            int f = LT_TEXTURE_FORMAT_RGBA8888;
+            while (f <= LT_TEXTURE_FORMAT_AUTO && strcmp(name, ltTextureFormatName((LTTextureFormat)f)) != 0) {
+                f++;
+            }
+            if (f > LT_TEXTURE_FORMAT_AUTO) {
+                return false;
+            }
+            atlas_format = (LTTextureFormat)f;
+        } else if (strcmp(argv[i], "-dither") == 0 && has_val) {
+            const char *name = argv[++i];
+            int d = LT_DITHER_NONE;
+            while (d <= LT_DITHER_DIFFUSE && strcmp(name, ltDitherName((LTDither)d)) != 0) {
+                d++;
+            }
+            if (d > LT_DITHER_DIFFUSE) {
+                return false;
+            }
+            atlas_dither = (LTDither)d;
+        } else if (argv[i][0] == '-') {
+            return false;
+        } else {
+            dir = argv[i];
+        }
+    }
+    return num_frames >= 0;
+}
@@ -1,13 +1,26 @@
 #!/bin/bash
+# Usage: gen_lua_scripts_h.sh [luac]
+# If a luac for the target is given the scripts are embedded as stripped
+# bytecode, otherwise as source.  Either way each script is a NUL
+# terminated char array, so its length is sizeof(lt_script_xxx) - 1.
 
 h=lua_scripts.h
+luac=$1
 echo "/* THIS FILE IS GENERATED BY $0 */" > $h
 
 for f in `ls lua/*.lua`; do
     name=`basename $f .lua`
-    echo "static const char *lt_script_$name = " >> $h
-    echo "\"-- $name.lua\\n\"" >> $h
-    cat $f | grep -v "Copyright .* Ian MacLarty" | sed 's/\\/\\\\/g' | sed 's/"/\\"/g' | sed 's/^/"/' | sed 's/$/\\n"/' >> $h
-    echo ";" >> $h
+    if [ -n "$luac" ]; then
+        $luac -s -o $h.tmp $f || exit 1
+        echo "static const unsigned char lt_script_$name[] = {" >> $h
+        od -An -v -tx1 $h.tmp | sed 's/ *\([0-9a-f][0-9a-f]\)/0x\1,/g' >> $h
+        echo "0x00};" >> $h
+        rm -f $h.tmp
+    else
+        echo "static const unsigned char lt_script_$name[] = " >> $h
+        echo "\"-- $name.lua\\n\"" >> $h
+        cat $f | grep -v "Copyright .* Ian MacLarty" | sed 's/\\/\\\\/g' | sed 's/"/\\"/g' | sed 's/^/"/' | sed 's/$/\\n"/' >> $h
+        echo ";" >> $h
+    fi
     echo >> $h
 done
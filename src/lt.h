@@ -24,6 +24,7 @@ THE SOFTWARE.
 #include <string.h>
 #include <errno.h>
 #include <cfloat>
+#include <climits>
 #include <list>
 #include <set>
 #include <map>
@@ -36,6 +37,7 @@ THE SOFTWARE.
 #include <unistd.h>
 #include <stdint.h>
 #include <sys/stat.h>
+#include <dirent.h>
 #include <pthread.h>
 #if !defined(LTANDROID) && !defined(LTMINGW)
 #include <glob.h>
@@ -167,9 +169,11 @@ extern "C" {
 #include "ltthreads.h"
 #include "ltconfig.h"
 #include "ltobject.h"
+#include "ltpool.h"
 #include "ltffi.h"
 #include "ltutil.h"
 #include "ltopengl.h"
+#include "ltnullgl.h"
 #include "ltinput.h"
 #include "ltevent.h"
 #include "ltaction.h"
@@ -186,17 +190,25 @@ extern "C" {
 #include "ltresource.h"
 #include "ltstate.h"
 #include "lttime.h"
+#include "ltprofile.h"
+#include "ltgc.h"
+#include "lttimer.h"
 #include "lttween.h"
+#include "ltsprite.h"
 #include "ltaudio.h"
 #include "ltvector.h"
 #include "ltmesh.h"
 #include "ltrendertarget.h"
+#include "ltbake.h"
+#include "lttilemap.h"
 #include "ltparticles.h"
 #include "lttext.h"
 #include "ltstore.h"
 #include "ltfilestore.h"
 #include "ltwavefront.h"
+#include "ltmeshfile.h"
 #include "ltlighting.h"
+#include "ltrenderqueue.h"
 #include "ltjson.h"
 #include "lthttp.h"
 #include "ltsha1.h"
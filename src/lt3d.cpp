@@ -6,11 +6,53 @@ LT_INIT_IMPL(lt3d)
 static bool depth_test_on = false;
 static bool depth_mask_on = true;
 static LTCullMode cull_mode = LT_CULL_OFF;
+static LTFog *active_fog = NULL;
+static bool frustum_culling = false;
+
+void ltGet3DState(LT3DState *state) {
+    state->depth_test = depth_test_on;
+    state->depth_mask = depth_mask_on;
+    state->cull = cull_mode;
+    state->fog = active_fog;
+}
+
+static void apply_fog(LTFog *fog) {
+    if (fog != NULL) {
+        ltEnableFog();
+        ltFogColor(fog->red, fog->green, fog->blue);
+        ltFogStart(fog->fstart);
+        ltFogEnd(fog->fend);
+    } else {
+        ltDisableFog();
+    }
+}
+
+void ltSet3DState(LT3DState *state) {
+    // Unchanged state is filtered out by ltopengl.cpp.
+    if (state->depth_test) {
+        ltEnableDepthTest();
+    } else {
+        ltDisableDepthTest();
+    }
+    if (state->depth_mask) {
+        ltEnableDepthMask();
+    } else {
+        ltDisableDepthMask();
+    }
+    ltCullFace(state->cull);
+    apply_fog(state->fog);
+    depth_test_on = state->depth_test;
+    depth_mask_on = state->depth_mask;
+    cull_mode = state->cull;
+    active_fog = state->fog;
+}
 
 void LTPerspective::draw() {
     if (child != NULL) {
         ltPushPerspective(nearz, origin, farz, vanish_x, vanish_y);
+        bool prev_culling = ltSetFrustumCulling(cull);
         child->draw();
+        ltSetFrustumCulling(prev_culling);
         ltPopPerspective();
     }
 }
@@ -25,6 +67,7 @@ LT_REGISTER_FIELD_FLOAT(LTPerspective, origin);
 LT_REGISTER_FIELD_FLOAT_AS(LTPerspective, farz, "far");
 LT_REGISTER_FIELD_FLOAT(LTPerspective, vanish_x);
 LT_REGISTER_FIELD_FLOAT(LTPerspective, vanish_y);
+LT_REGISTER_FIELD_BOOL(LTPerspective, cull);
 
 void LTCullFace::draw() {
     if (child != NULL) {
@@ -37,6 +80,15 @@ void LTCullFace::draw() {
     }
 }
 
+void LTCullFace::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->push();
+        queue->state()->gl3d.cull = mode;
+        child->enqueue(queue);
+        queue->pop();
+    }
+}
+
 static const LTEnumConstant CullMode_enum_vals[] = {
     {"back",    LT_CULL_BACK},
     {"front",   LT_CULL_FRONT},
@@ -67,6 +119,15 @@ void LTDepthTest::draw() {
     }
 }
 
+void LTDepthTest::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->push();
+        queue->state()->gl3d.depth_test = on;
+        child->enqueue(queue);
+        queue->pop();
+    }
+}
+
 LT_REGISTER_TYPE(LTDepthTest, "lt.DepthTest", "lt.Wrap")
 LT_REGISTER_FIELD_BOOL(LTDepthTest, on)
 
@@ -92,6 +153,15 @@ void LTDepthMask::draw() {
     }
 }
 
+void LTDepthMask::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->push();
+        queue->state()->gl3d.depth_mask = on;
+        child->enqueue(queue);
+        queue->pop();
+    }
+}
+
 LT_REGISTER_TYPE(LTDepthMask, "lt.DepthMask", "lt.Wrap")
 LT_REGISTER_FIELD_BOOL(LTDepthMask, on)
 
@@ -102,6 +172,13 @@ void LTPitch::draw() {
     }
 }
 
+void LTPitch::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->rotate(pitch, 1, 0, 0);
+        child->enqueue(queue);
+    }
+}
+
 bool LTPitch::inverse_transform(LTfloat *x, LTfloat *y) {
     return false;
 }
@@ -111,12 +188,21 @@ LT_REGISTER_FIELD_FLOAT(LTPitch, pitch)
 
 void LTFog::draw() {
     if (child != NULL) {
-        ltEnableFog();
-        ltFogColor(red, green, blue);
-        ltFogStart(fstart);
-        ltFogEnd(fend);
+        LTFog *prev_fog = active_fog;
+        active_fog = this;
+        apply_fog(this);
         child->draw();
-        ltDisableFog();
+        active_fog = prev_fog;
+        apply_fog(prev_fog);
+    }
+}
+
+void LTFog::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->push();
+        queue->state()->gl3d.fog = this;
+        child->enqueue(queue);
+        queue->pop();
     }
 }
 
@@ -126,3 +212,50 @@ LT_REGISTER_FIELD_FLOAT(LTFog, fend)
 LT_REGISTER_FIELD_FLOAT(LTFog, red)
 LT_REGISTER_FIELD_FLOAT(LTFog, green)
 LT_REGISTER_FIELD_FLOAT(LTFog, blue)
+
+bool ltFrustumCullingEnabled() {
+    return frustum_culling;
+}
+
+bool ltSetFrustumCulling(bool enabled) {
+    bool prev = frustum_culling;
+    frustum_culling = enabled;
+    return prev;
+}
+
+bool ltFrustumCull(const LTfloat *modelview, LTVec3 centre, LTVec3 half_extents) {
+    LTfloat mv[16];
+    if (modelview == NULL) {
+        ltGetMatrix(LT_MATRIX_MODE_MODELVIEW, mv);
+        modelview = mv;
+    }
+    LTfloat clip[16];
+    ltGetMatrix(LT_MATRIX_MODE_PROJECTION, clip);
+    ltMatMultiply(clip, clip, modelview);
+    lt_gl_counters.cull_tests++;
+
+    LTfloat hx = half_extents.x, hy = half_extents.y, hz = half_extents.z;
+    LTfloat radius = sqrtf(hx * hx + hy * hy + hz * hz);
+    for (int i = 0; i < 6; i++) {
+        // The planes are the fourth row of clip plus or minus each of the
+        // others.  Points with a non-negative distance are on the inside.
+        int row = i >> 1;
+        LTfloat sign = (i & 1) ? -1.0f : 1.0f;
+        LTfloat a = clip[3] + sign * clip[row];
+        LTfloat b = clip[7] + sign * clip[4 + row];
+        LTfloat c = clip[11] + sign * clip[8 + row];
+        LTfloat d = clip[15] + sign * clip[12 + row];
+        LTfloat dist = a * centre.x + b * centre.y + c * centre.z + d;
+        LTfloat sphere_reach = radius * sqrtf(a * a + b * b + c * c);
+        if (dist >= sphere_reach) {
+            continue;
+        }
+        // The box corner furthest along the plane's normal.
+        LTfloat box_reach = fabsf(a) * hx + fabsf(b) * hy + fabsf(c) * hz;
+        if (dist < -sphere_reach || dist + box_reach < 0.0f) {
+            lt_gl_counters.culled++;
+            return true;
+        }
+    }
+    return false;
+}
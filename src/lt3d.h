@@ -7,8 +7,9 @@ struct LTPerspective : LTWrapNode {
     LTfloat farz;
     LTfloat vanish_x;
     LTfloat vanish_y;
+    bool cull;  // Skip meshes outside the view frustum.
 
-    LTPerspective() {nearz = 1; origin = 2; farz = 10;};
+    LTPerspective() {nearz = 1; origin = 2; farz = 10; cull = true;};
     
     virtual void draw();
     bool inverse_transform(LTfloat *x, LTfloat *y);
@@ -18,24 +19,28 @@ struct LTCullFace : LTWrapNode {
     LTCullMode mode;
     LTCullFace() { mode = LT_CULL_BACK; }
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTDepthTest : LTWrapNode {
     bool on;
     LTDepthTest() {on = true;}
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTDepthMask : LTWrapNode {
     bool on;
     LTDepthMask() {on = true;}
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTPitch : LTWrapNode {
     LTfloat pitch;
 
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
     bool inverse_transform(LTfloat *x, LTfloat *y);
 };
 
@@ -45,4 +50,35 @@ struct LTFog : LTWrapNode {
     LTfloat red, green, blue;
 
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
+
+// The state set by the nearest enclosing lt.DepthTest, lt.DepthMask,
+// lt.CullFace and lt.Fog nodes.  Render queues (ltrenderqueue.h) save
+// it, give each item its own and put it back afterwards.
+struct LT3DState {
+    bool depth_test;
+    bool depth_mask;
+    LTCullMode cull;
+    LTFog *fog;         // NULL for no fog.
+};
+
+void ltGet3DState(LT3DState *state);
+// Also makes state the one the nodes above restore.
+void ltSet3DState(LT3DState *state);
+
+// Frustum culling.  While the child of an lt.Perspective node with cull
+// set is drawn, meshes test their bounds against the view frustum of the
+// current projection and aren't drawn if they're entirely outside it.
+// Bounds are tested as a sphere first, then, if the sphere straddles a
+// frustum plane, as a box.  Tests and culls are counted in
+// lt_gl_counters.
+
+bool ltFrustumCullingEnabled();
+// Returns the previous setting.
+bool ltSetFrustumCulling(bool enabled);
+
+// Returns true if the box with the given centre and half extents, in the
+// coordinates of modelview (or the current modelview matrix if NULL), is
+// entirely outside the view frustum.
+bool ltFrustumCull(const LTfloat *modelview, LTVec3 centre, LTVec3 half_extents);
@@ -6,6 +6,16 @@ LT_INIT_IMPL(ltaction)
 static std::list<LTAction*> action_list;
 static std::list<LTAction*>::iterator next_action = action_list.end();
 static std::list<LTAction*> cancelled_actions;
+static LTuint32 next_sequence = 0;
+
+LTuint32 ltNextActionSequence() {
+    return next_sequence++;
+}
+
+bool ltActionSequenceAfter(LTuint32 a, LTuint32 b) {
+    // Wraps around.
+    return (LTint32)(a - b) > 0;
+}
 
 LTAction::LTAction(LTSceneNode *n) {
     position = action_list.end();
@@ -14,6 +24,7 @@ LTAction::LTAction(LTSceneNode *n) {
     no_dups = false;
     cancelled = false;
     scheduled = false;
+    sequence = 0;
 }
 
 LTAction::~LTAction() {
@@ -27,6 +38,7 @@ void LTAction::schedule() {
     }
     action_list.push_front(this);
     position = action_list.begin();
+    sequence = ltNextActionSequence();
     scheduled = true;
 }
 
@@ -52,10 +64,15 @@ void LTAction::cancel() {
 }
 
 void ltExecuteActions(LTfloat dt) {
+    LT_PROFILE_SCOPE("actions");
+    ltBeginTweens(dt);
     next_action = action_list.begin();
     while (next_action != action_list.end()) {
         LTAction *action = *next_action;
         next_action++;
+        // Tweens scheduled after this action run before it, as they
+        // would if they were in the list.
+        ltAdvanceTweens(action->sequence);
         assert(action->cancelled || action->node->active);
         if (!action->cancelled && action->node->action_speed != 0.0f) {
             bool finished = action->doAction(dt * action->node->action_speed);
@@ -64,6 +81,7 @@ void ltExecuteActions(LTfloat dt) {
             }
         }
     }
+    ltEndTweens();
     for (std::list<LTAction*>::iterator it = cancelled_actions.begin(); it != cancelled_actions.end(); it++) {
         LTAction *action = *it;
         assert(action->cancelled);
@@ -80,5 +98,5 @@ void ltExecuteActions(LTfloat dt) {
 }
 
 int ltNumScheduledActions() {
-    return action_list.size();
+    return action_list.size() + ltNumActiveTweens();
 }
@@ -8,12 +8,18 @@ struct LTAction {
     bool no_dups;
     bool cancelled;
     bool scheduled;
+    LTuint32 sequence; // When last scheduled.  Later actions run first.
 
     LTAction(LTSceneNode *node);
     virtual ~LTAction();
 
-    void schedule();
-    void unschedule();
+    LT_POOLED_ALLOC
+
+    // Subclasses may override these to run from somewhere other than the
+    // main action list (see LTTweenAction), but should still set sequence
+    // with ltNextActionSequence when scheduled.
+    virtual void schedule();
+    virtual void unschedule();
     void cancel();
     virtual void on_cancel() {};
 
@@ -23,3 +29,6 @@ struct LTAction {
 
 void ltExecuteActions(LTfloat dt);
 int ltNumScheduledActions();
+LTuint32 ltNextActionSequence();
+// True if action a was scheduled after action b (or sequence b).
+bool ltActionSequenceAfter(LTuint32 a, LTuint32 b);
@@ -0,0 +1,228 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(ltbake)
+
+// Indices are 16 bit and relative to the start of their run.
+#define MAX_RUN_VERTICES 65536
+
+LTBaker::LTBaker() {
+    has_colors = false;
+    num_quads = 0;
+    LTBakerState s;
+    s.a = 1.0f;
+    s.b = 0.0f;
+    s.c = 0.0f;
+    s.d = 1.0f;
+    s.tx = 0.0f;
+    s.ty = 0.0f;
+    stack.push_back(s);
+}
+
+void LTBaker::push() {
+    stack.push_back(stack.back());
+}
+
+void LTBaker::pop() {
+    stack.pop_back();
+}
+
+void LTBaker::translate(LTfloat x, LTfloat y) {
+    LTBakerState *s = &stack.back();
+    s->tx += s->a * x + s->c * y;
+    s->ty += s->b * x + s->d * y;
+}
+
+void LTBaker::rotate(LTdegrees angle) {
+    LTBakerState *s = &stack.back();
+    LTfloat r = angle * LT_RADIANS_PER_DEGREE;
+    LTfloat co = cosf(r);
+    LTfloat si = sinf(r);
+    LTfloat a = s->a * co + s->c * si;
+    LTfloat b = s->b * co + s->d * si;
+    LTfloat c = s->c * co - s->a * si;
+    LTfloat d = s->d * co - s->b * si;
+    s->a = a;
+    s->b = b;
+    s->c = c;
+    s->d = d;
+}
+
+void LTBaker::scale(LTfloat sx, LTfloat sy) {
+    LTBakerState *s = &stack.back();
+    s->a *= sx;
+    s->b *= sx;
+    s->c *= sy;
+    s->d *= sy;
+}
+
+void LTBaker::tint(LTfloat r, LTfloat g, LTfloat b, LTfloat a) {
+    // Same order of multiplication as ltPushTint, so the colours match
+    // exactly.
+    LTColor *t = &stack.back().tint;
+    t->red = r * t->red;
+    t->green = g * t->green;
+    t->blue = b * t->blue;
+    t->alpha = a * t->alpha;
+}
+
+void LTBaker::add_quad(LTtexid texture_id, LTfloat *xys, LTtexcoord *uvs) {
+    int first = vertices.size();
+    if (runs.empty() || runs.back().texture_id != texture_id
+        || first + 4 - runs.back().first_vertex > MAX_RUN_VERTICES)
+    {
+        LTBakedRun run;
+        run.texture_id = texture_id;
+        run.first_vertex = first;
+        run.first_index = indices.size();
+        run.num_indices = 0;
+        runs.push_back(run);
+    }
+    LTBakedRun *run = &runs.back();
+    LTBakerState *s = &stack.back();
+    for (int i = 0; i < 4; i++) {
+        LTfloat x = xys[i * 2];
+        LTfloat y = xys[i * 2 + 1];
+        LTBakedVertex v;
+        v.x = s->a * x + s->c * y + s->tx;
+        v.y = s->b * x + s->d * y + s->ty;
+        v.red = s->tint.red;
+        v.green = s->tint.green;
+        v.blue = s->tint.blue;
+        v.alpha = s->tint.alpha;
+        v.u = uvs[i * 2];
+        v.v = uvs[i * 2 + 1];
+        vertices.push_back(v);
+    }
+    if (s->tint.red != 1.0f || s->tint.green != 1.0f
+        || s->tint.blue != 1.0f || s->tint.alpha != 1.0f)
+    {
+        has_colors = true;
+    }
+    // The fan 0, 1, 2, 3 as two triangles.
+    static const int fan[6] = {0, 1, 2, 0, 2, 3};
+    int base = first - run->first_vertex;
+    for (int i = 0; i < 6; i++) {
+        indices.push_back((LTvertindex)(base + fan[i]));
+    }
+    run->num_indices += 6;
+    num_quads++;
+}
+
+LTBakeNode::LTBakeNode() {
+    vertbuf = 0;
+    has_colors = false;
+    baked = false;
+    baked_epoch = -1;
+    bake_count = 0;
+    num_quads = 0;
+}
+
+LTBakeNode::~LTBakeNode() {
+    if (vertbuf != 0) {
+        ltDeleteVertBuffer(vertbuf);
+    }
+}
+
+void LTBakeNode::update() {
+    if (baked_epoch >= 0 && ltSubtreeLastChange(this) < baked_epoch) {
+        return;
+    }
+    // Changes made from here on are picked up next time.
+    baked_epoch = ltNextChangeEpoch();
+    bake_count++;
+    LTBaker baker;
+    baked = child != NULL && child->bake(&baker);
+    if (!baked || baker.vertices.empty()) {
+        indices.clear();
+        runs.clear();
+        has_colors = false;
+        num_quads = 0;
+        if (vertbuf != 0) {
+            ltDeleteVertBuffer(vertbuf);
+            vertbuf = 0;
+        }
+        return;
+    }
+    if (vertbuf == 0) {
+        vertbuf = ltGenVertBuffer();
+    }
+    ltBindVertBuffer(vertbuf);
+    ltStaticVertBufferData(baker.vertices.size() * sizeof(LTBakedVertex), &baker.vertices[0]);
+    indices.swap(baker.indices);
+    runs.swap(baker.runs);
+    has_colors = baker.has_colors;
+    num_quads = baker.num_quads;
+}
+
+void LTBakeNode::draw() {
+    if (child == NULL) {
+        return;
+    }
+    update();
+    if (!baked) {
+        child->draw();
+        return;
+    }
+    if (runs.empty()) {
+        return;
+    }
+    if (has_colors) {
+        // The colour array replaces the current tint rather than being
+        // multiplied by it.
+        LTColor tint;
+        ltPeekTint(&tint);
+        if (tint.red != 1.0f || tint.green != 1.0f || tint.blue != 1.0f || tint.alpha != 1.0f) {
+            child->draw();
+            return;
+        }
+        ltEnableColorArrays();
+    }
+    ltBindVertBuffer(vertbuf);
+    int stride = sizeof(LTBakedVertex);
+    for (unsigned int i = 0; i < runs.size(); i++) {
+        LTBakedRun *run = &runs[i];
+        LTuintptr base = run->first_vertex * stride;
+        ltEnableTexture(run->texture_id);
+        ltVertexPointer(2, LT_VERT_DATA_TYPE_FLOAT, stride,
+            (void*)(base + offsetof(LTBakedVertex, x)));
+        ltTexCoordPointer(2, LT_VERT_DATA_TYPE_SHORT, stride,
+            (void*)(base + offsetof(LTBakedVertex, u)));
+        if (has_colors) {
+            ltColorPointer(4, LT_VERT_DATA_TYPE_FLOAT, stride,
+                (void*)(base + offsetof(LTBakedVertex, red)));
+        }
+        ltDrawElements(LT_DRAWMODE_TRIANGLES, run->num_indices, &indices[run->first_index]);
+    }
+    if (has_colors) {
+        ltDisableColorArrays();
+        ltColorPointer(4, LT_VERT_DATA_TYPE_FLOAT, 0, 0); // XXX necessary?
+        ltRestoreTint();
+    }
+}
+
+bool LTBakeNode::bake(LTBaker *baker) {
+    return child == NULL || child->bake(baker);
+}
+
+static LTint get_bake_count(LTObject *obj) {
+    return ((LTBakeNode*)obj)->bake_count;
+}
+
+static LTint get_quads(LTObject *obj) {
+    return ((LTBakeNode*)obj)->num_quads;
+}
+
+static LTint get_draw_calls(LTObject *obj) {
+    return ((LTBakeNode*)obj)->runs.size();
+}
+
+static LTbool get_baked(LTObject *obj) {
+    return ((LTBakeNode*)obj)->baked;
+}
+
+LT_REGISTER_TYPE(LTBakeNode, "lt.Bake", "lt.Wrap")
+LT_REGISTER_PROPERTY_INT(LTBakeNode, bake_count, &get_bake_count, NULL);
+LT_REGISTER_PROPERTY_INT(LTBakeNode, quads, &get_quads, NULL);
+LT_REGISTER_PROPERTY_INT(LTBakeNode, draw_calls, &get_draw_calls, NULL);
+LT_REGISTER_PROPERTY_BOOL_NOCONS(LTBakeNode, baked, &get_baked, NULL);
@@ -0,0 +1,75 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltbake)
+
+// Baking flattens a static subtree into one vertex buffer.  The quads
+// in the subtree are transformed and tinted once on the CPU, then drawn
+// with one call per run of consecutive quads that share a texture.  Runs
+// keep the original draw order, so overlapping quads draw as before.
+//
+// Only subtrees made of nodes that implement LTSceneNode::bake can be
+// baked: layers, 2D translate, rotate and scale nodes, tint, hidden and
+// bake nodes, and textured nodes (images and render targets).
+
+struct LTBakedVertex {
+    LTfloat x, y;
+    LTfloat red, green, blue, alpha;
+    LTtexcoord u, v;
+};
+
+struct LTBakedRun {
+    LTtexid texture_id;
+    int first_vertex;
+    int first_index;
+    int num_indices;    // Indices are relative to first_vertex.
+};
+
+struct LTBakerState {
+    // x' = a * x + c * y + tx, y' = b * x + d * y + ty
+    LTfloat a, b, c, d, tx, ty;
+    LTColor tint;
+};
+
+struct LTBaker {
+    std::vector<LTBakedVertex> vertices;
+    std::vector<LTvertindex> indices;
+    std::vector<LTBakedRun> runs;
+    bool has_colors;    // Whether any quad is tinted.
+    int num_quads;
+
+    LTBaker();
+
+    // These mirror the matrix and tint stacks used when drawing.
+    void push();
+    void pop();
+    void translate(LTfloat x, LTfloat y);
+    void rotate(LTdegrees angle);
+    void scale(LTfloat sx, LTfloat sy);
+    void tint(LTfloat r, LTfloat g, LTfloat b, LTfloat a);
+
+    // xys and uvs are the quad's 4 corners in triangle fan order.
+    void add_quad(LTtexid texture_id, LTfloat *xys, LTtexcoord *uvs);
+
+private:
+    std::vector<LTBakerState> stack;
+};
+
+struct LTBakeNode : LTWrapNode {
+    LTvertbuf vertbuf;
+    std::vector<LTvertindex> indices;
+    std::vector<LTBakedRun> runs;
+    bool has_colors;
+    bool baked;         // false if the child couldn't be baked.
+    int baked_epoch;    // -1 if never baked.
+    int bake_count;
+    int num_quads;
+
+    LTBakeNode();
+    virtual ~LTBakeNode();
+
+    virtual void draw();
+    virtual bool bake(LTBaker *baker);
+
+    // Re-bakes the child if anything in the subtree has changed since it
+    // was last baked.
+    void update();
+};
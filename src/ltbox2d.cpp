@@ -362,7 +362,9 @@ static int world_step(lua_State *L) {
     if (num_args > 3) {
         position_iterations = luaL_checkinteger(L, 4);
     }
+    ltProfileBegin("physics");
     world->world->Step(time_step, velocity_iterations, position_iterations);
+    ltProfileEnd();
     return 0;
 }
 
@@ -31,6 +31,7 @@ struct LTBody : LTWrapNode {
     virtual void draw();
     //virtual bool containsPoint(LTfloat x, LTfloat y);
     virtual bool inverse_transform(LTfloat *x, LTfloat *y);
+    virtual int last_change() { return LT_ALWAYS_CHANGED; } // Moved by the world.
 };
 
 struct LTFixture : LTSceneNode {
@@ -79,6 +80,7 @@ struct LTBodyTracker : LTWrapNode {
 
     virtual bool inverse_transform(LTfloat *x, LTfloat *y);
     virtual void draw();
+    virtual int last_change() { return LT_ALWAYS_CHANGED; }
 };
 
 // Check if Box2D will allow the polygon to be attached to a body
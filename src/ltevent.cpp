@@ -124,6 +124,7 @@ struct LTEventVisitor : LTSceneNodeVisitor {
 };
 
 void ltPropagateEvent(LTSceneNode *node, LTEvent *event) {
+    LT_PROFILE_SCOPE("events");
     LTEventVisitor v(event);
     v.visit(node);
     std::list<LTEvent*>::iterator it;
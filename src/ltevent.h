@@ -74,6 +74,8 @@ struct LTEvent : LTObject {
         LTEvent::node = event->node;
         LTEvent::handler = event->handler;
     }
+
+    LT_POOLED_ALLOC
 };
 
 struct LTEventHandlerBB {
@@ -29,24 +29,34 @@ static void init_core_modules() {
         ltnet_init();
         ltobject_init();
         ltopengl_init();
+        ltnullgl_init();
         ltparticles_init();
+        ltpool_init();
         ltbox2d_init();
         ltpickle_init();
         ltprotocol_init();
         ltrandom_init();
         ltrendertarget_init();
+        ltbake_init();
+        lttilemap_init();
         ltresource_init();
         ltscene_init();
+        ltsprite_init();
         ltstate_init();
         ltstore_init();
         lttext_init();
         lttime_init();
+        lttimer_init();
+        ltprofile_init();
+        ltgc_init();
         lttween_init();
         ltutil_init();
         ltvector_init();
         ltmesh_init();
         ltwavefront_init();
+        ltmeshfile_init();
         ltlighting_init();
+        ltrenderqueue_init();
         ltinput_init();
         ltjson_init();
         lthttp_init();
@@ -331,6 +341,7 @@ static inline void set_field_val(lua_State *L, LTObject *obj, LTFieldInfo *field
             luaL_error(L, "Attempt to set method field '%s'", field_name);
             break;
     }
+    obj->changed();
 }
 
 // upvalue 1 = the method
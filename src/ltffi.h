@@ -100,6 +100,12 @@ LT_INIT_DECL(ltffi)
             (void*)getter, (void*)setter, NULL, __LINE__, true}; \
     static LTRegisterField LT_CONCAT(lt_register_field_, __LINE__)(LT_CONCAT(&lt_field_def_, __LINE__));
 
+#define LT_REGISTER_PROPERTY_INT_NOCONS(cpp_type, field_name, getter, setter) \
+    static LTFieldDef LT_CONCAT(lt_field_def_, __LINE__) = \
+        {#cpp_type, #field_name, LT_FIELD_KIND_INT, NULL, \
+            (void*)getter, (void*)setter, NULL, __LINE__, false}; \
+    static LTRegisterField LT_CONCAT(lt_register_field_, __LINE__)(LT_CONCAT(&lt_field_def_, __LINE__));
+
 #define LT_REGISTER_FIELD_ENUM(cpp_type, field_name, enum_type, enum_vals) \
     static LTint LT_CONCAT(lt_field_getter_, __LINE__)(LTObject *obj) { \
         return ((cpp_type*)obj)->field_name; \
@@ -0,0 +1,150 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(ltgc)
+
+#define LT_GC_MIN_STEP_KB       1
+#define LT_GC_MAX_STEP_KB       1024
+#define LT_GC_MIN_WORK_KB       4       // Work done each frame even if nothing allocated.
+#define LT_GC_WORK_MULTIPLIER   2       // Collect this many times faster than we allocate.
+#define LT_GC_STEPS_PER_FRAME   4       // Aim to reach the work target in this many steps.
+#define LT_GC_PAUSE_PERCENT     200     // Heap growth after a cycle before starting the next.
+#define LT_GC_MIN_HEAP_KB       1024
+#define LT_GC_CATCHUP_FRAMES    4       // Frames of work owed before catching up.
+#define LT_GC_CATCHUP_BUDGET    4       // Budget multiplier while catching up.
+
+static LTdouble budget = 0.0;
+static bool managed = false;
+static int last_heap_kb = 0;
+static int debt_kb = 0;                 // Work owed from earlier frames.
+static int pause_kb = 0;                // Heap size at which to start the next cycle.
+static LTdouble alloc_rate = 0.0;       // KB per frame (smoothed).
+static LTdouble secs_per_kb = 0.0;      // Measured collection speed (smoothed).
+static LTGCStats stats;
+
+void ltGCReset() {
+    budget = 0.0;
+    managed = false;
+    last_heap_kb = 0;
+    debt_kb = 0;
+    pause_kb = 0;
+    alloc_rate = 0.0;
+    secs_per_kb = 0.0;
+    memset(&stats, 0, sizeof(LTGCStats));
+}
+
+void ltGCSetBudget(lua_State *L, LTdouble secs) {
+    budget = secs;
+    if (budget <= 0.0 && managed) {
+        managed = false;
+        lua_gc(L, LUA_GCRESTART, 0);
+    }
+}
+
+LTdouble ltGCBudget() {
+    return budget;
+}
+
+void ltGCStep(lua_State *L, LTdouble slack) {
+    if (budget <= 0.0) {
+        return;
+    }
+    LT_PROFILE_SCOPE("gc");
+    int heap_kb = lua_gc(L, LUA_GCCOUNT, 0);
+    if (!managed) {
+        managed = true;
+        last_heap_kb = heap_kb;
+    }
+    int allocated = heap_kb - last_heap_kb;
+    if (allocated < 0) {
+        allocated = 0;
+    }
+    alloc_rate = alloc_rate * 0.9 + (LTdouble)allocated * 0.1;
+    last_heap_kb = heap_kb;
+    if (heap_kb < pause_kb) {
+        // Between cycles, like the pause of the default collector.
+        stats.secs = 0.0;
+        stats.steps = 0;
+        stats.heap_kb = heap_kb;
+        stats.alloc_kb = (int)alloc_rate;
+        stats.catching_up = false;
+        return;
+    }
+    pause_kb = 0;
+
+    int target_kb = (int)(fmax(alloc_rate, (LTdouble)allocated) * LT_GC_WORK_MULTIPLIER);
+    if (target_kb < LT_GC_MIN_WORK_KB) {
+        target_kb = LT_GC_MIN_WORK_KB;
+    }
+    // Work the time limit stopped us doing in earlier frames is carried
+    // over, and if too much builds up the budget is raised (but never
+    // beyond the slack) until it's paid off.
+    debt_kb += target_kb;
+    bool catching_up = debt_kb > target_kb * LT_GC_CATCHUP_FRAMES;
+    LTdouble limit = catching_up ? budget * LT_GC_CATCHUP_BUDGET : budget;
+    if (slack < limit) {
+        limit = slack;
+    }
+
+    int step_kb = target_kb / LT_GC_STEPS_PER_FRAME;
+    if (secs_per_kb > 0.0) {
+        // Don't let a single step overrun the time limit.
+        int max_kb = (int)(limit / (secs_per_kb * LT_GC_STEPS_PER_FRAME));
+        if (step_kb > max_kb) {
+            step_kb = max_kb;
+        }
+    }
+    if (step_kb < LT_GC_MIN_STEP_KB) {
+        step_kb = LT_GC_MIN_STEP_KB;
+    } else if (step_kb > LT_GC_MAX_STEP_KB) {
+        step_kb = LT_GC_MAX_STEP_KB;
+    }
+
+    LTdouble t0 = ltGetTime();
+    LTdouble elapsed = 0.0;
+    int work_kb = 0;
+    int steps = 0;
+    do {
+        work_kb += step_kb;
+        steps++;
+        if (lua_gc(L, LUA_GCSTEP, step_kb)) {
+            // Garbage from before the cycle has been freed, so
+            // nothing more is owed.
+            stats.cycles++;
+            pause_kb = lua_gc(L, LUA_GCCOUNT, 0) * LT_GC_PAUSE_PERCENT / 100;
+            if (pause_kb < LT_GC_MIN_HEAP_KB) {
+                pause_kb = LT_GC_MIN_HEAP_KB;
+            }
+            debt_kb = 0;
+            catching_up = false;
+            break;
+        }
+        elapsed = ltGetTime() - t0;
+    } while (elapsed < limit && work_kb < debt_kb);
+    elapsed = ltGetTime() - t0;
+    debt_kb = work_kb < debt_kb ? debt_kb - work_kb : 0;
+    // LUA_GCSTEP re-arms the automatic collector.
+    lua_gc(L, LUA_GCSTOP, 0);
+
+    LTdouble speed = elapsed / (LTdouble)work_kb;
+    secs_per_kb = secs_per_kb > 0.0 ? secs_per_kb * 0.8 + speed * 0.2 : speed;
+    last_heap_kb = lua_gc(L, LUA_GCCOUNT, 0);
+
+    stats.secs = elapsed;
+    stats.steps = steps;
+    stats.step_kb = step_kb;
+    stats.heap_kb = last_heap_kb;
+    stats.alloc_kb = (int)alloc_rate;
+    stats.catching_up = catching_up;
+    if (elapsed > stats.max_secs) {
+        stats.max_secs = elapsed;
+    }
+}
+
+void ltGCGetStats(LTGCStats *s) {
+    *s = stats;
+}
+
+void ltGCResetMax() {
+    stats.max_secs = 0.0;
+}
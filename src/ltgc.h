@@ -0,0 +1,43 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltgc)
+
+// Frame-budgeted Lua garbage collection.  This is off by default.  Once a
+// budget has been set and ltGCStep called, the Lua collector no longer
+// runs by itself; instead ltGCStep should be called once per frame (after
+// update and render) and performs bounded incremental collection work in
+// the time remaining.  As with the default collector, a new cycle isn't
+// started until the heap has doubled since the end of the last one.
+// During a cycle the amount of work tracks the allocation rate, and work
+// the time limit prevented is carried over to later frames.  If too much
+// is owed the budget is temporarily raised (still within the slack) until
+// it catches up.  Since nothing is collected between calls, a single frame
+// that allocates a lot will raise the peak heap size.
+
+struct LTGCStats {
+    LTdouble secs;      // Time spent collecting in the last ltGCStep.
+    int steps;          // LUA_GCSTEP calls in the last ltGCStep.
+    int step_kb;        // Step size used.
+    int heap_kb;        // Heap size after the last ltGCStep.
+    int alloc_kb;       // Smoothed allocation per frame.
+    int cycles;         // Total completed collection cycles.
+    LTdouble max_secs;  // Longest ltGCStep since last reset.
+    bool catching_up;   // Budget was raised in the last ltGCStep.
+};
+
+// Per-frame time budget (default 0, i.e. off; 0.002 is a reasonable
+// value).  A budget of 0 disables managed collection and restores the
+// default Lua collector.
+void ltGCSetBudget(lua_State *L, LTdouble secs);
+LTdouble ltGCBudget();
+
+// slack is the time left in the frame (negative if it overran).
+// The work done is bounded by the smaller of slack and the budget,
+// though at least one small step is always done.
+void ltGCStep(lua_State *L, LTdouble slack);
+
+// Call after creating a new Lua state to reset the scheduler
+// (this also turns managed collection off again).
+void ltGCReset();
+
+void ltGCGetStats(LTGCStats *stats);
+void ltGCResetMax();
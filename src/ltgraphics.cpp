@@ -484,6 +484,14 @@ void ltPopBlendMode() {
     }
 }
 
+LTBlendMode ltPeekBlendMode() {
+    if (!blend_mode_stack.empty()) {
+        return blend_mode_stack.front();
+    } else {
+        return LT_BLEND_MODE_NORMAL;
+    }
+}
+
 void ltPushTextureMode(LTTextureMode mode) {
     texture_mode_stack.push_front(mode);
     ltTextureMode(mode);
@@ -562,3 +570,85 @@ void ltDrawLineStrip(LTfloat *vertices, int num_vertices) {
     ltVertexPointer(2, LT_VERT_DATA_TYPE_FLOAT, 0, vertices);
     ltDrawArrays(LT_DRAWMODE_LINE_STRIP, 0, num_vertices);
 }
+
+void ltMatIdentity(LTfloat *m) {
+    for (int i = 0; i < 16; i++) {
+        m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+}
+
+void ltMatMultiply(LTfloat *out, const LTfloat *a, const LTfloat *b) {
+    LTfloat r[16];
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            r[col * 4 + row] =
+                  a[row]      * b[col * 4]
+                + a[4 + row]  * b[col * 4 + 1]
+                + a[8 + row]  * b[col * 4 + 2]
+                + a[12 + row] * b[col * 4 + 3];
+        }
+    }
+    memcpy(out, r, sizeof(r));
+}
+
+void ltMatTranslate(LTfloat *m, LTfloat x, LTfloat y, LTfloat z) {
+    for (int row = 0; row < 4; row++) {
+        m[12 + row] += m[row] * x + m[4 + row] * y + m[8 + row] * z;
+    }
+}
+
+void ltMatRotate(LTfloat *m, LTdegrees angle, LTfloat x, LTfloat y, LTfloat z) {
+    LTfloat len = sqrtf(x * x + y * y + z * z);
+    if (len == 0.0f) {
+        return;
+    }
+    x /= len;
+    y /= len;
+    z /= len;
+    LTfloat r = angle * LT_RADIANS_PER_DEGREE;
+    LTfloat c = cosf(r);
+    LTfloat s = sinf(r);
+    LTfloat t = 1.0f - c;
+    LTfloat rot[16] = {
+        x * x * t + c,      y * x * t + z * s,  x * z * t - y * s,  0,
+        x * y * t - z * s,  y * y * t + c,      y * z * t + x * s,  0,
+        x * z * t + y * s,  y * z * t - x * s,  z * z * t + c,      0,
+        0,                  0,                  0,                  1,
+    };
+    ltMatMultiply(m, m, rot);
+}
+
+void ltMatScale(LTfloat *m, LTfloat x, LTfloat y, LTfloat z) {
+    for (int row = 0; row < 4; row++) {
+        m[row] *= x;
+        m[4 + row] *= y;
+        m[8 + row] *= z;
+    }
+}
+
+void ltMatOrtho(LTfloat *m, LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat nearz, LTfloat farz) {
+    LTfloat o[16] = {
+        2.0f / (right - left), 0, 0, 0,
+        0, 2.0f / (top - bottom), 0, 0,
+        0, 0, -2.0f / (farz - nearz), 0,
+        -(right + left) / (right - left), -(top + bottom) / (top - bottom), -(farz + nearz) / (farz - nearz), 1,
+    };
+    ltMatMultiply(m, m, o);
+}
+
+void ltMatFrustum(LTfloat *m, LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat nearz, LTfloat farz) {
+    LTfloat f[16] = {
+        2.0f * nearz / (right - left), 0, 0, 0,
+        0, 2.0f * nearz / (top - bottom), 0, 0,
+        (right + left) / (right - left), (top + bottom) / (top - bottom), -(farz + nearz) / (farz - nearz), -1,
+        0, 0, -2.0f * farz * nearz / (farz - nearz), 0,
+    };
+    ltMatMultiply(m, m, f);
+}
+
+LTVec3 ltMatTransform(const LTfloat *m, LTVec3 p) {
+    return LTVec3(
+        m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+        m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+        m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+}
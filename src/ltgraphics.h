@@ -145,6 +145,19 @@ struct LTColor {
     }
 };
 
+// 4x4 matrices are arrays of 16 floats in column major order, as in GL.
+// The functions that take a matrix and transform arguments multiply it
+// on the right, like the corresponding GL calls.
+void ltMatIdentity(LTfloat *m);
+void ltMatMultiply(LTfloat *out, const LTfloat *a, const LTfloat *b); // out = a * b
+void ltMatTranslate(LTfloat *m, LTfloat x, LTfloat y, LTfloat z);
+void ltMatRotate(LTfloat *m, LTdegrees angle, LTfloat x, LTfloat y, LTfloat z);
+void ltMatScale(LTfloat *m, LTfloat x, LTfloat y, LTfloat z);
+void ltMatOrtho(LTfloat *m, LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat nearz, LTfloat farz);
+void ltMatFrustum(LTfloat *m, LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat nearz, LTfloat farz);
+// m * (p, 1), ignoring the w row.
+LTVec3 ltMatTransform(const LTfloat *m, LTVec3 p);
+
 enum LTDisplayOrientation {
     LT_DISPLAY_ORIENTATION_PORTRAIT,
     LT_DISPLAY_ORIENTATION_LANDSCAPE,
@@ -199,6 +212,7 @@ void ltPeekTint(LTColor *color);
 void ltRestoreTint();
 void ltPushBlendMode(LTBlendMode mode);
 void ltPopBlendMode();
+LTBlendMode ltPeekBlendMode();
 void ltPushTextureMode(LTTextureMode mode);
 void ltPopTextureMode();
 
@@ -12,7 +12,10 @@ void ltEnableAtlas(LTAtlas *atlas) {
     ltEnableTexture(atlas->texture_id);
 }
 
+static void use_texture(LTtexid texture_id);
+
 void ltEnableTexture(LTtexid texture_id) {
+    use_texture(texture_id);
     ltBindTexture(texture_id);
     ltEnableTexturing();
     ltEnableTextureCoordArrays();
@@ -23,11 +26,481 @@ void ltDisableTextures() {
     ltDisableTextureCoordArrays();
 }
 
-LTAtlas::LTAtlas(LTImagePacker *packer, LTTextureFilter minfilter, LTTextureFilter magfilter) {
+//-----------------------------------------------------------------
+
+static std::map<LTtexid, LTAtlas*> atlases_by_texture;
+static int texture_budget = 0;
+static int texture_frame = 0;
+static unsigned int texture_use_clock = 0;
+static LTtexid last_used_texture = 0;
+static LTTextureStats texture_stats;
+
+// Evicts atlases, least recently drawn first, until the resident ones
+// fit the budget.  Only atlases last drawn before frame before_frame
+// (and not keep) are evicted.
+static void enforce_texture_budget(LTAtlas *keep, int before_frame) {
+    while (texture_budget > 0 && texture_stats.resident_bytes > texture_budget) {
+        LTAtlas *lru = NULL;
+        std::map<LTtexid, LTAtlas*>::iterator it;
+        for (it = atlases_by_texture.begin(); it != atlases_by_texture.end(); it++) {
+            LTAtlas *a = it->second;
+            if (a != keep && a->resident && a->reloadable && a->last_frame < before_frame
+                && (lru == NULL || a->last_use < lru->last_use))
+            {
+                lru = a;
+            }
+        }
+        if (lru == NULL) {
+            // Everything else resident is needed.
+            return;
+        }
+        lru->evict();
+    }
+}
+
+static void make_resident(LTAtlas *atlas) {
+    atlas->resident = true;
+    texture_stats.resident++;
+    texture_stats.resident_bytes += atlas->bytes();
+    if (texture_stats.resident_bytes > texture_stats.peak_resident_bytes) {
+        texture_stats.peak_resident_bytes = texture_stats.resident_bytes;
+    }
+}
+
+static void use_texture(LTtexid texture_id) {
+    if (texture_id == last_used_texture) {
+        return;
+    }
+    last_used_texture = texture_id;
+    std::map<LTtexid, LTAtlas*>::iterator it = atlases_by_texture.find(texture_id);
+    if (it != atlases_by_texture.end()) {
+        LTAtlas *atlas = it->second;
+        atlas->last_frame = texture_frame;
+        atlas->last_use = ++texture_use_clock;
+        if (!atlas->resident) {
+            atlas->reload();
+        }
+    }
+}
+
+void ltSetTextureBudget(int bytes) {
+    texture_budget = bytes;
+    enforce_texture_budget(NULL, texture_frame);
+}
+
+int ltGetTextureBudget() {
+    return texture_budget;
+}
+
+void ltTextureFrameBoundary() {
+    texture_frame++;
+    last_used_texture = 0;
+    // Atlases drawn in the last frame will probably be drawn again.
+    enforce_texture_budget(NULL, texture_frame - 1);
+}
+
+void ltGetTextureStats(LTTextureStats *stats) {
+    *stats = texture_stats;
+}
+
+void ltResetTexturePeak() {
+    texture_stats.peak_resident_bytes = texture_stats.resident_bytes;
+}
+
+struct LTCStrCmp {
+    bool operator()(const char *a, const char *b) const {
+        return strcmp(a, b) < 0;
+    }
+};
+
+// Records where the packer's images came from and where they are, so
+// the atlas can be rebuilt.
+static void add_atlas_images(LTAtlas *atlas, LTImagePacker *packer,
+    std::map<const char*, int, LTCStrCmp> *source_index)
+{
+    if (packer->occupant == NULL) {
+        return;
+    }
+    LTImageBuffer *occupant = packer->occupant;
+    if (occupant->path == NULL) {
+        atlas->reloadable = false;
+    } else {
+        int src;
+        std::map<const char*, int, LTCStrCmp>::iterator it = source_index->find(occupant->path);
+        if (it == source_index->end()) {
+            LTAtlasSource source;
+            source.path = new char[strlen(occupant->path) + 1];
+            strcpy(source.path, occupant->path);
+            source.num_glyphs = 0;
+            src = atlas->sources.size();
+            atlas->sources.push_back(source);
+            (*source_index)[atlas->sources[src].path] = src;
+        } else {
+            src = it->second;
+        }
+        LTAtlasSource *source = &atlas->sources[src];
+        LTAtlasImage img;
+        img.glyph_index = occupant->glyph_index;
+        img.left = packer->left;
+        img.bottom = packer->bottom;
+        img.rotated = packer->rotated;
+        source->images.push_back(img);
+        if (img.glyph_index >= source->num_glyphs) {
+            source->num_glyphs = img.glyph_index + 1;
+        }
+    }
+    add_atlas_images(atlas, packer->lo_child, source_index);
+    add_atlas_images(atlas, packer->hi_child, source_index);
+}
+
+//-----------------------------------------------------------------
+
+// Where libpng puts each channel (see ltReadImage).
+#ifdef LTGLES1
+#define PIXEL_RED(pxl)      ((pxl) & 0xFF)
+#define PIXEL_BLUE(pxl)     (((pxl) >> 16) & 0xFF)
+#else
+#define PIXEL_RED(pxl)      (((pxl) >> 16) & 0xFF)
+#define PIXEL_BLUE(pxl)     ((pxl) & 0xFF)
+#endif
+#define PIXEL_GREEN(pxl)    (((pxl) >> 8) & 0xFF)
+#define PIXEL_ALPHA(pxl)    (((pxl) >> 24) & 0xFF)
+
+static LTTextureFormat default_atlas_format = LT_TEXTURE_FORMAT_RGBA8888;
+static LTDither default_atlas_dither = LT_DITHER_NONE;
+
+void ltSetDefaultAtlasFormat(LTTextureFormat format, LTDither dither) {
+    default_atlas_format = format;
+    default_atlas_dither = dither;
+}
+
+void ltGetDefaultAtlasFormat(LTTextureFormat *format, LTDither *dither) {
+    *format = default_atlas_format;
+    *dither = default_atlas_dither;
+}
+
+int ltTextureFormatBytes(LTTextureFormat format) {
+    switch (format) {
+        case LT_TEXTURE_FORMAT_RGB565:
+        case LT_TEXTURE_FORMAT_RGBA4444:
+        case LT_TEXTURE_FORMAT_RGBA5551:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+const char *ltTextureFormatName(LTTextureFormat format) {
+    switch (format) {
+        case LT_TEXTURE_FORMAT_RGBA8888: return "rgba8888";
+        case LT_TEXTURE_FORMAT_RGB565: return "rgb565";
+        case LT_TEXTURE_FORMAT_RGBA4444: return "rgba4444";
+        case LT_TEXTURE_FORMAT_RGBA5551: return "rgba5551";
+        case LT_TEXTURE_FORMAT_AUTO: return "auto";
+    }
+    return "unknown";
+}
+
+const char *ltDitherName(LTDither dither) {
+    switch (dither) {
+        case LT_DITHER_NONE: return "none";
+        case LT_DITHER_ORDERED: return "ordered";
+        case LT_DITHER_DIFFUSE: return "diffuse";
+    }
+    return "unknown";
+}
+
+// Bits per channel (red, green, blue, alpha) and their positions.
+static void format_bits(LTTextureFormat format, int *bits, int *shifts) {
+    static const int bits565[4] = {5, 6, 5, 0};
+    static const int shifts565[4] = {11, 5, 0, 0};
+    static const int bits4444[4] = {4, 4, 4, 4};
+    static const int shifts4444[4] = {12, 8, 4, 0};
+    static const int bits5551[4] = {5, 5, 5, 1};
+    static const int shifts5551[4] = {11, 6, 1, 0};
+    const int *b, *sh;
+    switch (format) {
+        case LT_TEXTURE_FORMAT_RGB565: b = bits565; sh = shifts565; break;
+        case LT_TEXTURE_FORMAT_RGBA4444: b = bits4444; sh = shifts4444; break;
+        default: b = bits5551; sh = shifts5551; break;
+    }
+    memcpy(bits, b, sizeof(int) * 4);
+    memcpy(shifts, sh, sizeof(int) * 4);
+}
+
+// Nearest n bit level to an 8 bit value, and back.
+static inline int quantize(int v, int max) {
+    return (v * max + 127) / 255;
+}
+
+static inline int expand(int q, int max) {
+    return (q * 255 + max / 2) / max;
+}
+
+static inline void pixel_channels(LTpixel pxl, int *c) {
+    c[0] = PIXEL_RED(pxl);
+    c[1] = PIXEL_GREEN(pxl);
+    c[2] = PIXEL_BLUE(pxl);
+    c[3] = PIXEL_ALPHA(pxl);
+}
+
+static const int bayer4x4[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5},
+};
+
+// Level q (of max) to use for 8 bit value v at threshold m of the
+// ordered dither pattern.  Values between two levels use the higher one
+// at a number of the 16 thresholds proportional to how close they are
+// to it, so values that are exactly a level are left alone.
+static int ordered_level(int v, int max, int m) {
+    int lo = v * max / 255;
+    while (lo > 0 && expand(lo, max) > v) {
+        lo--;
+    }
+    if (lo == max) {
+        return lo;
+    }
+    int lo_v = expand(lo, max);
+    int hi_v = expand(lo + 1, max);
+    return lo + ((v - lo_v) * 32 > (2 * m + 1) * (hi_v - lo_v) ? 1 : 0);
+}
+
+void ltConvertPixels(const LTpixel *src, LTushort *dest, int width, int height,
+    LTTextureFormat format, LTDither dither)
+{
+    int bits[4], shifts[4], max[4];
+    format_bits(format, bits, shifts);
+    for (int c = 0; c < 4; c++) {
+        max[c] = (1 << bits[c]) - 1;
+    }
+    // Channels that are dithered.  1 bit alpha is thresholded.
+    int dithered = bits[3] > 1 ? 4 : 3;
+
+    // Each channel's contribution to the texel, by 8 bit value.
+    LTushort nearest[4][256];
+    for (int c = 0; c < 4; c++) {
+        for (int v = 0; v < 256; v++) {
+            nearest[c][v] = bits[c] == 0 ? 0 : quantize(v, max[c]) << shifts[c];
+        }
+    }
+    // The same for each of the 16 thresholds of the ordered pattern.
+    LTushort (*ordered)[16][256] = NULL;
+    if (dither == LT_DITHER_ORDERED) {
+        ordered = new LTushort[4][16][256];
+        for (int c = 0; c < 4; c++) {
+            for (int m = 0; m < 16; m++) {
+                for (int v = 0; v < 256; v++) {
+                    ordered[c][m][v] = c >= dithered ? nearest[c][v]
+                        : bits[c] == 0 ? 0 : ordered_level(v, max[c], m) << shifts[c];
+                }
+            }
+        }
+    }
+    // Diffused error for this row and the next, in 16ths of an 8 bit
+    // level, with a pixel of padding at each end.  Values with error
+    // added are quantized through a table by 16th, and diffused_value
+    // holds each level's value in 16ths.
+    int *err = NULL, *next_err = NULL;
+    unsigned char (*diffused_level)[255 * 16 + 1] = NULL;
+    int diffused_value[4][64];
+    if (dither == LT_DITHER_DIFFUSE) {
+        err = new int[(width + 2) * 4];
+        next_err = new int[(width + 2) * 4];
+        memset(err, 0, sizeof(int) * (width + 2) * 4);
+        diffused_level = new unsigned char[4][255 * 16 + 1];
+        for (int c = 0; c < dithered; c++) {
+            for (int v = 0; v <= 255 * 16; v++) {
+                diffused_level[c][v] = (v * max[c] + 255 * 8) / (255 * 16);
+            }
+            for (int q = 0; q <= max[c]; q++) {
+                diffused_value[c][q] = expand(q, max[c]) * 16;
+            }
+        }
+    }
+
+    int ch[4];
+    for (int y = 0; y < height; y++) {
+        if (err != NULL) {
+            memset(next_err, 0, sizeof(int) * (width + 2) * 4);
+        }
+        for (int x = 0; x < width; x++) {
+            pixel_channels(*src++, ch);
+            if (ch[3] == 0 || dither == LT_DITHER_NONE) {
+                // Transparent pixels are not dithered, nor is their error
+                // passed on.
+                *dest++ = nearest[0][ch[0]] | nearest[1][ch[1]] | nearest[2][ch[2]] | nearest[3][ch[3]];
+            } else if (ordered != NULL) {
+                int m = bayer4x4[y & 3][x & 3];
+                *dest++ = ordered[0][m][ch[0]] | ordered[1][m][ch[1]]
+                    | ordered[2][m][ch[2]] | ordered[3][m][ch[3]];
+            } else {
+                LTushort texel = 0;
+                for (int c = 0; c < 4; c++) {
+                    if (c >= dithered) {
+                        texel |= nearest[c][ch[c]];
+                        continue;
+                    }
+                    int *e = &err[(x + 1) * 4 + c];
+                    int v = ch[c] * 16 + *e;
+                    v = v < 0 ? 0 : v > 255 * 16 ? 255 * 16 : v;
+                    int q = diffused_level[c][v];
+                    int d = v - diffused_value[c][q];
+                    e[4] += d * 7 / 16;
+                    next_err[x * 4 + c] += d * 3 / 16;
+                    next_err[(x + 1) * 4 + c] += d * 5 / 16;
+                    next_err[(x + 2) * 4 + c] += d / 16;
+                    texel |= q << shifts[c];
+                }
+                *dest++ = texel;
+            }
+        }
+        if (err != NULL) {
+            int *tmp = err;
+            err = next_err;
+            next_err = tmp;
+        }
+    }
+    if (ordered != NULL) {
+        delete[] ordered;
+    }
+    if (err != NULL) {
+        delete[] err;
+        delete[] next_err;
+        delete[] diffused_level;
+    }
+}
+
+// What the images in a packer need from a texture format.
+struct LTPixelContent {
+    bool opaque;
+    bool binary_alpha;      // Each pixel is opaque or fully transparent.
+    // Whether the colours of visible pixels convert exactly.
+    bool exact_rgb444;
+    bool exact_rgb555;
+    bool exact_rgb565;
+    bool exact_alpha4;
+};
+
+static void init_content(LTPixelContent *content) {
+    content->opaque = true;
+    content->binary_alpha = true;
+    content->exact_rgb444 = true;
+    content->exact_rgb555 = true;
+    content->exact_rgb565 = true;
+    content->exact_alpha4 = true;
+}
+
+static inline bool exact(int v, int max) {
+    return expand(quantize(v, max), max) == v;
+}
+
+static void scan_packer(LTImagePacker *packer, LTPixelContent *content) {
+    if (packer->occupant == NULL) {
+        return;
+    }
+    LTImageBuffer *img = packer->occupant;
+    int n = img->num_bb_pixels();
+    int ch[4];
+    for (int i = 0; i < n; i++) {
+        pixel_channels(img->bb_pixels[i], ch);
+        if (ch[3] != 255) {
+            content->opaque = false;
+        }
+        if (ch[3] == 0) {
+            continue;
+        }
+        if (ch[3] != 255) {
+            content->binary_alpha = false;
+            content->exact_alpha4 = content->exact_alpha4 && exact(ch[3], 15);
+        }
+        bool rb4 = exact(ch[0], 15) && exact(ch[2], 15);
+        bool rb5 = exact(ch[0], 31) && exact(ch[2], 31);
+        content->exact_rgb444 = content->exact_rgb444 && rb4 && exact(ch[1], 15);
+        content->exact_rgb555 = content->exact_rgb555 && rb5 && exact(ch[1], 31);
+        content->exact_rgb565 = content->exact_rgb565 && rb5 && exact(ch[1], 63);
+    }
+    scan_packer(packer->lo_child, content);
+    scan_packer(packer->hi_child, content);
+}
+
+static bool converts_exactly(LTPixelContent *content, LTTextureFormat format) {
+    switch (format) {
+        case LT_TEXTURE_FORMAT_RGB565:
+            return content->opaque && content->exact_rgb565;
+        case LT_TEXTURE_FORMAT_RGBA4444:
+            return content->exact_alpha4 && content->exact_rgb444;
+        case LT_TEXTURE_FORMAT_RGBA5551:
+            return content->binary_alpha && content->exact_rgb555;
+        default:
+            return true;
+    }
+}
+
+static LTTextureFormat choose_format(LTPixelContent *content) {
+    if (content->opaque) {
+        return LT_TEXTURE_FORMAT_RGB565;
+    } else if (content->binary_alpha) {
+        return LT_TEXTURE_FORMAT_RGBA5551;
+    } else {
+        return LT_TEXTURE_FORMAT_RGBA4444;
+    }
+}
+
+LTTextureFormat ltChooseTextureFormat(LTImagePacker *packer, bool *exact) {
+    LTPixelContent content;
+    init_content(&content);
+    scan_packer(packer, &content);
+    LTTextureFormat format = choose_format(&content);
+    *exact = converts_exactly(&content, format);
+    return format;
+}
+
+// Uploads buf (the whole atlas) to the bound texture.
+static void upload_atlas(LTAtlas *atlas, LTImageBuffer *buf) {
+    if (atlas->format == LT_TEXTURE_FORMAT_RGBA8888) {
+        ltTexImage(buf->width, buf->height, buf->bb_pixels);
+        return;
+    }
+    LT_PROFILE_SCOPE("atlas convert");
+    LTdouble t0 = ltGetTime();
+    LTushort *texels = new LTushort[buf->width * buf->height];
+    ltConvertPixels(buf->bb_pixels, texels, buf->width, buf->height, atlas->format, atlas->dither);
+    texture_stats.converted++;
+    texture_stats.convert_time += ltGetTime() - t0;
+    ltTexImage(buf->width, buf->height, texels, atlas->format);
+    delete[] texels;
+}
+
+LTAtlas::LTAtlas(LTImagePacker *packer, LTTextureFilter minfilter, LTTextureFilter magfilter,
+    LTTextureFormat format, LTDither dither)
+{
     static int atlas_num = 1;
     char atlas_name[64];
     snprintf(atlas_name, 64, "atlas%d", atlas_num++);
     ref_count = 0;
+    width = packer->width;
+    height = packer->height;
+    LTAtlas::minfilter = minfilter;
+    LTAtlas::magfilter = magfilter;
+    LTAtlas::format = format;
+    LTAtlas::dither = dither;
+    if (format != LT_TEXTURE_FORMAT_RGBA8888) {
+        LTPixelContent content;
+        init_content(&content);
+        scan_packer(packer, &content);
+        if (format == LT_TEXTURE_FORMAT_AUTO) {
+            LTAtlas::format = choose_format(&content);
+        }
+        if (converts_exactly(&content, LTAtlas::format)) {
+            LTAtlas::dither = LT_DITHER_NONE;
+        }
+    }
+    reloadable = true;
+    std::map<const char*, int, LTCStrCmp> source_index;
+    add_atlas_images(this, packer, &source_index);
     LTImageBuffer *buf = ltCreateAtlasImage(atlas_name, packer);
 #ifdef LT_DUMP_ATLASES
     {
@@ -42,14 +515,95 @@ LTAtlas::LTAtlas(LTImagePacker *packer, LTTextureFilter minfilter, LTTextureFilt
     ltBindTexture(texture_id);
     ltTextureMinFilter(minfilter);
     ltTextureMagFilter(magfilter);
-    ltTexImage(buf->width, buf->height, buf->bb_pixels);
+    upload_atlas(this, buf);
     delete buf;
+
+    atlases_by_texture[texture_id] = this;
+    texture_stats.atlases++;
+    texture_stats.bytes += bytes();
+    texture_stats.saved_bytes += width * height * 4 - bytes();
+    last_frame = texture_frame;
+    last_use = ++texture_use_clock;
+    make_resident(this);
+    enforce_texture_budget(this, texture_frame);
 }
 
 LTAtlas::~LTAtlas() {
+    if (resident) {
+        texture_stats.resident--;
+        texture_stats.resident_bytes -= bytes();
+    }
+    texture_stats.atlases--;
+    texture_stats.bytes -= bytes();
+    texture_stats.saved_bytes -= width * height * 4 - bytes();
+    atlases_by_texture.erase(texture_id);
+    if (last_used_texture == texture_id) {
+        last_used_texture = 0;
+    }
+    for (unsigned int i = 0; i < sources.size(); i++) {
+        delete[] sources[i].path;
+    }
     ltDeleteTexture(texture_id);
 }
 
+void LTAtlas::evict() {
+    // A 0x0 image frees the texture's storage but keeps its name.
+    ltBindTexture(texture_id);
+    ltTexImage(0, 0, NULL, format);
+    resident = false;
+    texture_stats.resident--;
+    texture_stats.resident_bytes -= bytes();
+    texture_stats.evictions++;
+    if (last_used_texture == texture_id) {
+        last_used_texture = 0;
+    }
+}
+
+void LTAtlas::reload() {
+    LT_PROFILE_SCOPE("atlas reload");
+    LTdouble t0 = ltGetTime();
+    LTImageBuffer *buf = ltCreateEmptyImageBuffer("atlas", width, height);
+    for (unsigned int i = 0; i < sources.size(); i++) {
+        LTAtlasSource *source = &sources[i];
+        LTImageBuffer *img = ltReadImage(source->path, "atlas image");
+        if (img == NULL) {
+            // ltReadImage has logged the error.  The images will be blank.
+            continue;
+        }
+        std::vector<LTImageBuffer*> glyphs;
+        if (source->num_glyphs > 0) {
+            // Glyphs are split off in order, so only the characters'
+            // count matters.
+            char *chars = new char[source->num_glyphs + 1];
+            memset(chars, ' ', source->num_glyphs);
+            chars[source->num_glyphs] = '\0';
+            std::list<LTImageBuffer*> *glyph_list = ltImageBufferToGlyphs(img, chars);
+            glyphs.assign(glyph_list->begin(), glyph_list->end());
+            delete glyph_list;
+            delete[] chars;
+        }
+        for (unsigned int j = 0; j < source->images.size(); j++) {
+            LTAtlasImage *ai = &source->images[j];
+            if (ai->glyph_index < 0) {
+                ltPasteImage(img, buf, ai->left, ai->bottom, ai->rotated);
+            } else if (ai->glyph_index < (int)glyphs.size()) {
+                ltPasteImage(glyphs[ai->glyph_index], buf, ai->left, ai->bottom, ai->rotated);
+            }
+        }
+        for (unsigned int j = 0; j < glyphs.size(); j++) {
+            delete glyphs[j];
+        }
+        delete img;
+    }
+    ltBindTexture(texture_id);
+    upload_atlas(this, buf);
+    delete buf;
+    texture_stats.reloads++;
+    texture_stats.reload_time += ltGetTime() - t0;
+    make_resident(this);
+    enforce_texture_budget(this, texture_frame);
+}
+
 LTImageBuffer::LTImageBuffer(const char *name) {
     LTImageBuffer::name = new char[strlen(name) + 1];
     strcpy(LTImageBuffer::name, name);
@@ -57,12 +611,17 @@ LTImageBuffer::LTImageBuffer(const char *name) {
     glyph_char = '\0';
     scaling = 1.0f;
     bb_pixels = NULL;
+    path = NULL;
+    glyph_index = -1;
 }
 
 LTImageBuffer::~LTImageBuffer() {
     if (bb_pixels != NULL) {
         delete[] bb_pixels;
     }
+    if (path != NULL) {
+        delete[] path;
+    }
     delete[] name;
 }
 
@@ -244,6 +803,8 @@ LTImageBuffer *ltReadImage(const char *path, const char *name) {
 
     LTImageBuffer *imgbuf = new LTImageBuffer(name);
     imgbuf->scaling = get_img_scaling(path);
+    imgbuf->path = new char[strlen(path) + 1];
+    strcpy(imgbuf->path, path);
 
     // Check for bounding box chunk.
     png_get_text(png_ptr, info_ptr, &text_ptr, &num_txt_chunks);
@@ -690,6 +1251,17 @@ void LTTexturedNode::draw() {
     ltDrawArrays(LT_DRAWMODE_TRIANGLE_FAN, 0, 4);
 }
 
+bool LTTexturedNode::bake(LTBaker *baker) {
+    baker->add_quad(texture_id, world_vertices, tex_coords);
+    return true;
+}
+
+void LTTexturedNode::enqueue(LTRenderQueue *queue) {
+    LTfloat *v = world_vertices;
+    LTVec3 centre((v[0] + v[4]) * 0.5f, (v[1] + v[5]) * 0.5f, 0.0f);
+    queue->add(this, centre, true, texture_id);
+}
+
 static LTfloat get_wld_left(LTObject *obj) {
     return ((LTTexturedNode*)obj)->world_vertices[0];
 }
@@ -29,6 +29,12 @@ struct LTImageBuffer {
     char glyph_char;
     LTfloat scaling;
 
+    // The file the pixels were read from (NULL if they weren't) and, for
+    // glyphs, the glyph's position in the font image.  Atlases use these
+    // to rebuild evicted textures.
+    char *path;
+    int glyph_index;
+
     // LTImageBuffer will make a copy of the filename string.
     LTImageBuffer(const char *file);
     virtual ~LTImageBuffer();
@@ -88,14 +94,115 @@ LTImageBuffer *ltCreateAtlasImage(const char *name, LTImagePacker *packer);
 /* The caller is responsible for freeing the buffer (with delete). */
 LTImageBuffer *ltCreateEmptyImageBuffer(const char *name, int w, int h);
 
+// Atlases may be uploaded in a 16 bit format, converted on the CPU when
+// the atlas is built.  With LT_TEXTURE_FORMAT_AUTO the format is chosen
+// from the packed images: RGB565 if they're opaque, RGBA5551 if every
+// pixel is either opaque or fully transparent, and RGBA4444 otherwise.
+// Dithering spreads the rounding error, either with a 4x4 ordered
+// pattern or by error diffusion (Floyd-Steinberg).  It's skipped when
+// the images convert exactly, and fully transparent pixels are never
+// dithered, so they don't bleed colour into filtered edges.  1 bit alpha
+// is always thresholded.
+
+enum LTDither {
+    LT_DITHER_NONE,
+    LT_DITHER_ORDERED,
+    LT_DITHER_DIFFUSE,
+};
+
+// Bytes per texel.
+int ltTextureFormatBytes(LTTextureFormat format);
+const char *ltTextureFormatName(LTTextureFormat format);
+const char *ltDitherName(LTDither dither);
+
+// The format LT_TEXTURE_FORMAT_AUTO picks for the packer's images.
+// Sets *exact to whether they would convert to it without loss.
+LTTextureFormat ltChooseTextureFormat(LTImagePacker *packer, bool *exact);
+
+// Converts width x height pixels to a 16 bit format.  dest must have
+// room for width * height shorts.
+void ltConvertPixels(const LTpixel *src, LTushort *dest, int width, int height,
+    LTTextureFormat format, LTDither dither);
+
+// Used by lt.LoadImages when it's given no format (initially RGBA8888
+// and no dithering).
+void ltSetDefaultAtlasFormat(LTTextureFormat format, LTDither dither);
+void ltGetDefaultAtlasFormat(LTTextureFormat *format, LTDither *dither);
+
+// Atlas textures are subject to a texture memory budget.  Each atlas
+// records where its images came from and where they were packed, so its
+// texture can be dropped and later rebuilt from the image files.
+// Whenever the resident atlases exceed the budget, the least recently
+// drawn ones are evicted until they fit: when an atlas becomes resident
+// (it's created, or drawn after being evicted), atlases not drawn in the
+// current frame may be evicted, and at each frame boundary, atlases not
+// drawn in the last frame may be.  Evicted atlases keep their texture
+// name, so the texture ids held by images, meshes and baked nodes stay
+// valid.
+// Atlases with images not read from files are never evicted.
+
+struct LTAtlasImage {
+    int glyph_index;    // -1 if not a glyph.
+    int left;
+    int bottom;
+    bool rotated;
+};
+
+struct LTAtlasSource {
+    char *path;
+    int num_glyphs;     // Glyphs to split the image into, or 0.
+    std::vector<LTAtlasImage> images;
+};
+
 struct LTAtlas {
     LTtexid texture_id;
     int ref_count;
 
-    LTAtlas(LTImagePacker *packer, LTTextureFilter minfilter, LTTextureFilter magfilter);
+    int width;
+    int height;
+    LTTextureFilter minfilter;
+    LTTextureFilter magfilter;
+    LTTextureFormat format;
+    LTDither dither;
+    std::vector<LTAtlasSource> sources;
+    bool reloadable;
+    bool resident;
+    int last_frame;     // Frame in which the atlas was last drawn.
+    unsigned int last_use;
+
+    LTAtlas(LTImagePacker *packer, LTTextureFilter minfilter, LTTextureFilter magfilter,
+        LTTextureFormat format = LT_TEXTURE_FORMAT_RGBA8888, LTDither dither = LT_DITHER_NONE);
     virtual ~LTAtlas();
+
+    int bytes() { return width * height * ltTextureFormatBytes(format); }
+    void evict();
+    // Rebuilds the texture from the image files.
+    void reload();
+};
+
+// 0 means no budget (the default).
+void ltSetTextureBudget(int bytes);
+int ltGetTextureBudget();
+// Starts a new frame for the purposes of eviction (see above).
+void ltTextureFrameBoundary();
+
+struct LTTextureStats {
+    int atlases;
+    int resident;
+    int bytes;              // Of all atlases, resident or not.
+    int resident_bytes;
+    int peak_resident_bytes;
+    int evictions;
+    int reloads;
+    LTdouble reload_time;   // Seconds.
+    int converted;          // Uploads converted to 16 bit formats.
+    LTdouble convert_time;  // Seconds.
+    int saved_bytes;        // Of all atlases, compared with RGBA8888.
 };
 
+void ltGetTextureStats(LTTextureStats *stats);
+void ltResetTexturePeak();
+
 // This represents a node that has a texture associated with it.
 // (LTRenderTarget is also a LTTexturedNode).
 struct LTTexturedNode : LTSceneNode {
@@ -112,6 +219,8 @@ struct LTTexturedNode : LTSceneNode {
 
     virtual ~LTTexturedNode();
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
+    virtual bool bake(LTBaker *baker);
 };
 
 struct LTImage : LTTexturedNode {
@@ -140,3 +249,4 @@ struct LTImage : LTTexturedNode {
 
 LTTexturedNode *lt_expect_LTTexturedNode(lua_State *L, int arg);
 void* lt_alloc_LTImage(lua_State *L);
+bool lt_is_LTImage(lua_State *L, int arg);
@@ -4,6 +4,7 @@
 LT_INIT_IMPL(ltlighting)
 
 static int next_light_num = 0;
+static bool lighting_on = false;
 
 LTLightingNode::LTLightingNode() {
     enabled = true;
@@ -11,7 +12,6 @@ LTLightingNode::LTLightingNode() {
 
 void LTLightingNode::draw() {
     if (child != NULL) {
-        static bool lighting_on = false;
         bool prev_lighting = lighting_on;
         if (enabled) {
             ltEnableLighting();
@@ -30,6 +30,15 @@ void LTLightingNode::draw() {
     }
 }
 
+void LTLightingNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->push();
+        queue->state()->lighting.lighting = enabled;
+        child->enqueue(queue);
+        queue->pop();
+    }
+}
+
 LT_REGISTER_TYPE(LTLightingNode, "lt.Lighting", "lt.Wrap")
 LT_REGISTER_FIELD_BOOL(LTLightingNode, enabled)
 
@@ -52,20 +61,39 @@ LTLight::LTLight() {
     fixed = false;
 }
 
-void LTLight::draw() {
-    int light_num = next_light_num;
-    next_light_num++;
+void LTLight::setup(int light_num) {
     ltEnableLight(light_num);
     ltLightAmbient(light_num, ambient.red, ambient.green, ambient.blue);
     ltLightDiffuse(light_num, diffuse.red, diffuse.green, diffuse.blue);
     ltLightSpecular(light_num, specular.red, specular.green, specular.blue);
     ltLightPosition(light_num, position.x, position.y, position.z, fixed ? 0 : 1);
     ltLightAttenuation(light_num, atten_q, atten_l, atten_c);
+}
+
+void LTLight::draw() {
+    int light_num = next_light_num;
+    next_light_num++;
+    setup(light_num);
     child->draw();
     ltDisableLight(light_num);
     next_light_num--;
 }
 
+void LTLight::enqueue(LTRenderQueue *queue) {
+    queue->push();
+    queue->add_light(this);
+    child->enqueue(queue);
+    queue->pop();
+}
+
+int ltNextLightNum() {
+    return next_light_num;
+}
+
+void ltSetNextLightNum(int n) {
+    next_light_num = n;
+}
+
 LT_REGISTER_TYPE(LTLight, "lt.Light", "lt.Wrap")
 LT_REGISTER_FIELD_FLOAT_AS(LTLight, ambient.red, "ambient_red")
 LT_REGISTER_FIELD_FLOAT_AS(LTLight, ambient.green, "ambient_green")
@@ -101,6 +129,8 @@ LTMaterial::LTMaterial() {
 };
 
 static std::vector<LTMaterial*> material_stack;
+// The material when the stack is empty, as set by ltSetLightingState.
+static LTMaterial *base_material = NULL;
 
 void LTMaterial::setup() {
     ltMaterialAmbient(ambient.red, ambient.green, ambient.blue);
@@ -120,6 +150,49 @@ void LTMaterial::draw() {
     }
 }
 
+void LTMaterial::enqueue(LTRenderQueue *queue) {
+    queue->push();
+    queue->state()->lighting.material = this;
+    child->enqueue(queue);
+    queue->pop();
+}
+
+// GL's initial material.
+static void setup_default_material() {
+    ltMaterialAmbient(0.2f, 0.2f, 0.2f);
+    ltMaterialDiffuse(0.8f, 0.8f, 0.8f, 1.0f);
+    ltMaterialSpecular(0, 0, 0);
+    ltMaterialEmission(0, 0, 0);
+    ltMaterialShininess(0);
+}
+
+void ltGetLightingState(LTLightingState *state) {
+    state->lighting = lighting_on;
+    state->material = material_stack.empty() ? base_material : material_stack.back();
+    state->light = -1;
+}
+
+void ltSetLightingState(LTLightingState *state) {
+    // Unchanged state is filtered out by ltopengl.cpp.  Queued lights
+    // are set by the render queue.
+    if (state->lighting) {
+        ltEnableLighting();
+    } else {
+        ltDisableLighting();
+    }
+    lighting_on = state->lighting;
+    if (state->material != NULL) {
+        state->material->setup();
+    } else {
+        setup_default_material();
+    }
+    if (material_stack.empty()) {
+        base_material = state->material;
+    } else if (state->material != NULL) {
+        material_stack.back() = state->material;
+    }
+}
+
 LT_REGISTER_TYPE(LTMaterial, "lt.Material", "lt.Wrap")
 LT_REGISTER_FIELD_FLOAT_AS(LTMaterial, ambient.red, "ambient_red")
 LT_REGISTER_FIELD_FLOAT_AS(LTMaterial, ambient.green, "ambient_green")
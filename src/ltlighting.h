@@ -7,6 +7,7 @@ struct LTLightingNode : LTWrapNode {
 
     LTLightingNode();
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTLight : LTWrapNode {
@@ -19,8 +20,17 @@ struct LTLight : LTWrapNode {
 
     LTLight();
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
+
+    // Enables GL light light_num with this light's settings.  The
+    // position is transformed by the current modelview matrix.
+    void setup(int light_num);
 };
 
+// The GL light used by the next lt.Light drawn.
+int ltNextLightNum();
+void ltSetNextLightNum(int n);
+
 struct LTMaterial : LTWrapNode {
     LTfloat shininess;
     LTColor ambient;
@@ -30,6 +40,18 @@ struct LTMaterial : LTWrapNode {
 
     LTMaterial();
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 
     void setup();
 };
+
+// The state set by the nearest enclosing lt.Lighting, lt.Material and
+// lt.Light nodes, for render queues (see LT3DState).
+struct LTLightingState {
+    bool lighting;
+    LTMaterial *material;   // NULL for GL's default material.
+    int light;              // Innermost light in the render queue's lights, or -1.
+};
+
+void ltGetLightingState(LTLightingState *state);
+void ltSetLightingState(LTLightingState *state);
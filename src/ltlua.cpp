@@ -9,21 +9,30 @@ LT_INIT_IMPL(ltlua)
 #include <signal.h>
 #endif
 
-static const char* setup_scripts[] = {
-    lt_script_lttimer,
-    lt_script_ltutil,
-    lt_script_ltrefs,
-    lt_script_ltui,
-    lt_script_lttween,
-    lt_script_ltanimator,
-    lt_script_lthierachy,
-    lt_script_ltmath,
-    lt_script_ltgraphics,
-    lt_script_ltimage,
-    lt_script_ltio,
-    lt_script_ltscene,
-    lt_script_lttext,
-    lt_script_ltsprite,
+struct LTSetupScript {
+    const char *name;
+    const char *data;
+    size_t len;
+};
+
+#define LT_SETUP_SCRIPT(name) {"@" #name ".lua", (const char*)lt_script_##name, sizeof(lt_script_##name) - 1}
+
+// Each script is either source or precompiled bytecode (see gen_lua_scripts_h.sh).
+static const LTSetupScript setup_scripts[] = {
+    LT_SETUP_SCRIPT(lttimer),
+    LT_SETUP_SCRIPT(ltutil),
+    LT_SETUP_SCRIPT(ltrefs),
+    LT_SETUP_SCRIPT(ltui),
+    LT_SETUP_SCRIPT(lttween),
+    LT_SETUP_SCRIPT(ltanimator),
+    LT_SETUP_SCRIPT(lthierachy),
+    LT_SETUP_SCRIPT(ltmath),
+    LT_SETUP_SCRIPT(ltgraphics),
+    LT_SETUP_SCRIPT(ltimage),
+    LT_SETUP_SCRIPT(ltio),
+    LT_SETUP_SCRIPT(ltscene),
+    LT_SETUP_SCRIPT(lttext),
+    LT_SETUP_SCRIPT(ltsprite),
 };
 
 #define MAX_START_SCRIPT_LEN 128
@@ -44,8 +53,20 @@ static bool g_gamecenter_initialized = false;
 static char g_start_script[MAX_START_SCRIPT_LEN];
 static bool g_was_error = false;
 
+// Small blocks allocated by the Lua state come from this pool
+// (unless LTNOLUAPOOL is defined).
+static LTPool lua_pool;
+
 /************************* Functions for calling lua **************************/
 
+#ifndef LTNOLUAPOOL
+// Same as the panic function luaL_newstate installs.
+static int panic(lua_State *L) {
+    ltLog("PANIC: unprotected error in call to Lua API (%s)", lua_tostring(L, -1));
+    return 0;
+}
+#endif
+
 // Check lua_pcall return status.
 static void check_status(lua_State *L, int status) {
     if (status) {
@@ -277,7 +298,13 @@ static const char *sound_path(const char *name) {
 }
 
 static const char *model_path(const char *name) {
-    return ltResourcePath(name, ".obj");
+    const char *path = ltResourcePath(name, ".ltm");
+    if (ltResourceExists(path)) {
+        return path;
+    } else {
+        delete[] path;
+        return ltResourcePath(name, ".obj");
+    }
 }
 
 /************************* Start script **************************/
@@ -555,6 +582,7 @@ static int lt_Vector(lua_State *L) {
             lua_pop(L, 1);
         }
         vec->size = capacity;
+        vec->touch();
     } else if (num_args == 2) {
         int capacity = luaL_checkinteger(L, 1);
         int stride = luaL_checkinteger(L, 2);
@@ -567,85 +595,157 @@ static int lt_Vector(lua_State *L) {
     return 1;
 }
 
+// Checks that the width columns starting at the 1 based column at arg
+// are in v and returns the 0 based column.
+static int check_vector_column(lua_State *L, LTVector *v, int arg, int width) {
+    int col = luaL_checkinteger(L, arg);
+    if (col < 1 || col + width - 1 > v->stride) {
+        return luaL_error(L, "Invalid column: %d", col);
+    }
+    return col - 1;
+}
+
 static int lt_GenerateVectorColumn(lua_State *L) {
     int num_args = ltLuaCheckNArgs(L, 3);
     LTVector *v = lt_expect_LTVector(L, 1);
-    int col = luaL_checkinteger(L, 2);
-    int stride = v->stride;
+    int col = check_vector_column(L, v, 2, 1);
     LTfloat lo = luaL_checknumber(L, 3);
     LTfloat hi = lo;
-    if (num_args > 3) {
+    if (num_args > 3 && !lua_isnil(L, 4)) {
         hi = luaL_checknumber(L, 4);
     }
-    if (col > stride || col < 1) {
-        return luaL_error(L, "Invalid column: %d", col);
+    LTRandomGenerator *r = NULL;
+    if (num_args > 4 && !lua_isnil(L, 5)) {
+        r = lt_expect_LTRandomGenerator(L, 5);
     }
-    LTfloat *ptr = v->data + col - 1;
-    LTfloat *end = ptr + v->size * stride;
     if (lo == hi) {
+        LTfloat *ptr = v->data + col;
+        LTfloat *end = ptr + v->size * v->stride;
         while (ptr != end) {
             *ptr = lo;
-            ptr += stride;
+            ptr += v->stride;
         }
+        v->touch();
     } else {
-        while (ptr != end) {
-            *ptr = ltRandBetween(lo, hi);
-            ptr += stride;
-        }
+        ltVectorRandom(v, col, lo, hi, r);
     }
     return 0;
 }
 
+static int lt_AddToVectorColumn(lua_State *L) {
+    ltLuaCheckNArgs(L, 3);
+    LTVector *v = lt_expect_LTVector(L, 1);
+    int col = check_vector_column(L, v, 2, 1);
+    ltVectorAdd(v, col, luaL_checknumber(L, 3));
+    return 0;
+}
+
+static int lt_MultiplyVectorColumn(lua_State *L) {
+    ltLuaCheckNArgs(L, 3);
+    LTVector *v = lt_expect_LTVector(L, 1);
+    int col = check_vector_column(L, v, 2, 1);
+    ltVectorMultiply(v, col, luaL_checknumber(L, 3));
+    return 0;
+}
+
+static int lt_MultiplyAddVectorColumns(lua_State *L) {
+    int num_args = ltLuaCheckNArgs(L, 3);
+    LTVector *v = lt_expect_LTVector(L, 1);
+    int dst = check_vector_column(L, v, 2, 1);
+    int src = check_vector_column(L, v, 3, 1);
+    LTfloat m = 1.0f;
+    if (num_args > 3) {
+        m = luaL_checknumber(L, 4);
+    }
+    ltVectorMultiplyAdd(v, dst, src, m);
+    return 0;
+}
+
+static int lt_ClampVectorColumn(lua_State *L) {
+    ltLuaCheckNArgs(L, 4);
+    LTVector *v = lt_expect_LTVector(L, 1);
+    int col = check_vector_column(L, v, 2, 1);
+    ltVectorClamp(v, col, luaL_checknumber(L, 3), luaL_checknumber(L, 4));
+    return 0;
+}
+
+static int lt_WrapVectorColumn(lua_State *L) {
+    ltLuaCheckNArgs(L, 4);
+    LTVector *v = lt_expect_LTVector(L, 1);
+    int col = check_vector_column(L, v, 2, 1);
+    LTfloat lo = luaL_checknumber(L, 3);
+    LTfloat hi = luaL_checknumber(L, 4);
+    if (hi <= lo) {
+        return luaL_error(L, "Empty wrap range: %f to %f", lo, hi);
+    }
+    ltVectorWrap(v, col, lo, hi);
+    return 0;
+}
+
+static int lt_LerpVectorColumns(lua_State *L) {
+    ltLuaCheckNArgs(L, 5);
+    LTVector *v = lt_expect_LTVector(L, 1);
+    int dst = check_vector_column(L, v, 2, 1);
+    int a = check_vector_column(L, v, 3, 1);
+    int b = check_vector_column(L, v, 4, 1);
+    ltVectorLerp(v, dst, a, b, luaL_checknumber(L, 5));
+    return 0;
+}
+
+// vector:Gather(col, src, src_col, ncols, index, index_col)
+// vector:Scatter(col, src, src_col, ncols, index, index_col)
+static int gather_or_scatter(lua_State *L, bool gather) {
+    ltLuaCheckNArgs(L, 7);
+    LTVector *dst = lt_expect_LTVector(L, 1);
+    LTVector *src = lt_expect_LTVector(L, 3);
+    int ncols = luaL_checkinteger(L, 5);
+    LTVector *index = lt_expect_LTVector(L, 6);
+    if (ncols < 1) {
+        return luaL_error(L, "Invalid number of columns: %d", ncols);
+    }
+    int dst_col = check_vector_column(L, dst, 2, ncols);
+    int src_col = check_vector_column(L, src, 4, ncols);
+    int index_col = check_vector_column(L, index, 7, 1);
+    int n = gather ? dst->size : src->size;
+    if (index->size < n) {
+        return luaL_error(L, "Index vector too small (%d records, need %d)", index->size, n);
+    }
+    bool ok;
+    if (gather) {
+        ok = ltVectorGather(dst, dst_col, src, src_col, ncols, index, index_col);
+    } else {
+        ok = ltVectorScatter(dst, dst_col, src, src_col, ncols, index, index_col);
+    }
+    if (!ok) {
+        return luaL_error(L, "Index out of range");
+    }
+    return 0;
+}
+
+static int lt_GatherVectorColumns(lua_State *L) {
+    return gather_or_scatter(L, true);
+}
+
+static int lt_ScatterVectorColumns(lua_State *L) {
+    return gather_or_scatter(L, false);
+}
+
 static int lt_FillVectorColumnsWithImageQuads(lua_State *L) {
     ltLuaCheckNArgs(L, 5);
     LTVector *vector = lt_expect_LTVector(L, 1);
-    int col = luaL_checkinteger(L, 2) - 1;
+    int col = check_vector_column(L, vector, 2, 4);
     LTTexturedNode *img = lt_expect_LTTexturedNode(L, 3);
     LTVector *offsets = lt_expect_LTVector(L, 4);
-    int offsets_col = luaL_checkinteger(L, 5) - 1;
-    if (vector->size < 4) {
-        return luaL_error(L, "Vector size must be at least 4");
-    }
-    if ((vector->size & 3) > 0) {
-        return luaL_error(L, "Vector size must be divisible by 4");
-    }
-    if (offsets->size != (vector->size >> 2)) {
-        return luaL_error(L, "Offsets vector must be a quarter of the size of the target vector");
-    }
-    if (vector->stride - col < 4) {
-        return luaL_error(L, "Vector stride to small (must be at least 4)");
-    }
-    if (offsets->stride - offsets_col < 2) {
-        return luaL_error(L, "Not enough columns in offsets vector (must be at least 2)");
-    }
-    int n = offsets->size;
-    //fprintf(stderr, "n = %d, col = %d, offsets_col = %d, offsets = %p, vector = %p\n", n, col, offsets_col, offsets->data, vector->data);
-    LTfloat *data = vector->data + col;
-    LTfloat *os_data = offsets->data + offsets_col;
-    for (int i = 0; i < n; i++) {
-        // XXX This is broken
-        data[0] = img->world_vertices[0] + os_data[0];
-        data[1] = img->world_vertices[1] + os_data[1];
-        data[2] = img->tex_coords[0];
-        data[3] = img->tex_coords[1];
-        data += vector->stride;
-        data[0] = img->world_vertices[2] + os_data[0];
-        data[1] = img->world_vertices[3] + os_data[1];
-        data[2] = img->tex_coords[2];
-        data[3] = img->tex_coords[3];
-        data += vector->stride;
-        data[0] = img->world_vertices[6] + os_data[0];
-        data[1] = img->world_vertices[7] + os_data[1];
-        data[2] = img->tex_coords[6];
-        data[3] = img->tex_coords[7];
-        data += vector->stride;
-        data[0] = img->world_vertices[4] + os_data[0];
-        data[1] = img->world_vertices[5] + os_data[1];
-        data[2] = img->tex_coords[4];
-        data[3] = img->tex_coords[5];
-        data += vector->stride;
-        os_data += offsets->stride;
+    int offsets_col = check_vector_column(L, offsets, 5, 2);
+    int verts_per_quad;
+    if (vector->size == offsets->size * 6) {
+        verts_per_quad = 6;
+    } else if (vector->size == offsets->size * 4) {
+        verts_per_quad = 4;
+    } else {
+        return luaL_error(L, "Vector size must be 6 (or 4) times the size of the offsets vector");
     }
+    ltVectorFillImageQuads(vector, col, img, offsets, offsets_col, verts_per_quad);
     return 0;
 }
 
@@ -898,10 +998,10 @@ static void add_packer_images_to_lua_table(lua_State *L, int w, int h, LTImagePa
 #define MIN_TEX_SIZE 64
 
 static void pack_image(lua_State *L, LTImagePacker *packer, LTImageBuffer *buf,
-        LTTextureFilter minfilter, LTTextureFilter magfilter) {
+        LTTextureFilter minfilter, LTTextureFilter magfilter, LTTextureFormat format, LTDither dither) {
     if (!ltPackImage(packer, buf)) {
         // Packer full, so generate an atlas.
-        LTAtlas *atlas = new LTAtlas(packer, minfilter, magfilter);
+        LTAtlas *atlas = new LTAtlas(packer, minfilter, magfilter, format, dither);
         add_packer_images_to_lua_table(L, packer->width, packer->height, packer, atlas);
         packer->deleteOccupants();
         packer->width = MIN_TEX_SIZE;
@@ -928,21 +1028,62 @@ static LTTextureFilter decode_texture_filter_arg(lua_State *L, int arg) {
     return LT_TEXTURE_FILTER_LINEAR; // unreachable
 }
 
+static LTTextureFormat decode_texture_format_arg(lua_State *L, int arg) {
+    const char *str = lua_tostring(L, arg);
+    if (str == NULL) {
+        luaL_error(L, "Expecting a string in argument %d", arg);
+    }
+    for (int f = LT_TEXTURE_FORMAT_RGBA8888; f <= LT_TEXTURE_FORMAT_AUTO; f++) {
+        if (strcmp(str, ltTextureFormatName((LTTextureFormat)f)) == 0) {
+            return (LTTextureFormat)f;
+        }
+    }
+    luaL_error(L, "Unrecognised texture format: %s", str);
+    return LT_TEXTURE_FORMAT_RGBA8888; // unreachable
+}
+
+static LTDither decode_dither_arg(lua_State *L, int arg) {
+    const char *str = lua_tostring(L, arg);
+    if (str == NULL) {
+        luaL_error(L, "Expecting a string in argument %d", arg);
+    }
+    for (int d = LT_DITHER_NONE; d <= LT_DITHER_DIFFUSE; d++) {
+        if (strcmp(str, ltDitherName((LTDither)d)) == 0) {
+            return (LTDither)d;
+        }
+    }
+    luaL_error(L, "Unrecognised dither: %s", str);
+    return LT_DITHER_NONE; // unreachable
+}
+
 static int lt_LoadImages(lua_State *L) {
     // Load images named in 1st argument (an array) and return a table
     // indexed by image name.
     // The second and third arguments are the minimize and magnify
     // texture filters to use.
+    // The fourth and fifth are the atlas texture format ("rgba8888",
+    // "rgb565", "rgba4444", "rgba5551" or "auto") and the dithering used
+    // to convert to it ("none", "ordered" or "diffuse").  They default
+    // to those set with ltSetDefaultAtlasFormat.
     // If an entry in the array is a table, then process it as a font.
     int num_args = ltLuaCheckNArgs(L, 1);
     LTTextureFilter minfilter = LT_TEXTURE_FILTER_LINEAR;
     LTTextureFilter magfilter = LT_TEXTURE_FILTER_LINEAR;
+    LTTextureFormat format;
+    LTDither dither;
+    ltGetDefaultAtlasFormat(&format, &dither);
     if (num_args > 1) {
         minfilter = decode_texture_filter_arg(L, 2);
     }
     if (num_args > 2) {
         magfilter = decode_texture_filter_arg(L, 3);
     }
+    if (num_args > 3) {
+        format = decode_texture_format_arg(L, 4);
+    }
+    if (num_args > 4) {
+        dither = decode_dither_arg(L, 5);
+    }
     lua_newtable(L); // The table to be returned.
     LTImagePacker *packer = new LTImagePacker(0, 0, MIN_TEX_SIZE, MIN_TEX_SIZE, max_atlas_size());
     int i = 1;
@@ -965,7 +1106,7 @@ static int lt_LoadImages(lua_State *L) {
             delete[] path;
             if (buf != NULL) {
                 // If buf is NULL ltReadImage would have already logged an error.
-                pack_image(L, packer, buf, minfilter, magfilter);
+                pack_image(L, packer, buf, minfilter, magfilter, format, dither);
             }
         } else if (lua_istable(L, -1)) {
             // A table entry means we should load the image as a font.
@@ -991,7 +1132,7 @@ static int lt_LoadImages(lua_State *L) {
                 delete buf;
                 std::list<LTImageBuffer *>::iterator it;
                 for (it = glyph_list->begin(); it != glyph_list->end(); it++) {
-                    pack_image(L, packer, *it, minfilter, magfilter);
+                    pack_image(L, packer, *it, minfilter, magfilter, format, dither);
                 }
                 delete glyph_list;
             }
@@ -1004,7 +1145,7 @@ static int lt_LoadImages(lua_State *L) {
 
     // Pack any images left in packer into a new texture.
     if (packer->size() > 0) {
-        LTAtlas *atlas = new LTAtlas(packer, minfilter, magfilter);
+        LTAtlas *atlas = new LTAtlas(packer, minfilter, magfilter, format, dither);
         add_packer_images_to_lua_table(L, packer->width, packer->height, packer, atlas);
         packer->deleteOccupants();
     }
@@ -1017,8 +1158,9 @@ static int lt_LoadImages(lua_State *L) {
 /************************* Models **************************/
 
 static int lt_LoadModels(lua_State *L) {
-    // Load wavefront models in 1st argument (an array) and return a table
-    // of meshes indexed by model name.
+    // Load models in 1st argument (an array) and return a table of meshes
+    // indexed by model name.  Binary .ltm models are used in preference
+    // to wavefront .obj ones.
     ltLuaCheckNArgs(L, 1);
     lua_newtable(L); // The table to be returned.
     int i = 1;
@@ -1039,7 +1181,9 @@ static int lt_LoadModels(lua_State *L) {
         }
         const char *path = model_path(name); 
         LTMesh *mesh = (LTMesh*)lt_alloc_LTMesh(L);
-        if (!ltReadWavefrontMesh(path, mesh)) {
+        int len = strlen(path);
+        bool binary = len > 4 && strcmp(path + len - 4, ".ltm") == 0;
+        if (!(binary ? ltReadMeshFile(path, mesh) : ltReadWavefrontMesh(path, mesh))) {
             return luaL_error(L, "Unable to read model at path %s", path);
         }
         delete[] path;
@@ -1737,6 +1881,252 @@ static int lt_ExecuteActions(lua_State *L) {
     return 0;
 }
 
+static void push_pool_stats(lua_State *L, LTPoolStats *stats) {
+    lua_newtable(L);
+    lua_pushinteger(L, stats->live);
+    lua_setfield(L, -2, "live");
+    lua_pushinteger(L, stats->peak);
+    lua_setfield(L, -2, "peak");
+    lua_pushinteger(L, stats->allocs);
+    lua_setfield(L, -2, "allocs");
+    lua_pushinteger(L, stats->chunks);
+    lua_setfield(L, -2, "chunks");
+}
+
+// Returns a table of pool allocator stats.  The totals are in the
+// top-level table and per size class stats (keyed by block size)
+// are in the "classes" sub-table.
+static int lt_PoolStats(lua_State *L) {
+    LTPoolStats stats;
+    ltPoolGetStats(&stats);
+    push_pool_stats(L, &stats);
+    lua_newtable(L);
+    for (int i = 0; i < LT_POOL_NUM_CLASSES; i++) {
+        ltPoolGetClassStats(i, &stats);
+        if (stats.allocs > 0) {
+            push_pool_stats(L, &stats);
+            lua_rawseti(L, -2, (i + 1) * LT_POOL_GRANULE);
+        }
+    }
+    lua_setfield(L, -2, "classes");
+    return 1;
+}
+
+static int lt_ResetPoolPeak(lua_State *L) {
+    ltPoolResetPeak();
+    return 0;
+}
+
+// Like lt.PoolStats, but for the pool the Lua state allocates from.
+// Blocks that fell through to malloc are in the "large" sub-table.
+static int lt_LuaPoolStats(lua_State *L) {
+    push_pool_stats(L, &lua_pool.total_stats);
+    lua_newtable(L);
+    for (int i = 0; i < LT_POOL_NUM_CLASSES; i++) {
+        if (lua_pool.class_stats[i].allocs > 0) {
+            push_pool_stats(L, &lua_pool.class_stats[i]);
+            lua_rawseti(L, -2, (i + 1) * LT_POOL_GRANULE);
+        }
+    }
+    lua_setfield(L, -2, "classes");
+    push_pool_stats(L, &lua_pool.large_stats);
+    lua_setfield(L, -2, "large");
+    return 1;
+}
+
+static int lt_ResetLuaPoolPeak(lua_State *L) {
+    lua_pool.reset_peak();
+    return 0;
+}
+
+/************************* GC **************************/
+
+// Sets the per-frame garbage collection budget in milliseconds.
+// 0 restores the default Lua collector.
+static int lt_SetGCBudget(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    ltGCSetBudget(L, luaL_checknumber(L, 1) / 1000.0);
+    return 0;
+}
+
+static int lt_RenderTargetStats(lua_State *L) {
+    LTRenderTargetStats stats;
+    ltGetRenderTargetStats(&stats);
+    lua_createtable(L, 0, 6);
+    lua_pushinteger(L, stats.renders);
+    lua_setfield(L, -2, "renders");
+    lua_pushinteger(L, stats.skips);
+    lua_setfield(L, -2, "skips");
+    lua_pushinteger(L, stats.buffers);
+    lua_setfield(L, -2, "buffers");
+    lua_pushinteger(L, stats.bytes);
+    lua_setfield(L, -2, "bytes");
+    lua_pushinteger(L, stats.free_buffers);
+    lua_setfield(L, -2, "free_buffers");
+    lua_pushinteger(L, stats.free_bytes);
+    lua_setfield(L, -2, "free_bytes");
+    return 1;
+}
+
+static int lt_SetTextureBudget(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    ltSetTextureBudget(luaL_checkinteger(L, 1));
+    return 0;
+}
+
+static int lt_TextureStats(lua_State *L) {
+    LTTextureStats stats;
+    ltGetTextureStats(&stats);
+    lua_createtable(L, 0, 12);
+    lua_pushinteger(L, ltGetTextureBudget());
+    lua_setfield(L, -2, "budget");
+    lua_pushinteger(L, stats.atlases);
+    lua_setfield(L, -2, "atlases");
+    lua_pushinteger(L, stats.resident);
+    lua_setfield(L, -2, "resident");
+    lua_pushinteger(L, stats.bytes);
+    lua_setfield(L, -2, "bytes");
+    lua_pushinteger(L, stats.resident_bytes);
+    lua_setfield(L, -2, "resident_bytes");
+    lua_pushinteger(L, stats.peak_resident_bytes);
+    lua_setfield(L, -2, "peak_resident_bytes");
+    lua_pushinteger(L, stats.evictions);
+    lua_setfield(L, -2, "evictions");
+    lua_pushinteger(L, stats.reloads);
+    lua_setfield(L, -2, "reloads");
+    lua_pushnumber(L, stats.reload_time * 1000.0);
+    lua_setfield(L, -2, "reload_ms");
+    lua_pushinteger(L, stats.converted);
+    lua_setfield(L, -2, "converted");
+    lua_pushnumber(L, stats.convert_time * 1000.0);
+    lua_setfield(L, -2, "convert_ms");
+    lua_pushinteger(L, stats.saved_bytes);
+    lua_setfield(L, -2, "saved_bytes");
+    return 1;
+}
+
+static int lt_ResetTexturePeak(lua_State *L) {
+    ltResetTexturePeak();
+    return 0;
+}
+
+static int lt_GCStats(lua_State *L) {
+    LTGCStats stats;
+    ltGCGetStats(&stats);
+    lua_createtable(L, 0, 9);
+    lua_pushnumber(L, stats.secs * 1000.0);
+    lua_setfield(L, -2, "ms");
+    lua_pushnumber(L, stats.max_secs * 1000.0);
+    lua_setfield(L, -2, "max_ms");
+    lua_pushnumber(L, ltGCBudget() * 1000.0);
+    lua_setfield(L, -2, "budget_ms");
+    lua_pushinteger(L, stats.steps);
+    lua_setfield(L, -2, "steps");
+    lua_pushinteger(L, stats.step_kb);
+    lua_setfield(L, -2, "step_kb");
+    lua_pushinteger(L, lua_gc(L, LUA_GCCOUNT, 0));
+    lua_setfield(L, -2, "heap_kb");
+    lua_pushinteger(L, stats.alloc_kb);
+    lua_setfield(L, -2, "alloc_kb");
+    lua_pushinteger(L, stats.cycles);
+    lua_setfield(L, -2, "cycles");
+    lua_pushboolean(L, stats.catching_up);
+    lua_setfield(L, -2, "catching_up");
+    return 1;
+}
+
+static int lt_ResetGCMax(lua_State *L) {
+    ltGCResetMax();
+    return 0;
+}
+
+/************************* Profiler **************************/
+
+static int lt_SetProfilerEnabled(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    ltSetProfilerEnabled(lua_toboolean(L, 1));
+    return 0;
+}
+
+static int lt_SetGLErrorChecking(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    ltSetGLErrorChecking(lua_toboolean(L, 1));
+    return 0;
+}
+
+static int lt_ProfileBegin(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    if (ltProfilerEnabled()) {
+        ltProfileBegin(ltProfileInternName(luaL_checkstring(L, 1)));
+    }
+    return 0;
+}
+
+static int lt_ProfileEnd(lua_State *L) {
+    ltProfileEnd();
+    return 0;
+}
+
+// Returns an array of the most recent n frames (most recent first).
+// Each frame is a table with the frame time in ms, the GL counters
+// and a "phases" table mapping each timer name to its total ms.
+static int lt_ProfileFrames(lua_State *L) {
+    int n = ltProfileNumFrames();
+    if (lua_gettop(L) > 0) {
+        int max = luaL_checkinteger(L, 1);
+        if (max < n) {
+            n = max;
+        }
+    }
+    lua_createtable(L, n, 0);
+    for (int i = 0; i < n; i++) {
+        LTProfileFrame *f = ltProfileGetFrame(i);
+        lua_createtable(L, 0, 12);
+        lua_pushinteger(L, f->number);
+        lua_setfield(L, -2, "number");
+        lua_pushnumber(L, f->duration * 1000.0);
+        lua_setfield(L, -2, "ms");
+        lua_pushinteger(L, f->gl.draw_calls);
+        lua_setfield(L, -2, "draw_calls");
+        lua_pushinteger(L, f->gl.state_changes);
+        lua_setfield(L, -2, "state_changes");
+        lua_pushinteger(L, f->gl.texture_binds);
+        lua_setfield(L, -2, "texture_binds");
+        lua_pushinteger(L, f->gl.buffer_bytes);
+        lua_setfield(L, -2, "buffer_bytes");
+        lua_pushinteger(L, f->gl.vertices);
+        lua_setfield(L, -2, "vertices");
+        lua_pushinteger(L, f->gl.issued_calls);
+        lua_setfield(L, -2, "issued_calls");
+        lua_pushinteger(L, f->gl.filtered_calls);
+        lua_setfield(L, -2, "filtered_calls");
+        lua_pushinteger(L, f->gl.cull_tests);
+        lua_setfield(L, -2, "cull_tests");
+        lua_pushinteger(L, f->gl.culled);
+        lua_setfield(L, -2, "culled");
+        lua_pushinteger(L, f->dropped_events);
+        lua_setfield(L, -2, "dropped");
+        lua_newtable(L);
+        for (int j = 0; j < f->num_events; j++) {
+            LTProfileEvent *e = &f->events[j];
+            lua_getfield(L, -1, e->name);
+            lua_Number ms = lua_tonumber(L, -1); // 0 if nil
+            lua_pop(L, 1);
+            lua_pushnumber(L, ms + e->duration * 1000.0);
+            lua_setfield(L, -2, e->name);
+        }
+        lua_setfield(L, -2, "phases");
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
+static int lt_ExportProfileTrace(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    lua_pushboolean(L, ltProfileWriteTrace(luaL_checkstring(L, 1)));
+    return 1;
+}
+
 /************************* Tweens **************************/
 
 struct LTLuaTweenOnDone : LTTweenOnDone {
@@ -1777,6 +2167,94 @@ struct LTLuaTweenOnDone : LTTweenOnDone {
     }
 };
 
+// Ease names are mapped to ids through a table in the registry, so
+// looking up a name is a single hash lookup on the interned string.
+static int check_ease(lua_State *L, int arg) {
+    int id;
+    switch (lua_type(L, arg)) {
+        case LUA_TNIL:
+        case LUA_TNONE:
+            return LT_EASE_LINEAR;
+        case LUA_TNUMBER:
+            id = lua_tointeger(L, arg);
+            if (!ltValidEaseId(id)) {
+                return luaL_error(L, "Invalid easing function id: %d", id);
+            }
+            return id;
+        case LUA_TSTRING:
+            lua_getfield(L, LUA_REGISTRYINDEX, "ltease_ids");
+            if (lua_isnil(L, -1)) {
+                lua_pop(L, 1);
+                lua_newtable(L);
+                for (int i = 0; i < LT_NUM_BUILTIN_EASES; i++) {
+                    lua_pushinteger(L, i);
+                    lua_setfield(L, -2, ltEaseName(i));
+                }
+                lua_pushvalue(L, -1);
+                lua_setfield(L, LUA_REGISTRYINDEX, "ltease_ids");
+            }
+            lua_pushvalue(L, arg);
+            lua_rawget(L, -2);
+            if (lua_isnil(L, -1)) {
+                return luaL_error(L, "Invalid easing function: %s", lua_tostring(L, arg));
+            }
+            id = lua_tointeger(L, -1);
+            lua_pop(L, 2);
+            return id;
+        default:
+            return luaL_error(L, "Easing function argument %d not nil, a string or an id", arg);
+    }
+}
+
+static int lt_EaseId(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    lua_pushinteger(L, check_ease(L, 1));
+    return 1;
+}
+
+static int lt_CubicBezierEaseId(lua_State *L) {
+    ltLuaCheckNArgs(L, 4);
+    int id = ltCubicBezierEaseId(luaL_checknumber(L, 1), luaL_checknumber(L, 2),
+        luaL_checknumber(L, 3), luaL_checknumber(L, 4));
+    if (id < 0) {
+        return luaL_error(L, "Too many distinct bezier ease curves");
+    }
+    lua_pushinteger(L, id);
+    return 1;
+}
+
+static int lt_Ease(lua_State *L) {
+    ltLuaCheckNArgs(L, 2);
+    int id = check_ease(L, 1);
+    lua_pushnumber(L, ltEase(id, luaL_checknumber(L, 2)));
+    return 1;
+}
+
+static int lt_SetEaseTablesEnabled(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    ltSetEaseTablesEnabled(lua_toboolean(L, 1));
+    return 0;
+}
+
+static int lt_TweenStats(lua_State *L) {
+    LTTweenStats stats;
+    ltGetTweenStats(&stats);
+    lua_newtable(L);
+    lua_pushinteger(L, stats.active);
+    lua_setfield(L, -2, "active");
+    lua_pushinteger(L, stats.advanced);
+    lua_setfield(L, -2, "advanced");
+    lua_pushnumber(L, stats.secs * 1000.0);
+    lua_setfield(L, -2, "ms");
+    if (stats.secs > 0.0) {
+        lua_pushnumber(L, (LTdouble)stats.advanced / (stats.secs * 1000.0));
+    } else {
+        lua_pushnumber(L, 0.0);
+    }
+    lua_setfield(L, -2, "per_ms");
+    return 1;
+}
+
 static int lt_AddTween(lua_State *L) {
     ltLuaCheckNArgs(L, 7); // node, field, target_val, time, delay, easing, action
     ltLuaFindFieldOwner(L, 1, 2);
@@ -1805,42 +2283,7 @@ static int lt_AddTween(lua_State *L) {
     LTfloat target_val = luaL_checknumber(L, 3);
     LTfloat time = luaL_checknumber(L, 4);
     LTfloat delay = luaL_checknumber(L, 5);
-    if (!(lua_isnil(L, 6) || lua_isstring(L, 6))) {
-        return luaL_error(L, "Ease func argument (6) not nil or a string");
-    }
-    const char *ease_func_str = lua_tostring(L, 6);
-    LTEaseFunc ease_func;
-    if (ease_func_str == NULL) {
-        ease_func = ltEase_linear;
-    } else if (strcmp(ease_func_str, "in") == 0) {
-        ease_func = ltEase_in;
-    } else if (strcmp(ease_func_str, "out") == 0) {
-        ease_func = ltEase_out;
-    } else if (strcmp(ease_func_str, "inout") == 0) {
-        ease_func = ltEase_inout;
-    } else if (strcmp(ease_func_str, "zoomin") == 0) {
-        ease_func = ltEase_zoomin;
-    } else if (strcmp(ease_func_str, "zoomout") == 0) {
-        ease_func = ltEase_zoomout;
-    } else if (strcmp(ease_func_str, "accel") == 0) {
-        ease_func = ltEase_accel;
-    } else if (strcmp(ease_func_str, "decel") == 0) {
-        ease_func = ltEase_decel;
-    } else if (strcmp(ease_func_str, "bounce") == 0) {
-        ease_func = ltEase_bounce;
-    } else if (strcmp(ease_func_str, "revolve") == 0) {
-        ease_func = ltEase_revolve;
-    } else if (strcmp(ease_func_str, "backin") == 0) {
-        ease_func = ltEase_backin;
-    } else if (strcmp(ease_func_str, "backout") == 0) {
-        ease_func = ltEase_backout;
-    } else if (strcmp(ease_func_str, "linear") == 0) {
-        ease_func = ltEase_linear;
-    } else if (strcmp(ease_func_str, "elastic") == 0) {
-        ease_func = ltEase_elastic;
-    } else {
-        return luaL_error(L, "Invalid easing function: ", ease_func_str);
-    }
+    int ease = check_ease(L, 6);
     LTLuaTweenOnDone *on_done = NULL;
     if (lua_isfunction(L, 7)) {
         int fref = ltLuaAddRef(L, -1, 7); // Add reference from node to action func.
@@ -1851,14 +2294,216 @@ static int lt_AddTween(lua_State *L) {
     }
     LTAction *action;
     if (is_int) {
-        action = new LTIntTweenAction(node, igetter, isetter, target_val, time, delay, ease_func, on_done);
+        action = new LTTweenAction(node, igetter, isetter, target_val, time, delay, ease, on_done);
     } else {
-        action = new LTTweenAction(node, getter, setter, target_val, time, delay, ease_func, on_done);
+        action = new LTTweenAction(node, getter, setter, target_val, time, delay, ease, on_done);
+    }
+    node->add_action(action);
+    return 0;
+}
+
+/************************* Timers **************************/
+
+// Global timers keep their callbacks in the registry and are advanced
+// by lt.AdvanceGlobalTimers.
+struct LTLuaGlobalTimerHandler : LTTimerHandler {
+    virtual void fire(LTTimer *timer) {
+        lua_rawgeti(g_L, LUA_REGISTRYINDEX, timer->ref);
+        luaL_unref(g_L, LUA_REGISTRYINDEX, timer->ref);
+        lua_call(g_L, 0, 0);
+    }
+    virtual void discard(LTTimer *timer) {
+        luaL_unref(g_L, LUA_REGISTRYINDEX, timer->ref);
+    }
+};
+
+static LTLuaGlobalTimerHandler global_timer_handler;
+static LTTimerWheel *global_timers = NULL;
+
+// Timers attached to a scene node live in a wheel advanced by an
+// action on the node, so they freeze when the node is paused or
+// removed from the scene.  Callbacks are referenced from the node.
+struct LTLuaNodeTimerAction : LTAction, LTTimerHandler {
+    int node_ref;
+    LTTimerWheel wheel;
+
+    LTLuaNodeTimerAction(LTSceneNode *node, int nref) : LTAction(node), wheel(this) {
+        node_ref = nref;
+        action_id = &global_timer_handler;
+    }
+    virtual ~LTLuaNodeTimerAction() {
+        if (g_L != NULL) {
+            del_weak_ref(g_L, node_ref);
+        }
+    }
+    virtual bool doAction(LTfloat dt) {
+        if (wheel.count > 0) {
+            wheel.advance(dt);
+        }
+        return false;
+    }
+    virtual void fire(LTTimer *timer) {
+        get_weak_ref(g_L, node_ref);
+        ltLuaGetRef(g_L, -1, timer->ref);
+        ltLuaDelRef(g_L, -2, timer->ref);
+        lua_remove(g_L, -2); // remove node
+        lua_call(g_L, 0, 0);
+    }
+    virtual void discard(LTTimer *timer) {
+        get_weak_ref(g_L, node_ref);
+        ltLuaDelRef(g_L, -1, timer->ref);
+        lua_pop(g_L, 1);
+    }
+};
+
+static LTLuaNodeTimerAction *get_node_timer_action(lua_State *L, int node_index, bool create) {
+    LTSceneNode *node = lt_expect_LTSceneNode(L, node_index);
+    if (node->actions != NULL) {
+        std::list<LTAction*>::iterator it;
+        for (it = node->actions->begin(); it != node->actions->end(); it++) {
+            if ((*it)->action_id == &global_timer_handler && !(*it)->cancelled) {
+                return (LTLuaNodeTimerAction*)*it;
+            }
+        }
     }
+    if (!create) {
+        return NULL;
+    }
+    LTLuaNodeTimerAction *action = new LTLuaNodeTimerAction(node, make_weak_ref(L, node_index));
     node->add_action(action);
+    return action;
+}
+
+// Args: secs, func, [node].  Returns a handle that can be passed to
+// lt.CancelTimer.
+static int lt_AddTimer(lua_State *L) {
+    int nargs = ltLuaCheckNArgs(L, 2);
+    LTfloat secs = luaL_checknumber(L, 1);
+    if (!lua_isfunction(L, 2)) {
+        return luaL_error(L, "Argument 2 not a function");
+    }
+    LTTimer *timer;
+    if (nargs >= 3 && !lua_isnil(L, 3)) {
+        LTLuaNodeTimerAction *action = get_node_timer_action(L, 3, true);
+        int fref = ltLuaAddRef(L, 3, 2); // Add reference from node to callback.
+        timer = action->wheel.add(secs, fref);
+    } else {
+        if (global_timers == NULL) {
+            global_timers = new LTTimerWheel(&global_timer_handler);
+        }
+        lua_pushvalue(L, 2);
+        int fref = luaL_ref(L, LUA_REGISTRYINDEX);
+        timer = global_timers->add(secs, fref);
+    }
+    lua_pushinteger(L, timer->handle);
+    return 1;
+}
+
+static int lt_CancelTimer(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    LTTimer *timer = ltLookupTimer(luaL_checkinteger(L, 1));
+    if (timer != NULL) {
+        timer->wheel->cancel(timer);
+    }
+    return 0;
+}
+
+static int lt_AdvanceGlobalTimers(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    if (global_timers != NULL) {
+        global_timers->advance(luaL_checknumber(L, 1));
+    }
+    return 0;
+}
+
+static int lt_ClearGlobalTimers(lua_State *L) {
+    if (global_timers != NULL) {
+        global_timers->clear();
+    }
+    return 0;
+}
+
+// Cancels all timers attached to the given node.
+static int lt_ClearTimers(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    LTLuaNodeTimerAction *action = get_node_timer_action(L, 1, false);
+    if (action != NULL) {
+        action->wheel.clear();
+    }
     return 0;
 }
 
+static int lt_NumTimers(lua_State *L) {
+    lua_pushinteger(L, ltNumLiveTimers());
+    return 1;
+}
+
+/************************* Sprites **************************/
+
+struct LTLuaSpriteListener : LTSpriteListener {
+    int node_ref;
+    int func_ref;
+
+    LTLuaSpriteListener(int nref, int fref) {
+        node_ref = nref;
+        func_ref = fref;
+    }
+    virtual ~LTLuaSpriteListener() {
+        if (g_L != NULL) {
+            del_weak_ref(g_L, node_ref);
+        }
+    }
+    void call(LTSprite *sprite, const char *event) {
+        get_weak_ref(g_L, node_ref);
+        assert(sprite == lua_touserdata(g_L, -1));
+        ltLuaGetRef(g_L, -1, func_ref);
+        assert(lua_isfunction(g_L, -1));
+        lua_pushvalue(g_L, -2); // push sprite again to pass to function
+        lua_pushstring(g_L, event);
+        lua_call(g_L, 2, 0);
+        lua_pop(g_L, 1); // pop sprite
+    }
+    virtual void on_loop(LTSprite *sprite) {
+        call(sprite, "loop");
+    }
+    virtual void on_finish(LTSprite *sprite) {
+        call(sprite, "finish");
+    }
+};
+
+// Args are an array of frames, fps and an optional callback that
+// is called as callback(sprite, "loop") or callback(sprite, "finish").
+static int lt_MakeSprite(lua_State *L) {
+    int nargs = ltLuaCheckNArgs(L, 2);
+    if (!lua_istable(L, 1)) {
+        return luaL_error(L, "Expecting an array of frames");
+    }
+    int n = lua_objlen(L, 1);
+    if (n == 0) {
+        return luaL_error(L, "A sprite needs at least one frame");
+    }
+    LTfloat fps = luaL_checknumber(L, 2);
+    LTSprite *sprite = new (lt_alloc_LTSprite(L)) LTSprite();
+    int sprite_idx = lua_gettop(L);
+    sprite->fps = fps;
+    for (int i = 1; i <= n; i++) {
+        lua_rawgeti(L, 1, i);
+        LTSceneNode *frame = lt_expect_LTSceneNode(L, -1);
+        ltLuaAddRef(L, sprite_idx, -1); // Add reference from sprite to frame.
+        sprite->add_frame(frame);
+        lua_pop(L, 1);
+    }
+    if (nargs >= 3 && !lua_isnil(L, 3)) {
+        if (!lua_isfunction(L, 3)) {
+            return luaL_error(L, "Argument 3 not a function or nil");
+        }
+        int fref = ltLuaAddRef(L, sprite_idx, 3); // Add reference from sprite to callback.
+        int nref = make_weak_ref(L, sprite_idx);
+        sprite->listener = new LTLuaSpriteListener(nref, fref);
+    }
+    return 1;
+}
+
 /*
 static int lt_MakeNativeTween(lua_State *L) {
     LTObject *obj = lt_expect_LTObject(L, 1);
@@ -1976,30 +2621,11 @@ static int lt_AdvanceNativeTween(lua_State *L) {
 /********************* Loading *****************************/
 
 /*
- * These come from lauxlib.c.  We have modified luaL_loadfile
- * to use only the base file name as the chunk name.
+ * Like luaL_loadfile, but uses only the base file name as the chunk
+ * name.  Compiled chunks are cached (see ltluacache.h).
  */
 
-typedef struct LoadF {
-    LTResource *r;
-    char buff[LUAL_BUFFERSIZE];
-    int eof;
-} LoadF;
-
-
-static const char *getF (lua_State *L, void *ud, size_t *size) {
-    LoadF *lf = (LoadF *)ud;
-    if (lf->eof) {
-        return NULL;
-    }
-    *size = ltReadResource(lf->r, lf->buff, sizeof(lf->buff));
-    if (*size < sizeof(lf->buff)) {
-        lf->eof = 1;
-    }
-    return (*size > 0) ? lf->buff : NULL;
-}
-
-static int loadstring (lua_State *L, const char *path, const char *str) {
+static int loadbuffer(lua_State *L, const char *path, const char *buf, size_t len) {
   const char *basename = strrchr(path, '/');
   if (basename == NULL) {
     basename = path;
@@ -2009,26 +2635,22 @@ static int loadstring (lua_State *L, const char *path, const char *str) {
   char chunkid[255];
   snprintf(chunkid, 255, "@%s", basename);
 
-  return luaL_loadbuffer(L, str, strlen(str), chunkid);
+  return ltLuaLoadCached(L, buf, len, chunkid);
 }
 
-static int loadfile (lua_State *L, LTResource *rsc) {
-  LoadF lf;
-  int status;
-  int fnameindex = lua_gettop(L) + 1;  /* index of filename on the stack */
+static int loadstring(lua_State *L, const char *path, const char *str) {
+  return loadbuffer(L, path, str, strlen(str));
+}
 
-  const char *basename = strrchr(rsc->name, '/');
-  if (basename == NULL) {
-    basename = rsc->name;
-  } else {
-    basename++;
+static int loadfile(lua_State *L, LTResource *rsc) {
+  int len;
+  char *buf = (char*)ltReadResourceAll(rsc, &len);
+  if (buf == NULL) {
+    lua_pushfstring(L, "Unable to read %s", rsc->name);
+    return LUA_ERRFILE;
   }
-
-  lua_pushfstring(L, "@%s", basename);
-  lf.r = rsc;
-  lf.eof = 0;
-  status = lua_load(L, getF, &lf, lua_tostring(L, -1));
-  lua_remove(L, fnameindex);
+  int status = loadbuffer(L, rsc->name, buf, len);
+  free(buf);
   return status;
 }
 
@@ -2066,6 +2688,31 @@ static int import(lua_State *L) {
     return lua_gettop(L) - top;
 }
 
+// Saves compiled modules in dir so they needn't be recompiled on the
+// next launch.  Call before importing the modules.
+static int lt_SetScriptCacheDir(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    ltLuaSetChunkCacheDir(lua_isnil(L, 1) ? NULL : luaL_checkstring(L, 1));
+    return 0;
+}
+
+static int lt_ScriptCacheStats(lua_State *L) {
+    LTLuaCacheStats stats;
+    ltLuaGetCacheStats(&stats);
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, stats.hits);
+    lua_setfield(L, -2, "hits");
+    lua_pushinteger(L, stats.disk_hits);
+    lua_setfield(L, -2, "disk_hits");
+    lua_pushinteger(L, stats.misses);
+    lua_setfield(L, -2, "misses");
+    lua_pushinteger(L, stats.chunks);
+    lua_setfield(L, -2, "chunks");
+    lua_pushinteger(L, stats.bytes);
+    lua_setfield(L, -2, "bytes");
+    return 1;
+}
+
 /************************ Configuration *****************************/
 
 static int lt_SetAppShortName(lua_State *L) {
@@ -2125,12 +2772,13 @@ static int lt_SampleAccelerometer(lua_State *L) {
 
 static int lt_ReadGamePadState(lua_State *L) {
     ltLuaCheckNArgs(L, 2);
-    int gamepad = lua_tointeger(L, 1);
     const char *statestr = lua_tostring(L, 2);
     if (statestr == NULL) {
         return luaL_error(L, "Expecting a string argument");
     }
-#ifdef LTGLFW
+    // The LTNULLGL build runs without GLFW, so has no game pads.
+#if defined(LTGLFW) && !defined(LTNULLGL)
+    int gamepad = lua_tointeger(L, 1);
     int joy;
     unsigned char buttons[LT_GAMEPAD_NUM_BUTTONS];
     float axes[LT_GAMEPAD_NUM_AXES];
@@ -2276,6 +2924,14 @@ static const luaL_Reg ltlib[] = {
     {"Vector",                          lt_Vector},
     {"GenerateVectorColumn",            lt_GenerateVectorColumn},
     {"FillVectorColumnsWithImageQuads", lt_FillVectorColumnsWithImageQuads},
+    {"AddToVectorColumn",               lt_AddToVectorColumn},
+    {"MultiplyVectorColumn",            lt_MultiplyVectorColumn},
+    {"MultiplyAddVectorColumns",        lt_MultiplyAddVectorColumns},
+    {"ClampVectorColumn",               lt_ClampVectorColumn},
+    {"WrapVectorColumn",                lt_WrapVectorColumn},
+    {"LerpVectorColumns",               lt_LerpVectorColumns},
+    {"GatherVectorColumns",             lt_GatherVectorColumns},
+    {"ScatterVectorColumns",            lt_ScatterVectorColumns},
     //{"DrawQuads",                       lt_DrawQuads},
 
     {"LoadModels",                      lt_LoadModels},
@@ -2283,6 +2939,20 @@ static const luaL_Reg ltlib[] = {
     //{"ParticleSystemFixtureFilter",     lt_ParticleSystemFixtureFilter},
 
     {"AddTween",                        lt_AddTween},
+    {"EaseId",                          lt_EaseId},
+    {"CubicBezierEaseId",               lt_CubicBezierEaseId},
+    {"Ease",                            lt_Ease},
+    {"SetEaseTablesEnabled",            lt_SetEaseTablesEnabled},
+    {"TweenStats",                      lt_TweenStats},
+
+    {"MakeSprite",                      lt_MakeSprite},
+
+    {"AddTimer",                        lt_AddTimer},
+    {"CancelTimer",                     lt_CancelTimer},
+    {"AdvanceGlobalTimers",             lt_AdvanceGlobalTimers},
+    {"ClearGlobalTimers",               lt_ClearGlobalTimers},
+    {"ClearTimers",                     lt_ClearTimers},
+    {"NumTimers",                       lt_NumTimers},
     //{"MakeNativeTween",                 lt_MakeNativeTween},
     //{"AdvanceNativeTween",              lt_AdvanceNativeTween},
     //{"TweenSet",                        lt_TweenSet},
@@ -2291,6 +2961,23 @@ static const luaL_Reg ltlib[] = {
 
     {"AddAction",                       lt_AddAction},
     {"ExecuteActions",                  lt_ExecuteActions},
+    {"PoolStats",                       lt_PoolStats},
+    {"ResetPoolPeak",                   lt_ResetPoolPeak},
+    {"LuaPoolStats",                    lt_LuaPoolStats},
+    {"ResetLuaPoolPeak",                lt_ResetLuaPoolPeak},
+    {"SetGCBudget",                     lt_SetGCBudget},
+    {"GCStats",                         lt_GCStats},
+    {"RenderTargetStats",               lt_RenderTargetStats},
+    {"SetTextureBudget",                lt_SetTextureBudget},
+    {"TextureStats",                    lt_TextureStats},
+    {"ResetTexturePeak",                lt_ResetTexturePeak},
+    {"ResetGCMax",                      lt_ResetGCMax},
+    {"SetProfilerEnabled",              lt_SetProfilerEnabled},
+    {"ProfileBegin",                    lt_ProfileBegin},
+    {"ProfileEnd",                      lt_ProfileEnd},
+    {"ProfileFrames",                   lt_ProfileFrames},
+    {"ExportProfileTrace",              lt_ExportProfileTrace},
+    {"SetGLErrorChecking",              lt_SetGLErrorChecking},
 
     {"LoadSamples",                     lt_LoadSamples},
     {"PlaySampleOnce",                  lt_PlaySampleOnce},
@@ -2361,6 +3048,8 @@ static const luaL_Reg ltlib[] = {
 //    {"NextRandomBool",                  lt_NextRandomBool},
 
     {"SetAppShortName",                 lt_SetAppShortName},
+    {"SetScriptCacheDir",               lt_SetScriptCacheDir},
+    {"ScriptCacheStats",                lt_ScriptCacheStats},
 
     {"SampleAccelerometer",             lt_SampleAccelerometer},
     {"ReadGamePadState",                lt_ReadGamePadState},
@@ -2411,9 +3100,10 @@ static void run_lua_file(lua_State *L, const char *file) {
 }
 
 static void run_setup_scripts(lua_State *L) {
-    int n = sizeof(setup_scripts) / sizeof(const char *);
+    int n = sizeof(setup_scripts) / sizeof(LTSetupScript);
     for (int i = 0; (i < n && !g_suspended); i++) {
-        check_status(L, luaL_loadstring(L, setup_scripts[i]));
+        const LTSetupScript *s = &setup_scripts[i];
+        check_status(L, luaL_loadbuffer(L, s->data, s->len, s->name));
         docall(L, 0, 0);
     }
 }
@@ -2516,11 +3206,19 @@ static void set_globals(lua_State *L) {
 void ltLuaSetup() {
     ltDoVerify();
     ltAudioInit();
+#ifdef LTNOLUAPOOL
     g_L = luaL_newstate();
+#else
+    g_L = lua_newstate(ltPoolLuaAlloc, &lua_pool);
+    if (g_L != NULL) {
+        lua_atpanic(g_L, panic);
+    }
+#endif
     if (g_L == NULL) {
         ltLog("Cannot create lua state: not enough memory.");
         ltAbort();
     }
+    ltGCReset();
     ltLuaInitFFI(g_L);
     luaL_openlibs(g_L);
     lua_pushcfunction(g_L, import);
@@ -2540,6 +3238,10 @@ void ltLuaSetup() {
 void ltLuaTeardown() {
     if (g_L != NULL) {
         ltDeactivateAllScenes(g_L);
+        if (global_timers != NULL) {
+            delete global_timers;
+            global_timers = NULL;
+        }
         lua_close(g_L);
         // If there was an error, then the descructors of some objects, such as
         // events, may not be called
@@ -2577,6 +3279,7 @@ void ltLuaResume() {
 }
 
 void ltLuaAdvance(LTdouble secs) {
+    LT_PROFILE_SCOPE("advance");
     if (g_L != NULL && !g_suspended && push_lt_func(g_L, "Advance")) {
         lua_pushnumber(g_L, secs);
         docall(g_L, 1, 0);
@@ -2585,6 +3288,9 @@ void ltLuaAdvance(LTdouble secs) {
 }
 
 void ltLuaRender() {
+    ltProfileFrameBoundary();
+    ltTextureFrameBoundary();
+    LT_PROFILE_SCOPE("render");
     if (g_L != NULL && !g_suspended) {
         if (!g_initialized) {
             ltInitGLState();
@@ -2599,6 +3305,10 @@ void ltLuaRender() {
             g_initialized = true;
         }
         if (!g_suspended) {
+            if (ltGLErrorCheckingEnabled()) {
+                // Anything since the last check, including loading.
+                ltCheckGLErrors("the last frame");
+            }
             ltInitGraphics();
             call_lt_func(g_L, "Render");
             ltDrawAdBackground();
@@ -2797,6 +3507,12 @@ void ltLuaGarbageCollect() {
     }
 }
 
+void ltLuaStepGC(LTdouble slack) {
+    if (g_L != NULL && !g_suspended) {
+        ltGCStep(g_L, slack);
+    }
+}
+
 /************************************************************/
 
 #define LT_LUA_TNIL     0
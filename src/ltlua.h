@@ -24,6 +24,8 @@ void ltLuaResizeWindow(LTfloat w, LTfloat h);
 void ltLuaGameCenterBecameAvailable();
 
 void ltLuaGarbageCollect();
+// Performs frame-budgeted incremental collection (see ltgc.h).
+void ltLuaStepGC(LTdouble slack);
 
 // The caller should free the pickler with delete.
 LTPickler *ltLuaPickleState();
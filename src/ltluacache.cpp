@@ -26,3 +26,173 @@ const char *ltLuaReadCache(const char *path) {
         return it->second;
     }
 }
+
+/************************* Compiled chunks **************************/
+
+struct LTDigestCmp {
+    bool operator()(const LTSHA1Digest &a, const LTSHA1Digest &b) const {
+        return memcmp(a.digest, b.digest, sizeof(a.digest)) < 0;
+    }
+};
+
+struct LTLuaChunk {
+    char *data;
+    size_t len;
+};
+
+#define CHUNKT std::map<LTSHA1Digest, LTLuaChunk, LTDigestCmp>
+#define CHUNKNAMET std::map<char *, LTSHA1Digest, CstrCmp>
+
+static CHUNKT chunks;
+static CHUNKNAMET chunk_keys; // Latest chunk for each chunkname.
+static char *chunk_dir = NULL;
+static LTLuaCacheStats stats = {0, 0, 0, 0, 0};
+
+void ltLuaSetChunkCacheDir(const char *dir) {
+    delete[] chunk_dir;
+    chunk_dir = NULL;
+    if (dir != NULL) {
+        ltMkDir(dir);
+        chunk_dir = new char[strlen(dir) + 1];
+        strcpy(chunk_dir, dir);
+    }
+}
+
+void ltLuaGetCacheStats(LTLuaCacheStats *s) {
+    *s = stats;
+}
+
+static int dump_writer(lua_State *L, const void *p, size_t sz, void *ud) {
+    std::vector<char> *buf = (std::vector<char>*)ud;
+    buf->insert(buf->end(), (const char*)p, (const char*)p + sz);
+    return 0;
+}
+
+static void add_chunk(LTSHA1Digest key, const char *data, size_t len) {
+    LTLuaChunk chunk;
+    chunk.data = new char[len];
+    chunk.len = len;
+    memcpy(chunk.data, data, len);
+    chunks[key] = chunk;
+    stats.chunks++;
+    stats.bytes += len;
+}
+
+static char *chunk_file(LTSHA1Digest key) {
+    char *hex = key.tostr();
+    int n = strlen(chunk_dir) + 48;
+    char *path = new char[n];
+    snprintf(path, n, "%s/%s.luac", chunk_dir, hex);
+    delete[] hex;
+    return path;
+}
+
+static void remove_chunk(CHUNKT::iterator it) {
+    stats.bytes -= it->second.len;
+    stats.chunks--;
+    delete[] it->second.data;
+    chunks.erase(it);
+}
+
+// Records key as the current chunk for chunkname, dropping the
+// chunk of any earlier version.
+static void set_chunk_key(const char *chunkname, LTSHA1Digest key) {
+    CHUNKNAMET::iterator kit = chunk_keys.find((char*)chunkname);
+    if (kit == chunk_keys.end()) {
+        char *name_copy = new char[strlen(chunkname) + 1];
+        strcpy(name_copy, chunkname);
+        chunk_keys[name_copy] = key;
+        return;
+    }
+    if (memcmp(kit->second.digest, key.digest, sizeof(key.digest)) == 0) {
+        return;
+    }
+    CHUNKT::iterator it = chunks.find(kit->second);
+    if (it != chunks.end()) {
+        remove_chunk(it);
+    }
+    if (chunk_dir != NULL) {
+        char *path = chunk_file(kit->second);
+        remove(path);
+        delete[] path;
+    }
+    kit->second = key;
+}
+
+static bool read_chunk_file(LTSHA1Digest key) {
+    char *path = chunk_file(key);
+    FILE *in = fopen(path, "rb");
+    delete[] path;
+    if (in == NULL) {
+        return false;
+    }
+    bool ok = false;
+    if (fseek(in, 0, SEEK_END) == 0) {
+        long len = ftell(in);
+        if (len > 0 && fseek(in, 0, SEEK_SET) == 0) {
+            char *data = new char[len];
+            if (fread(data, 1, len, in) == (size_t)len && data[0] == LUA_SIGNATURE[0]) {
+                add_chunk(key, data, len);
+                ok = true;
+            }
+            delete[] data;
+        }
+    }
+    fclose(in);
+    return ok;
+}
+
+static void write_chunk_file(LTSHA1Digest key, const char *data, size_t len) {
+    char *path = chunk_file(key);
+    FILE *out = fopen(path, "wb");
+    if (out == NULL) {
+        ltLog("Unable to write %s: %s", path, strerror(errno));
+    } else {
+        fwrite(data, 1, len, out);
+        fclose(out);
+    }
+    delete[] path;
+}
+
+int ltLuaLoadCached(lua_State *L, const char *src, size_t len, const char *chunkname) {
+    if (len > 0 && src[0] == LUA_SIGNATURE[0]) {
+        // Already compiled.
+        return luaL_loadbuffer(L, src, len, chunkname);
+    }
+    if (chunkname == NULL) {
+        chunkname = "";
+    }
+    LTSHA1Digest key = ltSHA1_named(chunkname, src, len);
+    CHUNKT::iterator it = chunks.find(key);
+    if (it != chunks.end()) {
+        stats.hits++;
+    } else if (chunk_dir != NULL && read_chunk_file(key)) {
+        stats.disk_hits++;
+        it = chunks.find(key);
+    }
+    if (it != chunks.end()) {
+        int r = luaL_loadbuffer(L, it->second.data, it->second.len, chunkname);
+        if (r == 0) {
+            set_chunk_key(chunkname, key);
+            return 0;
+        }
+        // Bad chunk (e.g. from a different Lua build); recompile.
+        lua_pop(L, 1);
+        remove_chunk(it);
+    }
+    stats.misses++;
+    int r = luaL_loadbuffer(L, src, len, chunkname);
+    if (r != 0) {
+        return r;
+    }
+    std::vector<char> dump;
+    lua_dump(L, dump_writer, &dump);
+    if (!dump.empty()) {
+        set_chunk_key(chunkname, key);
+        add_chunk(key, &dump[0], dump.size());
+        if (chunk_dir != NULL) {
+            write_chunk_file(key, &dump[0], dump.size());
+        }
+    }
+    return 0;
+}
@@ -1,2 +1,27 @@
 void ltLuaCacheAdd(const char *path, const char *data);
 const char *ltLuaReadCache(const char *path);
+
+// Compiled chunk cache.  Chunks are keyed by the SHA1 of their chunkname
+// and source (the bytecode records the chunkname for error messages), so
+// an unchanged module is loaded from bytecode instead of being recompiled,
+// even in a new Lua state (e.g. after a dev-server reload).  Only the
+// latest version of each chunkname is kept: when a module changes while
+// the game is running, its old chunk is dropped (and removed from the
+// cache directory).
+// Behaves like luaL_loadbuffer.
+int ltLuaLoadCached(lua_State *L, const char *src, size_t len, const char *chunkname);
+
+// If set, compiled chunks are also saved to and loaded from this directory,
+// so they survive restarts.  Only use a directory the game owns:
+// bytecode is not verified when loaded.
+void ltLuaSetChunkCacheDir(const char *dir);
+
+struct LTLuaCacheStats {
+    int hits;           // Loaded from memory.
+    int disk_hits;      // Loaded from the cache directory.
+    int misses;         // Compiled.
+    int chunks;
+    int bytes;
+};
+
+void ltLuaGetCacheStats(LTLuaCacheStats *stats);
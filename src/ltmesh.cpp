@@ -3,46 +3,122 @@
 
 LT_INIT_IMPL(ltmesh);
 
+// Texture coords outside this range don't fit in a short once scaled
+// by LT_MAX_TEX_COORD, so are uploaded as floats.
+#define MAX_SHORT_TEX_COORD (32767.0f / (LTfloat)LT_MAX_TEX_COORD)
+#define MIN_SHORT_TEX_COORD (-32768.0f / (LTfloat)LT_MAX_TEX_COORD)
+
+template <typename T>
+static T *copy_array(T *src, int n) {
+    if (src == NULL || n == 0) {
+        return NULL;
+    }
+    T *dst = new T[n];
+    memcpy(dst, src, sizeof(T) * n);
+    return dst;
+}
+
+// Resizes arr from n to m elements, keeping the first min(n, m).
+template <typename T>
+static void resize_array(T **arr, int n, int m) {
+    if (m == 0) {
+        delete[] *arr;
+        *arr = NULL;
+        return;
+    }
+    T *tmp = new T[m];
+    if (*arr != NULL) {
+        memcpy(tmp, *arr, sizeof(T) * (n < m ? n : m));
+        delete[] *arr;
+    }
+    *arr = tmp;
+}
+
+static inline LTubyte pack_color(LTfloat c) {
+    if (c <= 0.0f) return 0;
+    if (c >= 1.0f) return 255;
+    return (LTubyte)(c * 255.0f);
+}
+
+static inline LTbyte pack_normal(LTfloat n) {
+    if (n <= -1.0f) return -127;
+    if (n >= 1.0f) return 127;
+    return (LTbyte)roundf(n * 127.0f);
+}
+
+void ltPackNormal(LTVec3 n, LTbyte *p) {
+    p[0] = pack_normal(n.x);
+    p[1] = pack_normal(n.y);
+    p[2] = pack_normal(n.z);
+    p[3] = 0;
+}
+
+LTVec3 ltUnpackNormal(const LTbyte *p) {
+    return LTVec3((LTfloat)p[0] / 127.0f, (LTfloat)p[1] / 127.0f, (LTfloat)p[2] / 127.0f);
+}
+
+LTtexcoord ltPackTexCoord(LTfloat t) {
+    LTfloat tc = roundf(t * (LTfloat)LT_MAX_TEX_COORD);
+    if (tc <= -32768.0f) return -32768;
+    if (tc >= 32767.0f) return 32767;
+    return (LTtexcoord)tc;
+}
+
+static void init_mesh(LTMesh *m) {
+    m->dimensions = 2;
+    m->has_colors = false;
+    m->has_normals = false;
+    m->has_texture_coords = false;
+    m->texture = NULL;
+    m->texture_ref = LUA_NOREF;
+    m->draw_mode = LT_DRAWMODE_TRIANGLES;
+    m->size = 0;
+    m->xyzs = NULL;
+    m->colors = NULL;
+    m->normals = NULL;
+    m->uvs = NULL;
+    m->vertbuf = 0;
+    memset(&m->layout, 0, sizeof(LTMeshLayout));
+    m->vb_dirty = false;
+    m->vb_dynamic = false;
+    m->num_dirty_spans = 0;
+    m->left = 0.0f;
+    m->right = 0.0f;
+    m->bottom = 0.0f;
+    m->top = 0.0f;
+    m->farz = 0.0f;
+    m->nearz = 0.0f;
+    m->bb_dirty = false;
+    m->indices = NULL;
+    m->num_indices = 0;
+    m->indices_dirty = false;
+    m->batches = NULL;
+    m->num_batches = 0;
+    m->expanded = false;
+    m->translucent = false;
+    m->translucent_colors = false;
+    m->colors_scanned = false;
+}
+
 LTMesh::LTMesh() {
-    dimensions = 2;
-    has_colors = false;
-    has_normals = false;
-    has_texture_coords = false;
-    texture = NULL;
-    texture_ref = LUA_NOREF;
-    draw_mode = LT_DRAWMODE_TRIANGLES;
-    vdata = NULL;
-    size = 0;
-    vertbuf = 0;
-    vb_dirty = false;
-    left = 0.0f;
-    right = 0.0f;
-    bottom = 0.0f;
-    top = 0.0f;
-    farz = 0.0f;
-    nearz = 0.0f;
-    bb_dirty = false;
-    indices = NULL;
-    num_indices = 0;
-    indices_dirty = false;
+    init_mesh(this);
 }
 
 LTMesh::LTMesh(LTMesh *mesh) {
+    init_mesh(this);
     dimensions = mesh->dimensions;
     has_colors = mesh->has_colors;
     has_normals = mesh->has_normals;
     has_texture_coords = mesh->has_texture_coords;
     texture = mesh->texture;
-    texture_ref = LUA_NOREF;
     draw_mode = mesh->draw_mode;
+    translucent = mesh->translucent;
 
     size = mesh->size;
-    if (mesh->vdata != NULL) {
-        vdata = new LTVertData[size];
-        memcpy(vdata, mesh->vdata, sizeof(LTVertData) * size);
-    } else {
-        vdata = NULL;
-    }
+    xyzs = copy_array(mesh->xyzs, size);
+    colors = copy_array(mesh->colors, size * 4);
+    normals = copy_array(mesh->normals, size);
+    uvs = copy_array(mesh->uvs, size);
     vb_dirty = true;
 
     left = mesh->left;
@@ -53,41 +129,30 @@ LTMesh::LTMesh(LTMesh *mesh) {
     nearz = mesh->nearz;
     bb_dirty = mesh->bb_dirty;
 
-    vertbuf = 0;
-
-    if (mesh->num_indices > 0) {
-        indices = new LTvertindex[mesh->num_indices];
-        memcpy(indices, mesh->indices, mesh->num_indices * sizeof(LTvertindex));
-    } else {
-        indices = NULL;
-    }
     num_indices = mesh->num_indices;
+    indices = copy_array(mesh->indices, num_indices);
     indices_dirty = num_indices > 0;
 }
 
 LTMesh::LTMesh(LTTexturedNode *img) {
-    dimensions = 2;
-    has_colors = false;
-    has_normals = false;
-    has_texture_coords = true;
+    init_mesh(this);
     texture = img;
-    texture_ref = LUA_NOREF;
-    draw_mode = LT_DRAWMODE_TRIANGLES;
 
     size = 4;
-    vdata = new LTVertData[size];
+    xyzs = new LTVec3[size];
+    ensure_texture_coords();
 
     for (int i = 0; i < size; i++) {
-        vdata[i].xyz.x = img->world_vertices[i*2];
-        vdata[i].xyz.y = img->world_vertices[i*2+1];
-        vdata[i].uv.u = (LTfloat)img->tex_coords[i*2] / (LTfloat)LT_MAX_TEX_COORD;
-        vdata[i].uv.v = (LTfloat)img->tex_coords[i*2+1] / (LTfloat)LT_MAX_TEX_COORD;
+        xyzs[i].x = img->world_vertices[i*2];
+        xyzs[i].y = img->world_vertices[i*2+1];
+        uvs[i].u = (LTfloat)img->tex_coords[i*2] / (LTfloat)LT_MAX_TEX_COORD;
+        uvs[i].v = (LTfloat)img->tex_coords[i*2+1] / (LTfloat)LT_MAX_TEX_COORD;
     }
 
     vb_dirty = true;
 
     num_indices = 6;
-    indices = new LTvertindex[num_indices];
+    indices = new LTvertindex32[num_indices];
     indices[0] = 0;
     indices[1] = 1;
     indices[2] = 2;
@@ -104,180 +169,390 @@ LTMesh::LTMesh(LTTexturedNode *img) {
     farz = 0;
     nearz = 0;
     bb_dirty = false;
-
-    vertbuf = 0;
 }
 
-LTMesh::LTMesh(int dims, bool has_col, bool has_norm, bool has_tex_coords, LTImage *tex, LTDrawMode mode, LTVertData* dat, int sz) {
+LTMesh::LTMesh(int dims, LTImage *tex, LTDrawMode mode, int sz) {
+    init_mesh(this);
     dimensions = dims;
-    has_colors = has_col;
-    has_normals = has_norm;
-    has_texture_coords = has_tex_coords;
     texture = tex;
-    texture_ref = LUA_NOREF;
     draw_mode = mode;
-    vdata = dat;
     size = sz;
+    xyzs = sz > 0 ? new LTVec3[sz] : NULL;
     vb_dirty = true;
     bb_dirty = true;
+}
 
-    vertbuf = 0;
+LTMesh::~LTMesh() {
+    delete[] xyzs;
+    delete[] colors;
+    delete[] normals;
+    delete[] uvs;
+    delete[] indices;
+    free_batches();
+    if (vertbuf != 0) {
+        ltDeleteVertBuffer(vertbuf);
+    }
+}
 
-    indices = NULL;
-    num_indices = 0;
-    indices_dirty = false;
+void LTMesh::ensure_colors() {
+    if (colors == NULL && size > 0) {
+        colors = new LTubyte[size * 4];
+        memset(colors, 255, size * 4);
+    }
+    if (!has_colors) {
+        has_colors = true;
+        vb_dirty = true;
+    }
 }
 
-LTMesh::~LTMesh() {
-    if (vdata != NULL) {
-        delete[] vdata;
+void LTMesh::ensure_normals() {
+    if (normals == NULL && size > 0) {
+        normals = new LTVec3[size];
     }
-    if (indices != NULL) {
-        delete[] indices;
+    if (!has_normals) {
+        has_normals = true;
+        vb_dirty = true;
     }
-    if (vertbuf != 0) {
-        ltDeleteVertBuffer(vertbuf);
+}
+
+void LTMesh::ensure_texture_coords() {
+    if (uvs == NULL && size > 0) {
+        uvs = new LTTexCoord[size];
+    }
+    if (!has_texture_coords) {
+        has_texture_coords = true;
+        vb_dirty = true;
+    }
+}
+
+void LTMesh::set_color(int i, LTfloat r, LTfloat g, LTfloat b, LTfloat a) {
+    LTubyte *c = &colors[i * 4];
+    c[0] = pack_color(r);
+    c[1] = pack_color(g);
+    c[2] = pack_color(b);
+    c[3] = pack_color(a);
+}
+
+bool LTMesh::has_translucent_colors() {
+    // Any change to the colours also leaves the VBO out of date.
+    if (vb_dirty || num_dirty_spans > 0) {
+        colors_scanned = false;
+    }
+    if (!colors_scanned) {
+        translucent_colors = false;
+        if (has_colors && colors != NULL) {
+            for (int i = 0; i < size; i++) {
+                if (colors[i * 4 + 3] != 255) {
+                    translucent_colors = true;
+                    break;
+                }
+            }
+        }
+        colors_scanned = true;
     }
+    return translucent_colors;
+}
+
+void LTMesh::set_normal(int i, LTVec3 n) {
+    normals[i] = n;
+}
+
+LTVec3 LTMesh::get_normal(int i) {
+    return normals[i];
 }
 
 void LTMesh::resize_data(int sz) {
-    if (sz == 0) {
-        if (vdata != NULL) delete[] vdata;
-        vdata = NULL;
-    } else {
-        LTVertData *tmp = new LTVertData[sz];
-        memcpy(tmp, vdata, size * sizeof(LTVertData));
-        delete[] vdata;
-        vdata = tmp;
+    int old_size = size;
+    resize_array(&xyzs, old_size, sz);
+    if (colors != NULL) {
+        resize_array(&colors, old_size * 4, sz * 4);
+        if (sz > old_size) {
+            memset(&colors[old_size * 4], 255, (sz - old_size) * 4);
+        }
+    }
+    if (normals != NULL) {
+        resize_array(&normals, old_size, sz);
+    }
+    if (uvs != NULL) {
+        resize_array(&uvs, old_size, sz);
     }
     size = sz;
+    // Attributes that were set with no vertices still need arrays.
+    if (has_colors) ensure_colors();
+    if (has_normals) ensure_normals();
+    if (has_texture_coords) ensure_texture_coords();
     vb_dirty = true;
     bb_dirty = true;
 }
 
 void LTMesh::resize_indices(int sz) {
-    if (sz == 0) {
-        if (indices != NULL) delete[] indices;
-        indices = NULL;
-    } else {
-        LTvertindex *tmp = new LTvertindex[sz];
-        memcpy(tmp, indices, sizeof(LTvertindex) * num_indices);
-        delete[] indices;
-        indices = tmp;
-    }
+    resize_array(&indices, num_indices, sz);
     num_indices = sz;
     indices_dirty = true;
 }
 
+// Bulk operations on large meshes are split across worker threads.
+// The loops are kept simple and branch free so the compiler can
+// vectorise them.
+#define PARALLEL_MIN_VERTICES 8192
+
+// Face normals are summed per band of faces, each band into its own
+// array covering just the range of vertices its faces use.  For a grid,
+// where a band is a run of rows, that's about a band's worth of
+// vertices.  The bands' sums are then added up and normalised per
+// vertex range.
+struct LTNormalsJob {
+    LTMesh *mesh;
+    int num_faces;
+    int num_bands;
+    LTVec3 *band_sums[LT_MAX_WORKER_THREADS];
+    int band_first[LT_MAX_WORKER_THREADS];  // First vertex in band_sums.
+    int band_last[LT_MAX_WORKER_THREADS];
+};
+
+static void sum_normals_bands(int begin, int end, void *data) {
+    LTNormalsJob *job = (LTNormalsJob*)data;
+    LTVec3 *xyzs = job->mesh->xyzs;
+    LTvertindex32 *indices = job->mesh->indices;
+    for (int b = begin; b < end; b++) {
+        int i0 = (int)((int64_t)job->num_faces * b / job->num_bands) * 3;
+        int i1 = (int)((int64_t)job->num_faces * (b + 1) / job->num_bands) * 3;
+        int first = indices[i0];
+        int last = first;
+        for (int i = i0; i < i1; i++) {
+            int v = indices[i];
+            if (v < first) first = v;
+            if (v > last) last = v;
+        }
+        LTVec3 *sums = new LTVec3[last - first + 1];
+        for (int i = i0; i < i1; i += 3) {
+            int v1 = indices[i];
+            int v2 = indices[i + 1];
+            int v3 = indices[i + 2];
+            LTVec3 nm = (xyzs[v2] - xyzs[v1]).cross(xyzs[v3] - xyzs[v1]);
+            sums[v1 - first] += nm;
+            sums[v2 - first] += nm;
+            sums[v3 - first] += nm;
+        }
+        job->band_sums[b] = sums;
+        job->band_first[b] = first;
+        job->band_last[b] = last;
+    }
+}
+
+static void add_normals_range(int begin, int end, void *data) {
+    LTNormalsJob *job = (LTNormalsJob*)data;
+    LTVec3 *normals = job->mesh->normals;
+    for (int v = begin; v < end; v++) {
+        normals[v] = LTVec3();
+    }
+    // Bands in order, so the result doesn't depend on the ranges.
+    for (int b = 0; b < job->num_bands; b++) {
+        int first = job->band_first[b] > begin ? job->band_first[b] : begin;
+        int last = job->band_last[b] < end - 1 ? job->band_last[b] : end - 1;
+        LTVec3 *sums = job->band_sums[b];
+        int offset = job->band_first[b];
+        for (int v = first; v <= last; v++) {
+            normals[v] += sums[v - offset];
+        }
+    }
+    for (int v = begin; v < end; v++) {
+        normals[v].normalize();
+    }
+}
+
 void LTMesh::compute_normals() {
-    if (vdata == NULL) return;
+    if (xyzs == NULL) return;
 
     assert(indices != NULL);
     assert(num_indices % 3 == 0);
     assert(draw_mode == LT_DRAWMODE_TRIANGLES);
 
-    int n = num_indices;
-
-    for (int i = 0; i < size; i++) {
-        vdata[i].normal.zero();
+    int num_faces = num_indices / 3;
+    int num_bands = num_faces / PARALLEL_MIN_VERTICES;
+    if (num_bands > ltWorkerThreads()) {
+        num_bands = ltWorkerThreads();
+    }
+    ensure_normals();
+    if (num_bands > 1) {
+        LTNormalsJob job;
+        job.mesh = this;
+        job.num_faces = num_faces;
+        job.num_bands = num_bands;
+        ltParallelFor(num_bands, 1, sum_normals_bands, &job);
+        ltParallelFor(size, PARALLEL_MIN_VERTICES, add_normals_range, &job);
+        for (int b = 0; b < num_bands; b++) {
+            delete[] job.band_sums[b];
+        }
+    } else {
+        LTVec3 *accum = new LTVec3[size];
+        for (int t = 0; t < num_faces; t++) {
+            int i1 = indices[t * 3 + 0];
+            int i2 = indices[t * 3 + 1];
+            int i3 = indices[t * 3 + 2];
+            LTVec3 v1 = xyzs[i2] - xyzs[i1];
+            LTVec3 v2 = xyzs[i3] - xyzs[i1];
+            LTVec3 nm = v1.cross(v2);
+            accum[i1] += nm;
+            accum[i2] += nm;
+            accum[i3] += nm;
+        }
+        for (int v = 0; v < size; v++) {
+            accum[v].normalize();
+            set_normal(v, accum[v]);
+        }
+        delete[] accum;
     }
 
-    for (int i = 0; i < n; i += 3) {
-        LTVertData *vd1 = &vdata[indices[i + 0]];
-        LTVertData *vd2 = &vdata[indices[i + 1]];
-        LTVertData *vd3 = &vdata[indices[i + 2]];
-        LTVec3 *p1 = &vd1->xyz;
-        LTVec3 *p2 = &vd2->xyz;
-        LTVec3 *p3 = &vd3->xyz;
-        LTVec3 v1 = *p2 - *p1;
-        LTVec3 v2 = *p3 - *p1;
-        LTVec3 nm = v1.cross(v2);
-        vd1->normal += nm;
-        vd2->normal += nm;
-        vd3->normal += nm;
-    }
+    touch(0, size);
+}
 
-    for (int i = 0; i < size; i++) {
-        vdata[i].normal.normalize();
+bool LTMesh::uvs_fit_short(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        LTTexCoord *uv = &uvs[i];
+        if (uv->u > MAX_SHORT_TEX_COORD || uv->u < MIN_SHORT_TEX_COORD
+            || uv->v > MAX_SHORT_TEX_COORD || uv->v < MIN_SHORT_TEX_COORD)
+        {
+            return false;
+        }
     }
+    return true;
+}
 
-    has_normals = true;
+LTMeshLayout LTMesh::compute_layout() {
+    LTMeshLayout l;
+    l.stride = dimensions * 4; // 4 bytes per vertex coord
+    l.color_offset = -1;
+    l.normal_offset = -1;
+    l.uv_offset = -1;
+    l.uv_type = LT_VERT_DATA_TYPE_SHORT;
+    if (has_colors) {
+        l.color_offset = l.stride;
+        l.stride += 4; // 1 byte per channel (r, g, b, a = 4 total)
+    }
+    if (has_normals) {
+        l.normal_offset = l.stride;
+        l.stride += 4; // 1 byte per normal component + 1 extra to keep 4-byte alignment
+    }
+    if (has_texture_coords) {
+        l.uv_offset = l.stride;
+        if (!uvs_fit_short(0, size)) {
+            l.uv_type = LT_VERT_DATA_TYPE_FLOAT;
+        }
+        // 2 bytes per texture coordinate (u + v) = 4 total, or 8 as floats
+        l.stride += l.uv_type == LT_VERT_DATA_TYPE_SHORT ? 4 : 8;
+    }
+    return l;
+}
 
-    vb_dirty = true;
+void *LTMesh::generate_vbo_data(LTMeshLayout *l, int begin, int end) {
+    int stride = l->stride;
+    int n = end - begin;
+    char *data = (char*)malloc(stride * n);
+    if (dimensions > 2) {
+        for (int i = 0; i < n; i++) {
+            memcpy(data + i * stride, &xyzs[begin + i], 12);
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            memcpy(data + i * stride, &xyzs[begin + i], 8);
+        }
+    }
+    if (l->color_offset >= 0) {
+        char *ptr = data + l->color_offset;
+        for (int i = begin; i < end; i++) {
+            memcpy(ptr, &colors[i * 4], 4);
+            ptr += stride;
+        }
+    }
+    if (l->normal_offset >= 0) {
+        char *ptr = data + l->normal_offset;
+        for (int i = begin; i < end; i++) {
+            ltPackNormal(normals[i], (LTbyte*)ptr);
+            ptr += stride;
+        }
+    }
+    if (l->uv_offset >= 0) {
+        char *ptr = data + l->uv_offset;
+        if (l->uv_type == LT_VERT_DATA_TYPE_SHORT) {
+            for (int i = begin; i < end; i++) {
+                LTtexcoord *tc = (LTtexcoord*)ptr;
+                tc[0] = ltPackTexCoord(uvs[i].u);
+                tc[1] = ltPackTexCoord(uvs[i].v);
+                ptr += stride;
+            }
+        } else {
+            for (int i = begin; i < end; i++) {
+                memcpy(ptr, &uvs[i], 8);
+                ptr += stride;
+            }
+        }
+    }
+    return data;
 }
 
-static inline
-int compute_stride(LTMesh *m) {
-    int stride;
-    stride = m->dimensions * 4; // 4 bytes per vertex coord
-    stride += m->has_colors ? 4 : 0; // 1 byte per channel (r, g, b, a = 4 total)
-    stride += m->has_normals ? 4 : 0; // 1 byte per normal component + 1 extra to keep 4-byte alignment
-    stride += m->has_texture_coords ? 4 : 0; // 2 bytes per texture coordinate (u + v) = 4 total
-    return stride;
+static void set_pointers(LTMesh *mesh, LTvertbuf vb, bool textured) {
+    LTMeshLayout *layout = &mesh->layout;
+    int stride = layout->stride;
+    ltBindVertBuffer(vb);
+    ltVertexPointer(mesh->dimensions, LT_VERT_DATA_TYPE_FLOAT, stride, (void*)0);
+    if (mesh->has_colors) {
+        ltColorPointer(4, LT_VERT_DATA_TYPE_UBYTE, stride, (void*)(LTuintptr)layout->color_offset);
+    }
+    if (mesh->has_normals) {
+        ltNormalPointer(LT_VERT_DATA_TYPE_BYTE, stride, (void*)(LTuintptr)layout->normal_offset);
+    }
+    if (textured) {
+        ltTexCoordPointer(2, layout->uv_type, stride, (void*)(LTuintptr)layout->uv_offset);
+    }
 }
 
-void *LTMesh::generate_vbo_data() {
-    int stride = compute_stride(this);
-    void* data = malloc(stride * size);
-    void* ptr = data;
-    for (int i = 0; i < size; i++) {
-        LTVertData *vd = &vdata[i];
-        *((LTfloat*)ptr + 0) = vd->xyz.x;
-        *((LTfloat*)ptr + 1) = vd->xyz.y;
-        lt_incr_ptr(&ptr, 8);
-        if (dimensions > 2) {
-            *((LTfloat*)ptr) = vd->xyz.z;
-            lt_incr_ptr(&ptr, 4);
-        }
-        if (has_colors) {
-            *((LTubyte*)ptr + 0) = (LTubyte)(vd->color.red * 255.0);
-            *((LTubyte*)ptr + 1) = (LTubyte)(vd->color.green * 255.0);
-            *((LTubyte*)ptr + 2) = (LTubyte)(vd->color.blue * 255.0);
-            *((LTubyte*)ptr + 3) = (LTubyte)(vd->color.alpha * 255.0);
-            lt_incr_ptr(&ptr, 4);
-        }
-        if (has_normals) {
-            *((LTbyte*)ptr + 0) = (LTbyte)(vd->normal.x * 127.0);
-            *((LTbyte*)ptr + 1) = (LTbyte)(vd->normal.y * 127.0);
-            *((LTbyte*)ptr + 2) = (LTbyte)(vd->normal.z * 127.0);
-            lt_incr_ptr(&ptr, 4);
-        }
-        if (has_texture_coords) {
-            *((LTtexcoord*)ptr + 0) = (LTtexcoord)(vd->uv.u * (LTfloat)LT_MAX_TEX_COORD);
-            *((LTtexcoord*)ptr + 1) = (LTtexcoord)(vd->uv.v * (LTfloat)LT_MAX_TEX_COORD);
-            lt_incr_ptr(&ptr, 4);
-        }
-    }
-    assert(ptr == (void*)((char*)data + size * stride));
-    return data;
+// Returns the centre and half extents of the mesh's bounding box.
+static void get_bounds(LTMesh *mesh, LTVec3 *centre, LTVec3 *half_extents) {
+    mesh->ensure_bb_uptodate();
+    centre->x = (mesh->left + mesh->right) * 0.5f;
+    centre->y = (mesh->bottom + mesh->top) * 0.5f;
+    centre->z = (mesh->farz + mesh->nearz) * 0.5f;
+    half_extents->x = (mesh->right - mesh->left) * 0.5f;
+    half_extents->y = (mesh->top - mesh->bottom) * 0.5f;
+    half_extents->z = (mesh->nearz - mesh->farz) * 0.5f;
 }
 
 void LTMesh::draw() {
+    if (ltFrustumCullingEnabled() && size > 0) {
+        LTVec3 centre, half_extents;
+        get_bounds(this, &centre, &half_extents);
+        if (ltFrustumCull(NULL, centre, half_extents)) {
+            return;
+        }
+    }
     ensure_vb_uptodate();
-    int stride = compute_stride(this);
-    ltBindVertBuffer(vertbuf);
-    LTuintptr offset = 0;
-    ltVertexPointer(dimensions, LT_VERT_DATA_TYPE_FLOAT, stride, (void*)offset);
-    offset += dimensions * 4;
     if (has_colors) {
         ltEnableColorArrays();
-        ltColorPointer(4, LT_VERT_DATA_TYPE_UBYTE, stride, (void*)offset);
-        offset += 4;
     }
     if (has_normals) {
         ltEnableNormalArrays();
-        ltNormalPointer(LT_VERT_DATA_TYPE_BYTE, stride, (void*)offset);
-        offset += 4;
     }
-    if (texture != NULL) {
+    bool textured = texture != NULL && has_texture_coords;
+    if (textured) {
         ltEnableTexture(texture->texture_id);
-        ltTexCoordPointer(2, LT_VERT_DATA_TYPE_SHORT, stride, (void*)offset);
     } else {
         ltDisableTextures();
     }
-    if (num_indices > 0) {
-        ltDrawElements(draw_mode, num_indices, indices);
+    if (batches != NULL) {
+        for (int i = 0; i < num_batches; i++) {
+            LTMeshBatch *batch = &batches[i];
+            set_pointers(this, batch->vertbuf != 0 ? batch->vertbuf : vertbuf, textured);
+            ltDrawElements(draw_mode, batch->num_indices, batch->indices);
+        }
+    } else if (expanded) {
+        set_pointers(this, vertbuf, textured);
+        ltDrawArrays(draw_mode, 0, num_indices);
+    } else if (num_indices > 0) {
+        set_pointers(this, vertbuf, textured);
+        ltDrawElements32(draw_mode, num_indices, indices);
     } else {
+        set_pointers(this, vertbuf, textured);
         ltDrawArrays(draw_mode, 0, size);
     }
     if (has_normals) {
@@ -290,46 +565,116 @@ void LTMesh::draw() {
     }
 }
 
+void LTMesh::enqueue(LTRenderQueue *queue) {
+    if (size == 0) {
+        return;
+    }
+    LTVec3 centre, half_extents;
+    get_bounds(this, &centre, &half_extents);
+    bool tested = ltFrustumCullingEnabled();
+    if (tested && ltFrustumCull(queue->modelview(), centre, half_extents)) {
+        return;
+    }
+    bool textured = texture != NULL && has_texture_coords;
+    bool transparent = translucent;
+    LTMaterial *material = queue->state()->lighting.material;
+    if (queue->state()->lighting.lighting && material != NULL && material->diffuse.alpha < 1.0f) {
+        transparent = true;
+    }
+    if (!transparent) {
+        transparent = has_translucent_colors();
+    }
+    queue->add(this, centre, transparent, textured ? texture->texture_id : 0, tested);
+}
+
+struct LTStretchJob {
+    LTfloat *xyzs;
+    LTfloat p[3];
+    LTfloat below[3];   // Added to components less than p.
+    LTfloat above[3];   // Added to the others.
+};
+
+static void stretch_range(int begin, int end, void *data) {
+    LTStretchJob *job = (LTStretchJob*)data;
+    LTfloat *f = job->xyzs;
+    // Copied so the compiler knows they don't alias f.
+    LTfloat px = job->p[0], py = job->p[1], pz = job->p[2];
+    LTfloat bx = job->below[0], by = job->below[1], bz = job->below[2];
+    LTfloat ax = job->above[0], ay = job->above[1], az = job->above[2];
+    for (int i = begin * 3; i < end * 3; i += 3) {
+        f[i + 0] += f[i + 0] < px ? bx : ax;
+        f[i + 1] += f[i + 1] < py ? by : ay;
+        f[i + 2] += f[i + 2] < pz ? bz : az;
+    }
+}
+
 void LTMesh::stretch(LTfloat px, LTfloat py, LTfloat pz,
     LTfloat left, LTfloat right, LTfloat down, LTfloat up, LTfloat backward, LTfloat forward)
 {
-    if (vdata == NULL) return;
-    for (int i = 0; i < size; i++) {
-        LTVertData *vd = &vdata[i];
-        LTVec3 *p = &vd->xyz;
-        if (p->x < px) {
-            p->x -= left;
-        } else {
-            p->x += right;
-        }
-        if (p->y < py) {
-            p->y -= down;
-        } else {
-            p->y += up;
-        }
-        if (p->z < pz) {
-            p->z -= backward;
-        } else {
-            p->z += forward;
-        }
-    }
-
-    vb_dirty = true;
+    if (xyzs == NULL) return;
+    LTStretchJob job;
+    job.xyzs = (LTfloat*)xyzs;
+    job.p[0] = px;
+    job.p[1] = py;
+    job.p[2] = pz;
+    job.below[0] = -left;
+    job.below[1] = -down;
+    job.below[2] = -backward;
+    job.above[0] = right;
+    job.above[1] = up;
+    job.above[2] = forward;
+    ltParallelFor(size, PARALLEL_MIN_VERTICES, stretch_range, &job);
+
+    touch(0, size);
     bb_dirty = true;
 }
 
-void LTMesh::shift(LTfloat sx, LTfloat sy, LTfloat sz) {
-    if (vdata == NULL) return;
+struct LTShiftJob {
+    LTfloat *xyzs;
+    LTfloat sx, sy, sz;
+};
 
-    for (int i = 0; i < size; i++) {
-        LTVertData *vd = &vdata[i];
-        vd->xyz += LTVec3(sz, sy, sz);
+static void shift_range(int begin, int end, void *data) {
+    LTShiftJob *job = (LTShiftJob*)data;
+    LTfloat *f = job->xyzs;
+    LTfloat sx = job->sx;
+    LTfloat sy = job->sy;
+    LTfloat sz = job->sz;
+    for (int i = begin * 3; i < end * 3; i += 3) {
+        f[i + 0] += sx;
+        f[i + 1] += sy;
+        f[i + 2] += sz;
     }
+}
 
-    vb_dirty = true;
+void LTMesh::shift(LTfloat sx, LTfloat sy, LTfloat sz) {
+    if (xyzs == NULL) return;
+
+    LTShiftJob job;
+    job.xyzs = (LTfloat*)xyzs;
+    job.sx = sx;
+    job.sy = sy;
+    job.sz = sz;
+    ltParallelFor(size, PARALLEL_MIN_VERTICES, shift_range, &job);
+
+    touch(0, size);
     bb_dirty = true;
 }
 
+template <typename T>
+static void merge_array(T **dst, int n, T *src, int m) {
+    if (src == NULL) {
+        return;
+    }
+    T *tmp = new T[n + m];
+    if (*dst != NULL) {
+        memcpy(tmp, *dst, sizeof(T) * n);
+        delete[] *dst;
+    }
+    memcpy(&tmp[n], src, sizeof(T) * m);
+    *dst = tmp;
+}
+
 void LTMesh::merge(LTMesh *mesh) {
     assert(mesh->dimensions == dimensions);
     assert(mesh->has_colors == has_colors);
@@ -341,18 +686,15 @@ void LTMesh::merge(LTMesh *mesh) {
 
     int orig_size = size;
 
-    if (mesh->vdata != NULL) {
-        LTVertData *tmp = new LTVertData[size + mesh->size];
-        memcpy(tmp, vdata, sizeof(LTVertData) * size);
-        memcpy(&tmp[size], mesh->vdata, sizeof(LTVertData) * mesh->size);
-        delete[] vdata;
-        vdata = tmp;
-    }
+    merge_array(&xyzs, size, mesh->xyzs, mesh->size);
+    merge_array(&colors, size * 4, mesh->colors, mesh->size * 4);
+    merge_array(&normals, size, mesh->normals, mesh->size);
+    merge_array(&uvs, size, mesh->uvs, mesh->size);
     size += mesh->size;
 
     if (mesh->indices != NULL) {
-        LTvertindex *tmp = new LTvertindex[num_indices + mesh->num_indices];
-        memcpy(tmp, indices, sizeof(LTvertindex) * num_indices);
+        LTvertindex32 *tmp = new LTvertindex32[num_indices + mesh->num_indices];
+        memcpy(tmp, indices, sizeof(LTvertindex32) * num_indices);
         for (int i = 0; i < mesh->num_indices; i++) {
             tmp[i + num_indices] = mesh->indices[i] + orig_size;
         }
@@ -364,10 +706,63 @@ void LTMesh::merge(LTMesh *mesh) {
     vb_dirty = true;
     bb_dirty = true;
     indices_dirty = true;
+    changed();
+}
+
+struct LTGridJob {
+    LTMesh *mesh;
+    int rows, columns;
+    LTfloat left, right, bottom, top;
+    LTfloat tex_left, tex_right, tex_bottom, tex_top;
+};
+
+static void grid_rows(int begin, int end, void *data) {
+    LTGridJob *job = (LTGridJob*)data;
+    LTMesh *mesh = job->mesh;
+    int rows = job->rows;
+    int columns = job->columns;
+    LTfloat col_width = (job->right - job->left) / (LTfloat)columns;
+    LTfloat row_height = (job->top - job->bottom) / (LTfloat)rows;
+    LTfloat tex_col_width = (job->tex_right - job->tex_left) / (LTfloat)columns;
+    LTfloat tex_row_height = (job->tex_top - job->tex_bottom) / (LTfloat)rows;
+    for (int row = begin; row < end; row++) {
+        // The last row and column are set exactly, in case of rounding errors.
+        LTfloat y = row == rows ? job->top : job->bottom + row_height * (LTfloat)row;
+        LTfloat v = row == rows ? job->tex_top : job->tex_bottom + tex_row_height * (LTfloat)row;
+        int i = row * (columns + 1);
+        LTVec3 *xyz = &mesh->xyzs[i];
+        LTTexCoord *uv = &mesh->uvs[i];
+        for (int col = 0; col < columns; col++) {
+            xyz[col].x = job->left + col_width * (LTfloat)col;
+            xyz[col].y = y;
+            xyz[col].z = 0.0f;
+            uv[col].u = job->tex_left + tex_col_width * (LTfloat)col;
+            uv[col].v = v;
+        }
+        xyz[columns].x = job->right;
+        xyz[columns].y = y;
+        xyz[columns].z = 0.0f;
+        uv[columns].u = job->tex_right;
+        uv[columns].v = v;
+
+        if (row < rows) {
+            LTvertindex32 *ind = &mesh->indices[row * columns * 6];
+            for (int col = 0; col < columns; col++) {
+                ind[0] = i;
+                ind[1] = i + columns + 1;
+                ind[2] = i + 1;
+                ind[3] = i + 1;
+                ind[4] = i + columns + 1;
+                ind[5] = i + columns + 2;
+                ind += 6;
+                i++;
+            }
+        }
+    }
 }
 
 void LTMesh::grid(int rows, int columns) {
-    if (vdata == NULL) return;
+    if (xyzs == NULL) return;
     assert(dimensions == 2);
     assert(has_texture_coords);
     assert(!has_colors);
@@ -377,119 +772,314 @@ void LTMesh::grid(int rows, int columns) {
         delete[] indices;
     }
     num_indices = 6 * rows * columns;
-    indices = new LTvertindex[num_indices];
+    indices = new LTvertindex32[num_indices];
 
     draw_mode = LT_DRAWMODE_TRIANGLES;
 
     ensure_bb_uptodate();
 
     size = (rows + 1) * (columns + 1);
-    if (vdata != NULL) {
-        delete[] vdata;
-    }
-    vdata = new LTVertData[size];
+    delete[] xyzs;
+    delete[] uvs;
+    xyzs = new LTVec3[size];
+    uvs = new LTTexCoord[size];
+
+    LTGridJob job;
+    job.mesh = this;
+    job.rows = rows;
+    job.columns = columns;
+    job.left = left;
+    job.right = right;
+    job.bottom = bottom;
+    job.top = top;
+    job.tex_left = (LTfloat)texture->tex_coords[0] / (LTfloat)LT_MAX_TEX_COORD;
+    job.tex_right = (LTfloat)texture->tex_coords[2] / (LTfloat)LT_MAX_TEX_COORD;
+    job.tex_bottom = (LTfloat)texture->tex_coords[1] / (LTfloat)LT_MAX_TEX_COORD;
+    job.tex_top = (LTfloat)texture->tex_coords[5] / (LTfloat)LT_MAX_TEX_COORD;
+    ltParallelFor(rows + 1, PARALLEL_MIN_VERTICES / (columns + 1), grid_rows, &job);
 
-    LTfloat col_width = (right - left) / (LTfloat)columns;
-    LTfloat row_height = (top - bottom) / (LTfloat)rows;
-
-    LTfloat tex_left = (LTfloat)texture->tex_coords[0] / (LTfloat)LT_MAX_TEX_COORD;
-    LTfloat tex_right = (LTfloat)texture->tex_coords[2] / (LTfloat)LT_MAX_TEX_COORD;
-    LTfloat tex_bottom = (LTfloat)texture->tex_coords[1] / (LTfloat)LT_MAX_TEX_COORD;
-    LTfloat tex_top = (LTfloat)texture->tex_coords[5] / (LTfloat)LT_MAX_TEX_COORD;
-    LTfloat tex_col_width = (tex_right - tex_left) / (LTfloat)columns;
-    LTfloat tex_row_height = (tex_top - tex_bottom) / (LTfloat)rows;
-
-    LTfloat y = bottom;
-    LTfloat v = tex_bottom;
+    vb_dirty = true;
+    indices_dirty = true;
+    bb_dirty = true;
+    changed();
+}
 
+void LTMesh::touch(int begin, int end) {
+    changed();
+    if (vb_dirty || begin >= end) {
+        return;
+    }
+    // Spans are kept sorted and disjoint.  Find the first span that
+    // could overlap or be adjacent, then absorb all that do.
     int i = 0;
-    int j = 0;
-    for (int row = 0; row <= rows; row++) {
-        LTfloat x = left;
-        LTfloat u = tex_left;
-        for (int col = 0; col <= columns; col++) {
-            // Add vertex
-            vdata[i].xyz.x = x;
-            vdata[i].xyz.y = y;
-            vdata[i].uv.u = u;
-            vdata[i].uv.v = v;
-
-            if (col < columns && row < rows) {
-                // Add indicies
-                indices[j + 0] = i;
-                indices[j + 1] = i + columns + 1;
-                indices[j + 2] = i + 1;
-                indices[j + 3] = i + 1;
-                indices[j + 4] = i + columns + 1;
-                indices[j + 5] = i + columns + 2;
-                j += 6;
+    while (i < num_dirty_spans && dirty_spans[i].end < begin) {
+        i++;
+    }
+    int j = i;
+    while (j < num_dirty_spans && dirty_spans[j].begin <= end) {
+        if (dirty_spans[j].begin < begin) begin = dirty_spans[j].begin;
+        if (dirty_spans[j].end > end) end = dirty_spans[j].end;
+        j++;
+    }
+    // Replace spans [i, j) with the new one.
+    memmove(&dirty_spans[i + 1], &dirty_spans[j], sizeof(LTMeshSpan) * (num_dirty_spans - j));
+    num_dirty_spans += 1 - (j - i);
+    dirty_spans[i].begin = begin;
+    dirty_spans[i].end = end;
+
+    if (num_dirty_spans > LT_MESH_MAX_DIRTY_SPANS) {
+        // Merge the two closest spans.
+        int closest = 0;
+        int min_gap = INT_MAX;
+        for (i = 0; i < num_dirty_spans - 1; i++) {
+            int gap = dirty_spans[i + 1].begin - dirty_spans[i].end;
+            if (gap < min_gap) {
+                min_gap = gap;
+                closest = i;
             }
+        }
+        dirty_spans[closest].end = dirty_spans[closest + 1].end;
+        num_dirty_spans--;
+        memmove(&dirty_spans[closest + 1], &dirty_spans[closest + 2],
+            sizeof(LTMeshSpan) * (num_dirty_spans - closest - 1));
+    }
+}
+
+static int primitive_size(LTDrawMode mode) {
+    switch (mode) {
+        case LT_DRAWMODE_TRIANGLES: return 3;
+        case LT_DRAWMODE_LINES: return 2;
+        case LT_DRAWMODE_POINTS: return 1;
+        default: return 0;
+    }
+}
+
+static void add_batch(std::vector<LTMeshBatch> *batches, std::vector<LTvertindex32> *verts,
+    std::vector<LTvertindex> *indices, const char *data, int stride)
+{
+    LTMeshBatch batch;
+    batch.num_indices = indices->size();
+    batch.indices = new LTvertindex[batch.num_indices];
+    memcpy(batch.indices, &(*indices)[0], sizeof(LTvertindex) * batch.num_indices);
+    batch.num_vertices = verts->size();
+    batch.vertices = new LTvertindex32[batch.num_vertices];
+    memcpy(batch.vertices, &(*verts)[0], sizeof(LTvertindex32) * batch.num_vertices);
+    batch.vertbuf = 0;
+    if (data != NULL) {
+        char *batch_data = (char*)malloc(stride * batch.num_vertices);
+        for (int i = 0; i < batch.num_vertices; i++) {
+            memcpy(batch_data + i * stride, data + batch.vertices[i] * stride, stride);
+        }
+        batch.vertbuf = ltGenVertBuffer();
+        ltBindVertBuffer(batch.vertbuf);
+        ltStaticVertBufferData(stride * batch.num_vertices, batch_data);
+        free(batch_data);
+    }
+    batches->push_back(batch);
+}
 
-            i++;
-            
-            x += col_width;
-            u += tex_col_width;
-            if (col == columns - 1) {
-                // in case of rounding errors.
-                x = right;
-                u = tex_right;
+bool LTMesh::build_batches(int max_verts, bool upload) {
+    free_batches();
+    if (size <= max_verts) {
+        // All indices fit in 16 bits, so one batch using the mesh's VBO.
+        batches = new LTMeshBatch[1];
+        num_batches = 1;
+        batches[0].vertbuf = 0;
+        batches[0].num_indices = num_indices;
+        batches[0].vertices = NULL;
+        batches[0].num_vertices = size;
+        batches[0].indices = new LTvertindex[num_indices];
+        for (int i = 0; i < num_indices; i++) {
+            batches[0].indices[i] = (LTvertindex)indices[i];
+        }
+        return true;
+    }
+
+    int prim = primitive_size(draw_mode);
+    if (prim == 0) {
+        return false;
+    }
+    char *data = NULL;
+    if (upload) {
+        data = (char*)generate_vbo_data(&layout, 0, size);
+    }
+    std::vector<LTMeshBatch> result;
+    std::vector<int> local(size, -1);           // Batch index of each mesh vertex.
+    std::vector<LTvertindex32> verts;           // Mesh index of each batch vertex.
+    std::vector<LTvertindex> batch_indices;
+    int n = num_indices - num_indices % prim;
+    for (int i = 0; i < n; i += prim) {
+        // Start a new batch if this primitive's vertices won't fit.
+        int new_verts = 0;
+        for (int j = 0; j < prim; j++) {
+            if (local[indices[i + j]] < 0) {
+                new_verts++;
             }
         }
-        y += row_height;
-        v += tex_row_height;
-        if (row == rows - 1) {
-            y = top;
-            v = tex_top;
+        if ((int)verts.size() + new_verts > max_verts) {
+            add_batch(&result, &verts, &batch_indices, data, layout.stride);
+            for (int j = 0; j < (int)verts.size(); j++) {
+                local[verts[j]] = -1;
+            }
+            verts.clear();
+            batch_indices.clear();
+        }
+        for (int j = 0; j < prim; j++) {
+            LTvertindex32 v = indices[i + j];
+            if (local[v] < 0) {
+                local[v] = verts.size();
+                verts.push_back(v);
+            }
+            batch_indices.push_back((LTvertindex)local[v]);
         }
     }
-    assert(j == num_indices);
-    assert(i == size);
+    if (!batch_indices.empty()) {
+        add_batch(&result, &verts, &batch_indices, data, layout.stride);
+    }
+    free(data);
 
-    vb_dirty = true;
-    indices_dirty = true;
-    bb_dirty = true;
+    num_batches = result.size();
+    batches = new LTMeshBatch[num_batches];
+    for (int i = 0; i < num_batches; i++) {
+        batches[i] = result[i];
+    }
+    return true;
+}
+
+void LTMesh::free_batches() {
+    for (int i = 0; i < num_batches; i++) {
+        delete[] batches[i].indices;
+        delete[] batches[i].vertices;
+        if (batches[i].vertbuf != 0) {
+            ltDeleteVertBuffer(batches[i].vertbuf);
+        }
+    }
+    delete[] batches;
+    batches = NULL;
+    num_batches = 0;
+}
+
+void LTMesh::upload_expanded() {
+    static bool logged = false;
+    if (!logged) {
+        ltLog("32 bit indices unsupported: drawing %d vertex mesh without indices", size);
+        logged = true;
+    }
+    int stride = layout.stride;
+    char *data = (char*)generate_vbo_data(&layout, 0, size);
+    char *expanded_data = (char*)malloc(stride * num_indices);
+    for (int i = 0; i < num_indices; i++) {
+        memcpy(expanded_data + i * stride, data + indices[i] * stride, stride);
+    }
+    vertbuf = ltGenVertBuffer();
+    ltBindVertBuffer(vertbuf);
+    ltStaticVertBufferData(stride * num_indices, expanded_data);
+    free(expanded_data);
+    free(data);
+    expanded = true;
 }
 
 void LTMesh::ensure_vb_uptodate() {
+    if (vb_dirty || num_dirty_spans > 0) {
+        colors_scanned = false;
+    }
+    bool short_indices = num_indices > 0 && !ltUintIndicesSupported();
+    if (short_indices && size > LT_MESH_MAX_BATCH_VERTICES) {
+        // Sub-batches have their own VBOs, which are rebuilt on any change.
+        if (vb_dirty || num_dirty_spans > 0 || indices_dirty) {
+            if (vertbuf != 0) {
+                ltDeleteVertBuffer(vertbuf);
+                vertbuf = 0;
+            }
+            expanded = false;
+            layout = compute_layout();
+            if (!build_batches(LT_MESH_MAX_BATCH_VERTICES, true)) {
+                upload_expanded();
+            }
+            vb_dirty = false;
+            num_dirty_spans = 0;
+            indices_dirty = false;
+        }
+        return;
+    }
+    if (expanded) {
+        ltDeleteVertBuffer(vertbuf);
+        vertbuf = 0;
+        expanded = false;
+    }
     if (vertbuf == 0) {
         vertbuf = ltGenVertBuffer();
+        vb_dirty = true;
+    }
+    if (!vb_dirty && has_texture_coords && layout.uv_type == LT_VERT_DATA_TYPE_SHORT) {
+        // Changed uvs may no longer fit the current layout.
+        for (int i = 0; i < num_dirty_spans; i++) {
+            if (!uvs_fit_short(dirty_spans[i].begin, dirty_spans[i].end)) {
+                vb_dirty = true;
+                break;
+            }
+        }
     }
     if (vb_dirty) {
         ltBindVertBuffer(vertbuf);
-        void *data = generate_vbo_data();
-        ltStaticVertBufferData(size * compute_stride(this), data);
+        layout = compute_layout();
+        void *data = generate_vbo_data(&layout, 0, size);
+        if (vb_dynamic) {
+            ltDynamicVertBufferData(size * layout.stride, data);
+        } else {
+            ltStaticVertBufferData(size * layout.stride, data);
+        }
         free(data);
         vb_dirty = false;
+    } else if (num_dirty_spans > 0) {
+        ltBindVertBuffer(vertbuf);
+        int stride = layout.stride;
+        for (int i = 0; i < num_dirty_spans; i++) {
+            LTMeshSpan *span = &dirty_spans[i];
+            void *data = generate_vbo_data(&layout, span->begin, span->end);
+            ltVertBufferSubData(span->begin * stride, (span->end - span->begin) * stride, data);
+            free(data);
+        }
+        vb_dynamic = true;
     }
+    num_dirty_spans = 0;
+    if (short_indices) {
+        if (indices_dirty || batches == NULL || batches[0].vertbuf != 0) {
+            build_batches(LT_MESH_MAX_BATCH_VERTICES, false);
+        }
+    } else if (batches != NULL) {
+        free_batches();
+    }
+    indices_dirty = false;
 }
 
 void LTMesh::ensure_bb_uptodate() {
-    if (vdata != NULL && bb_dirty) {
+    if (xyzs != NULL && bb_dirty) {
         if (size > 0) {
-            LTVertData *vd = &vdata[0];
-            left = vd->xyz.x;
+            LTVec3 *p = &xyzs[0];
+            left = p->x;
             right = left;
-            bottom = vd->xyz.y;
+            bottom = p->y;
             top = bottom;
-            farz = vd->xyz.z;
+            farz = p->z;
             nearz = farz;
 
             for (int i = 1; i < size; i++) {
-                LTVertData *vd = &vdata[i];
-                if (vd->xyz.x > right) {
-                    right = vd->xyz.x;
-                } else if (vd->xyz.x < left) {
-                    left = vd->xyz.x;
+                LTVec3 *p = &xyzs[i];
+                if (p->x > right) {
+                    right = p->x;
+                } else if (p->x < left) {
+                    left = p->x;
                 }
-                if (vd->xyz.y > top) {
-                    top = vd->xyz.y;
-                } else if (vd->xyz.y < bottom) {
-                    bottom = vd->xyz.y;
+                if (p->y > top) {
+                    top = p->y;
+                } else if (p->y < bottom) {
+                    bottom = p->y;
                 }
-                if (vd->xyz.z > nearz) {
-                    nearz = vd->xyz.z;
-                } else if (vd->xyz.z < farz) {
-                    farz = vd->xyz.z;
+                if (p->z > nearz) {
+                    nearz = p->z;
+                } else if (p->z < farz) {
+                    farz = p->z;
                 }
             }
         } else {
@@ -504,6 +1094,35 @@ void LTMesh::ensure_bb_uptodate() {
     }
 }
 
+int LTMesh::cpu_bytes() {
+    int bytes = 0;
+    if (xyzs != NULL) bytes += size * sizeof(LTVec3);
+    if (colors != NULL) bytes += size * 4;
+    if (normals != NULL) bytes += size * sizeof(LTVec3);
+    if (uvs != NULL) bytes += size * sizeof(LTTexCoord);
+    bytes += num_indices * sizeof(LTvertindex32);
+    for (int i = 0; i < num_batches; i++) {
+        bytes += batches[i].num_indices * sizeof(LTvertindex);
+        if (batches[i].vertices != NULL) {
+            bytes += batches[i].num_vertices * sizeof(LTvertindex32);
+        }
+    }
+    return bytes;
+}
+
+int LTMesh::vbo_bytes() {
+    int bytes = 0;
+    if (vertbuf != 0) {
+        bytes += (expanded ? num_indices : size) * layout.stride;
+    }
+    for (int i = 0; i < num_batches; i++) {
+        if (batches[i].vertbuf != 0) {
+            bytes += batches[i].num_vertices * layout.stride;
+        }
+    }
+    return bytes;
+}
+
 void LTMesh::print() {
     if (dimensions == 2) {
         printf("     X     Y");
@@ -520,25 +1139,27 @@ void LTMesh::print() {
         printf("     U     V");
     }
     printf("\n");
-    if (vdata == NULL) {
+    if (xyzs == NULL) {
         printf("NO DATA\n");
     } else {
         for (int i = 0; i < size; i++) {
-            LTVertData *vd = &vdata[i];
+            LTVec3 *p = &xyzs[i];
             if (dimensions == 2) {
-                printf(" %5.2f %5.2f", vd->xyz.x, vd->xyz.y);
+                printf(" %5.2f %5.2f", p->x, p->y);
             } else {
-                printf(" %5.2f %5.2f %5.2f", vd->xyz.x, vd->xyz.y, vd->xyz.z);
+                printf(" %5.2f %5.2f %5.2f", p->x, p->y, p->z);
             }
             if (has_colors) {
-                printf(" %1.2f %1.2f %1.2f %1.2f", vd->color.red, vd->color.green, vd->color.blue,
-                    vd->color.alpha);
+                LTubyte *c = &colors[i * 4];
+                printf(" %1.2f %1.2f %1.2f %1.2f", c[0] / 255.0f, c[1] / 255.0f, c[2] / 255.0f,
+                    c[3] / 255.0f);
             }
             if (has_normals) {
-                printf(" %5.2f %5.2f %5.2f", vd->normal.x, vd->normal.y, vd->normal.y);
+                LTVec3 n = get_normal(i);
+                printf(" %5.2f %5.2f %5.2f", n.x, n.y, n.z);
             }
             if (has_texture_coords) {
-                printf(" %5.2f %5.2f", vd->uv.u, vd->uv.v);
+                printf(" %5.2f %5.2f", uvs[i].u, uvs[i].v);
             }
             printf("\n");
         }
@@ -546,7 +1167,7 @@ void LTMesh::print() {
     if (indices != NULL) {
         printf("indices = [");
         for (int i = 0; i < num_indices; i++) {
-            printf("%d, ", indices[i]);
+            printf("%u, ", indices[i]);
         }
         printf("]\n");
     } else {
@@ -642,33 +1263,80 @@ static int make_grid(lua_State *L) {
     return 1;
 }
 
-static int set_xys(lua_State *L) {
-    ltLuaCheckNArgs(L, 2);
-    LTMesh *mesh = lt_expect_LTMesh(L, 1);
+// Records runs of changed vertices as dirty spans.
+struct LTChangedRuns {
+    LTMesh *mesh;
+    int start;
+
+    LTChangedRuns(LTMesh *m) {
+        mesh = m;
+        start = -1;
+    }
+
+    void vertex(int i, bool changed) {
+        if (changed) {
+            if (start < 0) {
+                start = i;
+            }
+        } else if (start >= 0) {
+            mesh->touch(start, i);
+            start = -1;
+        }
+    }
+
+    void finish(int end) {
+        if (start >= 0) {
+            mesh->touch(start, end);
+        }
+    }
+};
+
+// Checks the table in argument 2 and the optional first vertex index
+// in argument 3.  With no index the mesh is resized to fit the table
+// (when grow_only is set, only if it's too small) and the first vertex
+// is 0.  With an index the vertices must already exist.
+static int check_vertex_table(lua_State *L, LTMesh *mesh, int components, bool grow_only, int *first) {
     if (!lua_istable(L, 2)) {
         return luaL_error(L, "Expecting a table in argument 2");
     }
     int len = lua_objlen(L, 2);
-    if (len & 0x1) {
-        return luaL_error(L, "table should have even length (in fact %d)", len);
-    }
-    int size = len / 2;
-    if (size != mesh->size) {
-        mesh->resize_data(size);
+    if (len % components != 0) {
+        return luaL_error(L, "table should have length divisible by %d (in fact %d)", components, len);
+    }
+    int n = len / components;
+    if (lua_isnoneornil(L, 3)) {
+        *first = 0;
+        if (n > mesh->size || (!grow_only && n != mesh->size)) {
+            mesh->resize_data(n);
+        }
+    } else {
+        *first = luaL_checkinteger(L, 3) - 1;
+        if (*first < 0 || *first + n > mesh->size) {
+            return luaL_error(L, "Vertices %d to %d out of range (mesh has %d)", *first + 1, *first + n, mesh->size);
+        }
     }
-    LTVertData *ptr = mesh->vdata;
-    for (int i = 1; i <= len; i += 2) {
-        lua_rawgeti(L, 2, i);
-        lua_rawgeti(L, 2, i  + 1);
+    return n;
+}
+
+static int set_xys(lua_State *L) {
+    ltLuaCheckNArgs(L, 2);
+    LTMesh *mesh = lt_expect_LTMesh(L, 1);
+    int first;
+    int n = check_vertex_table(L, mesh, 2, false, &first);
+    LTChangedRuns runs(mesh);
+    for (int i = 0; i < n; i++) {
+        lua_rawgeti(L, 2, i * 2 + 1);
+        lua_rawgeti(L, 2, i * 2 + 2);
         LTfloat x = luaL_checknumber(L, -2);
         LTfloat y = luaL_checknumber(L, -1);
         lua_pop(L, 2);
-        ptr->xyz.x = x;
-        ptr->xyz.y = y;
-        ptr++;
+        LTVec3 *p = &mesh->xyzs[first + i];
+        runs.vertex(first + i, p->x != x || p->y != y);
+        p->x = x;
+        p->y = y;
     }
+    runs.finish(first + n);
 
-    mesh->vb_dirty = true;
     mesh->bb_dirty = true;
 
     return 0;
@@ -677,36 +1345,30 @@ static int set_xys(lua_State *L) {
 static int set_xyzs(lua_State *L) {
     ltLuaCheckNArgs(L, 2);
     LTMesh *mesh = lt_expect_LTMesh(L, 1);
-    if (!lua_istable(L, 2)) {
-        return luaL_error(L, "Expecting a table in argument 2");
-    }
-    int len = lua_objlen(L, 2);
-    if (len % 3 != 0) {
-        return luaL_error(L, "table should have length divisible by 3 (in fact %d)", len);
-    }
+    int first;
+    int n = check_vertex_table(L, mesh, 3, true, &first);
     if (mesh->dimensions != 3) {
         mesh->dimensions = 3;
+        mesh->vb_dirty = true;
+        mesh->changed();
     }
-    int size = len / 3;
-    if (size > mesh->size) {
-        mesh->resize_data(size);
-    }
-    LTVertData *ptr = mesh->vdata;
-    for (int i = 1; i <= len; i += 3) {
-        lua_rawgeti(L, 2, i + 0);
-        lua_rawgeti(L, 2, i + 1);
-        lua_rawgeti(L, 2, i + 2);
+    LTChangedRuns runs(mesh);
+    for (int i = 0; i < n; i++) {
+        lua_rawgeti(L, 2, i * 3 + 1);
+        lua_rawgeti(L, 2, i * 3 + 2);
+        lua_rawgeti(L, 2, i * 3 + 3);
         LTfloat x = luaL_checknumber(L, -3);
         LTfloat y = luaL_checknumber(L, -2);
         LTfloat z = luaL_checknumber(L, -1);
         lua_pop(L, 3);
-        ptr->xyz.x = x;
-        ptr->xyz.y = y;
-        ptr->xyz.z = z;
-        ptr++;
+        LTVec3 *p = &mesh->xyzs[first + i];
+        runs.vertex(first + i, p->x != x || p->y != y || p->z != z);
+        p->x = x;
+        p->y = y;
+        p->z = z;
     }
+    runs.finish(first + n);
 
-    mesh->vb_dirty = true;
     mesh->bb_dirty = true;
 
     return 0;
@@ -715,35 +1377,26 @@ static int set_xyzs(lua_State *L) {
 static int set_rgbs(lua_State *L) {
     ltLuaCheckNArgs(L, 2);
     LTMesh *mesh = lt_expect_LTMesh(L, 1);
-    if (!lua_istable(L, 2)) {
-        return luaL_error(L, "Expecting a table in argument 2");
-    }
-    int len = lua_objlen(L, 2);
-    if (len % 3 != 0) {
-        return luaL_error(L, "table should have length divisible by 3 (in fact %d)", len);
-    }
-    mesh->has_colors = true;
-    int size = len / 3;
-    if (size > mesh->size) {
-        mesh->resize_data(size);
-    }
-    LTVertData *ptr = mesh->vdata;
-    for (int i = 1; i <= len; i += 3) {
-        lua_rawgeti(L, 2, i + 0);
-        lua_rawgeti(L, 2, i + 1);
-        lua_rawgeti(L, 2, i + 2);
-        LTfloat r = luaL_checknumber(L, -3);
-        LTfloat g = luaL_checknumber(L, -2);
-        LTfloat b = luaL_checknumber(L, -1);
+    int first;
+    int n = check_vertex_table(L, mesh, 3, true, &first);
+    mesh->ensure_colors();
+    LTChangedRuns runs(mesh);
+    for (int i = 0; i < n; i++) {
+        lua_rawgeti(L, 2, i * 3 + 1);
+        lua_rawgeti(L, 2, i * 3 + 2);
+        lua_rawgeti(L, 2, i * 3 + 3);
+        LTubyte r = pack_color(luaL_checknumber(L, -3));
+        LTubyte g = pack_color(luaL_checknumber(L, -2));
+        LTubyte b = pack_color(luaL_checknumber(L, -1));
         lua_pop(L, 3);
-        ptr->color.red = r;
-        ptr->color.green = g;
-        ptr->color.blue = b;
-        ptr++;
+        // Leave alpha as is.
+        LTubyte *c = &mesh->colors[(first + i) * 4];
+        runs.vertex(first + i, c[0] != r || c[1] != g || c[2] != b);
+        c[0] = r;
+        c[1] = g;
+        c[2] = b;
     }
-
-    mesh->vb_dirty = true;
-    mesh->bb_dirty = true;
+    runs.finish(first + n);
 
     return 0;
 }
@@ -751,37 +1404,27 @@ static int set_rgbs(lua_State *L) {
 static int set_rgbas(lua_State *L) {
     ltLuaCheckNArgs(L, 2);
     LTMesh *mesh = lt_expect_LTMesh(L, 1);
-    if (!lua_istable(L, 2)) {
-        return luaL_error(L, "Expecting a table in argument 2");
-    }
-    int len = lua_objlen(L, 2);
-    if (len % 4 != 0) {
-        return luaL_error(L, "table should have length divisible by 4 (in fact %d)", len);
-    }
-    mesh->has_colors = true;
-    int size = len / 4;
-    if (size > mesh->size) {
-        mesh->resize_data(size);
-    }
-    LTVertData *ptr = mesh->vdata;
-    for (int i = 1; i <= len; i += 4) {
-        lua_rawgeti(L, 2, i + 0);
-        lua_rawgeti(L, 2, i + 1);
-        lua_rawgeti(L, 2, i + 2);
-        lua_rawgeti(L, 2, i + 3);
+    int first;
+    int n = check_vertex_table(L, mesh, 4, true, &first);
+    mesh->ensure_colors();
+    LTChangedRuns runs(mesh);
+    for (int i = 0; i < n; i++) {
+        lua_rawgeti(L, 2, i * 4 + 1);
+        lua_rawgeti(L, 2, i * 4 + 2);
+        lua_rawgeti(L, 2, i * 4 + 3);
+        lua_rawgeti(L, 2, i * 4 + 4);
         LTfloat r = luaL_checknumber(L, -4);
         LTfloat g = luaL_checknumber(L, -3);
         LTfloat b = luaL_checknumber(L, -2);
         LTfloat a = luaL_checknumber(L, -1);
         lua_pop(L, 4);
-        ptr->color.red = r;
-        ptr->color.green = g;
-        ptr->color.blue = b;
-        ptr->color.alpha = a;
-        ptr++;
+        LTubyte *c = &mesh->colors[(first + i) * 4];
+        LTuint32 old;
+        memcpy(&old, c, 4);
+        mesh->set_color(first + i, r, g, b, a);
+        runs.vertex(first + i, memcmp(&old, c, 4) != 0);
     }
-
-    mesh->vb_dirty = true;
+    runs.finish(first + n);
 
     return 0;
 }
@@ -789,37 +1432,26 @@ static int set_rgbas(lua_State *L) {
 static int set_uvs(lua_State *L) {
     ltLuaCheckNArgs(L, 2);
     LTMesh *mesh = lt_expect_LTMesh(L, 1);
-    if (!lua_istable(L, 2)) {
-        return luaL_error(L, "Expecting a table in argument 2");
-    }
-    int len = lua_objlen(L, 2);
-    if (len & 0x1) {
-        return luaL_error(L, "table should have even length (in fact %d)", len);
-    }
-    int size = len / 2;
-    if (size != mesh->size) {
-        mesh->resize_data(size);
-    }
-    LTVertData *ptr = mesh->vdata;
-    for (int i = 1; i <= len; i += 2) {
-        lua_rawgeti(L, 2, i);
-        lua_rawgeti(L, 2, i  + 1);
+    int first;
+    int n = check_vertex_table(L, mesh, 2, false, &first);
+    mesh->ensure_texture_coords();
+    LTChangedRuns runs(mesh);
+    for (int i = 0; i < n; i++) {
+        lua_rawgeti(L, 2, i * 2 + 1);
+        lua_rawgeti(L, 2, i * 2 + 2);
         LTfloat u = luaL_checknumber(L, -2);
         LTfloat v = luaL_checknumber(L, -1);
         lua_pop(L, 2);
-        ptr->uv.u = u;
-        ptr->uv.v = v;
-        ptr++;
+        LTTexCoord *uv = &mesh->uvs[first + i];
+        runs.vertex(first + i, uv->u != u || uv->v != v);
+        uv->u = u;
+        uv->v = v;
     }
-
-    mesh->vb_dirty = true;
-    mesh->has_texture_coords = true;
+    runs.finish(first + n);
 
     return 0;
 }
 
-#define MAX_INDICES 65000
-
 static int set_indices(lua_State *L) {
     ltLuaCheckNArgs(L, 2);
     LTMesh *mesh = lt_expect_LTMesh(L, 1);
@@ -835,13 +1467,14 @@ static int set_indices(lua_State *L) {
         lua_rawgeti(L, 2, i + 1);
         int index = luaL_checkint(L, -1);
         lua_pop(L, 1);
-        if (index > size || index < 1 || index > MAX_INDICES) {
+        if (index > size || index < 1) {
             return luaL_error(L, "Invalid index: %d", index);
         }
-        mesh->indices[i] = (LTvertindex)(index - 1);
+        mesh->indices[i] = (LTvertindex32)(index - 1);
     }
 
     mesh->indices_dirty = true;
+    mesh->changed();
 
     return 0;
 }
@@ -884,9 +1517,20 @@ static void set_texture(LTObject *obj, LTObject *val) {
     mesh->texture = new_texture;
 }
 
+static LTint get_cpu_bytes(LTObject *obj) {
+    return ((LTMesh*)obj)->cpu_bytes();
+}
+
+static LTint get_vbo_bytes(LTObject *obj) {
+    return ((LTMesh*)obj)->vbo_bytes();
+}
+
 LT_REGISTER_TYPE(LTMesh, "lt.Mesh", "lt.SceneNode")
 LT_REGISTER_FIELD_ENUM(LTMesh, draw_mode, LTDrawMode, DrawMode_enum_vals)
 LT_REGISTER_PROPERTY_OBJ(LTMesh, texture, LTTexturedNode, get_texture, set_texture);
+LT_REGISTER_PROPERTY_INT(LTMesh, cpu_bytes, get_cpu_bytes, NULL);
+LT_REGISTER_PROPERTY_INT(LTMesh, vbo_bytes, get_vbo_bytes, NULL);
+LT_REGISTER_FIELD_BOOL(LTMesh, translucent)
 LT_REGISTER_METHOD(LTMesh, Clone, clone_mesh)
 LT_REGISTER_METHOD(LTMesh, Stretch, stretch_mesh)
 LT_REGISTER_METHOD(LTMesh, Shift, shift_mesh)
@@ -1,11 +1,46 @@
 /* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
 LT_INIT_DECL(ltmesh);
 
-struct LTVertData {
-    LTVec3 xyz;
-    LTColor color;
-    LTVec3 normal;
-    LTTexCoord uv;
+// Vertex attributes are kept in separate arrays.  An attribute's array
+// is only allocated once it's set, so a mesh only pays for what it uses.
+// Colours are stored packed, in the same form the VBO uses.  Normals
+// are kept as floats, so operations on them don't lose precision, and
+// are packed to bytes when the VBO data is generated.  The interleaved
+// VBO layout is derived from the attributes present (see LTMeshLayout).
+//
+// Changes that keep the layout and vertex count only re-upload the
+// vertices that changed.  These are recorded as dirty spans with
+// touch().  Anything else sets vb_dirty, which rebuilds the whole VBO.
+//
+// Indices are 32 bit.  Where GL can't draw 32 bit indices they are
+// converted to 16 bit batches.  If the mesh has more vertices than 16
+// bit indices can address, it's split into sub-batches, each with its
+// own VBO holding only the vertices it uses.  Strips, fans and loops
+// can't be split, so for those the VBO holds the vertices in index
+// order and is drawn without indices.
+
+#define LT_MESH_MAX_DIRTY_SPANS 16
+#define LT_MESH_MAX_BATCH_VERTICES 65536
+
+struct LTMeshLayout {
+    int stride;
+    int color_offset;           // -1 if no colours.
+    int normal_offset;          // -1 if no normals.
+    int uv_offset;              // -1 if no texture coords.
+    LTVertDataType uv_type;     // SHORT (scaled by LT_MAX_TEX_COORD) or FLOAT.
+};
+
+struct LTMeshBatch {
+    LTvertbuf vertbuf;          // 0 to use the mesh's VBO.
+    LTvertindex *indices;
+    int num_indices;
+    LTvertindex32 *vertices;    // Mesh index of each batch vertex, or NULL
+    int num_vertices;           // for the mesh's VBO.
+};
+
+struct LTMeshSpan {
+    int begin;
+    int end; // exclusive
 };
 
 struct LTMesh : LTSceneNode {
@@ -16,25 +51,44 @@ struct LTMesh : LTSceneNode {
     LTTexturedNode *texture;
     int texture_ref;
     LTDrawMode draw_mode;
-    LTVertData *vdata;
     int size; // number of vertices
+    LTVec3 *xyzs;
+    LTubyte *colors;    // RGBA, 4 per vertex.
+    LTVec3 *normals;
+    LTTexCoord *uvs;
     LTvertbuf vertbuf;
-    bool vb_dirty;
+    LTMeshLayout layout; // Layout of the current VBO.
+    bool vb_dirty;      // Whole VBO needs rebuilding.
+    bool vb_dynamic;    // VBO has had partial updates.
+    LTMeshSpan dirty_spans[LT_MESH_MAX_DIRTY_SPANS + 1]; // Sorted. One spare for merging.
+    int num_dirty_spans;
     LTfloat left, right, bottom, top, farz, nearz; // bounding box
     bool bb_dirty;
-    LTvertindex *indices;
+    LTvertindex32 *indices;
     int num_indices;
     bool indices_dirty;
+    LTMeshBatch *batches;   // Only when 32 bit indices aren't supported.
+    int num_batches;
+    bool expanded;          // VBO holds the vertices in index order.
+
+    // Render queues draw textured meshes as opaque unless this is set,
+    // so set it if the texture has translucent texels.
+    bool translucent;
+    // Whether any vertex colour has alpha below 1, cached by
+    // has_translucent_colors until the vertex data next changes.
+    bool translucent_colors;
+    bool colors_scanned;
 
     LTMesh();
     LTMesh(LTMesh *mesh); // clone
     LTMesh(LTTexturedNode *img);
-    // dat should be allocated with new[].  it will be deleted by ~LTMesh.
-    LTMesh(int dims, bool has_col, bool has_norm, bool has_tex_coords,
-        LTImage *tex, LTDrawMode mode, LTVertData *dat, int sz);
+    // Allocates xyzs for sz vertices.  Use the ensure_* methods to add
+    // other attributes.
+    LTMesh(int dims, LTImage *tex, LTDrawMode mode, int sz);
     virtual ~LTMesh();
 
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 
     void stretch(
         /* about this point: */ LTfloat px, LTfloat py, LTfloat pz,
@@ -45,17 +99,61 @@ struct LTMesh : LTSceneNode {
     void merge(LTMesh *mesh);
     void grid(int rows, int columns);
 
+    // Allocate the attribute array if necessary and set the has_* flag.
+    // New colours are opaque white; new normals and uvs are zero.
+    void ensure_colors();
+    void ensure_normals();
+    void ensure_texture_coords();
+
+    void set_color(int i, LTfloat r, LTfloat g, LTfloat b, LTfloat a);
+    void set_normal(int i, LTVec3 n);
+    LTVec3 get_normal(int i);
+    bool has_translucent_colors();
+
+    // Record that vertices [begin, end) have changed.  Spans that
+    // overlap or touch are merged.  When there are too many spans the
+    // two closest are merged.
+    void touch(int begin, int end);
+
     void ensure_vb_uptodate();
+    // Build 16 bit batches of at most max_verts vertices from the
+    // indices.  The sub-batch VBOs are only created if upload is true.
+    // Returns false if the draw mode can't be split.
+    bool build_batches(int max_verts, bool upload);
+    void free_batches();
+    // Upload the vertices in index order to a new VBO, for when
+    // build_batches fails.
+    void upload_expanded();
     void ensure_bb_uptodate();
     void resize_data(int sz);
     void resize_indices(int sz);
     void compute_normals();
     void print();
 
-private:
-    void *generate_vbo_data();
+    // Bytes used by the vertex and index arrays in main memory, and by
+    // the VBO (0 if not yet uploaded).
+    int cpu_bytes();
+    int vbo_bytes();
+
+    // Whether uvs [begin, end) can be stored as shorts scaled by
+    // LT_MAX_TEX_COORD.
+    bool uvs_fit_short(int begin, int end);
+
+    LTMeshLayout compute_layout();
+    // Returns interleaved vertex data for vertices [begin, end) in the
+    // given layout.  The caller should free it with free().
+    void *generate_vbo_data(LTMeshLayout *layout, int begin, int end);
 };
 
+// Normals as stored in VBOs and mesh files: x, y, z scaled by 127
+// and a byte of padding.
+void ltPackNormal(LTVec3 n, LTbyte *p);
+LTVec3 ltUnpackNormal(const LTbyte *p);
+
+// A texture coordinate as stored in short uv VBOs and mesh files,
+// rounded to the nearest multiple of 1/LT_MAX_TEX_COORD.
+LTtexcoord ltPackTexCoord(LTfloat t);
+
 void *lt_alloc_LTMesh(lua_State *L);
 LTMesh *lt_expect_LTMesh(lua_State *L, int arg);
 bool lt_is_LTMesh(lua_State *L, int arg);
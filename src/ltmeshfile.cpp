@@ -0,0 +1,490 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(ltmeshfile)
+
+#define MAX_VERTICES (1 << 26)
+#define MAX_INDICES  (1 << 28)
+
+static int padded(int bytes) {
+    return (bytes + 3) & ~3;
+}
+
+static int positions_bytes(LTuint32 flags, int n) {
+    return flags & LT_MESHFILE_SHORT_POSITIONS ? padded(n * 3 * 2) : n * 3 * 4;
+}
+
+static int uvs_bytes(LTuint32 flags, int n) {
+    return flags & LT_MESHFILE_SHORT_UVS ? n * 2 * 2 : n * 2 * 4;
+}
+
+static int indices_bytes(LTuint32 flags, int n) {
+    return flags & LT_MESHFILE_SHORT_INDICES ? padded(n * 2) : n * 4;
+}
+
+static bool valid_draw_mode(LTuint32 mode) {
+    switch (mode) {
+        case LT_DRAWMODE_TRIANGLES:
+        case LT_DRAWMODE_TRIANGLE_STRIP:
+        case LT_DRAWMODE_TRIANGLE_FAN:
+        case LT_DRAWMODE_POINTS:
+        case LT_DRAWMODE_LINES:
+        case LT_DRAWMODE_LINE_STRIP:
+        case LT_DRAWMODE_LINE_LOOP:
+            return true;
+    }
+    return false;
+}
+
+static bool read_mesh(const char *filename, const char *data, int len, LTMesh *mesh) {
+    if (len < (int)sizeof(LTMeshFileHeader)) {
+        ltLog("%s: Error: truncated header", filename);
+        return false;
+    }
+    LTMeshFileHeader *h = (LTMeshFileHeader*)data;
+    if (memcmp(h->magic, LT_MESHFILE_MAGIC, 4) != 0) {
+        ltLog("%s: Error: not a mesh file", filename);
+        return false;
+    }
+    if (h->num_vertices > MAX_VERTICES || h->num_indices > MAX_INDICES
+        || (h->dimensions != 2 && h->dimensions != 3) || !valid_draw_mode(h->draw_mode))
+    {
+        ltLog("%s: Error: corrupt header", filename);
+        return false;
+    }
+    LTuint32 flags = h->flags;
+    int n = h->num_vertices;
+    int num_indices = h->num_indices;
+    // Each part fits in an int, but together they may not.
+    int64_t expected = (int64_t)sizeof(LTMeshFileHeader) + positions_bytes(flags, n)
+        + (flags & LT_MESHFILE_COLORS ? n * 4 : 0)
+        + (flags & LT_MESHFILE_NORMALS ? n * 4 : 0)
+        + (flags & LT_MESHFILE_UVS ? uvs_bytes(flags, n) : 0)
+        + indices_bytes(flags, num_indices);
+    if ((int64_t)len != expected) {
+        ltLog("%s: Error: expecting %lld bytes, but file has %d", filename, (long long)expected, len);
+        return false;
+    }
+
+    mesh->~LTMesh(); // deconstruct before constructing again.
+    new (mesh) LTMesh(h->dimensions, NULL, (LTDrawMode)h->draw_mode, n);
+    const char *ptr = data + sizeof(LTMeshFileHeader);
+
+    if (flags & LT_MESHFILE_SHORT_POSITIONS) {
+        const LTushort *q = (const LTushort*)ptr;
+        LTfloat sx = (h->right - h->left) / 65535.0f;
+        LTfloat sy = (h->top - h->bottom) / 65535.0f;
+        LTfloat sz = (h->nearz - h->farz) / 65535.0f;
+        for (int i = 0; i < n; i++) {
+            mesh->xyzs[i].x = h->left + q[i * 3 + 0] * sx;
+            mesh->xyzs[i].y = h->bottom + q[i * 3 + 1] * sy;
+            mesh->xyzs[i].z = h->farz + q[i * 3 + 2] * sz;
+        }
+    } else {
+        memcpy(mesh->xyzs, ptr, n * sizeof(LTVec3));
+    }
+    ptr += positions_bytes(flags, n);
+
+    if (flags & LT_MESHFILE_COLORS) {
+        mesh->ensure_colors();
+        memcpy(mesh->colors, ptr, n * 4);
+        ptr += n * 4;
+    }
+    if (flags & LT_MESHFILE_NORMALS) {
+        mesh->ensure_normals();
+        const LTbyte *b = (const LTbyte*)ptr;
+        for (int i = 0; i < n; i++) {
+            mesh->normals[i] = ltUnpackNormal(&b[i * 4]);
+        }
+        ptr += n * 4;
+    }
+    if (flags & LT_MESHFILE_UVS) {
+        mesh->ensure_texture_coords();
+        if (flags & LT_MESHFILE_SHORT_UVS) {
+            const LTtexcoord *tc = (const LTtexcoord*)ptr;
+            for (int i = 0; i < n; i++) {
+                mesh->uvs[i].u = (LTfloat)tc[i * 2] / (LTfloat)LT_MAX_TEX_COORD;
+                mesh->uvs[i].v = (LTfloat)tc[i * 2 + 1] / (LTfloat)LT_MAX_TEX_COORD;
+            }
+        } else {
+            memcpy(mesh->uvs, ptr, n * sizeof(LTTexCoord));
+        }
+        ptr += uvs_bytes(flags, n);
+    }
+
+    if (num_indices > 0) {
+        mesh->resize_indices(num_indices);
+        LTvertindex32 max_index = 0;
+        if (flags & LT_MESHFILE_SHORT_INDICES) {
+            const LTvertindex *src = (const LTvertindex*)ptr;
+            for (int i = 0; i < num_indices; i++) {
+                mesh->indices[i] = src[i];
+                if (src[i] > max_index) max_index = src[i];
+            }
+        } else {
+            memcpy(mesh->indices, ptr, num_indices * sizeof(LTvertindex32));
+            for (int i = 0; i < num_indices; i++) {
+                if (mesh->indices[i] > max_index) max_index = mesh->indices[i];
+            }
+        }
+        if ((int)max_index >= n) {
+            ltLog("%s: Error: index %u out of range", filename, max_index);
+            mesh->resize_indices(0);
+            return false;
+        }
+    }
+
+    mesh->left = h->left;
+    mesh->right = h->right;
+    mesh->bottom = h->bottom;
+    mesh->top = h->top;
+    mesh->farz = h->farz;
+    mesh->nearz = h->nearz;
+    mesh->bb_dirty = false;
+    return true;
+}
+
+bool ltReadMeshFile(const char *filename, LTMesh *mesh) {
+    // Init obj in case we return false.
+    new (mesh) LTMesh(0, NULL, LT_DRAWMODE_TRIANGLES, 0);
+
+    LTResource *rsc = ltOpenResource(filename);
+    if (rsc == NULL) {
+        ltLog("Unable to open %s", filename);
+        return false;
+    }
+    int len;
+    char *data = (char*)ltReadResourceAll(rsc, &len);
+    ltCloseResource(rsc);
+    if (data == NULL) {
+        ltLog("Error reading %s", filename);
+        return false;
+    }
+    bool ok = read_mesh(filename, data, len, mesh);
+    free(data);
+    return ok;
+}
+
+static bool write_padded(FILE *f, const void *data, int bytes) {
+    static const char zeros[4] = {0, 0, 0, 0};
+    int pad = padded(bytes) - bytes;
+    return fwrite(data, 1, bytes, f) == (size_t)bytes
+        && fwrite(zeros, 1, pad, f) == (size_t)pad;
+}
+
+static LTushort quantise(LTfloat x, LTfloat min, LTfloat max) {
+    if (max <= min) {
+        return 0;
+    }
+    LTfloat q = (x - min) / (max - min) * 65535.0f + 0.5f;
+    if (q <= 0.0f) return 0;
+    if (q >= 65535.0f) return 65535;
+    return (LTushort)q;
+}
+
+bool ltWriteMeshFile(const char *filename, LTMesh *mesh, bool quantise_positions) {
+    mesh->ensure_bb_uptodate();
+    int n = mesh->size;
+
+    LTMeshFileHeader h;
+    memcpy(h.magic, LT_MESHFILE_MAGIC, 4);
+    h.flags = 0;
+    if (mesh->has_colors && mesh->colors != NULL) {
+        h.flags |= LT_MESHFILE_COLORS;
+    }
+    if (mesh->has_normals && mesh->normals != NULL) {
+        h.flags |= LT_MESHFILE_NORMALS;
+    }
+    if (mesh->has_texture_coords && mesh->uvs != NULL) {
+        h.flags |= LT_MESHFILE_UVS;
+        if (mesh->uvs_fit_short(0, n)) {
+            h.flags |= LT_MESHFILE_SHORT_UVS;
+        }
+    }
+    if (quantise_positions) {
+        h.flags |= LT_MESHFILE_SHORT_POSITIONS;
+    }
+    if (n <= 65536) {
+        h.flags |= LT_MESHFILE_SHORT_INDICES;
+    }
+    h.dimensions = mesh->dimensions;
+    h.draw_mode = mesh->draw_mode;
+    h.num_vertices = n;
+    h.num_indices = mesh->num_indices;
+    h.left = mesh->left;
+    h.right = mesh->right;
+    h.bottom = mesh->bottom;
+    h.top = mesh->top;
+    h.farz = mesh->farz;
+    h.nearz = mesh->nearz;
+
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL) {
+        ltLog("Unable to open %s for writing: %s", filename, strerror(errno));
+        return false;
+    }
+    bool ok = write_padded(f, &h, sizeof(h));
+
+    if (h.flags & LT_MESHFILE_SHORT_POSITIONS) {
+        std::vector<LTushort> q(n * 3);
+        for (int i = 0; i < n; i++) {
+            q[i * 3 + 0] = quantise(mesh->xyzs[i].x, h.left, h.right);
+            q[i * 3 + 1] = quantise(mesh->xyzs[i].y, h.bottom, h.top);
+            q[i * 3 + 2] = quantise(mesh->xyzs[i].z, h.farz, h.nearz);
+        }
+        ok = ok && write_padded(f, &q[0], n * 3 * 2);
+    } else {
+        ok = ok && write_padded(f, mesh->xyzs, n * sizeof(LTVec3));
+    }
+    if (h.flags & LT_MESHFILE_COLORS) {
+        ok = ok && write_padded(f, mesh->colors, n * 4);
+    }
+    if (h.flags & LT_MESHFILE_NORMALS) {
+        std::vector<LTbyte> b(n * 4);
+        for (int i = 0; i < n; i++) {
+            ltPackNormal(mesh->normals[i], &b[i * 4]);
+        }
+        ok = ok && write_padded(f, &b[0], n * 4);
+    }
+    if (h.flags & LT_MESHFILE_SHORT_UVS) {
+        std::vector<LTtexcoord> tc(n * 2);
+        for (int i = 0; i < n; i++) {
+            tc[i * 2] = ltPackTexCoord(mesh->uvs[i].u);
+            tc[i * 2 + 1] = ltPackTexCoord(mesh->uvs[i].v);
+        }
+        ok = ok && write_padded(f, &tc[0], n * 2 * sizeof(LTtexcoord));
+    } else if (h.flags & LT_MESHFILE_UVS) {
+        ok = ok && write_padded(f, mesh->uvs, n * sizeof(LTTexCoord));
+    }
+    if (mesh->num_indices > 0) {
+        if (h.flags & LT_MESHFILE_SHORT_INDICES) {
+            std::vector<LTvertindex> indices(mesh->indices, mesh->indices + mesh->num_indices);
+            ok = ok && write_padded(f, &indices[0], mesh->num_indices * sizeof(LTvertindex));
+        } else {
+            ok = ok && write_padded(f, mesh->indices, mesh->num_indices * sizeof(LTvertindex32));
+        }
+    }
+
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        ltLog("Error writing %s", filename);
+    }
+    return ok;
+}
+
+/************************* Vertex cache optimisation **************************/
+
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation".  Triangles
+// are added greedily, picking the one whose vertices score highest.
+// Vertices score higher the more recently they were used (they're
+// likely still in the cache) and the fewer unadded triangles they
+// have left (so they don't linger).
+
+#define SIM_CACHE_SIZE 32
+
+static LTfloat vertex_score(int cache_pos, int remaining) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+    LTfloat score = 0.0f;
+    if (cache_pos >= 0) {
+        if (cache_pos < 3) {
+            // The last triangle's vertices score lower, to avoid
+            // strips, which tend to use the cache poorly.
+            score = 0.75f;
+        } else {
+            LTfloat s = 1.0f - (LTfloat)(cache_pos - 3) / (LTfloat)(SIM_CACHE_SIZE - 3);
+            score = powf(s, 1.5f);
+        }
+    }
+    return score + 2.0f * powf((LTfloat)remaining, -0.5f);
+}
+
+static void optimize_triangle_order(LTvertindex32 *indices, int num_indices, int num_vertices) {
+    int num_tris = num_indices / 3;
+    if (num_tris == 0) {
+        return;
+    }
+
+    // Triangles using each vertex.  The first remaining[v] entries of
+    // v's list are the unadded ones.
+    std::vector<int> remaining(num_vertices, 0);
+    std::vector<int> offsets(num_vertices + 1, 0);
+    for (int i = 0; i < num_tris * 3; i++) {
+        remaining[indices[i]]++;
+    }
+    for (int v = 0; v < num_vertices; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<int> tri_lists(num_tris * 3);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < num_tris * 3; i++) {
+        tri_lists[fill[indices[i]]++] = i / 3;
+    }
+
+    std::vector<int> cache_pos(num_vertices, -1);
+    std::vector<LTfloat> vscore(num_vertices);
+    for (int v = 0; v < num_vertices; v++) {
+        vscore[v] = vertex_score(-1, remaining[v]);
+    }
+    std::vector<LTfloat> tscore(num_tris);
+    std::vector<bool> added(num_tris, false);
+    int best = 0;
+    for (int t = 0; t < num_tris; t++) {
+        tscore[t] = vscore[indices[t * 3]] + vscore[indices[t * 3 + 1]] + vscore[indices[t * 3 + 2]];
+        if (tscore[t] > tscore[best]) {
+            best = t;
+        }
+    }
+
+    std::vector<LTvertindex32> out;
+    out.reserve(num_tris * 3);
+    int cache[SIM_CACHE_SIZE + 3];
+    int cache_count = 0;
+    int cursor = 0;
+    for (int i = 0; i < num_tris; i++) {
+        if (best < 0) {
+            // Nothing in the cache has triangles left.  Start again
+            // from the next unadded triangle.
+            while (added[cursor]) {
+                cursor++;
+            }
+            best = cursor;
+        }
+        int t = best;
+        added[t] = true;
+        int new_cache[SIM_CACHE_SIZE + 3];
+        int new_count = 0;
+        for (int j = 0; j < 3; j++) {
+            int v = indices[t * 3 + j];
+            out.push_back(v);
+            // Remove t from v's unadded triangles.
+            int *list = &tri_lists[offsets[v]];
+            for (int k = 0; k < remaining[v]; k++) {
+                if (list[k] == t) {
+                    list[k] = list[remaining[v] - 1];
+                    list[remaining[v] - 1] = t;
+                    remaining[v]--;
+                    break;
+                }
+            }
+            bool dup = false;
+            for (int k = 0; k < new_count; k++) {
+                if (new_cache[k] == v) dup = true;
+            }
+            if (!dup) {
+                new_cache[new_count++] = v;
+            }
+        }
+        // The triangle's vertices move to the front of the cache.
+        for (int j = 0; j < cache_count; j++) {
+            int v = cache[j];
+            if (v != new_cache[0] && (new_count < 2 || v != new_cache[1])
+                && (new_count < 3 || v != new_cache[2]))
+            {
+                new_cache[new_count++] = v;
+            }
+        }
+        for (int j = 0; j < new_count; j++) {
+            int v = new_cache[j];
+            cache_pos[v] = j < SIM_CACHE_SIZE ? j : -1;
+            vscore[v] = vertex_score(cache_pos[v], remaining[v]);
+        }
+        // Rescore triangles touching the cache.
+        best = -1;
+        LTfloat best_score = -1.0f;
+        for (int j = 0; j < new_count; j++) {
+            int v = new_cache[j];
+            int *list = &tri_lists[offsets[v]];
+            for (int k = 0; k < remaining[v]; k++) {
+                int tt = list[k];
+                tscore[tt] = vscore[indices[tt * 3]] + vscore[indices[tt * 3 + 1]]
+                    + vscore[indices[tt * 3 + 2]];
+                if (tscore[tt] > best_score) {
+                    best_score = tscore[tt];
+                    best = tt;
+                }
+            }
+        }
+        cache_count = new_count < SIM_CACHE_SIZE ? new_count : SIM_CACHE_SIZE;
+        memcpy(cache, new_cache, sizeof(int) * cache_count);
+    }
+    memcpy(indices, &out[0], sizeof(LTvertindex32) * out.size());
+}
+
+static void permute(void *arr, int elem_size, std::vector<int> &remap) {
+    if (arr == NULL) {
+        return;
+    }
+    int n = remap.size();
+    char *tmp = (char*)malloc(elem_size * n);
+    for (int v = 0; v < n; v++) {
+        memcpy(tmp + remap[v] * elem_size, (char*)arr + v * elem_size, elem_size);
+    }
+    memcpy(arr, tmp, elem_size * n);
+    free(tmp);
+}
+
+void ltOptimizeVertexCache(LTMesh *mesh) {
+    if (mesh->draw_mode != LT_DRAWMODE_TRIANGLES || mesh->num_indices < 3) {
+        return;
+    }
+    optimize_triangle_order(mesh->indices, mesh->num_indices, mesh->size);
+
+    // Vertices in first-use order, so fetches are mostly sequential.
+    // Unused vertices go at the end.
+    int n = mesh->size;
+    std::vector<int> remap(n, -1);
+    int next = 0;
+    for (int i = 0; i < mesh->num_indices; i++) {
+        LTvertindex32 v = mesh->indices[i];
+        if (remap[v] < 0) {
+            remap[v] = next++;
+        }
+        mesh->indices[i] = remap[v];
+    }
+    for (int v = 0; v < n; v++) {
+        if (remap[v] < 0) {
+            remap[v] = next++;
+        }
+    }
+    permute(mesh->xyzs, sizeof(LTVec3), remap);
+    permute(mesh->colors, 4, remap);
+    permute(mesh->normals, sizeof(LTVec3), remap);
+    permute(mesh->uvs, sizeof(LTTexCoord), remap);
+
+    mesh->vb_dirty = true;
+    mesh->indices_dirty = true;
+}
+
+LTfloat ltVertexCacheMissRatio(LTvertindex32 *indices, int num_indices, int cache_size) {
+    int num_tris = num_indices / 3;
+    if (num_tris == 0) {
+        return 0.0f;
+    }
+    std::vector<LTvertindex32> fifo(cache_size);
+    int head = 0;
+    int count = 0;
+    int misses = 0;
+    for (int i = 0; i < num_tris * 3; i++) {
+        LTvertindex32 v = indices[i];
+        bool hit = false;
+        for (int j = 0; j < count; j++) {
+            if (fifo[j] == v) {
+                hit = true;
+                break;
+            }
+        }
+        if (!hit) {
+            misses++;
+            fifo[head] = v;
+            head = (head + 1) % cache_size;
+            if (count < cache_size) {
+                count++;
+            }
+        }
+    }
+    return (LTfloat)misses / (LTfloat)num_tris;
+}
@@ -0,0 +1,50 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltmeshfile)
+
+// Binary mesh files (.ltm), written offline by tools/objtoltm.
+//
+// The file is a header followed by one array per attribute, in the
+// order positions, colours, normals, uvs, indices, each padded to a
+// multiple of 4 bytes.  Colours are stored packed exactly as LTMesh
+// keeps them, so loading them is a memcpy.  Normals are packed as in
+// the VBO (see ltPackNormal).  Positions are floats, or with
+// LT_MESHFILE_SHORT_POSITIONS unsigned shorts scaled to the bounding
+// box.  Uvs are floats, or with LT_MESHFILE_SHORT_UVS shorts scaled by
+// LT_MAX_TEX_COORD.  Indices are 16 bit with
+// LT_MESHFILE_SHORT_INDICES, otherwise 32 bit.  All values are little
+// endian.
+
+#define LT_MESHFILE_MAGIC "LTM1"
+
+enum {
+    LT_MESHFILE_COLORS          = 1 << 0,
+    LT_MESHFILE_NORMALS         = 1 << 1,
+    LT_MESHFILE_UVS             = 1 << 2,
+    LT_MESHFILE_SHORT_POSITIONS = 1 << 3,
+    LT_MESHFILE_SHORT_UVS       = 1 << 4,
+    LT_MESHFILE_SHORT_INDICES   = 1 << 5,
+};
+
+struct LTMeshFileHeader {
+    char magic[4];
+    LTuint32 flags;
+    LTuint32 dimensions;
+    LTuint32 draw_mode;
+    LTuint32 num_vertices;
+    LTuint32 num_indices;
+    LTfloat left, right, bottom, top, farz, nearz;
+};
+
+bool ltReadMeshFile(const char *filename, LTMesh *mesh);
+
+// Uvs and indices are stored as shorts when they fit.  Positions are
+// only quantised if quantise_positions is set, since it loses precision.
+bool ltWriteMeshFile(const char *filename, LTMesh *mesh, bool quantise_positions);
+
+// Reorders a triangle mesh's triangles for the post-transform vertex
+// cache (Forsyth's algorithm), then its vertices into first-use order.
+void ltOptimizeVertexCache(LTMesh *mesh);
+
+// Average number of vertex cache misses per triangle for a FIFO cache
+// of the given size.
+LTfloat ltVertexCacheMissRatio(LTvertindex32 *indices, int num_indices, int cache_size);
@@ -0,0 +1,439 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+#include <stdarg.h>
+
+LT_INIT_IMPL(ltnullgl)
+
+static LTNullGLStats stats = {0, 0, 0, 0, 0, 0, 0};
+static FILE *log_file = NULL;
+
+static bool capturing = false;
+static std::map<GLuint, std::vector<char> > buffer_data;
+static int last_draw_count = 0;
+static int last_draw_sizes[3] = {0, 0, 0};
+static std::vector<LTfloat> last_draw_data[3];
+
+void ltNullGLGetStats(LTNullGLStats *s) {
+    *s = stats;
+}
+
+void ltNullGLResetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void ltNullGLSetLog(FILE *f) {
+    log_file = f;
+}
+
+void ltNullGLSetCapture(bool capture) {
+    capturing = capture;
+    if (!capturing) {
+        buffer_data.clear();
+    }
+}
+
+void ltNullGLGetLastDraw(LTNullGLDraw *draw) {
+    draw->count = last_draw_count;
+    draw->vertex_size = last_draw_sizes[0];
+    draw->color_size = last_draw_sizes[1];
+    draw->tex_coord_size = last_draw_sizes[2];
+    draw->vertices = last_draw_data[0].empty() ? NULL : &last_draw_data[0][0];
+    draw->colors = last_draw_data[1].empty() ? NULL : &last_draw_data[1][0];
+    draw->tex_coords = last_draw_data[2].empty() ? NULL : &last_draw_data[2][0];
+}
+
+#ifdef LTNULLGL
+
+enum CallKind {
+    STATE,
+    DRAW,
+    QUERY,  // Gets and gens.
+};
+
+static GLuint next_name = 1;
+
+struct NullGLArray {
+    bool enabled;
+    GLint size;
+    GLenum type;
+    GLsizei stride;
+    const GLvoid *pointer;
+    GLuint buffer; // Bound when the pointer was set.
+};
+
+static NullGLArray vertex_array = {false, 0, 0, 0, NULL, 0};
+static NullGLArray color_array = {false, 0, 0, 0, NULL, 0};
+static NullGLArray tex_coord_array = {false, 0, 0, 0, NULL, 0};
+static GLuint array_buffer = 0;
+
+// Copies count vertices of a into out and returns the number of
+// components per vertex (see LTNullGLDraw).
+static int capture_array(NullGLArray *a, int first, int count, std::vector<LTfloat> *out) {
+    out->clear();
+    if (!a->enabled) {
+        return 0;
+    }
+    if (a->type != GL_FLOAT) {
+        return -1;
+    }
+    int stride = a->stride != 0 ? a->stride : a->size * sizeof(LTfloat);
+    const char *base = (const char*)a->pointer;
+    if (a->buffer != 0) {
+        std::vector<char> &data = buffer_data[a->buffer];
+        LTuintptr offset = (LTuintptr)a->pointer;
+        if (count > 0 && offset + (LTuintptr)(first + count - 1) * stride + a->size * sizeof(LTfloat) > data.size()) {
+            return -1;
+        }
+        base = data.empty() ? NULL : &data[0] + offset;
+    }
+    out->resize(count * a->size);
+    for (int i = 0; i < count; i++) {
+        memcpy(&(*out)[i * a->size], base + (first + i) * stride, a->size * sizeof(LTfloat));
+    }
+    return a->size;
+}
+
+static NullGLArray *client_array(GLenum array) {
+    switch (array) {
+        case GL_VERTEX_ARRAY: return &vertex_array;
+        case GL_COLOR_ARRAY: return &color_array;
+        case GL_TEXTURE_COORD_ARRAY: return &tex_coord_array;
+    }
+    return NULL;
+}
+
+static void set_pointer(NullGLArray *a, GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
+    a->size = size;
+    a->type = type;
+    a->stride = stride;
+    a->pointer = pointer;
+    a->buffer = array_buffer;
+}
+
+static void record(CallKind kind, const char *name, const char *fmt, ...) {
+    stats.calls++;
+    if (kind == STATE) {
+        stats.state_changes++;
+    } else if (kind == DRAW) {
+        stats.draw_calls++;
+    }
+    if (log_file != NULL) {
+        fprintf(log_file, "%s(", name);
+        va_list args;
+        va_start(args, fmt);
+        vfprintf(log_file, fmt, args);
+        va_end(args);
+        fprintf(log_file, ")\n");
+    }
+}
+
+static void gen_names(GLsizei n, GLuint *names) {
+    for (int i = 0; i < n; i++) {
+        names[i] = next_name++;
+    }
+}
+
+void ltNullGLEnable(GLenum cap) {
+    record(STATE, "glEnable", "0x%x", cap);
+}
+
+void ltNullGLDisable(GLenum cap) {
+    record(STATE, "glDisable", "0x%x", cap);
+}
+
+void ltNullGLEnableClientState(GLenum array) {
+    NullGLArray *a = client_array(array);
+    if (a != NULL) {
+        a->enabled = true;
+    }
+    record(STATE, "glEnableClientState", "0x%x", array);
+}
+
+void ltNullGLDisableClientState(GLenum array) {
+    NullGLArray *a = client_array(array);
+    if (a != NULL) {
+        a->enabled = false;
+    }
+    record(STATE, "glDisableClientState", "0x%x", array);
+}
+
+void ltNullGLBlendEquation(GLenum mode) {
+    record(STATE, "glBlendEquation", "0x%x", mode);
+}
+
+void ltNullGLBlendFunc(GLenum sfactor, GLenum dfactor) {
+    record(STATE, "glBlendFunc", "0x%x, 0x%x", sfactor, dfactor);
+}
+
+void ltNullGLTexParameteri(GLenum target, GLenum pname, GLint param) {
+    record(STATE, "glTexParameteri", "0x%x, 0x%x, 0x%x", target, pname, param);
+}
+
+void ltNullGLTexEnvi(GLenum target, GLenum pname, GLint param) {
+    record(STATE, "glTexEnvi", "0x%x, 0x%x, 0x%x", target, pname, param);
+}
+
+void ltNullGLMaterialf(GLenum face, GLenum pname, GLfloat param) {
+    record(STATE, "glMaterialf", "0x%x, 0x%x, %g", face, pname, param);
+}
+
+void ltNullGLMaterialfv(GLenum face, GLenum pname, const GLfloat *params) {
+    record(STATE, "glMaterialfv", "0x%x, 0x%x, {%g, %g, %g, %g}", face, pname,
+        params[0], params[1], params[2], params[3]);
+}
+
+void ltNullGLLightf(GLenum light, GLenum pname, GLfloat param) {
+    record(STATE, "glLightf", "0x%x, 0x%x, %g", light, pname, param);
+}
+
+void ltNullGLLightfv(GLenum light, GLenum pname, const GLfloat *params) {
+    record(STATE, "glLightfv", "0x%x, 0x%x, {%g, %g, %g, %g}", light, pname,
+        params[0], params[1], params[2], params[3]);
+}
+
+void ltNullGLFogf(GLenum pname, GLfloat param) {
+    record(STATE, "glFogf", "0x%x, %g", pname, param);
+}
+
+void ltNullGLFogfv(GLenum pname, const GLfloat *params) {
+    // Only used for GL_FOG_COLOR.
+    record(STATE, "glFogfv", "0x%x, {%g, %g, %g, %g}", pname,
+        params[0], params[1], params[2], params[3]);
+}
+
+void ltNullGLDepthMask(GLboolean flag) {
+    record(STATE, "glDepthMask", "%d", flag);
+}
+
+void ltNullGLDepthFunc(GLenum func) {
+    record(STATE, "glDepthFunc", "0x%x", func);
+}
+
+void ltNullGLColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) {
+    record(STATE, "glColorMask", "%d, %d, %d, %d", r, g, b, a);
+}
+
+void ltNullGLCullFace(GLenum mode) {
+    record(STATE, "glCullFace", "0x%x", mode);
+}
+
+void ltNullGLFrontFace(GLenum mode) {
+    record(STATE, "glFrontFace", "0x%x", mode);
+}
+
+void ltNullGLColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    record(STATE, "glColor4f", "%g, %g, %g, %g", r, g, b, a);
+}
+
+void ltNullGLClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    record(STATE, "glClearColor", "%g, %g, %g, %g", r, g, b, a);
+}
+
+void ltNullGLClear(GLbitfield mask) {
+    record(DRAW, "glClear", "0x%x", mask);
+}
+
+void ltNullGLViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    record(STATE, "glViewport", "%d, %d, %d, %d", x, y, width, height);
+}
+
+void ltNullGLMatrixMode(GLenum mode) {
+    record(STATE, "glMatrixMode", "0x%x", mode);
+}
+
+void ltNullGLPushMatrix() {
+    record(STATE, "glPushMatrix", "");
+}
+
+void ltNullGLPopMatrix() {
+    record(STATE, "glPopMatrix", "");
+}
+
+void ltNullGLLoadIdentity() {
+    record(STATE, "glLoadIdentity", "");
+}
+
+void ltNullGLMultMatrixf(const GLfloat *m) {
+    record(STATE, "glMultMatrixf", "{%g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g}",
+        m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+        m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+}
+
+void ltNullGLLoadMatrixf(const GLfloat *m) {
+    record(STATE, "glLoadMatrixf", "{%g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g}",
+        m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+        m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+}
+
+void ltNullGLOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble nearz, GLdouble farz) {
+    record(STATE, "glOrtho", "%g, %g, %g, %g, %g, %g", left, right, bottom, top, nearz, farz);
+}
+
+void ltNullGLFrustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble nearz, GLdouble farz) {
+    record(STATE, "glFrustum", "%g, %g, %g, %g, %g, %g", left, right, bottom, top, nearz, farz);
+}
+
+void ltNullGLRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
+    record(STATE, "glRotatef", "%g, %g, %g, %g", angle, x, y, z);
+}
+
+void ltNullGLScalef(GLfloat x, GLfloat y, GLfloat z) {
+    record(STATE, "glScalef", "%g, %g, %g", x, y, z);
+}
+
+void ltNullGLTranslatef(GLfloat x, GLfloat y, GLfloat z) {
+    record(STATE, "glTranslatef", "%g, %g, %g", x, y, z);
+}
+
+void ltNullGLGenTextures(GLsizei n, GLuint *textures) {
+    gen_names(n, textures);
+    record(QUERY, "glGenTextures", "%d -> %u", n, textures[0]);
+}
+
+void ltNullGLDeleteTextures(GLsizei n, const GLuint *textures) {
+    record(STATE, "glDeleteTextures", "%d, %u", n, textures[0]);
+}
+
+void ltNullGLBindTexture(GLenum target, GLuint texture) {
+    record(STATE, "glBindTexture", "0x%x, %u", target, texture);
+}
+
+void ltNullGLTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+    GLint border, GLenum format, GLenum type, const GLvoid *pixels)
+{
+    switch (type) {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            stats.texture_bytes += width * height * 2;
+            break;
+        default:
+            stats.texture_bytes += width * height * 4;
+            break;
+    }
+    record(STATE, "glTexImage2D", "0x%x, %d, 0x%x, %d, %d, %d, 0x%x, 0x%x, %p",
+        target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+void ltNullGLGenBuffers(GLsizei n, GLuint *buffers) {
+    gen_names(n, buffers);
+    record(QUERY, "glGenBuffers", "%d -> %u", n, buffers[0]);
+}
+
+void ltNullGLDeleteBuffers(GLsizei n, const GLuint *buffers) {
+    for (int i = 0; i < n; i++) {
+        buffer_data.erase(buffers[i]);
+        if (buffers[i] == array_buffer) {
+            array_buffer = 0;
+        }
+    }
+    record(STATE, "glDeleteBuffers", "%d, %u", n, buffers[0]);
+}
+
+void ltNullGLBindBuffer(GLenum target, GLuint buffer) {
+    if (target == GL_ARRAY_BUFFER) {
+        array_buffer = buffer;
+    }
+    record(STATE, "glBindBuffer", "0x%x, %u", target, buffer);
+}
+
+void ltNullGLBufferData(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage) {
+    stats.buffer_bytes += size;
+    stats.buffer_uploads++;
+    if (capturing && target == GL_ARRAY_BUFFER && array_buffer != 0) {
+        std::vector<char> &d = buffer_data[array_buffer];
+        d.resize(size);
+        if (data != NULL && size > 0) {
+            memcpy(&d[0], data, size);
+        }
+    }
+    record(STATE, "glBufferData", "0x%x, %d, %p, 0x%x", target, (int)size, data, usage);
+}
+
+void ltNullGLBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data) {
+    stats.buffer_bytes += size;
+    stats.buffer_uploads++;
+    if (capturing && target == GL_ARRAY_BUFFER && array_buffer != 0) {
+        std::vector<char> &d = buffer_data[array_buffer];
+        if ((GLsizeiptr)d.size() >= offset + size && size > 0) {
+            memcpy(&d[offset], data, size);
+        }
+    }
+    record(STATE, "glBufferSubData", "0x%x, %d, %d, %p", target, (int)offset, (int)size, data);
+}
+
+void ltNullGLVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
+    set_pointer(&vertex_array, size, type, stride, pointer);
+    record(STATE, "glVertexPointer", "%d, 0x%x, %d, %p", size, type, stride, pointer);
+}
+
+void ltNullGLColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
+    set_pointer(&color_array, size, type, stride, pointer);
+    record(STATE, "glColorPointer", "%d, 0x%x, %d, %p", size, type, stride, pointer);
+}
+
+void ltNullGLNormalPointer(GLenum type, GLsizei stride, const GLvoid *pointer) {
+    record(STATE, "glNormalPointer", "0x%x, %d, %p", type, stride, pointer);
+}
+
+void ltNullGLTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {
+    set_pointer(&tex_coord_array, size, type, stride, pointer);
+    record(STATE, "glTexCoordPointer", "%d, 0x%x, %d, %p", size, type, stride, pointer);
+}
+
+void ltNullGLDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    stats.vertices += count;
+    if (capturing) {
+        last_draw_count = count;
+        last_draw_sizes[0] = capture_array(&vertex_array, first, count, &last_draw_data[0]);
+        last_draw_sizes[1] = capture_array(&color_array, first, count, &last_draw_data[1]);
+        last_draw_sizes[2] = capture_array(&tex_coord_array, first, count, &last_draw_data[2]);
+    }
+    record(DRAW, "glDrawArrays", "0x%x, %d, %d", mode, first, count);
+}
+
+void ltNullGLDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices) {
+    stats.vertices += count;
+    record(DRAW, "glDrawElements", "0x%x, %d, 0x%x, %p", mode, count, type, indices);
+}
+
+void ltNullGLGenFramebuffers(GLsizei n, GLuint *framebuffers) {
+    gen_names(n, framebuffers);
+    record(QUERY, "glGenFramebuffers", "%d -> %u", n, framebuffers[0]);
+}
+
+void ltNullGLDeleteFramebuffers(GLsizei n, const GLuint *framebuffers) {
+    record(STATE, "glDeleteFramebuffers", "%d, %u", n, framebuffers[0]);
+}
+
+void ltNullGLBindFramebuffer(GLenum target, GLuint framebuffer) {
+    record(STATE, "glBindFramebuffer", "0x%x, %u", target, framebuffer);
+}
+
+void ltNullGLFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) {
+    record(STATE, "glFramebufferTexture2D", "0x%x, 0x%x, 0x%x, %u, %d",
+        target, attachment, textarget, texture, level);
+}
+
+GLenum ltNullGLCheckFramebufferStatus(GLenum target) {
+    record(QUERY, "glCheckFramebufferStatus", "0x%x", target);
+    return GL_FRAMEBUFFER_COMPLETE_EXT;
+}
+
+const GLubyte *ltNullGLGetString(GLenum name) {
+    record(QUERY, "glGetString", "0x%x", name);
+    switch (name) {
+        case GL_VENDOR: return (const GLubyte*)"lotech";
+        case GL_RENDERER: return (const GLubyte*)"null";
+        case GL_VERSION: return (const GLubyte*)"2.1 null";
+        case GL_EXTENSIONS: return (const GLubyte*)"GL_ARB_texture_non_power_of_two";
+    }
+    return NULL;
+}
+
+GLenum ltNullGLGetError() {
+    record(QUERY, "glGetError", "");
+    return GL_NO_ERROR;
+}
+
+#endif
@@ -0,0 +1,232 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltnullgl)
+
+// A stand-in for OpenGL that records calls instead of rendering, so
+// games can run without a GPU or display (see clients/headless).  When
+// liblt is built with LTNULLGL the GL functions used by ltopengl.cpp
+// are redirected to the functions below, which count (and optionally
+// log) each call.  Everything above the GL calls, including the state
+// caching in ltopengl.cpp, runs as normal.  Generated names count up
+// from 1 and glCheckFramebufferStatus always reports complete.
+
+struct LTNullGLStats {
+    int calls;
+    int draw_calls;
+    int vertices;       // Vertices (or indices) drawn.
+    int state_changes;  // Calls other than draws, gets and gens.
+    int buffer_bytes;   // Uploaded to vertex buffers.
+    int buffer_uploads; // glBufferData and glBufferSubData calls.
+    int texture_bytes;  // Uploaded to textures.
+};
+
+void ltNullGLGetStats(LTNullGLStats *stats);
+void ltNullGLResetStats();
+
+// Writes each call and its arguments to f.  NULL stops logging.
+void ltNullGLSetLog(FILE *f);
+
+// While capturing, vertex buffer data is kept and each glDrawArrays
+// copies out the float arrays it would read, whether they come from
+// client memory or a buffer, so tests can check what was drawn.
+struct LTNullGLDraw {
+    int count;
+    // Components per vertex, 0 if the array is disabled or -1 if it
+    // isn't float data or reads past the end of its buffer.
+    int vertex_size;
+    int color_size;
+    int tex_coord_size;
+    const LTfloat *vertices;
+    const LTfloat *colors;
+    const LTfloat *tex_coords;
+};
+
+void ltNullGLSetCapture(bool capture);
+// The last draw captured.  Valid until the next draw.
+void ltNullGLGetLastDraw(LTNullGLDraw *draw);
+
+#ifdef LTNULLGL
+
+#ifdef LTGLES1
+#error LTNULLGL is only supported for desktop GL builds
+#endif
+
+void ltNullGLEnable(GLenum cap);
+void ltNullGLDisable(GLenum cap);
+void ltNullGLEnableClientState(GLenum array);
+void ltNullGLDisableClientState(GLenum array);
+void ltNullGLBlendEquation(GLenum mode);
+void ltNullGLBlendFunc(GLenum sfactor, GLenum dfactor);
+void ltNullGLTexParameteri(GLenum target, GLenum pname, GLint param);
+void ltNullGLTexEnvi(GLenum target, GLenum pname, GLint param);
+void ltNullGLMaterialf(GLenum face, GLenum pname, GLfloat param);
+void ltNullGLMaterialfv(GLenum face, GLenum pname, const GLfloat *params);
+void ltNullGLLightf(GLenum light, GLenum pname, GLfloat param);
+void ltNullGLLightfv(GLenum light, GLenum pname, const GLfloat *params);
+void ltNullGLFogf(GLenum pname, GLfloat param);
+void ltNullGLFogfv(GLenum pname, const GLfloat *params);
+void ltNullGLDepthMask(GLboolean flag);
+void ltNullGLDepthFunc(GLenum func);
+void ltNullGLColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+void ltNullGLCullFace(GLenum mode);
+void ltNullGLFrontFace(GLenum mode);
+void ltNullGLColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+void ltNullGLClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+void ltNullGLClear(GLbitfield mask);
+void ltNullGLViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+void ltNullGLMatrixMode(GLenum mode);
+void ltNullGLPushMatrix();
+void ltNullGLPopMatrix();
+void ltNullGLLoadIdentity();
+void ltNullGLMultMatrixf(const GLfloat *m);
+void ltNullGLLoadMatrixf(const GLfloat *m);
+void ltNullGLOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble nearz, GLdouble farz);
+void ltNullGLFrustum(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble nearz, GLdouble farz);
+void ltNullGLRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z);
+void ltNullGLScalef(GLfloat x, GLfloat y, GLfloat z);
+void ltNullGLTranslatef(GLfloat x, GLfloat y, GLfloat z);
+
+void ltNullGLGenTextures(GLsizei n, GLuint *textures);
+void ltNullGLDeleteTextures(GLsizei n, const GLuint *textures);
+void ltNullGLBindTexture(GLenum target, GLuint texture);
+void ltNullGLTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+    GLint border, GLenum format, GLenum type, const GLvoid *pixels);
+
+void ltNullGLGenBuffers(GLsizei n, GLuint *buffers);
+void ltNullGLDeleteBuffers(GLsizei n, const GLuint *buffers);
+void ltNullGLBindBuffer(GLenum target, GLuint buffer);
+void ltNullGLBufferData(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage);
+void ltNullGLBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data);
+
+void ltNullGLVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer);
+void ltNullGLColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer);
+void ltNullGLNormalPointer(GLenum type, GLsizei stride, const GLvoid *pointer);
+void ltNullGLTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer);
+void ltNullGLDrawArrays(GLenum mode, GLint first, GLsizei count);
+void ltNullGLDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices);
+
+void ltNullGLGenFramebuffers(GLsizei n, GLuint *framebuffers);
+void ltNullGLDeleteFramebuffers(GLsizei n, const GLuint *framebuffers);
+void ltNullGLBindFramebuffer(GLenum target, GLuint framebuffer);
+void ltNullGLFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+GLenum ltNullGLCheckFramebufferStatus(GLenum target);
+
+const GLubyte *ltNullGLGetString(GLenum name);
+GLenum ltNullGLGetError();
+
+// Some of these are GLEW macros, so undefine them first.
+#undef glEnable
+#undef glDisable
+#undef glEnableClientState
+#undef glDisableClientState
+#undef glBlendEquation
+#undef glBlendFunc
+#undef glTexParameteri
+#undef glTexEnvi
+#undef glMaterialf
+#undef glMaterialfv
+#undef glLightf
+#undef glLightfv
+#undef glFogf
+#undef glFogfv
+#undef glDepthMask
+#undef glDepthFunc
+#undef glColorMask
+#undef glCullFace
+#undef glFrontFace
+#undef glColor4f
+#undef glClearColor
+#undef glClear
+#undef glViewport
+#undef glMatrixMode
+#undef glPushMatrix
+#undef glPopMatrix
+#undef glLoadIdentity
+#undef glMultMatrixf
+#undef glLoadMatrixf
+#undef glOrtho
+#undef glFrustum
+#undef glRotatef
+#undef glScalef
+#undef glTranslatef
+#undef glGenTextures
+#undef glDeleteTextures
+#undef glBindTexture
+#undef glTexImage2D
+#undef glGenBuffers
+#undef glDeleteBuffers
+#undef glBindBuffer
+#undef glBufferData
+#undef glBufferSubData
+#undef glVertexPointer
+#undef glColorPointer
+#undef glNormalPointer
+#undef glTexCoordPointer
+#undef glDrawArrays
+#undef glDrawElements
+#undef glGenFramebuffersEXT
+#undef glDeleteFramebuffersEXT
+#undef glBindFramebufferEXT
+#undef glFramebufferTexture2DEXT
+#undef glCheckFramebufferStatusEXT
+#undef glGetString
+#undef glGetError
+
+#define glEnable                    ltNullGLEnable
+#define glDisable                   ltNullGLDisable
+#define glEnableClientState         ltNullGLEnableClientState
+#define glDisableClientState        ltNullGLDisableClientState
+#define glBlendEquation             ltNullGLBlendEquation
+#define glBlendFunc                 ltNullGLBlendFunc
+#define glTexParameteri             ltNullGLTexParameteri
+#define glTexEnvi                   ltNullGLTexEnvi
+#define glMaterialf                 ltNullGLMaterialf
+#define glMaterialfv                ltNullGLMaterialfv
+#define glLightf                    ltNullGLLightf
+#define glLightfv                   ltNullGLLightfv
+#define glFogf                      ltNullGLFogf
+#define glFogfv                     ltNullGLFogfv
+#define glDepthMask                 ltNullGLDepthMask
+#define glDepthFunc                 ltNullGLDepthFunc
+#define glColorMask                 ltNullGLColorMask
+#define glCullFace                  ltNullGLCullFace
+#define glFrontFace                 ltNullGLFrontFace
+#define glColor4f                   ltNullGLColor4f
+#define glClearColor                ltNullGLClearColor
+#define glClear                     ltNullGLClear
+#define glViewport                  ltNullGLViewport
+#define glMatrixMode                ltNullGLMatrixMode
+#define glPushMatrix                ltNullGLPushMatrix
+#define glPopMatrix                 ltNullGLPopMatrix
+#define glLoadIdentity              ltNullGLLoadIdentity
+#define glMultMatrixf               ltNullGLMultMatrixf
+#define glLoadMatrixf               ltNullGLLoadMatrixf
+#define glOrtho                     ltNullGLOrtho
+#define glFrustum                   ltNullGLFrustum
+#define glRotatef                   ltNullGLRotatef
+#define glScalef                    ltNullGLScalef
+#define glTranslatef                ltNullGLTranslatef
+#define glGenTextures               ltNullGLGenTextures
+#define glDeleteTextures            ltNullGLDeleteTextures
+#define glBindTexture               ltNullGLBindTexture
+#define glTexImage2D                ltNullGLTexImage2D
+#define glGenBuffers                ltNullGLGenBuffers
+#define glDeleteBuffers             ltNullGLDeleteBuffers
+#define glBindBuffer                ltNullGLBindBuffer
+#define glBufferData                ltNullGLBufferData
+#define glBufferSubData             ltNullGLBufferSubData
+#define glVertexPointer             ltNullGLVertexPointer
+#define glColorPointer              ltNullGLColorPointer
+#define glNormalPointer             ltNullGLNormalPointer
+#define glTexCoordPointer           ltNullGLTexCoordPointer
+#define glDrawArrays                ltNullGLDrawArrays
+#define glDrawElements              ltNullGLDrawElements
+#define glGenFramebuffersEXT        ltNullGLGenFramebuffers
+#define glDeleteFramebuffersEXT     ltNullGLDeleteFramebuffers
+#define glBindFramebufferEXT        ltNullGLBindFramebuffer
+#define glFramebufferTexture2DEXT   ltNullGLFramebufferTexture2D
+#define glCheckFramebufferStatusEXT ltNullGLCheckFramebufferStatus
+#define glGetString                 ltNullGLGetString
+#define glGetError                  ltNullGLGetError
+
+#endif
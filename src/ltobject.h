@@ -10,6 +10,9 @@ struct LTObject {
     // This is called after a new object is constructed using
     // the default constructor function.
     virtual void init(lua_State *L) {};
+
+    // Called after a field is set from Lua or tweened.
+    virtual void changed() {};
 };
 
 LTObject *lt_expect_LTObject(lua_State *L, int arg);
@@ -10,7 +10,7 @@ LT_INIT_IMPL(ltopengl)
 #define glBlendEquation glBlendEquationOES
 #else
 // XXX glBlendEquation not available in Tizen (and I suspect some android devices too).
-#define glBlendEquation(arg) 
+#define glBlendEquation(arg)
 #endif
 #ifndef GL_FUNC_ADD
 #define GL_FUNC_ADD GL_FUNC_ADD_OES
@@ -41,21 +41,45 @@ static void set_state_str();
 #define gltrace
 #endif
 
-#define LTGLCHECK
+// glGetError can stall the pipeline, so by default errors are only
+// checked once per frame, and only if ltSetGLErrorChecking(true) has
+// been called.  Define LTGLCHECK to check after every call instead.
+//#define LTGLCHECK
 #ifdef LTGLCHECK
-#define check_for_errors if (glGetError() != GL_NO_ERROR) \
-    {ltLog("OpenGL error at %s:%d %s", __FILE__, __LINE__, __func__); }
+#define check_for_errors ltCheckGLErrors(__func__);
 #else
 #define check_for_errors
 #endif
 
+// Every GL call is followed by issued.  Requests for state GL is already
+// in are dropped and counted by filtered instead.
+#define issued lt_gl_counters.issued_calls++; check_for_errors
+#define filtered lt_gl_counters.filtered_calls++;
+
+// GL guarantees at least this many lights.
+#define MAX_LIGHTS 8
+
+// GL only guarantees 2 for the projection and texture stacks.
+#define MATRIX_STACK_DEPTH 32
+
+// Cached enums and floats hold these until their state is first set.
+#define UNKNOWN_ENUM ((GLenum)-1)
+static const LTuint32 unknown_float_bits = 0x7FC0DEAD; // A NaN.
+
+static bool gl_error_checking = false;
+
 // State
 static bool texturing;
 static bool texture_coord_arrays;
 static LTBlendMode blend_mode;
+static bool blend;
+static GLenum blend_equation;
+static GLenum blend_src;
+static GLenum blend_dst;
 static LTTextureMode texture_mode;
 static bool depth_test;
 static bool depth_mask;
+static GLenum depth_func;
 static bool dither;
 static bool alpha_test;
 static bool stencil_test;
@@ -64,24 +88,173 @@ static bool index_arrays;
 static bool color_arrays;
 static bool normal_arrays;
 static bool fog;
+static GLfloat fog_color[4];
+static GLfloat fog_start;
+static GLfloat fog_end;
+static GLfloat fog_mode;
 static bool lighting;
+static bool cull_face_enabled;
+static GLenum cull_face;
+static GLenum matrix_mode;
+static bool color_mask[4];
+static GLfloat clear_color[4];
+static GLfloat current_color[4];
+static GLint viewport[4];
 static LTtexid bound_texture;
 static LTframebuf bound_framebuffer;
 static LTvertbuf bound_vertbuffer;
+static bool uint_indices_supported;
+static bool npot_textures_supported;
+
+struct LightState {
+    bool enabled;
+    GLfloat ambient[4];
+    GLfloat diffuse[4];
+    GLfloat specular[4];
+    GLfloat attenuation[3]; // constant, linear, quadratic
+};
+static LightState lights[MAX_LIGHTS];
+
+struct MaterialState {
+    GLfloat shininess;
+    GLfloat ambient[4];
+    GLfloat diffuse[4];
+    GLfloat specular[4];
+    GLfloat emission[4];
+};
+static MaterialState material;
+
+// The arguments of the last gl*Pointer call for one client array.  The
+// buffer bound at the time is part of the array state.
+struct ArrayPointer {
+    bool valid;
+    LTvertbuf buffer;
+    int size;
+    LTVertDataType type;
+    int stride;
+    void *data;
+};
+static ArrayPointer vertex_pointer;
+static ArrayPointer color_pointer;
+static ArrayPointer normal_pointer;
+static ArrayPointer tex_coord_pointer;
+
+// Copies of the GL matrix stacks, so ltGetMatrix doesn't need glGet.
+struct MatrixStack {
+    int top;
+    LTfloat m[MATRIX_STACK_DEPTH][16];
+};
+static MatrixStack matrix_stacks[3];
+
+#ifndef GL_UNSIGNED_INT
+#define GL_UNSIGNED_INT 0x1405
+#endif
+
+static void forget_floats(GLfloat *cache, int n) {
+    for (int i = 0; i < n; i++) {
+        memcpy(&cache[i], &unknown_float_bits, sizeof(GLfloat));
+    }
+}
+
+// Returns true if cache already holds the n values in v, otherwise
+// copies them into cache and returns false.
+static bool same_floats(GLfloat *cache, const GLfloat *v, int n) {
+    if (memcmp(cache, v, n * sizeof(GLfloat)) == 0) {
+        return true;
+    }
+    memcpy(cache, v, n * sizeof(GLfloat));
+    return false;
+}
+
+static MatrixStack *matrix_stack(GLenum mode) {
+    switch (mode) {
+        case GL_PROJECTION: return &matrix_stacks[1];
+        case GL_TEXTURE: return &matrix_stacks[2];
+        default: return &matrix_stacks[0];
+    }
+}
+
+static LTfloat *current_matrix() {
+    MatrixStack *stack = matrix_stack(matrix_mode);
+    return stack->m[stack->top];
+}
+
+// As same_floats, for the arguments of a gl*Pointer call.
+static bool same_pointer(ArrayPointer *p, int size, LTVertDataType type, int stride, void *data) {
+    if (p->valid && p->buffer == bound_vertbuffer && p->size == size
+        && p->type == type && p->stride == stride && p->data == data)
+    {
+        return true;
+    }
+    p->valid = true;
+    p->buffer = bound_vertbuffer;
+    p->size = size;
+    p->type = type;
+    p->stride = stride;
+    p->data = data;
+    return false;
+}
+
+static void set_cap(bool *cached, GLenum cap, bool enable) {
+    if (*cached != enable) {
+        if (enable) {
+            glEnable(cap);
+        } else {
+            glDisable(cap);
+        }
+        lt_gl_counters.state_changes++;
+        issued
+        *cached = enable;
+    } else {
+        filtered
+    }
+}
+
+static void set_client_state(bool *cached, GLenum array, bool enable) {
+    if (*cached != enable) {
+        if (enable) {
+            glEnableClientState(array);
+        } else {
+            glDisableClientState(array);
+        }
+        lt_gl_counters.state_changes++;
+        issued
+        *cached = enable;
+    } else {
+        filtered
+    }
+}
 
 void ltInitGLState() {
+    const char *extensions = (const char*)glGetString(GL_EXTENSIONS);
+#ifdef LTGLES1
+    uint_indices_supported = extensions != NULL
+        && strstr(extensions, "GL_OES_element_index_uint") != NULL;
+    npot_textures_supported = extensions != NULL
+        && strstr(extensions, "GL_OES_texture_npot") != NULL;
+#else
+    uint_indices_supported = true;
+    const char *version = (const char*)glGetString(GL_VERSION);
+    npot_textures_supported = (version != NULL && atoi(version) >= 2)
+        || (extensions != NULL && strstr(extensions, "GL_ARB_texture_non_power_of_two") != NULL);
+#endif
     glDisable(GL_TEXTURE_2D);
     texturing = false;
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     texture_coord_arrays = false;
     glDisable(GL_BLEND);
+    blend = false;
     blend_mode = LT_BLEND_MODE_OFF;
+    blend_equation = UNKNOWN_ENUM;
+    blend_src = UNKNOWN_ENUM;
+    blend_dst = UNKNOWN_ENUM;
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
     texture_mode = LT_TEXTURE_MODE_MODULATE;
     glDisable(GL_DEPTH_TEST);
     depth_test = false;
     glDepthMask(GL_TRUE);
     depth_mask = true;
+    depth_func = UNKNOWN_ENUM;
     glDisable(GL_DITHER);
     dither = false;
     glDisable(GL_ALPHA_TEST);
@@ -100,59 +273,106 @@ void ltInitGLState() {
     normal_arrays = false;
     glDisable(GL_FOG);
     fog = false;
+    forget_floats(fog_color, 4);
+    forget_floats(&fog_start, 1);
+    forget_floats(&fog_end, 1);
+    forget_floats(&fog_mode, 1);
     glDisable(GL_LIGHTING);
     lighting = false;
+    for (int i = 0; i < MAX_LIGHTS; i++) {
+        glDisable(GL_LIGHT0 + i);
+        lights[i].enabled = false;
+        forget_floats(lights[i].ambient, 4);
+        forget_floats(lights[i].diffuse, 4);
+        forget_floats(lights[i].specular, 4);
+        forget_floats(lights[i].attenuation, 3);
+    }
+    forget_floats(&material.shininess, 1);
+    forget_floats(material.ambient, 4);
+    forget_floats(material.diffuse, 4);
+    forget_floats(material.specular, 4);
+    forget_floats(material.emission, 4);
     glDisable(GL_CULL_FACE);
+    cull_face_enabled = false;
+    cull_face = UNKNOWN_ENUM;
     glFrontFace(GL_CCW);
     glEnable(GL_NORMALIZE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    for (int i = 0; i < 4; i++) {
+        color_mask[i] = true;
+    }
+    GLenum modes[] = {GL_TEXTURE, GL_PROJECTION, GL_MODELVIEW};
+    for (int i = 0; i < 3; i++) {
+        glMatrixMode(modes[i]);
+        glLoadIdentity();
+        MatrixStack *stack = matrix_stack(modes[i]);
+        stack->top = 0;
+        ltMatIdentity(stack->m[0]);
+    }
+    matrix_mode = GL_MODELVIEW;
+    forget_floats(clear_color, 4);
+    forget_floats(current_color, 4);
+    for (int i = 0; i < 4; i++) {
+        viewport[i] = -1;
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
     bound_texture = 0;
     GLEXT(glBindFramebuffer)(GL_EXT(GL_FRAMEBUFFER), 0);
     bound_framebuffer = 0;
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     bound_vertbuffer = 0;
+    vertex_pointer.valid = false;
+    color_pointer.valid = false;
+    normal_pointer.valid = false;
+    tex_coord_pointer.valid = false;
 
     check_for_errors
     gltrace
 }
 
+void ltSetGLErrorChecking(bool enabled) {
+    gl_error_checking = enabled;
+}
+
+bool ltGLErrorCheckingEnabled() {
+    return gl_error_checking;
+}
+
+bool ltCheckGLErrors(const char *where) {
+    bool ok = true;
+    // A lost context may report errors forever.
+    for (int i = 0; i < 16; i++) {
+        GLenum err = glGetError();
+        if (err == GL_NO_ERROR) {
+            break;
+        }
+        ltLog("OpenGL error 0x%04x in %s", err, where);
+        ok = false;
+    }
+    return ok;
+}
+
 void ltEnableTexturing() {
     gltrace
-    if (!texturing) {
-        glEnable(GL_TEXTURE_2D);
-        check_for_errors
-        texturing = true;
-    }
+    set_cap(&texturing, GL_TEXTURE_2D, true);
     gltrace
 }
 
 void ltDisableTexturing() {
     gltrace
-    if (texturing) {
-        glDisable(GL_TEXTURE_2D);
-        check_for_errors
-        texturing = false;
-    }
+    set_cap(&texturing, GL_TEXTURE_2D, false);
     gltrace
 }
 
 void ltEnableTextureCoordArrays() {
     gltrace
-    if (!texture_coord_arrays) {
-        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-        check_for_errors
-        texture_coord_arrays = true;
-    }
+    set_client_state(&texture_coord_arrays, GL_TEXTURE_COORD_ARRAY, true);
     gltrace
 }
 
 void ltDisableTextureCoordArrays() {
     gltrace
-    if (texture_coord_arrays) {
-        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-        check_for_errors
-        texture_coord_arrays = false;
-    }
+    set_client_state(&texture_coord_arrays, GL_TEXTURE_COORD_ARRAY, false);
     gltrace
 }
 
@@ -160,30 +380,46 @@ void ltTextureMode(LTTextureMode mode) {
     gltrace
     if (mode != texture_mode) {
         glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode);
-        check_for_errors
+        lt_gl_counters.state_changes++;
+        issued
         texture_mode = mode;
+    } else {
+        filtered
     }
     gltrace
 }
 
 void ltColorMask(bool r, bool g, bool b, bool a) {
     gltrace
-    glColorMask(r, g, b, a);
-    check_for_errors
+    if (r != color_mask[0] || g != color_mask[1] || b != color_mask[2] || a != color_mask[3]) {
+        glColorMask(r, g, b, a);
+        lt_gl_counters.state_changes++;
+        issued
+        color_mask[0] = r;
+        color_mask[1] = g;
+        color_mask[2] = b;
+        color_mask[3] = a;
+    } else {
+        filtered
+    }
     gltrace
 }
 
+// Filters are per texture and only set when a texture is created, so
+// aren't cached.
 void ltTextureMagFilter(LTTextureFilter filter) {
     gltrace
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
-    check_for_errors
+    lt_gl_counters.state_changes++;
+    issued
     gltrace
 }
 
 void ltTextureMinFilter(LTTextureFilter filter) {
     gltrace
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter); 
-    check_for_errors
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    lt_gl_counters.state_changes++;
+    issued
     gltrace
 }
 
@@ -191,8 +427,11 @@ void ltBindTexture(LTtexid texture_id) {
     gltrace
     if (bound_texture != texture_id) {
         glBindTexture(GL_TEXTURE_2D, texture_id);
-        check_for_errors
+        lt_gl_counters.texture_binds++;
+        issued
         bound_texture = texture_id;
+    } else {
+        filtered
     }
     gltrace
 }
@@ -201,12 +440,15 @@ LTtexid ltGenTexture() {
     gltrace
     LTtexid t;
     glGenTextures(1, &t);
+    issued
 #if !defined(LTGLES1)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    issued
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    issued
     glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE);
+    issued
 #endif
-    check_for_errors
     gltrace
     return t;
 }
@@ -217,90 +459,117 @@ void ltDeleteTexture(LTtexid texture_id) {
         ltBindTexture(0);
     }
     glDeleteTextures(1, &texture_id);
-    check_for_errors
+    issued
     gltrace
 }
 
-void ltTexImage(int width, int height, void *data) {
+void ltTexImage(int width, int height, void *data, LTTextureFormat format) {
     gltrace
-    #ifdef LTGLES1
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    #else
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, data);
-    #endif
-    check_for_errors
+    switch (format) {
+        case LT_TEXTURE_FORMAT_RGB565:
+            #ifdef LTGLES1
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, data);
+            #else
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5, width, height, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, data);
+            #endif
+            break;
+        case LT_TEXTURE_FORMAT_RGBA4444:
+            #ifdef LTGLES1
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, data);
+            #else
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA4, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, data);
+            #endif
+            break;
+        case LT_TEXTURE_FORMAT_RGBA5551:
+            #ifdef LTGLES1
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, data);
+            #else
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, data);
+            #endif
+            break;
+        default:
+            #ifdef LTGLES1
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            #else
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, data);
+            #endif
+            break;
+    }
+    issued
     gltrace
 }
 
+static void set_blend(GLenum equation, GLenum src, GLenum dst) {
+    set_cap(&blend, GL_BLEND, true);
+    if (equation != blend_equation) {
+        glBlendEquation(equation);
+        lt_gl_counters.state_changes++;
+        issued
+        blend_equation = equation;
+    } else {
+        filtered
+    }
+    if (src != blend_src || dst != blend_dst) {
+        glBlendFunc(src, dst);
+        lt_gl_counters.state_changes++;
+        issued
+        blend_src = src;
+        blend_dst = dst;
+    } else {
+        filtered
+    }
+}
+
 void ltBlendMode(LTBlendMode new_mode) {
     gltrace
     LTBlendMode old_mode = blend_mode;
     if (old_mode != new_mode) {
         switch (new_mode) {
             case LT_BLEND_MODE_NORMAL:
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_ADD);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                set_blend(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
                 break;
             case LT_BLEND_MODE_INVERT:
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_SUBTRACT);
-                glBlendFunc(GL_ONE, GL_ONE);
+                set_blend(GL_FUNC_SUBTRACT, GL_ONE, GL_ONE);
                 break;
             case LT_BLEND_MODE_ADD:
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_ADD);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+                set_blend(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE);
                 break;
             case LT_BLEND_MODE_SUBTRACT:
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+                set_blend(GL_FUNC_REVERSE_SUBTRACT, GL_SRC_ALPHA, GL_ONE);
                 break;
                 /*
             case LT_BLEND_MODE_DIFF:
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_SUBTRACT);
-                glBlendFunc(GL_ONE, GL_ONE);
+                set_blend(GL_FUNC_SUBTRACT, GL_ONE, GL_ONE);
                 break;
                 */
             case LT_BLEND_MODE_COLOR:
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_ADD);
-                glBlendFunc(GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
+                set_blend(GL_FUNC_ADD, GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
                 break;
             case LT_BLEND_MODE_MULTIPLY:
-                glEnable(GL_BLEND);
-                glBlendEquation(GL_FUNC_ADD);
-                glBlendFunc(GL_DST_COLOR, GL_ZERO);
+                set_blend(GL_FUNC_ADD, GL_DST_COLOR, GL_ZERO);
                 break;
             case LT_BLEND_MODE_OFF:
-                glDisable(GL_BLEND);
+                // The equation and function are kept for when blending
+                // is next enabled.
+                set_cap(&blend, GL_BLEND, false);
                 break;
         }
         blend_mode = new_mode;
-        check_for_errors
+    } else {
+        filtered
     }
     gltrace
 }
 
 void ltEnableDepthTest() {
     gltrace
-    if (!depth_test) {
-        glEnable(GL_DEPTH_TEST);
-        check_for_errors
-        depth_test = true;
-    }
+    set_cap(&depth_test, GL_DEPTH_TEST, true);
     gltrace
 }
 
 void ltDisableDepthTest() {
     gltrace
-    if (depth_test) {
-        glDisable(GL_DEPTH_TEST);
-        check_for_errors
-        depth_test = false;
-    }
+    set_cap(&depth_test, GL_DEPTH_TEST, false);
     gltrace
 }
 
@@ -308,8 +577,11 @@ void ltEnableDepthMask() {
     gltrace
     if (!depth_mask) {
         glDepthMask(GL_TRUE);
-        check_for_errors
+        lt_gl_counters.state_changes++;
+        issued
         depth_mask = true;
+    } else {
+        filtered
     }
     gltrace
 }
@@ -318,180 +590,129 @@ void ltDisableDepthMask() {
     gltrace
     if (depth_mask) {
         glDepthMask(GL_FALSE);
-        check_for_errors
+        lt_gl_counters.state_changes++;
+        issued
         depth_mask = false;
+    } else {
+        filtered
     }
     gltrace
 }
 
 void ltDepthFunc(LTDepthFunc f) {
     gltrace
-    glDepthFunc(f);
-    check_for_errors
+    if ((GLenum)f != depth_func) {
+        glDepthFunc(f);
+        lt_gl_counters.state_changes++;
+        issued
+        depth_func = f;
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltEnableDither() {
     gltrace
-    if (!dither) {
-        glEnable(GL_DITHER);
-        check_for_errors
-        dither = true;
-    }
+    set_cap(&dither, GL_DITHER, true);
     gltrace
 }
 
 void ltDisableDither() {
     gltrace
-    if (dither) {
-        glDisable(GL_DITHER);
-        check_for_errors
-        dither = false;
-    }
+    set_cap(&dither, GL_DITHER, false);
     gltrace
 }
 
 void ltEnableAlphaTest() {
     gltrace
-    if (!alpha_test) {
-        glEnable(GL_ALPHA_TEST);
-        check_for_errors
-        alpha_test = true;
-    }
+    set_cap(&alpha_test, GL_ALPHA_TEST, true);
     gltrace
 }
 
 void ltDisableAlphaTest() {
     gltrace
-    if (alpha_test) {
-        glDisable(GL_ALPHA_TEST);
-        check_for_errors
-        alpha_test = false;
-    }
+    set_cap(&alpha_test, GL_ALPHA_TEST, false);
     gltrace
 }
 
 void ltEnableStencilTest() {
     gltrace
-    if (!stencil_test) {
-        glEnable(GL_STENCIL_TEST);
-        check_for_errors
-        stencil_test = true;
-    }
+    set_cap(&stencil_test, GL_STENCIL_TEST, true);
     gltrace
 }
 
 void ltDisableStencilTest() {
     gltrace
-    if (stencil_test) {
-        glDisable(GL_STENCIL_TEST);
-        check_for_errors
-        stencil_test = false;
-    }
+    set_cap(&stencil_test, GL_STENCIL_TEST, false);
     gltrace
 }
 
 void ltEnableVertexArrays() {
     gltrace
-    if (!vertex_arrays) {
-        glEnableClientState(GL_VERTEX_ARRAY);
-        check_for_errors
-        vertex_arrays = true;
-    }
+    set_client_state(&vertex_arrays, GL_VERTEX_ARRAY, true);
     gltrace
 }
 
 void ltDisableVertexArrays() {
     gltrace
-    if (vertex_arrays) {
-        glDisableClientState(GL_VERTEX_ARRAY);
-        check_for_errors
-        vertex_arrays = false;
-    }
+    set_client_state(&vertex_arrays, GL_VERTEX_ARRAY, false);
     gltrace
 }
 
 void ltEnableIndexArrays() {
     gltrace
-    if (!index_arrays) {
 #if !defined(LTGLES1)
-        glEnableClientState(GL_INDEX_ARRAY);
+    set_client_state(&index_arrays, GL_INDEX_ARRAY, true);
+#else
+    index_arrays = true;
 #endif
-        check_for_errors
-        index_arrays = true;
-    }
     gltrace
 }
 
 void ltDisableIndexArrays() {
     gltrace
-    if (index_arrays) {
 #if !defined(LTGLES1)
-        glDisableClientState(GL_INDEX_ARRAY);
+    set_client_state(&index_arrays, GL_INDEX_ARRAY, false);
+#else
+    index_arrays = false;
 #endif
-        check_for_errors
-        index_arrays = false;
-    }
     gltrace
 }
 
 void ltEnableColorArrays() {
     gltrace
-    if (!color_arrays) {
-        glEnableClientState(GL_COLOR_ARRAY);
-        check_for_errors
-        color_arrays = true;
-    }
+    set_client_state(&color_arrays, GL_COLOR_ARRAY, true);
     gltrace
 }
 
 void ltDisableColorArrays() {
     gltrace
-    if (color_arrays) {
-        glDisableClientState(GL_COLOR_ARRAY);
-        check_for_errors
-        color_arrays = false;
-    }
+    set_client_state(&color_arrays, GL_COLOR_ARRAY, false);
     gltrace
 }
 
 void ltEnableNormalArrays() {
     gltrace
-    if (!normal_arrays) {
-        glEnableClientState(GL_NORMAL_ARRAY);
-        check_for_errors
-        normal_arrays = true;
-    }
+    set_client_state(&normal_arrays, GL_NORMAL_ARRAY, true);
     gltrace
 }
 
 void ltDisableNormalArrays() {
     gltrace
-    if (normal_arrays) {
-        glDisableClientState(GL_NORMAL_ARRAY);
-        check_for_errors
-        normal_arrays = false;
-    }
+    set_client_state(&normal_arrays, GL_NORMAL_ARRAY, false);
     gltrace
 }
 
 void ltEnableFog() {
     gltrace
-    if (!fog) {
-        glEnable(GL_FOG);
-        check_for_errors
-        fog = true;
-    }
+    set_cap(&fog, GL_FOG, true);
     gltrace
 }
 
 void ltDisableFog() {
     gltrace
-    if (fog) {
-        glDisable(GL_FOG);
-        check_for_errors
-        fog = false;
-    }
+    set_cap(&fog, GL_FOG, false);
     gltrace
 }
 
@@ -502,36 +723,62 @@ void ltFogColor(LTfloat r, LTfloat g, LTfloat b) {
     colv[1] = g;
     colv[2] = b;
     colv[3] = 1.0f;
-    glFogfv(GL_FOG_COLOR, (const GLfloat*)colv);
-    check_for_errors
+    if (!same_floats(fog_color, colv, 4)) {
+        glFogfv(GL_FOG_COLOR, (const GLfloat*)colv);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltFogStart(LTfloat start) {
     gltrace
-    glFogf(GL_FOG_START, start);
-    check_for_errors
+    if (!same_floats(&fog_start, &start, 1)) {
+        glFogf(GL_FOG_START, start);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltFogEnd(LTfloat end) {
     gltrace
-    glFogf(GL_FOG_END, end);
-    check_for_errors
+    if (!same_floats(&fog_end, &end, 1)) {
+        glFogf(GL_FOG_END, end);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltFogMode(LTFogMode mode) {
     gltrace
-    glFogf(GL_FOG_MODE, mode);
-    check_for_errors
+    GLfloat m = mode;
+    if (!same_floats(&fog_mode, &m, 1)) {
+        glFogf(GL_FOG_MODE, m);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltClearColor(LTfloat r, LTfloat g, LTfloat b, LTfloat a) {
     gltrace
-    glClearColor(r, g, b, a);
-    check_for_errors
+    GLfloat c[] = {r, g, b, a};
+    if (!same_floats(clear_color, c, 4)) {
+        glClearColor(r, g, b, a);
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
@@ -545,155 +792,186 @@ void ltClear(bool color, bool depthbuf) {
         clear_mask |= GL_DEPTH_BUFFER_BIT;
     }
     glClear(clear_mask);
-    check_for_errors
+    issued
     gltrace
 }
 
 void ltColor(LTfloat r, LTfloat g, LTfloat b, LTfloat a) {
     gltrace
-    glColor4f(r, g, b, a);
-    check_for_errors
+    GLfloat c[] = {r, g, b, a};
+    if (!same_floats(current_color, c, 4)) {
+        glColor4f(r, g, b, a);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltEnableLighting() {
     gltrace
-    if (!lighting) {
-        glEnable(GL_LIGHTING);
-        check_for_errors
-        lighting = true;
-    }
+    set_cap(&lighting, GL_LIGHTING, true);
     gltrace
 }
 
 void ltDisableLighting() {
     gltrace
-    if (lighting) {
-        glDisable(GL_LIGHTING);
-        check_for_errors
-        lighting = false;
-    }
+    set_cap(&lighting, GL_LIGHTING, false);
     gltrace
 }
 
 void ltEnableLight(int light) {
     gltrace
-    if (light < GL_MAX_LIGHTS) {
-        glEnable(GL_LIGHT0 + light);
+    if (light < MAX_LIGHTS) {
+        set_cap(&lights[light].enabled, GL_LIGHT0 + light, true);
     } else {
-        ltLog("Warning: too many lights (max %d)", GL_MAX_LIGHTS);
+        ltLog("Warning: too many lights (max %d)", MAX_LIGHTS);
     }
     gltrace
 }
 
 void ltDisableLight(int light) {
     gltrace
-    if (light < GL_MAX_LIGHTS) {
-        glDisable(GL_LIGHT0 + light);
+    if (light < MAX_LIGHTS) {
+        set_cap(&lights[light].enabled, GL_LIGHT0 + light, false);
     }
     gltrace
 }
 
+static void set_light_color(int light, GLfloat *cache, GLenum pname, LTfloat r, LTfloat g, LTfloat b) {
+    GLfloat color[] = {r, g, b, 1};
+    if (!same_floats(cache, color, 4)) {
+        glLightfv(GL_LIGHT0 + light, pname, color);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
+}
+
 void ltLightAmbient(int light, LTfloat r, LTfloat g, LTfloat b) {
     gltrace
-    if (light < GL_MAX_LIGHTS) {
-        GLfloat color[] = {r, g, b, 1};
-        glLightfv(GL_LIGHT0 + light, GL_AMBIENT, color);
+    if (light < MAX_LIGHTS) {
+        set_light_color(light, lights[light].ambient, GL_AMBIENT, r, g, b);
     }
     gltrace
 }
 
 void ltLightDiffuse(int light, LTfloat r, LTfloat g, LTfloat b) {
     gltrace
-    if (light < GL_MAX_LIGHTS) {
-        GLfloat color[] = {r, g, b, 1};
-        glLightfv(GL_LIGHT0 + light, GL_DIFFUSE, color);
+    if (light < MAX_LIGHTS) {
+        set_light_color(light, lights[light].diffuse, GL_DIFFUSE, r, g, b);
     }
     gltrace
 }
 
 void ltLightSpecular(int light, LTfloat r, LTfloat g, LTfloat b) {
     gltrace
-    if (light < GL_MAX_LIGHTS) {
-        GLfloat color[] = {r, g, b, 1};
-        glLightfv(GL_LIGHT0 + light, GL_SPECULAR, color);
+    if (light < MAX_LIGHTS) {
+        set_light_color(light, lights[light].specular, GL_SPECULAR, r, g, b);
     }
     gltrace
 }
 
+// Not cached, because GL transforms the position by the current
+// modelview matrix.
 void ltLightPosition(int light, LTfloat x, LTfloat y, LTfloat z, LTfloat w) {
     gltrace
-    if (light < GL_MAX_LIGHTS) {
+    if (light < MAX_LIGHTS) {
         GLfloat pos[] = {x, y, z, w};
         glLightfv(GL_LIGHT0 + light, GL_POSITION, pos);
+        lt_gl_counters.state_changes++;
+        issued
     }
     gltrace
 }
 
 void ltLightAttenuation(int light, LTfloat q, LTfloat l, LTfloat c) {
     gltrace
-    if (light < GL_MAX_LIGHTS) {
-        glLightf(GL_LIGHT0 + light, GL_CONSTANT_ATTENUATION, c);
-        glLightf(GL_LIGHT0 + light, GL_LINEAR_ATTENUATION, l);
-        glLightf(GL_LIGHT0 + light, GL_QUADRATIC_ATTENUATION, q);
+    if (light < MAX_LIGHTS) {
+        GLfloat *cache = lights[light].attenuation;
+        GLfloat atten[] = {c, l, q};
+        GLenum pnames[] = {GL_CONSTANT_ATTENUATION, GL_LINEAR_ATTENUATION, GL_QUADRATIC_ATTENUATION};
+        for (int i = 0; i < 3; i++) {
+            if (!same_floats(&cache[i], &atten[i], 1)) {
+                glLightf(GL_LIGHT0 + light, pnames[i], atten[i]);
+                lt_gl_counters.state_changes++;
+                issued
+            } else {
+                filtered
+            }
+        }
     }
     gltrace
 }
 
+static void set_material(GLfloat *cache, GLenum pname, LTfloat r, LTfloat g, LTfloat b, LTfloat a) {
+    GLfloat color[] = {r, g, b, a};
+    if (!same_floats(cache, color, 4)) {
+        glMaterialfv(GL_FRONT_AND_BACK, pname, color);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
+}
+
 void ltMaterialShininess(LTfloat shininess) {
     gltrace
-    glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
+    if (!same_floats(&material.shininess, &shininess, 1)) {
+        glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltMaterialAmbient(LTfloat r, LTfloat g, LTfloat b) {
     gltrace
-    GLfloat color[] = {r, g, b, 1};
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, color);
+    set_material(material.ambient, GL_AMBIENT, r, g, b, 1);
     gltrace
 }
 
 void ltMaterialDiffuse(LTfloat r, LTfloat g, LTfloat b, LTfloat a) {
     gltrace
-    GLfloat color[] = {r, g, b, a};
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, color);
+    set_material(material.diffuse, GL_DIFFUSE, r, g, b, a);
     gltrace
 }
 
 void ltMaterialSpecular(LTfloat r, LTfloat g, LTfloat b) {
     gltrace
-    GLfloat color[] = {r, g, b, 1};
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, color);
+    set_material(material.specular, GL_SPECULAR, r, g, b, 1);
     gltrace
 }
 
 void ltMaterialEmission(LTfloat r, LTfloat g, LTfloat b) {
     gltrace
-    GLfloat color[] = {r, g, b, 1};
-    glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, color);
+    set_material(material.emission, GL_EMISSION, r, g, b, 1);
     gltrace
 }
 
 void ltCullFace(LTCullMode mode) {
     gltrace
     switch (mode) {
-        case LT_CULL_BACK: {
-            glEnable(GL_CULL_FACE);
-            check_for_errors
-            glCullFace(GL_BACK);
-            check_for_errors
-            break;
-        }
+        case LT_CULL_BACK:
         case LT_CULL_FRONT: {
-            glEnable(GL_CULL_FACE);
-            check_for_errors
-            glCullFace(GL_FRONT);
-            check_for_errors
+            set_cap(&cull_face_enabled, GL_CULL_FACE, true);
+            GLenum face = mode == LT_CULL_BACK ? GL_BACK : GL_FRONT;
+            if (face != cull_face) {
+                glCullFace(face);
+                lt_gl_counters.state_changes++;
+                issued
+                cull_face = face;
+            } else {
+                filtered
+            }
             break;
         }
         case LT_CULL_OFF: {
-            glDisable(GL_CULL_FACE);
-            check_for_errors
+            set_cap(&cull_face_enabled, GL_CULL_FACE, false);
             break;
         }
     }
@@ -702,39 +980,69 @@ void ltCullFace(LTCullMode mode) {
 
 void ltMatrixMode(LTMatrixMode mode) {
     gltrace
-    glMatrixMode(mode);
-    check_for_errors
+    if ((GLenum)mode != matrix_mode) {
+        glMatrixMode(mode);
+        issued
+        matrix_mode = mode;
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltPushMatrix() {
     gltrace
     glPushMatrix();
-    check_for_errors
+    issued
+    MatrixStack *stack = matrix_stack(matrix_mode);
+    if (stack->top + 1 < MATRIX_STACK_DEPTH) {
+        memcpy(stack->m[stack->top + 1], stack->m[stack->top], sizeof(stack->m[0]));
+        stack->top++;
+    }
     gltrace
 }
 
 void ltPopMatrix() {
     gltrace
     glPopMatrix();
-    check_for_errors
+    issued
+    MatrixStack *stack = matrix_stack(matrix_mode);
+    if (stack->top > 0) {
+        stack->top--;
+    }
     gltrace
 }
 
 void ltMultMatrix(LTfloat *m) {
     gltrace
     glMultMatrixf(m);
-    check_for_errors
+    issued
+    LTfloat *cur = current_matrix();
+    ltMatMultiply(cur, cur, m);
+    gltrace
+}
+
+void ltLoadMatrix(LTfloat *m) {
+    gltrace
+    glLoadMatrixf(m);
+    issued
+    memcpy(current_matrix(), m, 16 * sizeof(LTfloat));
     gltrace
 }
 
 void ltLoadIdentity() {
     gltrace
     glLoadIdentity();
-    check_for_errors
+    issued
+    ltMatIdentity(current_matrix());
     gltrace
 }
 
+void ltGetMatrix(LTMatrixMode mode, LTfloat *m) {
+    MatrixStack *stack = matrix_stack(mode);
+    memcpy(m, stack->m[stack->top], 16 * sizeof(LTfloat));
+}
+
 void ltOrtho(LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat nearz, LTfloat farz) {
     gltrace
     #ifdef LTGLES1
@@ -742,7 +1050,8 @@ void ltOrtho(LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat n
     #else
     glOrtho(left, right, bottom, top, nearz, farz);
     #endif
-    check_for_errors
+    issued
+    ltMatOrtho(current_matrix(), left, right, bottom, top, nearz, farz);
     gltrace
 }
 
@@ -753,35 +1062,47 @@ void ltFrustum(LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat
     #else
     glFrustum(left, right, bottom, top, nearz, farz);
     #endif
-    check_for_errors
+    issued
+    ltMatFrustum(current_matrix(), left, right, bottom, top, nearz, farz);
     gltrace
 }
 
 void ltTranslate(LTfloat x, LTfloat y, LTfloat z) {
     gltrace
     glTranslatef(x, y, z);
-    check_for_errors
+    issued
+    ltMatTranslate(current_matrix(), x, y, z);
     gltrace
 }
 
 void ltRotate(LTdegrees degrees, LTfloat x, LTfloat y, LTfloat z) {
     gltrace
     glRotatef(degrees, x, y, z);
-    check_for_errors
+    issued
+    ltMatRotate(current_matrix(), degrees, x, y, z);
     gltrace
 }
 
 void ltScale(LTfloat x, LTfloat y, LTfloat z) {
     gltrace
     glScalef(x, y, z);
-    check_for_errors
+    issued
+    ltMatScale(current_matrix(), x, y, z);
     gltrace
 }
 
 void ltViewport(int x, int y, int width, int height) {
     gltrace
-    glViewport(x, y, width, height);
-    check_for_errors
+    if (x != viewport[0] || y != viewport[1] || width != viewport[2] || height != viewport[3]) {
+        glViewport(x, y, width, height);
+        issued
+        viewport[0] = x;
+        viewport[1] = y;
+        viewport[2] = width;
+        viewport[3] = height;
+    } else {
+        filtered
+    }
     gltrace
 }
 
@@ -789,7 +1110,7 @@ LTvertbuf ltGenVertBuffer() {
     gltrace
     LTvertbuf vb;
     glGenBuffers(1, &vb);
-    check_for_errors
+    issued
     gltrace
     return vb;
 }
@@ -798,8 +1119,11 @@ void ltBindVertBuffer(LTvertbuf vb) {
     gltrace
     if (bound_vertbuffer != vb) {
         glBindBuffer(GL_ARRAY_BUFFER, vb);
-        check_for_errors
+        lt_gl_counters.state_changes++;
+        issued
         bound_vertbuffer = vb;
+    } else {
+        filtered
     }
     gltrace
 }
@@ -812,64 +1136,140 @@ void ltDeleteVertBuffer(LTvertbuf vb) {
         ltBindVertBuffer(0);
     }
     glDeleteBuffers(1, &vb);
-    check_for_errors
+    issued
+    // GL unbinds vb from any arrays that use it, and the name may be
+    // reused.
+    ArrayPointer *pointers[] = {&vertex_pointer, &color_pointer, &normal_pointer, &tex_coord_pointer};
+    for (int i = 0; i < 4; i++) {
+        if (pointers[i]->buffer == vb) {
+            pointers[i]->valid = false;
+        }
+    }
     gltrace
 }
 
 void ltStaticVertBufferData(int size, const void *data) {
     gltrace
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
-    check_for_errors
+    lt_gl_counters.buffer_bytes += size;
+    issued
+    gltrace
+}
+
+void ltDynamicVertBufferData(int size, const void *data) {
+    gltrace
+    glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    lt_gl_counters.buffer_bytes += size;
+    issued
+    gltrace
+}
+
+void ltVertBufferSubData(int offset, int size, const void *data) {
+    gltrace
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    lt_gl_counters.buffer_bytes += size;
+    issued
     gltrace
 }
 
 void ltVertexPointer(int size, LTVertDataType type, int stride, void *data) {
     gltrace
-    glVertexPointer(size, type, stride, data);
-    check_for_errors
+    if (!same_pointer(&vertex_pointer, size, type, stride, data)) {
+        glVertexPointer(size, type, stride, data);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltColorPointer(int size, LTVertDataType type, int stride, void *data) {
     gltrace
-    glColorPointer(size, type, stride, data);
-    check_for_errors
+    if (!same_pointer(&color_pointer, size, type, stride, data)) {
+        glColorPointer(size, type, stride, data);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltNormalPointer(LTVertDataType type, int stride, void *data) {
     gltrace
-    glNormalPointer(type, stride, data);
-    check_for_errors
+    if (!same_pointer(&normal_pointer, 3, type, stride, data)) {
+        glNormalPointer(type, stride, data);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
 void ltTexCoordPointer(int size, LTVertDataType type, int stride, void *data) {
     gltrace
-    glTexCoordPointer(size, type, stride, data);
-    check_for_errors
+    if (!same_pointer(&tex_coord_pointer, size, type, stride, data)) {
+        glTexCoordPointer(size, type, stride, data);
+        lt_gl_counters.state_changes++;
+        issued
+    } else {
+        filtered
+    }
     gltrace
 }
 
+// The current colour is undefined after drawing with a colour array.
+static void after_draw() {
+    if (color_arrays) {
+        forget_floats(current_color, 4);
+    }
+}
+
 void ltDrawArrays(LTDrawMode mode, int start, int count) {
     gltrace
     glDrawArrays(mode, start, count);
-    check_for_errors
+    lt_gl_counters.draw_calls++;
+    lt_gl_counters.vertices += count;
+    issued
+    after_draw();
     gltrace
 }
 
 void ltDrawElements(LTDrawMode mode, int n, LTvertindex *indices) {
     gltrace
     glDrawElements(mode, n, GL_UNSIGNED_SHORT, indices);
-    check_for_errors
+    lt_gl_counters.draw_calls++;
+    lt_gl_counters.vertices += n;
+    issued
+    after_draw();
+    gltrace
+}
+
+void ltDrawElements32(LTDrawMode mode, int n, LTvertindex32 *indices) {
     gltrace
+    glDrawElements(mode, n, GL_UNSIGNED_INT, indices);
+    lt_gl_counters.draw_calls++;
+    lt_gl_counters.vertices += n;
+    issued
+    after_draw();
+    gltrace
+}
+
+bool ltUintIndicesSupported() {
+    return uint_indices_supported;
+}
+
+bool ltNPOTTexturesSupported() {
+    return npot_textures_supported;
 }
 
 LTframebuf ltGenFramebuffer() {
     gltrace
     LTframebuf fb;
     GLEXT(glGenFramebuffers)(1, &fb);
-    check_for_errors
+    issued
     gltrace
     return fb;
 }
@@ -878,8 +1278,11 @@ void ltBindFramebuffer(LTframebuf fb) {
     gltrace
     if (bound_framebuffer != fb) {
         GLEXT(glBindFramebuffer)(GL_EXT(GL_FRAMEBUFFER), fb);
-        check_for_errors
+        lt_gl_counters.state_changes++;
+        issued
         bound_framebuffer = fb;
+    } else {
+        filtered
     }
     gltrace
 }
@@ -890,19 +1293,20 @@ void ltDeleteFramebuffer(LTframebuf fb) {
         ltBindFramebuffer(0);
     }
     GLEXT(glDeleteFramebuffers)(1, &fb);
-    check_for_errors
+    issued
     gltrace
 }
 
 void ltFramebufferTexture(LTtexid texture_id) {
     gltrace
     GLEXT(glFramebufferTexture2D)(GL_EXT(GL_FRAMEBUFFER), GL_EXT(GL_COLOR_ATTACHMENT0), GL_TEXTURE_2D, texture_id, 0);
-    check_for_errors
+    issued
     gltrace
 }
 
 bool ltFramebufferComplete() {
     GLenum status = GLEXT(glCheckFramebufferStatus)(GL_EXT(GL_FRAMEBUFFER));
+    issued
     return status == GL_EXT(GL_FRAMEBUFFER_COMPLETE);
 }
 
@@ -5,6 +5,7 @@ typedef GLuint          LTvertbuf;
 typedef GLuint          LTframebuf;
 typedef GLuint          LTtexid;
 typedef GLushort        LTvertindex;
+typedef GLuint          LTvertindex32;
 typedef GLshort         LTtexcoord;
 
 enum LTDepthFunc {
@@ -62,14 +63,35 @@ enum LTTextureFilter {
     LT_TEXTURE_FILTER_NEAREST = GL_NEAREST,
 };
 
+// Texel formats for ltTexImage.  16 bit texels are packed into shorts
+// with red in the high bits.
+enum LTTextureFormat {
+    LT_TEXTURE_FORMAT_RGBA8888,  // LTpixels.
+    LT_TEXTURE_FORMAT_RGB565,
+    LT_TEXTURE_FORMAT_RGBA4444,
+    LT_TEXTURE_FORMAT_RGBA5551,
+    LT_TEXTURE_FORMAT_AUTO,      // Atlases only: chosen from the images (see ltimage.h).
+};
+
 enum LTCullMode {
     LT_CULL_BACK,
     LT_CULL_FRONT,
     LT_CULL_OFF,
 };
 
+// ltopengl.cpp keeps a copy of the GL state it sets and drops calls that
+// wouldn't change it, so all GL calls should go through the functions
+// below.  ltInitGLState puts GL and the copy in a known state.
 void ltInitGLState();
 
+// When enabled ltLuaRender logs any GL errors once per frame.  Build
+// with LTGLCHECK to check after every call instead.  Off by default,
+// since glGetError can stall the pipeline.
+void ltSetGLErrorChecking(bool enabled);
+bool ltGLErrorCheckingEnabled();
+// Logs and clears pending GL errors.  Returns false if there were any.
+bool ltCheckGLErrors(const char *where);
+
 void ltEnableTexturing();
 void ltDisableTexturing();
 void ltEnableTextureCoordArrays();
@@ -81,7 +103,8 @@ void ltTextureMinFilter(LTTextureFilter filter);
 void ltBindTexture(LTtexid texture_id);
 LTtexid ltGenTexture();
 void ltDeleteTexture(LTtexid);
-void ltTexImage(int width, int height, void *data);
+void ltTexImage(int width, int height, void *data,
+    LTTextureFormat format = LT_TEXTURE_FORMAT_RGBA8888);
 
 void ltBlendMode(LTBlendMode mode);
 
@@ -150,6 +173,10 @@ void ltPushMatrix();
 void ltPopMatrix();
 void ltLoadIdentity();
 void ltMultMatrix(LTfloat *mat);
+void ltLoadMatrix(LTfloat *mat);
+// The current matrix of the given stack, from a copy kept by the
+// functions above, so it's cheap to call.
+void ltGetMatrix(LTMatrixMode mode, LTfloat *mat);
 void ltOrtho(LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat nearz, LTfloat farz);
 void ltFrustum(LTfloat left, LTfloat right, LTfloat bottom, LTfloat top, LTfloat nearz, LTfloat farz);
 
@@ -163,12 +190,23 @@ LTvertbuf ltGenVertBuffer();
 void ltDeleteVertBuffer(LTvertbuf vb);
 void ltBindVertBuffer(LTvertbuf vb);
 void ltStaticVertBufferData(int size, const void *data);
+// For buffers that are partially updated with ltVertBufferSubData.
+void ltDynamicVertBufferData(int size, const void *data);
+void ltVertBufferSubData(int offset, int size, const void *data);
 void ltVertexPointer(int size, LTVertDataType type, int stride, void *data);
 void ltColorPointer(int size, LTVertDataType type, int stride, void *data);
 void ltNormalPointer(LTVertDataType type, int stride, void *data);
 void ltTexCoordPointer(int size, LTVertDataType type, int stride, void *data);
 void ltDrawArrays(LTDrawMode mode, int start, int count);
 void ltDrawElements(LTDrawMode mode, int n, LTvertindex *indices);
+// Only if ltUintIndicesSupported().
+void ltDrawElements32(LTDrawMode mode, int n, LTvertindex32 *indices);
+// Always true for desktop GL.  For GLES1 needs GL_OES_element_index_uint.
+bool ltUintIndicesSupported();
+// Whether textures may have sizes that aren't powers of 2.  Desktop GL
+// 2.0 or GL_ARB_texture_non_power_of_two, or GLES1 with
+// GL_OES_texture_npot.
+bool ltNPOTTexturesSupported();
 
 LTframebuf ltGenFramebuffer();
 void ltDeleteFramebuffer(LTframebuf fb);
@@ -228,6 +228,10 @@ void LTParticleSystem::add_particle() {
 void LTParticleSystem::advance(LTfloat dt) {
     //if (!executeActions(dt)) return;
 
+    if (num_particles > 0 || particles_active) {
+        changed();
+    }
+
     if (particles_active && emission_rate > 0.0f) {
         LTfloat rate = 1.0f / emission_rate;
         emit_counter += dt;
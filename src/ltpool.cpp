@@ -0,0 +1,187 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(ltpool)
+
+#define CHUNK_SIZE (16 * 1024)
+
+struct LTPoolBlock {
+    LTPoolBlock *next;
+};
+
+static LTPool engine_pool;
+
+static inline int size_class(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    return (int)((size - 1) / LT_POOL_GRANULE);
+}
+
+static inline void count_alloc(LTPoolStats *s) {
+    s->live++;
+    s->allocs++;
+    if (s->live > s->peak) {
+        s->peak = s->live;
+    }
+}
+
+// Returns false if out of memory.
+static bool refill(LTPool *pool, int cls) {
+    size_t block_size = (cls + 1) * LT_POOL_GRANULE;
+    int n = CHUNK_SIZE / block_size;
+    char *chunk = (char*)malloc(n * block_size);
+    if (chunk == NULL) {
+        return false;
+    }
+    // Thread the chunk onto the free list in address order.
+    LTPoolBlock *head = pool->free_lists[cls];
+    for (int i = n - 1; i >= 0; i--) {
+        LTPoolBlock *b = (LTPoolBlock*)(chunk + i * block_size);
+        b->next = head;
+        head = b;
+    }
+    pool->free_lists[cls] = head;
+    pool->class_stats[cls].chunks++;
+    pool->total_stats.chunks++;
+    return true;
+}
+
+// Allocates a small block, or returns NULL if out of memory.
+static inline void *alloc_small(LTPool *pool, size_t size) {
+    int cls = size_class(size);
+    if (pool->free_lists[cls] == NULL && !refill(pool, cls)) {
+        return NULL;
+    }
+    LTPoolBlock *b = pool->free_lists[cls];
+    pool->free_lists[cls] = b->next;
+    count_alloc(&pool->class_stats[cls]);
+    count_alloc(&pool->total_stats);
+    return b;
+}
+
+void *LTPool::alloc(size_t size) {
+    if (size > LT_POOL_MAX_SIZE) {
+        count_alloc(&total_stats);
+        count_alloc(&large_stats);
+        void *ptr = malloc(size);
+        if (ptr == NULL) {
+            ltLog("Out of memory allocating %d bytes", (int)size);
+            ltAbort();
+        }
+        return ptr;
+    }
+    void *ptr = alloc_small(this, size);
+    if (ptr == NULL) {
+        ltLog("Out of memory allocating pool chunk");
+        ltAbort();
+    }
+    return ptr;
+}
+
+void LTPool::free(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return;
+    }
+    total_stats.live--;
+    if (size > LT_POOL_MAX_SIZE) {
+        large_stats.live--;
+        ::free(ptr);
+        return;
+    }
+    int cls = size_class(size);
+    LTPoolBlock *b = (LTPoolBlock*)ptr;
+    b->next = free_lists[cls];
+    free_lists[cls] = b;
+    class_stats[cls].live--;
+}
+
+void LTPool::reset_peak() {
+    total_stats.peak = total_stats.live;
+    large_stats.peak = large_stats.live;
+    for (int i = 0; i < LT_POOL_NUM_CLASSES; i++) {
+        class_stats[i].peak = class_stats[i].live;
+    }
+}
+
+void *ltPoolAlloc(size_t size) {
+    return engine_pool.alloc(size);
+}
+
+void ltPoolFree(void *ptr, size_t size) {
+    engine_pool.free(ptr, size);
+}
+
+void ltPoolGetStats(LTPoolStats *stats) {
+    *stats = engine_pool.total_stats;
+}
+
+void ltPoolGetClassStats(int cls, LTPoolStats *stats) {
+    if (cls >= 0 && cls < LT_POOL_NUM_CLASSES) {
+        *stats = engine_pool.class_stats[cls];
+    } else {
+        memset(stats, 0, sizeof(LTPoolStats));
+    }
+}
+
+void ltPoolResetPeak() {
+    engine_pool.reset_peak();
+}
+
+// Lua assumes shrinking a block never fails.  If there's no memory for
+// the smaller block, the old one is kept and from then on belongs to
+// the new size class, which it's big enough for (Lua frees it with the
+// new size).
+static void *keep_shrunk_block(LTPool *pool, void *ptr, size_t osize, size_t nsize) {
+    int cls = size_class(nsize);
+    if (osize > LT_POOL_MAX_SIZE) {
+        pool->large_stats.live--;
+        // Give back what the size class doesn't need, if realloc can.
+        void *p = realloc(ptr, (cls + 1) * LT_POOL_GRANULE);
+        if (p != NULL) {
+            ptr = p;
+        }
+    } else {
+        pool->class_stats[size_class(osize)].live--;
+    }
+    pool->class_stats[cls].live++;
+    return ptr;
+}
+
+void *ltPoolLuaAlloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+    LTPool *pool = (LTPool*)ud;
+    if (nsize == 0) {
+        pool->free(ptr, osize);
+        return NULL;
+    }
+    if (ptr == NULL) {
+        // Lua treats failure as an out of memory error, so don't abort.
+        if (nsize > LT_POOL_MAX_SIZE) {
+            void *p = malloc(nsize);
+            if (p != NULL) {
+                count_alloc(&pool->total_stats);
+                count_alloc(&pool->large_stats);
+            }
+            return p;
+        }
+        return alloc_small(pool, nsize);
+    }
+    if (osize > LT_POOL_MAX_SIZE && nsize > LT_POOL_MAX_SIZE) {
+        // Both large: let realloc grow in place if it can.
+        return realloc(ptr, nsize);
+    }
+    if (osize <= LT_POOL_MAX_SIZE && nsize <= LT_POOL_MAX_SIZE
+            && size_class(osize) == size_class(nsize)) {
+        return ptr;
+    }
+    void *p = ltPoolLuaAlloc(ud, NULL, 0, nsize);
+    if (p == NULL) {
+        if (nsize < osize) {
+            return keep_shrunk_block(pool, ptr, osize, nsize);
+        }
+        return NULL;
+    }
+    memcpy(p, ptr, osize < nsize ? osize : nsize);
+    pool->free(ptr, osize);
+    return p;
+}
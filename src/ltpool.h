@@ -0,0 +1,65 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltpool)
+
+// Size-class pool allocator for small, short-lived engine objects
+// (events, actions, tweens).  Freed blocks go onto a per-class free
+// list and are reused, so steady-state churn never reaches malloc.
+// Blocks larger than LT_POOL_MAX_SIZE fall through to malloc.
+// Chunks are never returned to the system, so the memory held by each
+// size class stays at its peak (see the chunks stat; each chunk is
+// 16KB).  This suits the engine's steady churn, but a pool used for a
+// Lua state keeps the heap's high water mark of small blocks until the
+// state is closed.
+// Not thread safe: only use from the main thread.
+
+#define LT_POOL_GRANULE     16
+#define LT_POOL_MAX_SIZE    512
+#define LT_POOL_NUM_CLASSES (LT_POOL_MAX_SIZE / LT_POOL_GRANULE)
+
+struct LTPoolStats {
+    int live;       // Blocks currently allocated.
+    int peak;       // Highest value live has reached.
+    int allocs;     // Total allocations.
+    int chunks;     // Chunks obtained from malloc.
+};
+
+struct LTPoolBlock;
+
+// Separate pools keep separate free lists and stats.  Zero
+// initialisation is a valid empty pool, so pools can be static.
+struct LTPool {
+    LTPoolBlock *free_lists[LT_POOL_NUM_CLASSES];
+    LTPoolStats class_stats[LT_POOL_NUM_CLASSES];
+    LTPoolStats large_stats;
+    LTPoolStats total_stats;
+
+    void *alloc(size_t size); // Aborts if out of memory.
+    void free(void *ptr, size_t size);
+    void reset_peak();
+};
+
+// The engine object pool.
+void *ltPoolAlloc(size_t size);
+void ltPoolFree(void *ptr, size_t size);
+
+// Totals over all size classes (including blocks that fell through
+// to malloc).
+void ltPoolGetStats(LTPoolStats *stats);
+// Stats for a single size class (0 <= cls < LT_POOL_NUM_CLASSES).
+void ltPoolGetClassStats(int cls, LTPoolStats *stats);
+void ltPoolResetPeak();
+
+// A lua_Alloc that allocates from the LTPool passed as ud.  Unlike
+// LTPool::alloc it returns NULL when out of memory, so Lua can raise
+// a memory error instead of the process aborting.  Shrinking never
+// fails: without memory for the smaller block the old one is kept.
+void *ltPoolLuaAlloc(void *ud, void *ptr, size_t osize, size_t nsize);
+
+// Place inside a class (with a virtual destructor if it's subclassed)
+// to route new/delete for it and its subclasses through the pool.
+// Placement new is still allowed so the class can live in Lua userdata.
+#define LT_POOLED_ALLOC \
+    static void *operator new(size_t size) { return ltPoolAlloc(size); } \
+    static void operator delete(void *ptr, size_t size) { ltPoolFree(ptr, size); } \
+    static void *operator new(size_t, void *ptr) { return ptr; } \
+    static void operator delete(void *, void *) {}
@@ -0,0 +1,183 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(ltprofile)
+
+LTGLCounters lt_gl_counters = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static bool enabled = false;
+static LTProfileFrame *frames = NULL; // Ring buffer.
+static int curr_frame = 0;          // Index of frame being recorded.
+static int num_completed = 0;
+static int frame_number = 0;
+static int open_events[LT_PROFILE_MAX_DEPTH];
+static int depth = 0;
+static int skipped_depth = 0;       // Begins past LT_PROFILE_MAX_DEPTH or the event limit.
+
+struct LTCStrLess {
+    bool operator()(const char *a, const char *b) const {
+        return strcmp(a, b) < 0;
+    }
+};
+static std::set<const char*, LTCStrLess> *interned_names = NULL;
+
+static void start_frame(LTdouble now) {
+    LTProfileFrame *f = &frames[curr_frame];
+    f->number = frame_number++;
+    f->start = now;
+    f->duration = 0.0;
+    f->num_events = 0;
+    f->dropped_events = 0;
+    memset(&lt_gl_counters, 0, sizeof(LTGLCounters));
+    depth = 0;
+    skipped_depth = 0;
+}
+
+void ltSetProfilerEnabled(bool e) {
+    if (e && !enabled) {
+        if (frames == NULL) {
+            frames = new LTProfileFrame[LT_PROFILE_MAX_FRAMES];
+        }
+        curr_frame = 0;
+        num_completed = 0;
+        start_frame(ltGetTime());
+    }
+    enabled = e;
+}
+
+bool ltProfilerEnabled() {
+    return enabled;
+}
+
+void ltProfileFrameBoundary() {
+    if (!enabled) {
+        memset(&lt_gl_counters, 0, sizeof(LTGLCounters));
+        return;
+    }
+    LTdouble now = ltGetTime();
+    LTProfileFrame *f = &frames[curr_frame];
+    // Close any events left open (e.g. by a Lua error).
+    while (depth > 0) {
+        ltProfileEnd();
+    }
+    f->duration = now - f->start;
+    f->gl = lt_gl_counters;
+    curr_frame = (curr_frame + 1) % LT_PROFILE_MAX_FRAMES;
+    if (num_completed < LT_PROFILE_MAX_FRAMES - 1) {
+        num_completed++;
+    }
+    start_frame(now);
+}
+
+void ltProfileBegin(const char *name) {
+    if (!enabled) {
+        return;
+    }
+    LTProfileFrame *f = &frames[curr_frame];
+    if (skipped_depth > 0 || depth >= LT_PROFILE_MAX_DEPTH || f->num_events >= LT_PROFILE_MAX_EVENTS) {
+        skipped_depth++;
+        f->dropped_events++;
+        return;
+    }
+    LTProfileEvent *e = &f->events[f->num_events];
+    e->name = name;
+    e->start = ltGetTime() - f->start;
+    e->duration = 0.0;
+    e->depth = depth;
+    open_events[depth++] = f->num_events++;
+}
+
+void ltProfileEnd() {
+    if (!enabled) {
+        return;
+    }
+    if (skipped_depth > 0) {
+        skipped_depth--;
+        return;
+    }
+    if (depth == 0) {
+        return;
+    }
+    LTProfileFrame *f = &frames[curr_frame];
+    LTProfileEvent *e = &f->events[open_events[--depth]];
+    e->duration = ltGetTime() - f->start - e->start;
+}
+
+const char *ltProfileInternName(const char *name) {
+    if (interned_names == NULL) {
+        interned_names = new std::set<const char*, LTCStrLess>();
+    }
+    std::set<const char*, LTCStrLess>::iterator it = interned_names->find(name);
+    if (it != interned_names->end()) {
+        return *it;
+    }
+    char *copy = strdup(name);
+    interned_names->insert(copy);
+    return copy;
+}
+
+int ltProfileNumFrames() {
+    return enabled ? num_completed : 0;
+}
+
+LTProfileFrame *ltProfileGetFrame(int i) {
+    if (i < 0 || i >= ltProfileNumFrames()) {
+        return NULL;
+    }
+    int index = (curr_frame - 1 - i + LT_PROFILE_MAX_FRAMES) % LT_PROFILE_MAX_FRAMES;
+    return &frames[index];
+}
+
+static void write_json_string(FILE *out, const char *str) {
+    fputc('"', out);
+    for (const char *c = str; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', out);
+            fputc(*c, out);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+bool ltProfileWriteTrace(const char *path) {
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        ltLog("Unable to open %s for writing: %s", path, strerror(errno));
+        return false;
+    }
+    int n = ltProfileNumFrames();
+    LTdouble origin = n > 0 ? ltProfileGetFrame(n - 1)->start : 0.0;
+    bool first = true;
+    fprintf(out, "{\"traceEvents\":[\n");
+    // Oldest first.
+    for (int i = n - 1; i >= 0; i--) {
+        LTProfileFrame *f = ltProfileGetFrame(i);
+        LTdouble frame_us = (f->start - origin) * 1.0e6;
+        fprintf(out, "%s{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+            "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"number\":%d}}",
+            first ? "" : ",\n", frame_us, f->duration * 1.0e6, f->number);
+        first = false;
+        for (int j = 0; j < f->num_events; j++) {
+            LTProfileEvent *e = &f->events[j];
+            fprintf(out, ",\n{\"name\":");
+            write_json_string(out, e->name);
+            fprintf(out, ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                frame_us + e->start * 1.0e6, e->duration * 1.0e6);
+        }
+        fprintf(out, ",\n{\"name\":\"gl\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.3f,"
+            "\"args\":{\"draw_calls\":%d,\"state_changes\":%d,\"texture_binds\":%d,\"vertices\":%d,"
+            "\"buffer_bytes\":%d,\"issued_calls\":%d,\"filtered_calls\":%d,"
+            "\"cull_tests\":%d,\"culled\":%d}}",
+            frame_us, f->gl.draw_calls, f->gl.state_changes, f->gl.texture_binds, f->gl.vertices,
+            f->gl.buffer_bytes, f->gl.issued_calls, f->gl.filtered_calls,
+            f->gl.cull_tests, f->gl.culled);
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    bool ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
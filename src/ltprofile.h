@@ -0,0 +1,71 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltprofile)
+
+// Frame profiler.  Records nested CPU timings for engine phases and
+// GL call counts for each frame into a ring buffer of recent frames.
+// Disabled by default; when disabled the timers cost a single branch.
+
+#define LT_PROFILE_MAX_FRAMES 120
+#define LT_PROFILE_MAX_EVENTS 512 // Per frame.
+#define LT_PROFILE_MAX_DEPTH  32
+
+struct LTGLCounters {
+    int draw_calls;
+    int state_changes;
+    int texture_binds;
+    int vertices;
+    int buffer_bytes;   // Uploaded to vertex buffers.
+    int issued_calls;   // All GL calls made.
+    int filtered_calls; // Calls dropped because GL was already in that state.
+    int cull_tests;     // Meshes tested against the view frustum.
+    int culled;         // Meshes not drawn because they were outside it.
+};
+
+// Updated by ltopengl.cpp and ltFrustumCull whether or not profiling is
+// enabled.
+extern LTGLCounters lt_gl_counters;
+
+struct LTProfileEvent {
+    const char *name;   // Must be a static or interned string.
+    LTdouble start;     // Seconds since the start of the frame.
+    LTdouble duration;
+    int depth;
+};
+
+struct LTProfileFrame {
+    int number;
+    LTdouble start;     // ltGetTime() at start of frame.
+    LTdouble duration;
+    LTGLCounters gl;
+    int num_events;
+    int dropped_events;
+    LTProfileEvent events[LT_PROFILE_MAX_EVENTS];
+};
+
+void ltSetProfilerEnabled(bool enabled);
+bool ltProfilerEnabled();
+
+// Marks the end of one frame and the start of the next.
+void ltProfileFrameBoundary();
+
+void ltProfileBegin(const char *name);
+void ltProfileEnd();
+
+// Returns a copy of name that lives as long as the program.
+const char *ltProfileInternName(const char *name);
+
+// Number of completed frames in the ring buffer.
+int ltProfileNumFrames();
+// i = 0 is the most recent completed frame.
+LTProfileFrame *ltProfileGetFrame(int i);
+
+// Writes the completed frames as Chrome trace event JSON
+// (load in chrome://tracing).  Returns false on I/O error.
+bool ltProfileWriteTrace(const char *path);
+
+struct LTProfileScope {
+    LTProfileScope(const char *name) { ltProfileBegin(name); }
+    ~LTProfileScope() { ltProfileEnd(); }
+};
+
+#define LT_PROFILE_SCOPE(name) LTProfileScope LT_CONCAT(lt_profile_scope_, __LINE__)(name)
@@ -180,6 +180,8 @@ struct LTCommandUpdateFile : LTCommand {
                 ltLog("Synced %s", file_name);
             }
             fclose(f);
+            // The file may be new.
+            ltResetResourceIndex();
         } else {
             ltLog("Unable to open %s for writing: %s", file_name, strerror(errno));
         }
@@ -22,3 +22,5 @@ struct LTRandomGenerator : LTObject {
 };
 
 bool ltRandomQuickCheck();
+
+LTRandomGenerator *lt_expect_LTRandomGenerator(lua_State *L, int arg);
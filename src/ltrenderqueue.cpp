@@ -0,0 +1,324 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(ltrenderqueue)
+
+void LTRenderQueue::begin(const LTfloat *modelview, LTfloat alpha, LTRenderState *state) {
+    items.clear();
+    order.clear();
+    groups.clear();
+    lights.clear();
+    memset(&stats, 0, sizeof(stats));
+    entry_state = *state;
+    entry_alpha = alpha;
+    LTRenderQueueFrame f;
+    memcpy(f.modelview, modelview, sizeof(f.modelview));
+    f.state = *state;
+    stack.clear();
+    stack.push_back(f);
+}
+
+void LTRenderQueue::push() {
+    stack.push_back(stack.back());
+}
+
+void LTRenderQueue::pop() {
+    stack.pop_back();
+}
+
+void LTRenderQueue::translate(LTfloat x, LTfloat y, LTfloat z) {
+    ltMatTranslate(stack.back().modelview, x, y, z);
+}
+
+void LTRenderQueue::rotate(LTdegrees angle, LTfloat x, LTfloat y, LTfloat z) {
+    ltMatRotate(stack.back().modelview, angle, x, y, z);
+}
+
+void LTRenderQueue::scale(LTfloat x, LTfloat y, LTfloat z) {
+    ltMatScale(stack.back().modelview, x, y, z);
+}
+
+void LTRenderQueue::mult(const LTfloat *m) {
+    LTfloat *mv = stack.back().modelview;
+    ltMatMultiply(mv, mv, m);
+}
+
+void LTRenderQueue::tint(LTfloat r, LTfloat g, LTfloat b, LTfloat a) {
+    // Same order of multiplication as ltPushTint.
+    LTColor *t = &stack.back().tint;
+    t->red = r * t->red;
+    t->green = g * t->green;
+    t->blue = b * t->blue;
+    t->alpha = a * t->alpha;
+}
+
+LTRenderState *LTRenderQueue::state() {
+    return &stack.back().state;
+}
+
+LTfloat LTRenderQueue::alpha() {
+    return stack.back().tint.alpha * entry_alpha;
+}
+
+LTfloat *LTRenderQueue::modelview() {
+    return stack.back().modelview;
+}
+
+// Returns how many of the GL states differ.
+static int state_diff(const LTRenderState *a, const LTRenderState *b) {
+    return (a->gl3d.depth_test != b->gl3d.depth_test)
+        + (a->gl3d.depth_mask != b->gl3d.depth_mask)
+        + (a->gl3d.cull != b->gl3d.cull)
+        + (a->gl3d.fog != b->gl3d.fog)
+        + (a->lighting.lighting != b->lighting.lighting)
+        + (a->lighting.material != b->lighting.material)
+        + (a->lighting.light != b->lighting.light)
+        + (a->blend != b->blend)
+        + (a->texture != b->texture);
+}
+
+void LTRenderQueue::add_light(LTLight *light) {
+    LTRenderQueueFrame *f = &stack.back();
+    LTQueuedLight l;
+    l.light = light;
+    memcpy(l.modelview, f->modelview, sizeof(l.modelview));
+    l.outer = f->state.lighting.light;
+    f->state.lighting.light = lights.size();
+    lights.push_back(l);
+}
+
+void LTRenderQueue::add(LTSceneNode *node, LTVec3 centre, bool transparent, LTtexid texture,
+    bool frustum_tested)
+{
+    LTRenderQueueFrame *f = &stack.back();
+    LTRenderItem item;
+    item.node = node;
+    memcpy(item.modelview, f->modelview, sizeof(item.modelview));
+    item.tint = f->tint;
+    item.state = f->state;
+    item.state.texture = texture;
+    item.frustum_tested = frustum_tested;
+    item.depth = -ltMatTransform(f->modelview, centre).z;
+    LT3DState *s = &f->state.gl3d;
+    item.transparent = transparent || alpha() < 1.0f
+        || !s->depth_test || !s->depth_mask || f->state.blend != LT_BLEND_MODE_NORMAL;
+    item.group = -1;
+    if (!item.transparent) {
+        // Items usually share state with recent ones, so search from the
+        // most recent group.
+        for (int g = groups.size() - 1; g >= 0; g--) {
+            if (state_diff(&groups[g], &item.state) == 0) {
+                item.group = g;
+                break;
+            }
+        }
+        if (item.group < 0) {
+            item.group = groups.size();
+            groups.push_back(item.state);
+        }
+    }
+    items.push_back(item);
+}
+
+struct LTRenderItemCmp {
+    std::vector<LTRenderItem> *items;
+    LTRenderItemCmp(std::vector<LTRenderItem> *its) { items = its; }
+    bool operator()(int i, int j) const {
+        const LTRenderItem *a = &(*items)[i];
+        const LTRenderItem *b = &(*items)[j];
+        if (a->transparent != b->transparent) {
+            return b->transparent;
+        }
+        if (a->transparent) {
+            return a->depth > b->depth;
+        }
+        if (a->group != b->group) {
+            return a->group < b->group;
+        }
+        return a->depth < b->depth;
+    }
+};
+
+void LTRenderQueue::sort() {
+    LT_PROFILE_SCOPE("render queue sort");
+    LTdouble t0 = ltGetTime();
+    int n = items.size();
+    order.resize(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), LTRenderItemCmp(&items));
+    stats.sort_time = ltGetTime() - t0;
+
+    stats.items = n;
+    for (int i = 0; i < n; i++) {
+        if (items[i].transparent) {
+            stats.transparent++;
+        }
+        if (i > 0) {
+            stats.unsorted_state_changes += state_diff(&items[i - 1].state, &items[i].state);
+            stats.state_changes += state_diff(&items[order[i - 1]].state, &items[order[i]].state);
+        }
+    }
+    stats.opaque = n - stats.transparent;
+}
+
+// Returns the number of lights from light out, filling chain with their
+// indices, outermost first.
+static int light_chain(std::vector<LTQueuedLight> *lights, int light, int *chain) {
+    int n = 0;
+    for (int l = light; l >= 0; l = (*lights)[l].outer) {
+        n++;
+    }
+    int i = n;
+    for (int l = light; l >= 0; l = (*lights)[l].outer) {
+        chain[--i] = l;
+    }
+    return n;
+}
+
+void LTRenderQueue::set_lights(int light, int current) {
+    std::vector<int> chain(lights.size());
+    std::vector<int> current_chain(lights.size());
+    int n = light_chain(&lights, light, &chain[0]);
+    int current_n = light_chain(&lights, current, &current_chain[0]);
+    // Lights are numbered from the outside in, as when drawn, so the
+    // outer lights the two share are already set up.
+    int same = 0;
+    while (same < n && same < current_n && chain[same] == current_chain[same]) {
+        same++;
+    }
+    for (int i = same; i < n; i++) {
+        LTQueuedLight *l = &lights[chain[i]];
+        ltLoadMatrix(l->modelview);
+        l->light->setup(first_light_num + i);
+    }
+    for (int i = n; i < current_n; i++) {
+        ltDisableLight(first_light_num + i);
+    }
+    // For any lights in nodes drawn whole.
+    ltSetNextLightNum(first_light_num + n);
+}
+
+void LTRenderQueue::draw() {
+    ltPushMatrix();
+    first_light_num = ltNextLightNum();
+    int light = -1;
+    for (unsigned int i = 0; i < order.size(); i++) {
+        LTRenderItem *item = &items[order[i]];
+        // Nodes drawn whole may change state, so every item sets all of
+        // its own.  Unchanged state is filtered out by ltopengl.cpp.
+        ltSet3DState(&item->state.gl3d);
+        ltSetLightingState(&item->state.lighting);
+        if (item->state.lighting.light != light) {
+            set_lights(item->state.lighting.light, light);
+            light = item->state.lighting.light;
+        }
+        ltPushBlendMode(item->state.blend);
+        ltPushTint(item->tint.red, item->tint.green, item->tint.blue, item->tint.alpha);
+        ltLoadMatrix(item->modelview);
+        if (item->frustum_tested) {
+            bool prev_culling = ltSetFrustumCulling(false);
+            item->node->draw();
+            ltSetFrustumCulling(prev_culling);
+        } else {
+            item->node->draw();
+        }
+        ltPopTint();
+        ltPopBlendMode();
+    }
+    if (light != -1) {
+        set_lights(-1, light);
+    }
+    ltSet3DState(&entry_state.gl3d);
+    ltSetLightingState(&entry_state.lighting);
+    ltPopMatrix();
+}
+
+static void begin_queue(LTRenderQueueNode *node, const LTfloat *modelview) {
+    LTRenderState state;
+    ltGet3DState(&state.gl3d);
+    ltGetLightingState(&state.lighting);
+    state.blend = ltPeekBlendMode();
+    state.texture = 0;
+    LTColor tint;
+    ltPeekTint(&tint);
+    node->queue.begin(modelview, tint.alpha, &state);
+    if (node->child != NULL) {
+        node->child->enqueue(&node->queue);
+    }
+    node->queue.sort();
+}
+
+void LTRenderQueueNode::draw() {
+    if (child != NULL) {
+        LTfloat modelview[16];
+        ltGetMatrix(LT_MATRIX_MODE_MODELVIEW, modelview);
+        begin_queue(this, modelview);
+        queue.draw();
+    }
+}
+
+// Returns a table describing the items in draw order, as they would be
+// queued with an identity modelview matrix.  Each entry has the item's
+// depth, whether it's transparent and the node's index in the
+// arguments, if it was passed (nil otherwise).
+static int draw_order(lua_State *L) {
+    int nargs = ltLuaCheckNArgs(L, 1);
+    LTRenderQueueNode *node = lt_expect_LTRenderQueueNode(L, 1);
+    LTfloat identity[16];
+    ltMatIdentity(identity);
+    begin_queue(node, identity);
+    std::vector<LTRenderItem> *items = &node->queue.items;
+    lua_createtable(L, node->queue.order.size(), 0);
+    for (unsigned int i = 0; i < node->queue.order.size(); i++) {
+        LTRenderItem *item = &(*items)[node->queue.order[i]];
+        lua_createtable(L, 0, 3);
+        lua_pushnumber(L, item->depth);
+        lua_setfield(L, -2, "depth");
+        lua_pushboolean(L, item->transparent);
+        lua_setfield(L, -2, "transparent");
+        for (int arg = 2; arg <= nargs; arg++) {
+            if (lua_touserdata(L, arg) == item->node) {
+                lua_pushinteger(L, arg - 1);
+                lua_setfield(L, -2, "node");
+                break;
+            }
+        }
+        lua_rawseti(L, -2, i + 1);
+    }
+    return 1;
+}
+
+static LTint get_items(LTObject *obj) {
+    return ((LTRenderQueueNode*)obj)->queue.stats.items;
+}
+
+static LTint get_opaque(LTObject *obj) {
+    return ((LTRenderQueueNode*)obj)->queue.stats.opaque;
+}
+
+static LTint get_transparent(LTObject *obj) {
+    return ((LTRenderQueueNode*)obj)->queue.stats.transparent;
+}
+
+static LTint get_state_changes(LTObject *obj) {
+    return ((LTRenderQueueNode*)obj)->queue.stats.state_changes;
+}
+
+static LTint get_unsorted_state_changes(LTObject *obj) {
+    return ((LTRenderQueueNode*)obj)->queue.stats.unsorted_state_changes;
+}
+
+static LTfloat get_sort_time(LTObject *obj) {
+    return ((LTRenderQueueNode*)obj)->queue.stats.sort_time;
+}
+
+LT_REGISTER_TYPE(LTRenderQueueNode, "lt.RenderQueue", "lt.Wrap")
+LT_REGISTER_PROPERTY_INT_NOCONS(LTRenderQueueNode, items, &get_items, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTRenderQueueNode, opaque, &get_opaque, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTRenderQueueNode, transparent, &get_transparent, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTRenderQueueNode, state_changes, &get_state_changes, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTRenderQueueNode, unsorted_state_changes, &get_unsorted_state_changes, NULL);
+LT_REGISTER_PROPERTY_FLOAT_NOCONS(LTRenderQueueNode, sort_time, &get_sort_time, NULL);
+LT_REGISTER_METHOD(LTRenderQueueNode, DrawOrder, draw_order)
@@ -0,0 +1,123 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltrenderqueue)
+
+// A render queue draws a subtree in an order chosen for the GPU rather
+// than scene order.  The subtree is first walked on the CPU (see
+// LTSceneNode::enqueue), which records each drawable node with its
+// modelview matrix, tint and GL state.  Items are then split in two:
+//
+// - Opaque items (meshes with no translucent colours that aren't marked
+//   translucent, drawn with depth testing and depth writes on and the
+//   normal blend mode) are drawn first, grouped by state so that GL
+//   state changes between them are few, and front to back within a
+//   group so the depth test rejects hidden fragments early.  Groups
+//   are drawn in the order their states first appear in the scene.
+// - Everything else is drawn afterwards, back to front, so blending
+//   comes out right.  Items at the same depth keep scene order.
+//
+// lt.Light nodes are recorded with the modelview matrix they were
+// queued with, and each item's state refers to the lights enclosing it,
+// so lights are set up again only between items lit differently.
+//
+// Nodes that don't implement enqueue are drawn whole, as one
+// transparent item placed at their origin.  A queue is meant to sit
+// just under an lt.Perspective node.
+
+struct LTRenderState {
+    LT3DState gl3d;
+    LTLightingState lighting;
+    LTBlendMode blend;
+    LTtexid texture;        // 0 if untextured.
+};
+
+struct LTRenderItem {
+    LTSceneNode *node;
+    LTfloat modelview[16];
+    LTColor tint;           // Relative to the tint when the queue is drawn.
+    LTRenderState state;
+    LTfloat depth;          // Distance in front of the eye.
+    bool transparent;
+    bool frustum_tested;    // Already passed ltFrustumCull, so not tested again when drawn.
+    int group;              // Index of the state in LTRenderQueue::groups if opaque.
+};
+
+struct LTQueuedLight {
+    LTLight *light;
+    LTfloat modelview[16];
+    int outer;              // Index of the enclosing queued light, or -1.
+};
+
+struct LTRenderQueueStats {
+    int items;
+    int opaque;
+    int transparent;
+    int state_changes;          // Between consecutive items, in draw order.
+    int unsorted_state_changes; // The same, had items been drawn in scene order.
+    LTdouble sort_time;         // Seconds.
+};
+
+struct LTRenderQueueFrame {
+    LTfloat modelview[16];
+    LTColor tint;
+    LTRenderState state;
+};
+
+struct LTRenderQueue {
+    std::vector<LTRenderItem> items;
+    std::vector<int> order;     // Indices into items, in draw order.
+    std::vector<LTRenderState> groups; // Distinct opaque states, in scene order.
+    std::vector<LTQueuedLight> lights;
+    LTRenderQueueStats stats;
+
+    // Starts a new queue whose items are relative to the given
+    // modelview matrix, tint alpha and state.
+    void begin(const LTfloat *modelview, LTfloat alpha, LTRenderState *state);
+
+    // These mirror the matrix, tint and state stacks used when drawing.
+    void push();
+    void pop();
+    void translate(LTfloat x, LTfloat y, LTfloat z);
+    void rotate(LTdegrees angle, LTfloat x, LTfloat y, LTfloat z);
+    void scale(LTfloat x, LTfloat y, LTfloat z);
+    void mult(const LTfloat *m);
+    void tint(LTfloat r, LTfloat g, LTfloat b, LTfloat a);
+    // The state nodes in the subtree may change.  Changes last until the
+    // enclosing pop().
+    LTRenderState *state();
+    // The tint alpha, including that of the enclosing tints.
+    LTfloat alpha();
+    LTfloat *modelview();
+
+    // Adds a light, at the current modelview matrix, to the state.
+    void add_light(LTLight *light);
+
+    // centre is in node coordinates and is used for the item's depth.
+    // The item is transparent if any of the state makes it so,
+    // regardless of the transparent argument.
+    void add(LTSceneNode *node, LTVec3 centre, bool transparent, LTtexid texture = 0,
+        bool frustum_tested = false);
+
+    // Fills order and stats.
+    void sort();
+    // Draws the items in order, then restores the state passed to begin.
+    void draw();
+
+private:
+    std::vector<LTRenderQueueFrame> stack;
+    LTRenderState entry_state;
+    LTfloat entry_alpha;
+    int first_light_num;    // GL light used by the outermost queued light.
+
+    // Sets up the queued lights enclosing light (an index into lights),
+    // replacing those enclosing the one given as current.
+    void set_lights(int light, int current);
+};
+
+// Queues its child's subtree each frame and draws it sorted.
+struct LTRenderQueueNode : LTWrapNode {
+    LTRenderQueue queue;
+
+    virtual void draw();
+};
+
+LTRenderQueueNode *lt_expect_LTRenderQueueNode(lua_State *L, int arg);
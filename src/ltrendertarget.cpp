@@ -3,15 +3,117 @@
 
 LT_INIT_IMPL(ltrendertarget)
 
+static std::list<LTRenderTargetBuffer*> pool; // Most recently released first.
+static int num_renders = 0;
+static int num_skips = 0;
+
+static int buffer_bytes(LTRenderTargetBuffer *buf) {
+    return buf->width * buf->height * 4;
+}
+
+static LTRenderTargetBuffer *new_buffer(int width, int height) {
+    LTRenderTargetBuffer *buf = new LTRenderTargetBuffer();
+    buf->width = width;
+    buf->height = height;
+    buf->in_use = false;
+    buf->texture_id = ltGenTexture();
+    ltBindTexture(buf->texture_id);
+    ltTexImage(width, height, NULL);
+    buf->fbo = ltGenFramebuffer();
+    ltBindFramebuffer(buf->fbo);
+    ltFramebufferTexture(buf->texture_id);
+    if (!ltFramebufferComplete()) {
+        ltLog("Unable to create frame buffer of size %dx%d", width, height);
+        ltAbort();
+    }
+    ltBindFramebuffer(0);
+    return buf;
+}
+
+static void delete_buffer(LTRenderTargetBuffer *buf) {
+    ltDeleteFramebuffer(buf->fbo);
+    ltDeleteTexture(buf->texture_id);
+    delete buf;
+}
+
+static LTRenderTargetBuffer *acquire(int width, int height) {
+    int tex_width, tex_height;
+    if (ltNPOTTexturesSupported()) {
+        int align = LT_RENDER_TARGET_POOL_ALIGN;
+        tex_width = ((width + align - 1) / align) * align;
+        tex_height = ((height + align - 1) / align) * align;
+        if (tex_width < align) tex_width = align;
+        if (tex_height < align) tex_height = align;
+    } else {
+        tex_width = 64;
+        tex_height = 64;
+        while (tex_width < width) tex_width <<= 1;
+        while (tex_height < height) tex_height <<= 1;
+    }
+    LTRenderTargetBuffer *best = NULL;
+    std::list<LTRenderTargetBuffer*>::iterator it;
+    for (it = pool.begin(); it != pool.end(); it++) {
+        LTRenderTargetBuffer *buf = *it;
+        if (!buf->in_use && buf->width >= tex_width && buf->height >= tex_height
+            && buf->width * buf->height <= 2 * tex_width * tex_height
+            && (best == NULL || buf->width * buf->height < best->width * best->height))
+        {
+            best = buf;
+        }
+    }
+    if (best == NULL) {
+        best = new_buffer(tex_width, tex_height);
+        pool.push_front(best);
+    }
+    best->in_use = true;
+    return best;
+}
+
+static void release(LTRenderTargetBuffer *buf) {
+    buf->in_use = false;
+    pool.remove(buf);
+    pool.push_front(buf);
+    // Drop the least recently released free buffers over the limit.
+    int free_bytes = 0;
+    std::list<LTRenderTargetBuffer*>::iterator it = pool.begin();
+    while (it != pool.end()) {
+        LTRenderTargetBuffer *b = *it;
+        if (!b->in_use) {
+            free_bytes += buffer_bytes(b);
+            if (free_bytes > LT_RENDER_TARGET_POOL_MAX_FREE_BYTES) {
+                delete_buffer(b);
+                it = pool.erase(it);
+                continue;
+            }
+        }
+        it++;
+    }
+}
+
+void ltGetRenderTargetStats(LTRenderTargetStats *stats) {
+    memset(stats, 0, sizeof(LTRenderTargetStats));
+    stats->renders = num_renders;
+    stats->skips = num_skips;
+    std::list<LTRenderTargetBuffer*>::iterator it;
+    for (it = pool.begin(); it != pool.end(); it++) {
+        int bytes = buffer_bytes(*it);
+        stats->buffers++;
+        stats->bytes += bytes;
+        if (!(*it)->in_use) {
+            stats->free_buffers++;
+            stats->free_bytes += bytes;
+        }
+    }
+}
+
 struct LTRenderTargetAction : LTAction {
     LTRenderTarget *rt;
     LTRenderTargetAction(LTSceneNode *node) : LTAction(node) {
         rt = (LTRenderTarget*)node;
     };
     virtual bool doAction(LTfloat dt) {
-        if (rt->child != NULL) {
-            LTColor clear_color(0, 0, 0, 0);
-            rt->renderNode(rt->child, &clear_color);
+        if (rt->child != NULL && !rt->update()) {
+            num_skips++;
         }
         return false;
     }
@@ -22,9 +124,26 @@ LTRenderTarget::LTRenderTarget() {
     magfilter = LT_TEXTURE_FILTER_LINEAR;
     depthbuf_enabled = false;
     initialized = false;
+    buffer = NULL;
+    dirty = true;
+    always_render = false;
+    rendered_epoch = 0;
+    render_count = 0;
     add_action(new LTRenderTargetAction(this));
 }
 
+void LTRenderTarget::acquire_buffer() {
+    buffer = acquire(width, height);
+    tex_width = buffer->width;
+    tex_height = buffer->height;
+    texture_id = buffer->texture_id;
+    fbo = buffer->fbo;
+    ltBindTexture(texture_id);
+    ltTextureMinFilter(minfilter);
+    ltTextureMagFilter(magfilter);
+    dirty = true;
+}
+
 void LTRenderTarget::init(lua_State *L) {
     LTTexturedNode::init(L);
     if (vp_x1 == 0.0f && vp_x2 == 0.0f) {
@@ -48,27 +167,40 @@ void LTRenderTarget::init(lua_State *L) {
         wld_y2 = world_height * 0.5f;
     }
 
-    // Compute dimensions of target texture (must be powers of 2).
-    tex_width = 64;
-    tex_height = 64;
-    while (tex_width < width) tex_width <<= 1;
-    while (tex_height < height) tex_height <<= 1;
-
-    // Generate texture.
-    texture_id = ltGenTexture();
-    ltBindTexture(texture_id);
-    ltTextureMinFilter(minfilter);
-    ltTextureMagFilter(magfilter);
-    ltTexImage(tex_width, tex_height, NULL);
-
+    acquire_buffer();
     setup();
 
     initialized = true;
 }
 
 LTRenderTarget::~LTRenderTarget() {
-    ltDeleteFramebuffer(fbo);
-    ltDeleteTexture(texture_id);
+    if (buffer != NULL) {
+        release(buffer);
+    }
+}
+
+bool LTRenderTarget::update() {
+    if (child == NULL || !initialized) {
+        return false;
+    }
+    if (!dirty && !always_render && ltSubtreeLastChange(child) < rendered_epoch) {
+        return false;
+    }
+    // Changes made from here on (including while rendering) are
+    // picked up next time.
+    rendered_epoch = ltNextChangeEpoch();
+    dirty = false;
+    LTColor clear_color(0, 0, 0, 0);
+    renderNode(child, &clear_color);
+    render_count++;
+    num_renders++;
+    changed();
+    return true;
+}
+
+int LTRenderTarget::last_change() {
+    update();
+    return change_stamp;
 }
 
 void LTRenderTarget::renderNode(LTSceneNode *node, LTColor *clear_color) {
@@ -83,6 +215,7 @@ void LTRenderTarget::renderNode(LTSceneNode *node, LTColor *clear_color) {
     ltFinishRendering();
 }
 
+// Frame buffers aren't shared between contexts, but textures are.
 void LTRenderTarget::preContextChange() {
     ltDeleteVertBuffer(texbuf);
     ltDeleteVertBuffer(vertbuf);
@@ -90,15 +223,20 @@ void LTRenderTarget::preContextChange() {
 }
 
 void LTRenderTarget::postContextChange() {
+    fbo = ltGenFramebuffer();
+    ltBindFramebuffer(fbo);
+    ltFramebufferTexture(texture_id);
+    buffer->fbo = fbo;
     setup();
+    dirty = true;
 }
 
 static void setup_texture_coords(LTRenderTarget *target) {
     // Set up texture coords for drawing.
-    int texel_w = LT_MAX_TEX_COORD / target->tex_width;
-    int texel_h = LT_MAX_TEX_COORD / target->tex_height;
-    LTtexcoord tex_right = target->width * texel_w;
-    LTtexcoord tex_top = target->height * texel_h;
+    // The texture size need not be a power of 2, so avoid rounding the
+    // texel size.
+    LTtexcoord tex_right = target->width * LT_MAX_TEX_COORD / target->tex_width;
+    LTtexcoord tex_top = target->height * LT_MAX_TEX_COORD / target->tex_height;
     target->tex_coords[0] = 0;          target->tex_coords[1] = 0;
     target->tex_coords[2] = tex_right;  target->tex_coords[3] = 0;
     target->tex_coords[4] = tex_right;  target->tex_coords[5] = tex_top;
@@ -108,17 +246,6 @@ static void setup_texture_coords(LTRenderTarget *target) {
 }
 
 void LTRenderTarget::setup() {
-    // Generate frame buffer.
-    fbo = ltGenFramebuffer();
-    ltBindFramebuffer(fbo);
-
-    // Attach texture to frame buffer.
-    ltFramebufferTexture(texture_id);
-    if (!ltFramebufferComplete()) {
-        ltLog("Unable to create frame buffer of size %dx%d", tex_width, tex_height);
-        ltAbort();
-    }
-
     texbuf = ltGenVertBuffer();
     setup_texture_coords(this);
 
@@ -140,11 +267,20 @@ static LTint get_pheight(LTObject *obj) {
     return ((LTRenderTarget*)obj)->height;
 }
 
+static void resize(LTRenderTarget *target) {
+    if (target->width > target->tex_width || target->height > target->tex_height) {
+        release(target->buffer);
+        target->acquire_buffer();
+    }
+    setup_texture_coords(target);
+    target->dirty = true;
+}
+
 static void set_pwidth(LTObject *obj, LTint val) {
     LTRenderTarget *target = (LTRenderTarget*)obj;
     target->width = val;
     if (target->initialized) {
-        setup_texture_coords(target);
+        resize(target);
     }
 }
 
@@ -152,10 +288,56 @@ static void set_pheight(LTObject *obj, LTint val) {
     LTRenderTarget *target = (LTRenderTarget*)obj;
     target->height = val;
     if (target->initialized) {
-        setup_texture_coords(target);
+        resize(target);
     }
 }
 
+static LTint get_render_count(LTObject *obj) {
+    return ((LTRenderTarget*)obj)->render_count;
+}
+
+// The viewport only affects the rendered texture, which isn't
+// re-rendered unless the target is dirty.
+static LTfloat get_vp_x1(LTObject *obj) {
+    return ((LTRenderTarget*)obj)->vp_x1;
+}
+
+static void set_vp_x1(LTObject *obj, LTfloat val) {
+    LTRenderTarget *target = (LTRenderTarget*)obj;
+    target->vp_x1 = val;
+    target->dirty = true;
+}
+
+static LTfloat get_vp_y1(LTObject *obj) {
+    return ((LTRenderTarget*)obj)->vp_y1;
+}
+
+static void set_vp_y1(LTObject *obj, LTfloat val) {
+    LTRenderTarget *target = (LTRenderTarget*)obj;
+    target->vp_y1 = val;
+    target->dirty = true;
+}
+
+static LTfloat get_vp_x2(LTObject *obj) {
+    return ((LTRenderTarget*)obj)->vp_x2;
+}
+
+static void set_vp_x2(LTObject *obj, LTfloat val) {
+    LTRenderTarget *target = (LTRenderTarget*)obj;
+    target->vp_x2 = val;
+    target->dirty = true;
+}
+
+static LTfloat get_vp_y2(LTObject *obj) {
+    return ((LTRenderTarget*)obj)->vp_y2;
+}
+
+static void set_vp_y2(LTObject *obj, LTfloat val) {
+    LTRenderTarget *target = (LTRenderTarget*)obj;
+    target->vp_y2 = val;
+    target->dirty = true;
+}
+
 void LTRenderTarget::visit_children(LTSceneNodeVisitor *v, bool reverse) {
     if (child != NULL) {
         v->visit(child);
@@ -177,16 +359,17 @@ static void set_child(LTObject *obj, LTObject *val) {
     if (new_child != NULL) {
         new_child->enter(rt);
     }
+    rt->dirty = true;
 }
 
 LT_REGISTER_TYPE(LTRenderTarget, "lt.RenderTarget", "lt.TexturedNode")
 LT_REGISTER_PROPERTY_OBJ(LTRenderTarget, child, LTSceneNode, get_child, set_child);
 LT_REGISTER_PROPERTY_INT(LTRenderTarget, pwidth, &get_pwidth, &set_pwidth);
 LT_REGISTER_PROPERTY_INT(LTRenderTarget, pheight, &get_pheight, &set_pheight);
-LT_REGISTER_FIELD_FLOAT(LTRenderTarget, vp_x1)
-LT_REGISTER_FIELD_FLOAT(LTRenderTarget, vp_y1)
-LT_REGISTER_FIELD_FLOAT(LTRenderTarget, vp_x2)
-LT_REGISTER_FIELD_FLOAT(LTRenderTarget, vp_y2)
+LT_REGISTER_PROPERTY_FLOAT(LTRenderTarget, vp_x1, &get_vp_x1, &set_vp_x1);
+LT_REGISTER_PROPERTY_FLOAT(LTRenderTarget, vp_y1, &get_vp_y1, &set_vp_y1);
+LT_REGISTER_PROPERTY_FLOAT(LTRenderTarget, vp_x2, &get_vp_x2, &set_vp_x2);
+LT_REGISTER_PROPERTY_FLOAT(LTRenderTarget, vp_y2, &get_vp_y2, &set_vp_y2);
 LT_REGISTER_FIELD_FLOAT(LTRenderTarget, wld_x1)
 LT_REGISTER_FIELD_FLOAT(LTRenderTarget, wld_y1)
 LT_REGISTER_FIELD_FLOAT(LTRenderTarget, wld_x2)
@@ -197,3 +380,7 @@ static const LTEnumConstant RenderTarget_filter_enum_vals[] = {
     {NULL, 0}};
 LT_REGISTER_FIELD_ENUM(LTRenderTarget, minfilter, LTTextureFilter, RenderTarget_filter_enum_vals)
 LT_REGISTER_FIELD_ENUM(LTRenderTarget, magfilter, LTTextureFilter, RenderTarget_filter_enum_vals)
+// After the constructor arguments above, so they keep their positions.
+LT_REGISTER_PROPERTY_INT(LTRenderTarget, render_count, &get_render_count, NULL);
+LT_REGISTER_FIELD_BOOL(LTRenderTarget, dirty)
+LT_REGISTER_FIELD_BOOL(LTRenderTarget, always_render)
@@ -1,6 +1,34 @@
 /* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
 LT_INIT_DECL(ltrendertarget)
 
+// Render target textures and their frame buffers come from a shared
+// pool.  A target gets the smallest free buffer that fits it without
+// wasting more than half its area, or a new one.  Released buffers are
+// kept for reuse, up to LT_RENDER_TARGET_POOL_MAX_FREE_BYTES.
+#define LT_RENDER_TARGET_POOL_MAX_FREE_BYTES (4 * 1024 * 1024)
+// New buffer sizes are rounded up to a multiple of this when non power
+// of 2 textures are supported, so similar sizes can share buffers.
+#define LT_RENDER_TARGET_POOL_ALIGN 16
+
+struct LTRenderTargetBuffer {
+    LTtexid     texture_id;
+    LTframebuf  fbo;
+    int         width;
+    int         height;
+    bool        in_use;
+};
+
+struct LTRenderTargetStats {
+    int renders;        // Times a target's child was rendered.
+    int skips;          // Frames a target was skipped as unchanged.
+    int buffers;        // Pooled buffers, in use or free.
+    int bytes;
+    int free_buffers;
+    int free_bytes;
+};
+
+void ltGetRenderTargetStats(LTRenderTargetStats *stats);
+
 struct LTRenderTarget : LTTexturedNode {
     LTframebuf      fbo;
     bool            depthbuf_enabled;
@@ -8,12 +36,15 @@ struct LTRenderTarget : LTTexturedNode {
     LTint             width;
     LTint             height;
 
-    // The target texture dimensions must be powers of 2, so may
-    // be different from the specified width and height.
-    // These are also used for the dimensions of the depth buffer.
+    // The target texture may be larger than the specified width and
+    // height (it's rounded up to a power of 2 if that's required, and
+    // may come from the pool).  These are also used for the dimensions
+    // of the depth buffer.
     LTint             tex_width;
     LTint             tex_height;
 
+    LTRenderTargetBuffer *buffer;
+
     // Viewport
     LTfloat vp_x1;
     LTfloat vp_y1;
@@ -33,6 +64,15 @@ struct LTRenderTarget : LTTexturedNode {
 
     LTSceneNode *child;
 
+    // The child is only re-rendered when dirty or always_render is set,
+    // or something in its subtree has changed since the last render
+    // (see ltSubtreeLastChange).  Setting the viewport from Lua sets
+    // dirty.
+    bool dirty;
+    bool always_render;
+    int rendered_epoch;
+    int render_count;
+
     LTRenderTarget();
     virtual ~LTRenderTarget();
 
@@ -43,6 +83,16 @@ struct LTRenderTarget : LTTexturedNode {
     // the given color first (clear_color may be NULL).
     void renderNode(LTSceneNode *node, LTColor *clear_color);
 
+    // Re-renders the child if required.  Returns whether it did.
+    bool update();
+
+    // Nested targets are brought up to date first, so targets that
+    // draw them see the new contents.
+    virtual int last_change();
+
+    // Takes a buffer big enough for width x height from the pool.
+    void acquire_buffer();
+
     virtual void preContextChange();
     virtual void postContextChange();
 
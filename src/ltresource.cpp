@@ -36,7 +36,7 @@ void ltCloseResource(LTResource *rsc) {
     delete rsc;
 }
 
-bool ltResourceExists(const char* filename) {
+static bool check_file(const char* filename) {
     // XXX What's the overhead of this?
     AAsset* asset = AAssetManager_open(asset_mgr, filename, AASSET_MODE_STREAMING);
     if (asset != NULL) {
@@ -47,6 +47,20 @@ bool ltResourceExists(const char* filename) {
     }
 }
 
+// Calls add for each file in dir.  Returns false if dir can't be listed.
+static bool list_dir(const char *dir, void (*add)(void*, const char*), void *data) {
+    AAssetDir *adir = AAssetManager_openDir(asset_mgr, dir);
+    if (adir == NULL) {
+        return false;
+    }
+    const char *name;
+    while ((name = AAssetDir_getNextFileName(adir)) != NULL) {
+        add(data, name);
+    }
+    AAssetDir_close(adir);
+    return true;
+}
+
 #else
 
 LTResource *ltOpenResource(const char* filename) {
@@ -77,12 +91,173 @@ void ltCloseResource(LTResource *rsc) {
     delete rsc;
 }
 
-bool ltResourceExists(const char* filename) {
+static bool check_file(const char* filename) {
     return ltFileExists(filename);
 }
 
+static bool list_dir(const char *dir, void (*add)(void*, const char*), void *data) {
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        return false;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        add(data, entry->d_name);
+    }
+    closedir(d);
+    return true;
+}
+
+#endif
+
+#if defined(LTOSX) || defined(LTMINGW)
+// These filesystems are case-insensitive by default, so the index
+// ignores (ASCII) case too.
+#define FOLD_CASE 1
 #endif
 
+#ifdef FOLD_CASE
+static inline char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+#endif
+
+struct LTResourceNameLess {
+    bool operator()(const char *a, const char *b) const {
+        #ifdef FOLD_CASE
+            while (*a != '\0' && fold(*a) == fold(*b)) {
+                a++;
+                b++;
+            }
+            return fold(*a) < fold(*b);
+        #else
+            return strcmp(a, b) < 0;
+        #endif
+    }
+};
+
+typedef std::set<char*, LTResourceNameLess> LTResourceNames;
+
+struct LTResourceDir {
+    bool listed;
+    LTResourceNames names;
+};
+
+typedef std::map<char*, LTResourceDir*, LTResourceNameLess> LTResourceIndex;
+
+static bool index_enabled = true;
+static LTResourceIndex resource_index;
+static LTResourceStats resource_stats = {0, 0, 0};
+
+static char *copy_str(const char *str, int len) {
+    char *copy = new char[len + 1];
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+static void add_name(void *data, const char *name) {
+    LTResourceNames *names = (LTResourceNames*)data;
+    if (names->find((char*)name) == names->end()) {
+        names->insert(copy_str(name, strlen(name)));
+    }
+}
+
+// Returns the index entry for the first dir_len characters of path,
+// listing the directory if it hasn't been already.
+static LTResourceDir *get_dir(const char *path, int dir_len) {
+    char *dir = copy_str(path, dir_len);
+    LTResourceIndex::iterator it = resource_index.find(dir);
+    if (it != resource_index.end()) {
+        delete[] dir;
+        return it->second;
+    }
+    LTResourceDir *d = new LTResourceDir();
+    #ifdef LTANDROID
+        const char *list_path = dir;
+    #else
+        const char *list_path = dir_len == 0 ? "." : dir;
+    #endif
+    d->listed = list_dir(list_path, &add_name, &d->names);
+    resource_stats.dir_reads++;
+    resource_index[dir] = d;
+    return d;
+}
+
+// Looks path up in the index.  *listed is set to false if its
+// directory can't be listed.
+static bool index_lookup(const char *path, bool *listed) {
+    const char *slash = strrchr(path, '/');
+    const char *base = path;
+    int dir_len = 0;
+    if (slash != NULL) {
+        base = slash + 1;
+        // Keep the slash only for the root directory.
+        dir_len = slash == path ? 1 : slash - path;
+        #ifdef LTMINGW
+            if (dir_len == 2 && path[1] == ':') {
+                dir_len = 3; // Drive root.
+            }
+        #endif
+    }
+    LTResourceDir *dir = get_dir(path, dir_len);
+    *listed = dir->listed;
+    return dir->listed && dir->names.find((char*)base) != dir->names.end();
+}
+
+bool ltResourceExists(const char* filename) {
+    resource_stats.exists_calls++;
+    if (index_enabled) {
+        bool listed;
+        #ifdef LTMINGW
+            // Either separator may be used.
+            char *path = copy_str(filename, strlen(filename));
+            for (char *c = path; *c != '\0'; c++) {
+                if (*c == '\\') {
+                    *c = '/';
+                }
+            }
+            bool found = index_lookup(path, &listed);
+            delete[] path;
+        #else
+            bool found = index_lookup(filename, &listed);
+        #endif
+        if (found) {
+            return true;
+        }
+        #ifndef LTDEVMODE
+            if (listed) {
+                return false;
+            }
+        #endif
+        // In dev mode files may be created after their directory was
+        // listed, so misses are checked too.
+    }
+    resource_stats.file_checks++;
+    return check_file(filename);
+}
+
+void ltSetResourceIndexEnabled(bool enabled) {
+    index_enabled = enabled;
+}
+
+void ltResetResourceIndex() {
+    LTResourceIndex::iterator it;
+    for (it = resource_index.begin(); it != resource_index.end(); it++) {
+        LTResourceNames::iterator nit;
+        for (nit = it->second->names.begin(); nit != it->second->names.end(); nit++) {
+            delete[] *nit;
+        }
+        delete it->second;
+        delete[] it->first;
+    }
+    resource_index.clear();
+}
+
+void ltGetResourceStats(LTResourceStats *stats) {
+    *stats = resource_stats;
+}
+
 char* ltReadTextResource(const char *path, int *len) {
     LTResource *rsc = ltOpenResource(path);
     if (rsc == NULL) {
@@ -19,6 +19,27 @@ LTResource *ltOpenResource(const char* filename);
 
 bool ltResourceExists(const char* filename);
 
+// ltResourceExists answers from an index of directory entries.  A
+// directory is listed the first time a path in it is checked, so probing
+// many candidate names (see image_path in ltlua.cpp) costs one directory
+// read rather than a filesystem check per name.  Directories that can't
+// be listed fall back to checking each path, as do misses in dev mode
+// (LTDEVMODE), so files created since the listing are found.  Names
+// are matched exactly on Linux, iOS and Android, but ignoring case on
+// macOS and Windows, where backslash is also a separator.
+void ltSetResourceIndexEnabled(bool enabled);
+// Forgets all directory listings.  Must be called when resource files
+// are added or removed (the dev server does this after syncing a file).
+void ltResetResourceIndex();
+
+struct LTResourceStats {
+    int exists_calls;   // Calls to ltResourceExists.
+    int file_checks;    // Filesystem (or asset manager) checks for a single path.
+    int dir_reads;      // Directories listed.
+};
+
+void ltGetResourceStats(LTResourceStats *stats);
+
 // Returns bytes read, < 0 on error.
 int ltReadResource(LTResource *rsc, void* buf, int count);
 
@@ -8,13 +8,52 @@ LT_INIT_IMPL(ltscene)
 
 //static void check_scene_nodes();
 
+static int change_epoch = 1;
+
+int ltChangeEpoch() {
+    return change_epoch;
+}
+
+int ltNextChangeEpoch() {
+    return ++change_epoch;
+}
+
+struct LTLastChangeVisitor : LTSceneNodeVisitor {
+    int last_change;
+    LTLastChangeVisitor() { last_change = 0; }
+    virtual void visit(LTSceneNode *node) {
+        int c = node->last_change();
+        if (c > last_change) {
+            last_change = c;
+        }
+        if (last_change != LT_ALWAYS_CHANGED) {
+            node->visit_children(this);
+        }
+    }
+};
+
+int ltSubtreeLastChange(LTSceneNode *node) {
+    LTLastChangeVisitor v;
+    v.visit(node);
+    return v.last_change;
+}
+
 LTSceneNode::LTSceneNode() {
     event_handlers = NULL;
     active = 0;
     action_speed = 1.0f;
+    change_stamp = ltChangeEpoch();
     //all_nodes.push_back(this);
 }
 
+void LTSceneNode::changed() {
+    change_stamp = change_epoch;
+}
+
+void LTSceneNode::enqueue(LTRenderQueue *queue) {
+    queue->add(this, LTVec3(0.0f, 0.0f, 0.0f), true);
+}
+
 LTSceneNode::~LTSceneNode() {
     assert(!active);
     if (event_handlers != NULL) {
@@ -315,6 +354,7 @@ void LTLayer::insert_front(LTSceneNode *node, int ref) {
     node_list.push_back(LTLayerNodeRefPair(node, ref));
     node_index.insert(std::pair<LTSceneNode*, std::list<LTLayerNodeRefPair>::iterator>(node, --node_list.end()));
     node->enter(this);
+    changed();
     //check_scene_nodes();
 }
 
@@ -323,6 +363,7 @@ void LTLayer::insert_back(LTSceneNode *node, int ref) {
     node_list.push_front(LTLayerNodeRefPair(node, ref));
     node_index.insert(std::pair<LTSceneNode*, std::list<LTLayerNodeRefPair>::iterator>(node, node_list.begin()));
     node->enter(this);
+    changed();
     //check_scene_nodes();
 }
 
@@ -337,6 +378,7 @@ bool LTLayer::insert_above(LTSceneNode *existing_node, LTSceneNode *new_node, in
         std::list<LTLayerNodeRefPair>::iterator new_it = node_list.insert(++existing_it, LTLayerNodeRefPair(new_node, ref));
         node_index.insert(std::pair<LTSceneNode*, std::list<LTLayerNodeRefPair>::iterator>(new_node, new_it));
         new_node->enter(this);
+        changed();
         //check_scene_nodes();
         return true;
     } else {
@@ -355,6 +397,7 @@ bool LTLayer::insert_below(LTSceneNode *existing_node, LTSceneNode *new_node, in
         std::list<LTLayerNodeRefPair>::iterator new_it = node_list.insert(existing_it, LTLayerNodeRefPair(new_node, ref));
         node_index.insert(std::pair<LTSceneNode*, std::list<LTLayerNodeRefPair>::iterator>(new_node, new_it));
         new_node->enter(this);
+        changed();
         //check_scene_nodes();
         return true;
     } else {
@@ -377,6 +420,9 @@ void LTLayer::remove(lua_State *L, int layer_index, LTSceneNode *node) {
         node_list.erase(it->second);
         it->first->exit(this);
     }
+    if (range.first != range.second) {
+        changed();
+    }
     node_index.erase(range.first, range.second);
     //check_scene_nodes();
 }
@@ -398,6 +444,28 @@ void LTLayer::draw() {
     }
 }
 
+bool LTLayer::bake(LTBaker *baker) {
+    std::list<LTLayerNodeRefPair>::iterator it;
+    for (it = node_list.begin(); it != node_list.end(); it++) {
+        baker->push();
+        bool ok = (*it).node->bake(baker);
+        baker->pop();
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LTLayer::enqueue(LTRenderQueue *queue) {
+    std::list<LTLayerNodeRefPair>::iterator it;
+    for (it = node_list.begin(); it != node_list.end(); it++) {
+        queue->push();
+        (*it).node->enqueue(queue);
+        queue->pop();
+    }
+}
+
 void LTLayer::visit_children(LTSceneNodeVisitor *v, bool reverse) {
     if (reverse) {
         std::list<LTLayerNodeRefPair>::reverse_iterator it;
@@ -436,6 +504,24 @@ void LTTranslateNode::draw() {
     }
 }
 
+bool LTTranslateNode::bake(LTBaker *baker) {
+    if (z != 0.0f) {
+        return false;
+    }
+    if (child != NULL) {
+        baker->translate(x, y);
+        return child->bake(baker);
+    }
+    return true;
+}
+
+void LTTranslateNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->translate(x, y, z);
+        child->enqueue(queue);
+    }
+}
+
 bool LTTranslateNode::inverse_transform(LTfloat *x1, LTfloat *y1) {
     *x1 -= x;
     *y1 -= y;
@@ -456,6 +542,25 @@ void LTRotateNode::draw() {
     }
 }
 
+bool LTRotateNode::bake(LTBaker *baker) {
+    if (child != NULL) {
+        baker->translate(cx, cy);
+        baker->rotate(angle);
+        baker->translate(-cx, -cy);
+        return child->bake(baker);
+    }
+    return true;
+}
+
+void LTRotateNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->translate(cx, cy, 0.0f);
+        queue->rotate(angle, 0.0f, 0.0f, 1.0f);
+        queue->translate(-cx, -cy, 0.0f);
+        child->enqueue(queue);
+    }
+}
+
 bool LTRotateNode::inverse_transform(LTfloat *x, LTfloat *y) {
     LTfloat a = -angle * LT_RADIANS_PER_DEGREE;
     LTfloat s = sinf(a);
@@ -491,6 +596,22 @@ void LTScaleNode::draw() {
     }
 }
 
+bool LTScaleNode::bake(LTBaker *baker) {
+    if (child != NULL) {
+        // Baked vertices have z = 0, so scale_z doesn't matter.
+        baker->scale(scale_x * scale, scale_y * scale);
+        return child->bake(baker);
+    }
+    return true;
+}
+
+void LTScaleNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->scale(scale_x * scale, scale_y * scale, scale_z * scale);
+        child->enqueue(queue);
+    }
+}
+
 bool LTScaleNode::inverse_transform(LTfloat *x, LTfloat *y) {
     if (scale_x != 0.0f && scale_y != 0.0f && scale != 0.0f && scale_z == 1.0f) {
         *x /= (scale_x * scale);
@@ -520,6 +641,19 @@ void LTShearNode::draw() {
     }
 }
 
+void LTShearNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        LTfloat matrix[] = {
+            1,  xy, xz, 0,
+            yx, 1,  yz, 0,
+            zx, zy, 1,  0,
+            0,  0,  0,  1,
+        };
+        queue->mult(matrix);
+        child->enqueue(queue);
+    }
+}
+
 LT_REGISTER_TYPE(LTShearNode, "lt.Shear", "lt.Wrap");
 LT_REGISTER_FIELD_FLOAT(LTShearNode, xy);
 LT_REGISTER_FIELD_FLOAT(LTShearNode, xz);
@@ -549,6 +683,19 @@ void LTTransformNode::draw() {
     }
 }
 
+void LTTransformNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        LTfloat matrix[] = {
+            m1, m5, m9,  m13,
+            m2, m6, m10, m14,
+            m3, m7, m11, m15,
+            m4, m8, m12, m16,
+        };
+        queue->mult(matrix);
+        child->enqueue(queue);
+    }
+}
+
 LT_REGISTER_TYPE(LTTransformNode, "lt.Transform", "lt.Wrap");
 LT_REGISTER_FIELD_FLOAT(LTTransformNode, m1);
 LT_REGISTER_FIELD_FLOAT(LTTransformNode, m2);
@@ -575,6 +722,26 @@ void LTTintNode::draw() {
     }
 }
 
+bool LTTintNode::bake(LTBaker *baker) {
+    if (child != NULL) {
+        baker->push();
+        baker->tint(red, green, blue, alpha);
+        bool ok = child->bake(baker);
+        baker->pop();
+        return ok;
+    }
+    return true;
+}
+
+void LTTintNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->push();
+        queue->tint(red, green, blue, alpha);
+        child->enqueue(queue);
+        queue->pop();
+    }
+}
+
 LT_REGISTER_TYPE(LTTintNode, "lt.Tint", "lt.Wrap");
 LT_REGISTER_FIELD_FLOAT(LTTintNode, red);
 LT_REGISTER_FIELD_FLOAT(LTTintNode, green);
@@ -638,6 +805,15 @@ void LTBlendModeNode::draw() {
     }
 }
 
+void LTBlendModeNode::enqueue(LTRenderQueue *queue) {
+    if (child != NULL) {
+        queue->push();
+        queue->state()->blend = mode;
+        child->enqueue(queue);
+        queue->pop();
+    }
+}
+
 static const LTEnumConstant BlendMode_enum_vals[] = {
     {"normal", LT_BLEND_MODE_NORMAL},
     {"invert", LT_BLEND_MODE_INVERT},
@@ -673,6 +849,13 @@ LT_REGISTER_FIELD_FLOAT(LTRectNode, y2)
 
 void LTHiddenNode::draw() {};
 
+bool LTHiddenNode::bake(LTBaker *baker) {
+    return true;
+}
+
+void LTHiddenNode::enqueue(LTRenderQueue *queue) {
+}
+
 LT_REGISTER_TYPE(LTHiddenNode, "lt.Hidden", "lt.Wrap")
 
 /*
@@ -2,6 +2,8 @@
 LT_INIT_DECL(ltscene)
 
 struct LTSceneNode;
+struct LTBaker;
+struct LTRenderQueue;
 
 struct LTSceneNodeVisitor {
     virtual void visit(LTSceneNode *node) = 0;
@@ -12,6 +14,7 @@ struct LTSceneNode : LTObject {
     std::list<LTAction *> *actions;
     int active;
     LTfloat action_speed;
+    int change_stamp; // Change epoch of the last changed() call.
 
     LTSceneNode();
     virtual ~LTSceneNode();
@@ -32,8 +35,35 @@ struct LTSceneNode : LTObject {
     void add_action(LTAction *action);
 
     virtual bool containsPoint(LTfloat x, LTfloat y) { return false; }
+
+    // Should be called when anything that affects how the node draws
+    // changes.  Field sets from Lua and tweens call it automatically.
+    virtual void changed();
+
+    // Epoch in which the node (not its children) last changed.  Nodes
+    // that change without calling changed(), such as physics bodies,
+    // return LT_ALWAYS_CHANGED.
+    virtual int last_change() { return change_stamp; }
+
+    // Adds what the node draws to baker and returns true, or returns
+    // false if the node can't be baked (see ltbake.h).
+    virtual bool bake(LTBaker *baker) { return false; }
+
+    // Adds what the node draws to queue (see ltrenderqueue.h).  By
+    // default the whole node is one transparent item.
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
+// Change tracking lets render targets skip re-rendering subtrees that
+// haven't changed.  changed() stamps a node with the current epoch and
+// ltNextChangeEpoch starts a new one, so a node has changed since
+// some point if its stamp is >= the epoch started then.
+#define LT_ALWAYS_CHANGED INT_MAX
+int ltChangeEpoch();
+int ltNextChangeEpoch();
+// The latest last_change() of node and its descendants.
+int ltSubtreeLastChange(LTSceneNode *node);
+
 struct LTLayerNodeRefPair {
     LTSceneNode *node;
     int ref;
@@ -61,6 +91,8 @@ struct LTLayer : LTSceneNode {
 
     virtual void draw();
     virtual void visit_children(LTSceneNodeVisitor *v, bool reverse);
+    virtual bool bake(LTBaker *baker);
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTWrapNode : LTSceneNode {
@@ -80,6 +112,8 @@ struct LTTranslateNode : LTWrapNode {
 
     virtual void draw();
     virtual bool inverse_transform(LTfloat *x, LTfloat *y);
+    virtual bool bake(LTBaker *baker);
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTRotateNode : LTWrapNode {
@@ -90,6 +124,8 @@ struct LTRotateNode : LTWrapNode {
 
     virtual void draw();
     virtual bool inverse_transform(LTfloat *x, LTfloat *y);
+    virtual bool bake(LTBaker *baker);
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTScaleNode : LTWrapNode {
@@ -103,6 +139,8 @@ struct LTScaleNode : LTWrapNode {
     virtual void init(lua_State *L);
     virtual void draw();
     virtual bool inverse_transform(LTfloat *x, LTfloat *y);
+    virtual bool bake(LTBaker *baker);
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTShearNode : LTWrapNode {
@@ -114,6 +152,7 @@ struct LTShearNode : LTWrapNode {
     LTfloat zy;
 
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTTransformNode : LTWrapNode {
@@ -136,6 +175,7 @@ struct LTTransformNode : LTWrapNode {
 
     LTTransformNode();
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTTintNode : LTWrapNode {
@@ -147,6 +187,8 @@ struct LTTintNode : LTWrapNode {
     LTTintNode() {red = 1; green = 1; blue = 1; alpha = 1;};
 
     virtual void draw();
+    virtual bool bake(LTBaker *baker);
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTTextureModeNode : LTWrapNode {
@@ -171,6 +213,7 @@ struct LTBlendModeNode : LTWrapNode {
     LTBlendModeNode() {};
 
     virtual void draw();
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 struct LTRectNode : LTSceneNode {
@@ -183,6 +226,8 @@ struct LTRectNode : LTSceneNode {
 
 struct LTHiddenNode : LTWrapNode {
     virtual void draw();
+    virtual bool bake(LTBaker *baker);
+    virtual void enqueue(LTRenderQueue *queue);
 };
 
 LTSceneNode *lt_expect_LTSceneNode(lua_State *L, int arg);
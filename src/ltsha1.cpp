@@ -78,7 +78,8 @@ A million repetitions of "a"
   34AA973C D4C4DAA4 F61EEB2B DBAD2731 6534016F
 */
 
-/* #define SHA1HANDSOFF  */
+/* Without this SHA1_Transform scribbles over the caller's data. */
+#define SHA1HANDSOFF
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -278,6 +279,16 @@ LTSHA1Digest ltSHA1(const char *data, size_t len) {
     return digest;
 }
 
+LTSHA1Digest ltSHA1_named(const char *name, const char *data, size_t len) {
+    LTSHA1Digest digest;
+    SHA1_CTX ctx;
+    SHA1_Init(&ctx);
+    SHA1_Update(&ctx, (uint8_t*)name, strlen(name) + 1);
+    SHA1_Update(&ctx, (uint8_t*)data, len);
+    SHA1_Final(&ctx, (uint8_t*)&digest.digest[0]);
+    return digest;
+}
+
 LTSHA1Digest ltSHA1_lua_modules(const char **modules, int num_modules) {
     LTSHA1Digest digest;
     SHA1_CTX ctx;
@@ -292,7 +303,6 @@ LTSHA1Digest ltSHA1_lua_modules(const char **modules, int num_modules) {
             ltLog("Unable to read %s", path);
         } else {
             ltLuaCacheAdd(path, data);
-            // XXX This seems to corrupt data!
             SHA1_Update(&ctx, (uint8_t*)data, len);
         }
         delete[] path;
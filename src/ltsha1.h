@@ -6,4 +6,6 @@ struct LTSHA1Digest {
 };
 
 LTSHA1Digest ltSHA1(const char *data, size_t len);
+// Digest of a name (including its terminating nul) followed by data.
+LTSHA1Digest ltSHA1_named(const char *name, const char *data, size_t len);
 LTSHA1Digest ltSHA1_lua_modules(const char **modules, int num_modules);
@@ -0,0 +1,175 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(ltsprite)
+
+struct LTSpriteAction : LTAction {
+    LTSprite *sprite;
+    LTSpriteAction(LTSprite *sprite) : LTAction(sprite) {
+        LTSpriteAction::sprite = sprite;
+    }
+    virtual bool doAction(LTfloat dt) {
+        if (sprite->auto_advance) {
+            sprite->advance(dt);
+        }
+        return false;
+    }
+};
+
+LTSprite::LTSprite() {
+    fps = 10.0f;
+    mode = LT_SPRITE_MODE_LOOP;
+    paused = false;
+    finished = false;
+    auto_advance = true;
+    loop_frame = 0;
+    curr_frame = 0;
+    direction = 1;
+    t_accum = 0.0f;
+    listener = NULL;
+    add_action(new LTSpriteAction(this));
+}
+
+LTSprite::~LTSprite() {
+    if (listener != NULL) {
+        delete listener;
+    }
+}
+
+void LTSprite::add_frame(LTSceneNode *frame) {
+    frames.push_back(frame);
+    if (frames.size() == 1) {
+        frame->enter(this);
+        changed();
+    }
+}
+
+void LTSprite::set_frame(int frame) {
+    if (frame == curr_frame || frame < 0 || frame >= (int)frames.size()) {
+        return;
+    }
+    frames[curr_frame]->exit(this);
+    curr_frame = frame;
+    frames[curr_frame]->enter(this);
+    changed();
+}
+
+void LTSprite::reset() {
+    t_accum = 0.0f;
+    direction = 1;
+    finished = false;
+    set_frame(0);
+}
+
+void LTSprite::advance(LTfloat dt) {
+    int n = frames.size();
+    if (paused || finished || fps <= 0.0f || n < 2) {
+        return;
+    }
+    LTfloat spf = 1.0f / fps;
+    int frame = curr_frame;
+    bool looped = false;
+    t_accum += dt;
+    while (t_accum >= spf) {
+        t_accum -= spf;
+        frame += direction;
+        if (frame >= n) {
+            switch (mode) {
+                case LT_SPRITE_MODE_LOOP:
+                    frame = (loop_frame >= 0 && loop_frame < n) ? loop_frame : 0;
+                    looped = true;
+                    break;
+                case LT_SPRITE_MODE_ONCE:
+                    frame = n - 1;
+                    finished = true;
+                    break;
+                case LT_SPRITE_MODE_PINGPONG:
+                    frame = n - 2;
+                    direction = -1;
+                    break;
+            }
+        } else if (frame < 0) {
+            frame = 1;
+            direction = 1;
+            looped = true;
+        }
+        if (finished) {
+            t_accum = 0.0f;
+            break;
+        }
+    }
+    set_frame(frame);
+    // Fire at most one callback per step, after the frame is updated,
+    // so the listener sees a consistent sprite.
+    if (listener != NULL) {
+        if (finished) {
+            listener->on_finish(this);
+        } else if (looped) {
+            listener->on_loop(this);
+        }
+    }
+}
+
+void LTSprite::draw() {
+    if (!frames.empty()) {
+        frames[curr_frame]->draw();
+    }
+}
+
+void LTSprite::visit_children(LTSceneNodeVisitor *v, bool reverse) {
+    if (!frames.empty()) {
+        v->visit(frames[curr_frame]);
+    }
+}
+
+static LTint get_curr_frame(LTObject *obj) {
+    return ((LTSprite*)obj)->curr_frame + 1;
+}
+
+static void set_curr_frame(LTObject *obj, LTint val) {
+    ((LTSprite*)obj)->set_frame(val - 1);
+}
+
+static LTint get_num_frames(LTObject *obj) {
+    return ((LTSprite*)obj)->frames.size();
+}
+
+static LTint get_loop_frame(LTObject *obj) {
+    return ((LTSprite*)obj)->loop_frame + 1;
+}
+
+static void set_loop_frame(LTObject *obj, LTint val) {
+    ((LTSprite*)obj)->loop_frame = val - 1;
+}
+
+static int sprite_reset(lua_State *L) {
+    ltLuaCheckNArgs(L, 1);
+    LTSprite *sprite = lt_expect_LTSprite(L, 1);
+    sprite->reset();
+    return 0;
+}
+
+static int sprite_advance(lua_State *L) {
+    ltLuaCheckNArgs(L, 2);
+    LTSprite *sprite = lt_expect_LTSprite(L, 1);
+    sprite->advance(luaL_checknumber(L, 2));
+    return 0;
+}
+
+static const LTEnumConstant SpriteMode_enum_vals[] = {
+    {"loop",        LT_SPRITE_MODE_LOOP},
+    {"once",        LT_SPRITE_MODE_ONCE},
+    {"pingpong",    LT_SPRITE_MODE_PINGPONG},
+    {NULL, 0}};
+
+LT_REGISTER_TYPE(LTSprite, "lt.SpriteImpl", "lt.SceneNode")
+LT_REGISTER_FIELD_FLOAT(LTSprite, fps)
+LT_REGISTER_FIELD_ENUM(LTSprite, mode, LTSpriteMode, SpriteMode_enum_vals)
+LT_REGISTER_FIELD_BOOL(LTSprite, paused)
+LT_REGISTER_FIELD_BOOL(LTSprite, finished)
+LT_REGISTER_FIELD_BOOL(LTSprite, auto_advance)
+LT_REGISTER_PROPERTY_INT(LTSprite, curr_frame, get_curr_frame, set_curr_frame)
+LT_REGISTER_PROPERTY_INT(LTSprite, num_frames, get_num_frames, NULL)
+LT_REGISTER_PROPERTY_INT(LTSprite, loop_frame, get_loop_frame, set_loop_frame)
+LT_REGISTER_METHOD(LTSprite, Reset, sprite_reset)
+LT_REGISTER_METHOD(LTSprite, Advance, sprite_advance)
@@ -0,0 +1,51 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(ltsprite)
+
+enum LTSpriteMode {
+    LT_SPRITE_MODE_LOOP,
+    LT_SPRITE_MODE_ONCE,
+    LT_SPRITE_MODE_PINGPONG,
+};
+
+struct LTSprite;
+
+// Notified when a sprite wraps around or reaches the end
+// of a "once" animation.
+struct LTSpriteListener {
+    virtual ~LTSpriteListener() {};
+    virtual void on_loop(LTSprite *sprite) = 0;
+    virtual void on_finish(LTSprite *sprite) = 0;
+};
+
+// Animates through a list of frames (usually images).  Advanced by
+// an action, so it runs at the node's action_speed and only while active,
+// unless auto_advance is false, in which case advance must be called
+// explicitly (as lt.AdvanceSprites does for old style sprite sets).
+struct LTSprite : LTSceneNode {
+    std::vector<LTSceneNode*> frames;
+    LTfloat fps;
+    LTSpriteMode mode;
+    bool paused;
+    bool finished;
+    bool auto_advance;
+    int loop_frame; // Frame to restart from in loop mode (0 based).
+    int curr_frame; // 0 based.
+    int direction;  // 1 or -1 (pingpong mode).
+    LTfloat t_accum;
+    LTSpriteListener *listener;
+
+    LTSprite();
+    virtual ~LTSprite();
+
+    // Frames should be added before the sprite is first drawn.
+    void add_frame(LTSceneNode *frame);
+    void set_frame(int frame);
+    void reset();
+    void advance(LTfloat dt);
+
+    virtual void draw();
+    virtual void visit_children(LTSceneNodeVisitor *v, bool reverse);
+};
+
+void *lt_alloc_LTSprite(lua_State *L);
+LTSprite *lt_expect_LTSprite(lua_State *L, int arg);
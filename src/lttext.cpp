@@ -31,6 +31,10 @@ static LTImageBuffer *create_glyph(LTImageBuffer *buf, int start_col, int end_co
     glyph->bb_bottom = 0;
     glyph->is_glyph = true;
     glyph->glyph_char = chr;
+    if (buf->path != NULL) {
+        glyph->path = new char[strlen(buf->path) + 1];
+        strcpy(glyph->path, buf->path);
+    }
     LTpixel *pxls = new LTpixel[w * h];
     glyph->bb_pixels = pxls;
     LTpixel *src_ptr = buf->bb_pixels + start_col;
@@ -57,6 +61,7 @@ std::list<LTImageBuffer *> *ltImageBufferToGlyphs(LTImageBuffer *buf, const char
         }
         glyph_end = col - 1;
         LTImageBuffer *glyph = create_glyph(buf, glyph_start, glyph_end, *chr);
+        glyph->glyph_index = chr - glyph_chars;
         glyphs->push_back(glyph);
         while (col < num_cols && transparent_column(buf, col)) {
             col++;
@@ -43,3 +43,126 @@ void ltUnlockMutex(LTMutex *mutex) {
     pthread_mutex_unlock(mutex);
 }
 */
+
+#include "lt.h"
+
+static int worker_threads = 0; // 0 until first used.
+
+// Workers are started the first time they're needed and then wait for
+// work for the life of the process, so a call costs a wake up rather
+// than a thread creation.  Each call bumps job_generation; worker i
+// runs range i of the current job, if there is one.
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static int pool_size = 1; // Including the calling thread.
+static bool pool_busy = false;
+
+static void (*job_f)(int begin, int end, void *data) = NULL;
+static void *job_data = NULL;
+static int job_n = 0;
+static int job_threads = 0;
+static unsigned job_generation = 0;
+static int job_pending = 0;
+
+static int range_start(int i) {
+    return (int)((long long)job_n * i / job_threads);
+}
+
+static void *worker(void *ud) {
+    int index = (int)(LTintptr)ud;
+    unsigned generation = 0;
+    pthread_mutex_lock(&pool_mutex);
+    for (;;) {
+        while (job_generation == generation) {
+            pthread_cond_wait(&work_cond, &pool_mutex);
+        }
+        generation = job_generation;
+        if (index >= job_threads) {
+            continue;
+        }
+        int begin = range_start(index);
+        int end = range_start(index + 1);
+        pthread_mutex_unlock(&pool_mutex);
+        job_f(begin, end, job_data);
+        pthread_mutex_lock(&pool_mutex);
+        if (--job_pending == 0) {
+            pthread_cond_signal(&done_cond);
+        }
+    }
+    return NULL;
+}
+
+// Returns the number of threads available, up to n.
+static int grow_pool(int n) {
+    while (pool_size < n) {
+        pthread_t id;
+        if (pthread_create(&id, NULL, worker, (void*)(LTintptr)pool_size) != 0) {
+            break;
+        }
+        pthread_detach(id);
+        pool_size++;
+    }
+    return pool_size < n ? pool_size : n;
+}
+
+int ltWorkerThreads() {
+    if (worker_threads == 0) {
+        int cpus = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+        cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        ltSetWorkerThreads(cpus);
+    }
+    return worker_threads;
+}
+
+void ltSetWorkerThreads(int n) {
+    if (n < 1) {
+        n = 1;
+    } else if (n > LT_MAX_WORKER_THREADS) {
+        n = LT_MAX_WORKER_THREADS;
+    }
+    worker_threads = n;
+}
+
+void ltParallelFor(int n, int min_range, void (*f)(int begin, int end, void *data), void *data) {
+    int threads = ltWorkerThreads();
+    if (min_range < 1) {
+        min_range = 1;
+    }
+    if (threads > n / min_range) {
+        threads = n / min_range;
+    }
+    pthread_mutex_lock(&pool_mutex);
+    // Nested or concurrent calls just run on the calling thread.
+    if (threads > 1 && !pool_busy) {
+        threads = grow_pool(threads);
+    } else {
+        threads = 1;
+    }
+    if (threads <= 1) {
+        pthread_mutex_unlock(&pool_mutex);
+        f(0, n, data);
+        return;
+    }
+    pool_busy = true;
+    job_f = f;
+    job_data = data;
+    job_n = n;
+    job_threads = threads;
+    job_pending = threads - 1;
+    job_generation++;
+    pthread_cond_broadcast(&work_cond);
+    int end = range_start(1);
+    pthread_mutex_unlock(&pool_mutex);
+
+    f(0, end, data);
+
+    pthread_mutex_lock(&pool_mutex);
+    while (job_pending > 0) {
+        pthread_cond_wait(&done_cond, &pool_mutex);
+    }
+    pool_busy = false;
+    pthread_mutex_unlock(&pool_mutex);
+}
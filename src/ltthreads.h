@@ -9,3 +9,18 @@ void ltDeleteMutex(LTMutex *mutex);
 void ltLockMutex(LTMutex *mutex);
 void ltUnlockMutex(LTMutex *mutex);
 */
+
+#define LT_MAX_WORKER_THREADS 8
+
+// Runs f over [0, n) split into contiguous ranges, one per thread.
+// The calling thread takes the first range and the call returns once
+// all ranges are done.  Ranges are at least min_range long, so small
+// jobs just run on the calling thread.  f must not call Lua or GL.
+// The worker threads are started on first use and then kept waiting
+// for work, so calls are cheap enough for per frame jobs.
+void ltParallelFor(int n, int min_range, void (*f)(int begin, int end, void *data), void *data);
+
+// Defaults to the number of CPUs, up to LT_MAX_WORKER_THREADS.
+// 1 runs everything on the calling thread.
+void ltSetWorkerThreads(int n);
+int ltWorkerThreads();
@@ -0,0 +1,492 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(lttilemap)
+
+#define CS LT_TILEMAP_CHUNK_SIZE
+
+// Two triangles per quad, shared by all chunks since quads are always
+// 4 consecutive vertices in fan order.
+static LTvertindex *quad_indices = NULL;
+
+static void init_quad_indices() {
+    if (quad_indices != NULL) {
+        return;
+    }
+    static const int fan[6] = {0, 1, 2, 0, 2, 3};
+    quad_indices = new LTvertindex[CS * CS * 6];
+    for (int q = 0; q < CS * CS; q++) {
+        for (int i = 0; i < 6; i++) {
+            quad_indices[q * 6 + i] = (LTvertindex)(q * 4 + fan[i]);
+        }
+    }
+}
+
+LTTileMap::LTTileMap() {
+    init(0, 0, 1.0f, 1.0f);
+}
+
+LTTileMap::LTTileMap(int w, int h, LTfloat tile_w, LTfloat tile_h) {
+    init(w, h, tile_w, tile_h);
+}
+
+void LTTileMap::init(int w, int h, LTfloat tile_w, LTfloat tile_h) {
+    width = w;
+    height = h;
+    tile_width = tile_w;
+    tile_height = tile_h;
+    tiles = new LTushort[w * h];
+    memset(tiles, 0, w * h * sizeof(LTushort));
+    chunks_x = (w + CS - 1) / CS;
+    chunks_y = (h + CS - 1) / CS;
+    chunks = new LTTileChunk[chunks_x * chunks_y];
+    memset(&stats, 0, sizeof(stats));
+}
+
+LTTileMap::~LTTileMap() {
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        if (chunks[i].vertbuf != 0) {
+            ltDeleteVertBuffer(chunks[i].vertbuf);
+        }
+    }
+    delete[] chunks;
+    delete[] tiles;
+}
+
+void LTTileMap::set(int x, int y, int tile) {
+    LTushort *t = &tiles[y * width + x];
+    if (*t != tile) {
+        *t = (LTushort)tile;
+        chunks[(y / CS) * chunks_x + x / CS].dirty = true;
+        changed();
+    }
+}
+
+void LTTileMap::fill(int tile) {
+    for (int i = 0; i < width * height; i++) {
+        tiles[i] = (LTushort)tile;
+    }
+    invalidate();
+}
+
+void LTTileMap::add_image(LTTexturedNode *img, LTfloat orig_w, LTfloat orig_h) {
+    // Same corner order as the image's tex_coords.
+    static const LTshort full[8] = {0, 0, 1, 0, 1, 1, 0, 1};
+    images.push_back(img);
+    for (int i = 0; i < 8; i++) {
+        LTfloat size = i % 2 == 0 ? orig_w : orig_h;
+        if (size <= 0.0f) {
+            image_corners.push_back(full[i] * LT_TILEMAP_SUBTILE);
+        } else {
+            // An image's world_vertices are its bounding box relative to
+            // the centre of the untrimmed image.
+            LTfloat f = img->world_vertices[i] / size + 0.5f;
+            image_corners.push_back((LTshort)floorf(f * LT_TILEMAP_SUBTILE + 0.5f));
+        }
+    }
+    invalidate();
+}
+
+void LTTileMap::invalidate() {
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        chunks[i].dirty = true;
+    }
+    changed();
+}
+
+void LTTileMap::build_chunk(int cx, int cy) {
+    LTdouble t0 = ltGetTime();
+    LTTileChunk *chunk = &chunks[cy * chunks_x + cx];
+    int x0 = cx * CS;
+    int y0 = cy * CS;
+    int x1 = x0 + CS < width ? x0 + CS : width;
+    int y1 = y0 + CS < height ? y0 + CS : height;
+    int num_images = images.size();
+
+    // First count the quads for each texture, so the quads can be
+    // written already grouped.
+    int run_of[CS * CS];
+    chunk->runs.clear();
+    int last = -1;
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int tile = tiles[y * width + x];
+            int *r = &run_of[(y - y0) * CS + (x - x0)];
+            if (tile == 0 || tile > num_images) {
+                *r = -1;
+                continue;
+            }
+            LTtexid tex = images[tile - 1]->texture_id;
+            if (last < 0 || chunk->runs[last].texture_id != tex) {
+                last = -1;
+                for (unsigned int i = 0; i < chunk->runs.size(); i++) {
+                    if (chunk->runs[i].texture_id == tex) {
+                        last = i;
+                        break;
+                    }
+                }
+                if (last < 0) {
+                    LTTileRun run;
+                    run.texture_id = tex;
+                    run.first_quad = 0;
+                    run.num_quads = 0;
+                    last = chunk->runs.size();
+                    chunk->runs.push_back(run);
+                }
+            }
+            chunk->runs[last].num_quads++;
+            *r = last;
+        }
+    }
+    int num_quads = 0;
+    int cursor[CS * CS];
+    for (unsigned int i = 0; i < chunk->runs.size(); i++) {
+        chunk->runs[i].first_quad = num_quads;
+        cursor[i] = num_quads;
+        num_quads += chunk->runs[i].num_quads;
+    }
+
+    if (num_quads > 0) {
+        LTTileVertex *verts = new LTTileVertex[num_quads * 4];
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                int r = run_of[(y - y0) * CS + (x - x0)];
+                if (r < 0) {
+                    continue;
+                }
+                int image = tiles[y * width + x] - 1;
+                LTTexturedNode *img = images[image];
+                const LTshort *corners = &image_corners[image * 8];
+                LTTileVertex *v = &verts[cursor[r]++ * 4];
+                LTshort lx = (LTshort)((x - x0) * LT_TILEMAP_SUBTILE);
+                LTshort ly = (LTshort)((y - y0) * LT_TILEMAP_SUBTILE);
+                for (int i = 0; i < 4; i++) {
+                    v[i].x = lx + corners[i * 2];
+                    v[i].y = ly + corners[i * 2 + 1];
+                    v[i].u = img->tex_coords[i * 2];
+                    v[i].v = img->tex_coords[i * 2 + 1];
+                }
+            }
+        }
+        if (chunk->vertbuf == 0) {
+            chunk->vertbuf = ltGenVertBuffer();
+        }
+        ltBindVertBuffer(chunk->vertbuf);
+        ltStaticVertBufferData(num_quads * 4 * sizeof(LTTileVertex), verts);
+        delete[] verts;
+    } else if (chunk->vertbuf != 0) {
+        ltDeleteVertBuffer(chunk->vertbuf);
+        chunk->vertbuf = 0;
+    }
+    chunk->num_quads = num_quads;
+    chunk->dirty = false;
+    stats.chunk_builds++;
+    stats.build_time += ltGetTime() - t0;
+}
+
+void LTTileMap::build_all() {
+    for (int cy = 0; cy < chunks_y; cy++) {
+        for (int cx = 0; cx < chunks_x; cx++) {
+            if (chunks[cy * chunks_x + cx].dirty) {
+                build_chunk(cx, cy);
+            }
+        }
+    }
+}
+
+// Computes the range of chunks overlapping the viewport when the map is
+// drawn with an affine transform (as it is under the default 2D
+// projection).  Returns false if the transform isn't affine.
+static bool visible_chunks(LTTileMap *map, int *cx0, int *cy0, int *cx1, int *cy1) {
+    LTfloat mv[16];
+    LTfloat clip[16];
+    ltGetMatrix(LT_MATRIX_MODE_MODELVIEW, mv);
+    ltGetMatrix(LT_MATRIX_MODE_PROJECTION, clip);
+    ltMatMultiply(clip, clip, mv);
+    if (clip[3] != 0.0f || clip[7] != 0.0f || clip[15] <= 0.0f) {
+        return false;
+    }
+    // The map's plane in tile coordinates maps to clip space with
+    // x' = a * x + c * y + tx, y' = b * x + d * y + ty.
+    LTfloat w = clip[15];
+    LTfloat a = clip[0] * map->tile_width;
+    LTfloat b = clip[1] * map->tile_width;
+    LTfloat c = clip[4] * map->tile_height;
+    LTfloat d = clip[5] * map->tile_height;
+    LTfloat tx = clip[12];
+    LTfloat ty = clip[13];
+    LTfloat det = a * d - b * c;
+    *cx0 = *cy0 = 0;
+    *cx1 = *cy1 = -1;
+    if (det == 0.0f) {
+        return true;
+    }
+    // Map the corners of the viewport back onto the map.
+    LTfloat minx = 0.0f, maxx = 0.0f, miny = 0.0f, maxy = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        LTfloat px = ((i & 1) ? w : -w) - tx;
+        LTfloat py = ((i & 2) ? w : -w) - ty;
+        LTfloat x = (d * px - c * py) / det;
+        LTfloat y = (a * py - b * px) / det;
+        if (i == 0 || x < minx) minx = x;
+        if (i == 0 || x > maxx) maxx = x;
+        if (i == 0 || y < miny) miny = y;
+        if (i == 0 || y > maxy) maxy = y;
+    }
+    LTfloat cs = (LTfloat)CS;
+    if (maxx <= 0.0f || maxy <= 0.0f || minx >= map->width || miny >= map->height) {
+        return true;
+    }
+    // A chunk whose edge is on the edge of the viewport isn't visible.
+    *cx0 = minx <= 0.0f ? 0 : (int)(minx / cs);
+    *cy0 = miny <= 0.0f ? 0 : (int)(miny / cs);
+    *cx1 = maxx >= map->width ? map->chunks_x - 1 : (int)ceilf(maxx / cs) - 1;
+    *cy1 = maxy >= map->height ? map->chunks_y - 1 : (int)ceilf(maxy / cs) - 1;
+    return true;
+}
+
+void LTTileMap::draw() {
+    stats.chunks_drawn = 0;
+    stats.draw_calls = 0;
+    if (images.empty()) {
+        return;
+    }
+    int cx0, cy0, cx1, cy1;
+    bool affine = visible_chunks(this, &cx0, &cy0, &cx1, &cy1);
+    if (!affine) {
+        cx0 = cy0 = 0;
+        cx1 = chunks_x - 1;
+        cy1 = chunks_y - 1;
+    }
+    LTfloat chunk_w = CS * tile_width;
+    LTfloat chunk_h = CS * tile_height;
+    LTVec3 half_extents(fabsf(chunk_w) * 0.5f, fabsf(chunk_h) * 0.5f, 0.0f);
+    init_quad_indices();
+    int stride = sizeof(LTTileVertex);
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            if (!affine) {
+                LTVec3 centre((cx + 0.5f) * chunk_w, (cy + 0.5f) * chunk_h, 0.0f);
+                if (ltFrustumCull(NULL, centre, half_extents)) {
+                    continue;
+                }
+            }
+            LTTileChunk *chunk = &chunks[cy * chunks_x + cx];
+            if (chunk->dirty) {
+                build_chunk(cx, cy);
+            }
+            if (chunk->num_quads == 0) {
+                continue;
+            }
+            ltPushMatrix();
+            ltTranslate(cx * chunk_w, cy * chunk_h, 0.0f);
+            ltScale(tile_width / LT_TILEMAP_SUBTILE, tile_height / LT_TILEMAP_SUBTILE, 1.0f);
+            ltBindVertBuffer(chunk->vertbuf);
+            ltVertexPointer(2, LT_VERT_DATA_TYPE_SHORT, stride, (void*)offsetof(LTTileVertex, x));
+            ltTexCoordPointer(2, LT_VERT_DATA_TYPE_SHORT, stride, (void*)offsetof(LTTileVertex, u));
+            for (unsigned int i = 0; i < chunk->runs.size(); i++) {
+                LTTileRun *run = &chunk->runs[i];
+                ltEnableTexture(run->texture_id);
+                ltDrawElements(LT_DRAWMODE_TRIANGLES, run->num_quads * 6,
+                    &quad_indices[run->first_quad * 6]);
+            }
+            ltPopMatrix();
+            stats.chunks_drawn++;
+            stats.draw_calls += chunk->runs.size();
+        }
+    }
+}
+
+int LTTileMap::cpu_bytes() {
+    int bytes = width * height * sizeof(LTushort) + chunks_x * chunks_y * sizeof(LTTileChunk);
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        bytes += chunks[i].runs.capacity() * sizeof(LTTileRun);
+    }
+    return bytes;
+}
+
+int LTTileMap::vbo_bytes() {
+    int bytes = 0;
+    for (int i = 0; i < chunks_x * chunks_y; i++) {
+        if (chunks[i].vertbuf != 0) {
+            bytes += chunks[i].num_quads * 4 * sizeof(LTTileVertex);
+        }
+    }
+    return bytes;
+}
+
+// Replaces the map's images with those in the table at index arg.
+// The map is at index map_arg.
+static void set_images(lua_State *L, LTTileMap *map, int map_arg, int arg) {
+    for (unsigned int i = 0; i < map->image_refs.size(); i++) {
+        ltLuaDelRef(L, map_arg, map->image_refs[i]);
+    }
+    map->images.clear();
+    map->image_refs.clear();
+    map->image_corners.clear();
+    int n = lua_objlen(L, arg);
+    for (int i = 1; i <= n; i++) {
+        lua_rawgeti(L, arg, i);
+        LTTexturedNode *img = lt_expect_LTTexturedNode(L, -1);
+        if (lt_is_LTImage(L, -1)) {
+            LTImage *trimmed = (LTImage*)img;
+            map->add_image(img, trimmed->orig_width, trimmed->orig_height);
+        } else {
+            map->add_image(img);
+        }
+        map->image_refs.push_back(ltLuaAddRef(L, map_arg, -1));
+        lua_pop(L, 1);
+    }
+    map->invalidate();
+}
+
+static int new_TileMap(lua_State *L) {
+    int nargs = ltLuaCheckNArgs(L, 4);
+    int w = luaL_checkinteger(L, 1);
+    int h = luaL_checkinteger(L, 2);
+    LTfloat tile_w = luaL_checknumber(L, 3);
+    LTfloat tile_h = luaL_checknumber(L, 4);
+    if (w <= 0 || h <= 0) {
+        return luaL_error(L, "Tile map dimensions must be positive");
+    }
+    // cpu_bytes and the tile indices are ints.
+    if (w > INT_MAX / (int)sizeof(LTushort) / h) {
+        return luaL_error(L, "Tile map %dx%d is too large", w, h);
+    }
+    if (nargs > 4 && !lua_istable(L, 5)) {
+        return luaL_error(L, "Expecting an array of images in argument 5");
+    }
+    LTTileMap *map = new (lt_alloc_LTTileMap(L)) LTTileMap(w, h, tile_w, tile_h);
+    if (nargs > 4) {
+        set_images(L, map, lua_gettop(L), 5);
+    }
+    return 1;
+}
+
+static LTTileMap *check_tile(lua_State *L, int *x, int *y) {
+    LTTileMap *map = lt_expect_LTTileMap(L, 1);
+    *x = luaL_checkinteger(L, 2) - 1;
+    *y = luaL_checkinteger(L, 3) - 1;
+    if (*x < 0 || *x >= map->width || *y < 0 || *y >= map->height) {
+        luaL_error(L, "Tile %d, %d is outside the %dx%d map", *x + 1, *y + 1, map->width, map->height);
+    }
+    return map;
+}
+
+static int check_tile_value(lua_State *L, int arg) {
+    int tile = luaL_checkinteger(L, arg);
+    if (tile < 0 || tile > 0xFFFF) {
+        return luaL_error(L, "Invalid tile value: %d", tile);
+    }
+    return tile;
+}
+
+static int set_images_method(lua_State *L) {
+    ltLuaCheckNArgs(L, 2);
+    LTTileMap *map = lt_expect_LTTileMap(L, 1);
+    if (!lua_istable(L, 2)) {
+        return luaL_error(L, "Expecting an array of images");
+    }
+    set_images(L, map, 1, 2);
+    return 0;
+}
+
+static int set_tile(lua_State *L) {
+    ltLuaCheckNArgs(L, 4);
+    int x, y;
+    LTTileMap *map = check_tile(L, &x, &y);
+    map->set(x, y, check_tile_value(L, 4));
+    return 0;
+}
+
+static int get_tile(lua_State *L) {
+    ltLuaCheckNArgs(L, 3);
+    int x, y;
+    LTTileMap *map = check_tile(L, &x, &y);
+    lua_pushinteger(L, map->get(x, y));
+    return 1;
+}
+
+// Sets all the tiles from an array of width * height values, row by
+// row from the bottom.
+static int set_tiles(lua_State *L) {
+    ltLuaCheckNArgs(L, 2);
+    LTTileMap *map = lt_expect_LTTileMap(L, 1);
+    if (!lua_istable(L, 2)) {
+        return luaL_error(L, "Expecting an array of tiles");
+    }
+    int n = map->width * map->height;
+    if ((int)lua_objlen(L, 2) != n) {
+        return luaL_error(L, "Expecting %d tiles", n);
+    }
+    for (int i = 0; i < n; i++) {
+        lua_rawgeti(L, 2, i + 1);
+        map->tiles[i] = (LTushort)check_tile_value(L, -1);
+        lua_pop(L, 1);
+    }
+    map->invalidate();
+    return 0;
+}
+
+static int fill(lua_State *L) {
+    ltLuaCheckNArgs(L, 2);
+    LTTileMap *map = lt_expect_LTTileMap(L, 1);
+    map->fill(check_tile_value(L, 2));
+    return 0;
+}
+
+static LTint get_width(LTObject *obj) {
+    return ((LTTileMap*)obj)->width;
+}
+
+static LTint get_height(LTObject *obj) {
+    return ((LTTileMap*)obj)->height;
+}
+
+static LTint get_chunks(LTObject *obj) {
+    LTTileMap *map = (LTTileMap*)obj;
+    return map->chunks_x * map->chunks_y;
+}
+
+static LTint get_chunk_builds(LTObject *obj) {
+    return ((LTTileMap*)obj)->stats.chunk_builds;
+}
+
+static LTfloat get_build_time(LTObject *obj) {
+    return ((LTTileMap*)obj)->stats.build_time;
+}
+
+static LTint get_chunks_drawn(LTObject *obj) {
+    return ((LTTileMap*)obj)->stats.chunks_drawn;
+}
+
+static LTint get_draw_calls(LTObject *obj) {
+    return ((LTTileMap*)obj)->stats.draw_calls;
+}
+
+static LTint get_cpu_bytes(LTObject *obj) {
+    return ((LTTileMap*)obj)->cpu_bytes();
+}
+
+static LTint get_vbo_bytes(LTObject *obj) {
+    return ((LTTileMap*)obj)->vbo_bytes();
+}
+
+LT_REGISTER_TYPE(LTTileMap, "lt.TileMap", "lt.SceneNode")
+LT_REGISTER_FIELD_FLOAT(LTTileMap, tile_width);
+LT_REGISTER_FIELD_FLOAT(LTTileMap, tile_height);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, width, &get_width, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, height, &get_height, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, chunks, &get_chunks, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, chunk_builds, &get_chunk_builds, NULL);
+LT_REGISTER_PROPERTY_FLOAT_NOCONS(LTTileMap, build_time, &get_build_time, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, chunks_drawn, &get_chunks_drawn, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, draw_calls, &get_draw_calls, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, cpu_bytes, &get_cpu_bytes, NULL);
+LT_REGISTER_PROPERTY_INT_NOCONS(LTTileMap, vbo_bytes, &get_vbo_bytes, NULL);
+LT_REGISTER_METHOD(LTTileMap, new, new_TileMap);
+LT_REGISTER_METHOD(LTTileMap, SetImages, set_images_method);
+LT_REGISTER_METHOD(LTTileMap, Set, set_tile);
+LT_REGISTER_METHOD(LTTileMap, Get, get_tile);
+LT_REGISTER_METHOD(LTTileMap, SetTiles, set_tiles);
+LT_REGISTER_METHOD(LTTileMap, Fill, fill);
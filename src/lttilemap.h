@@ -0,0 +1,97 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(lttilemap)
+
+// A grid of tiles drawn from a set of images.  Tile (0, 0) is the
+// bottom left one and covers (0, 0) to (tile_width, tile_height).  Tile
+// values index the image set from 1; 0 is an empty tile.
+//
+// The grid is split into square chunks of LT_TILEMAP_CHUNK_SIZE tiles,
+// each with its own static vertex buffer holding one quad per non-empty
+// tile, grouped by texture.  A chunk's buffer is built the first time
+// the chunk is visible and rebuilt only when one of its tiles changes,
+// so a visible chunk costs one draw call per texture it uses.  Chunks
+// that don't overlap the viewport are skipped.
+//
+// Quad corners are stored as shorts in 1/LT_TILEMAP_SUBTILE tiles
+// relative to the chunk and scaled when drawn, so a tile takes 2 bytes
+// in main memory and 32 bytes of vertex buffer once its chunk is built.
+// An image trimmed of transparent edges covers only its bounding box
+// within the tile, as when the image is drawn on its own.
+
+#define LT_TILEMAP_CHUNK_SIZE 32
+#define LT_TILEMAP_SUBTILE 256
+
+struct LTTileVertex {
+    LTshort x, y;       // 1/LT_TILEMAP_SUBTILE tiles from the chunk's bottom left corner.
+    LTtexcoord u, v;
+};
+
+// Quads in a chunk that share a texture.
+struct LTTileRun {
+    LTtexid texture_id;
+    int first_quad;
+    int num_quads;
+};
+
+struct LTTileChunk {
+    LTvertbuf vertbuf;  // 0 until built.
+    int num_quads;
+    bool dirty;
+    std::vector<LTTileRun> runs;
+
+    LTTileChunk() {
+        vertbuf = 0;
+        num_quads = 0;
+        dirty = true;
+    }
+};
+
+struct LTTileMapStats {
+    int chunks_drawn;   // In the last draw.
+    int draw_calls;     // In the last draw.
+    int chunk_builds;   // Since the map was created.
+    LTdouble build_time; // Seconds spent building chunks.
+};
+
+struct LTTileMap : LTSceneNode {
+    int width;          // In tiles.
+    int height;
+    LTfloat tile_width;
+    LTfloat tile_height;
+    LTushort *tiles;    // Row major, bottom row first.
+    std::vector<LTTexturedNode*> images;
+    std::vector<int> image_refs; // Lua refs from the map to the images.
+    std::vector<LTshort> image_corners; // 8 per image, in LT_TILEMAP_SUBTILE units.
+    int chunks_x;
+    int chunks_y;
+    LTTileChunk *chunks;
+    LTTileMapStats stats;
+
+    LTTileMap(); // An empty 0x0 map.
+    LTTileMap(int w, int h, LTfloat tile_w, LTfloat tile_h);
+    virtual ~LTTileMap();
+
+    int get(int x, int y) { return tiles[y * width + x]; }
+    void set(int x, int y, int tile);
+    void fill(int tile);
+    // Appends an image to the set.  An lt.Image is passed with its
+    // untrimmed size, which fills a tile; other textured nodes are
+    // passed without and stretched over the whole tile.
+    void add_image(LTTexturedNode *img, LTfloat orig_w = 0.0f, LTfloat orig_h = 0.0f);
+    // Marks every chunk for rebuilding, e.g. after the images change.
+    void invalidate();
+
+    void build_chunk(int cx, int cy);
+    void build_all();
+
+    virtual void draw();
+
+    int cpu_bytes();
+    int vbo_bytes();
+
+private:
+    void init(int w, int h, LTfloat tile_w, LTfloat tile_h);
+};
+
+void *lt_alloc_LTTileMap(lua_State *L);
+LTTileMap *lt_expect_LTTileMap(lua_State *L, int arg);
@@ -1,6 +1,19 @@
 /* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
 #include "lt.h"
+#ifndef LTIOS
+#include <sys/time.h>
+#endif
 
 LT_INIT_IMPL(lttime)
 
 LTsecs LT_step_length = 1.0f / 60.0f;
+
+LTdouble ltGetTime() {
+#ifdef LTIOS
+    return ltIOSGetTime();
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (LTdouble)tv.tv_sec + (LTdouble)tv.tv_usec * 1.0e-6;
+#endif
+}
@@ -2,3 +2,7 @@
 LT_INIT_DECL(lttime)
 
 extern LTsecs LT_step_length;
+
+// Wall clock time in seconds from an arbitrary origin.
+// Only useful for measuring intervals.
+LTdouble ltGetTime();
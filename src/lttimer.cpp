@@ -0,0 +1,321 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+#include "lt.h"
+
+LT_INIT_IMPL(lttimer)
+
+#define HANDLE_INDEX_BITS 24
+#define HANDLE_INDEX_MASK ((1 << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GEN_MASK 0x7F
+
+/************************* Handles **************************/
+
+// Handle = generation << HANDLE_INDEX_BITS | (index + 1).
+// The generation is bumped each time a slot is freed, so stale
+// handles don't match a newer timer in the same slot.
+static std::vector<LTTimer*> handle_timers;
+static std::vector<int> handle_gens;
+static std::vector<int> free_handles;
+static int num_live_timers = 0;
+
+static int alloc_handle(LTTimer *timer) {
+    int index;
+    if (free_handles.empty()) {
+        index = handle_timers.size();
+        handle_timers.push_back(timer);
+        handle_gens.push_back(0);
+    } else {
+        index = free_handles.back();
+        free_handles.pop_back();
+        handle_timers[index] = timer;
+    }
+    num_live_timers++;
+    return (handle_gens[index] << HANDLE_INDEX_BITS) | (index + 1);
+}
+
+static void free_handle(int handle) {
+    int index = (handle & HANDLE_INDEX_MASK) - 1;
+    handle_timers[index] = NULL;
+    handle_gens[index] = (handle_gens[index] + 1) & HANDLE_GEN_MASK;
+    free_handles.push_back(index);
+    num_live_timers--;
+}
+
+LTTimer *ltLookupTimer(int handle) {
+    int index = (handle & HANDLE_INDEX_MASK) - 1;
+    int gen = (handle >> HANDLE_INDEX_BITS) & HANDLE_GEN_MASK;
+    if (index < 0 || index >= (int)handle_timers.size() || handle_gens[index] != gen) {
+        return NULL;
+    }
+    return handle_timers[index];
+}
+
+int ltNumLiveTimers() {
+    return num_live_timers;
+}
+
+/************************* Lists **************************/
+
+static inline void list_init(LTTimerLink *head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static inline bool list_empty(LTTimerLink *head) {
+    return head->next == head;
+}
+
+static inline void list_append(LTTimerLink *head, LTTimerLink *link) {
+    link->prev = head->prev;
+    link->next = head;
+    head->prev->next = link;
+    head->prev = link;
+}
+
+static inline void list_remove(LTTimerLink *link) {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = link;
+    link->prev = link;
+}
+
+// Moves all links from src to the (empty) list dest.
+static inline void list_splice(LTTimerLink *src, LTTimerLink *dest) {
+    if (list_empty(src)) {
+        list_init(dest);
+    } else {
+        dest->next = src->next;
+        dest->prev = src->prev;
+        dest->next->prev = dest;
+        dest->prev->next = dest;
+        list_init(src);
+    }
+}
+
+/************************* Wheel **************************/
+
+LTTimerWheel::LTTimerWheel(LTTimerHandler *handler) {
+    for (int l = 0; l < LT_TIMER_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < LT_TIMER_WHEEL_SIZE; s++) {
+            list_init(&slots[l][s]);
+        }
+        occupied[l] = 0;
+    }
+    list_init(&overflow);
+    list_init(&firing);
+    now = 0;
+    elapsed = 0.0;
+    count = 0;
+    LTTimerWheel::handler = handler;
+}
+
+static void free_list(LTTimerLink *head) {
+    while (!list_empty(head)) {
+        LTTimer *timer = (LTTimer*)head->next;
+        list_remove(timer);
+        free_handle(timer->handle);
+        delete timer;
+    }
+}
+
+LTTimerWheel::~LTTimerWheel() {
+    for (int l = 0; l < LT_TIMER_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < LT_TIMER_WHEEL_SIZE; s++) {
+            free_list(&slots[l][s]);
+        }
+    }
+    free_list(&overflow);
+    free_list(&firing);
+}
+
+void LTTimerWheel::insert(LTTimer *timer) {
+    uint64_t expiry = timer->expiry;
+    if (expiry < now) {
+        // Overdue, so run on the next tick.
+        expiry = now + 1;
+    }
+    uint64_t delta = expiry - now;
+    for (int l = 0; l < LT_TIMER_WHEEL_LEVELS; l++) {
+        if (delta < ((uint64_t)1 << ((l + 1) * LT_TIMER_WHEEL_BITS))) {
+            int s = (expiry >> (l * LT_TIMER_WHEEL_BITS)) & LT_TIMER_WHEEL_MASK;
+            list_append(&slots[l][s], timer);
+            occupied[l] |= (uint64_t)1 << s;
+            return;
+        }
+    }
+    list_append(&overflow, timer);
+}
+
+LTTimer *LTTimerWheel::add(LTfloat secs, int ref) {
+    LTTimer *timer = new LTTimer();
+    // Round up so a timer never fires before its time has
+    // elapsed (allowing for float error in frame times).
+    LTdouble expiry = ceil(elapsed + (LTdouble)secs * LT_TIMER_TICKS_PER_SEC - 1.0e-3);
+    if (expiry <= (LTdouble)now) {
+        timer->expiry = now + 1;
+    } else {
+        timer->expiry = (uint64_t)expiry;
+    }
+    timer->wheel = this;
+    timer->ref = ref;
+    timer->handle = alloc_handle(timer);
+    insert(timer);
+    count++;
+    return timer;
+}
+
+void LTTimerWheel::cancel(LTTimer *timer) {
+    assert(timer->wheel == this);
+    list_remove(timer);
+    count--;
+    free_handle(timer->handle);
+    handler->discard(timer);
+    delete timer;
+}
+
+void LTTimerWheel::clear() {
+    // Collect first, since discard may cancel other timers.
+    std::vector<LTTimer*> timers;
+    for (int l = 0; l < LT_TIMER_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < LT_TIMER_WHEEL_SIZE; s++) {
+            LTTimerLink *head = &slots[l][s];
+            for (LTTimerLink *link = head->next; link != head; link = link->next) {
+                timers.push_back((LTTimer*)link);
+            }
+        }
+    }
+    for (LTTimerLink *link = overflow.next; link != &overflow; link = link->next) {
+        timers.push_back((LTTimer*)link);
+    }
+    for (LTTimerLink *link = firing.next; link != &firing; link = link->next) {
+        timers.push_back((LTTimer*)link);
+    }
+    for (unsigned int i = 0; i < timers.size(); i++) {
+        LTTimer *timer = timers[i];
+        list_remove(timer);
+        count--;
+        free_handle(timer->handle);
+    }
+    for (unsigned int i = 0; i < timers.size(); i++) {
+        handler->discard(timers[i]);
+        delete timers[i];
+    }
+}
+
+void LTTimerWheel::cascade(LTTimerLink *slot) {
+    LTTimerLink pending;
+    list_splice(slot, &pending);
+    while (!list_empty(&pending)) {
+        LTTimer *timer = (LTTimer*)pending.next;
+        list_remove(timer);
+        insert(timer);
+    }
+}
+
+void LTTimerWheel::cascade(int level, int index) {
+    occupied[level] &= ~((uint64_t)1 << index);
+    cascade(&slots[level][index]);
+}
+
+// Returns the first tick after now with timers to cascade or fire, or
+// ~0 if there are none.  A level l slot is visited on ticks that
+// are multiples of WHEEL_SIZE^l, so the next visit to each occupied slot
+// is found from its distance round the level from the current position.
+uint64_t LTTimerWheel::next_tick() {
+    uint64_t next = ~(uint64_t)0;
+    for (int l = 0; l < LT_TIMER_WHEEL_LEVELS; l++) {
+        int shift = l * LT_TIMER_WHEEL_BITS;
+        uint64_t pos = now >> shift;
+        for (int k = 1; k <= LT_TIMER_WHEEL_SIZE && occupied[l] != 0; k++) {
+            int s = (pos + k) & LT_TIMER_WHEEL_MASK;
+            if (occupied[l] & ((uint64_t)1 << s)) {
+                if (list_empty(&slots[l][s])) {
+                    // Its timers were cancelled.
+                    occupied[l] &= ~((uint64_t)1 << s);
+                } else {
+                    uint64_t t = (pos + k) << shift;
+                    if (t < next) {
+                        next = t;
+                    }
+                    break;
+                }
+            }
+        }
+        // Higher levels and the overflow list are only visited on
+        // later multiples of WHEEL_SIZE^(l+1).
+        int up = shift + LT_TIMER_WHEEL_BITS;
+        if (next <= ((now >> up) + 1) << up) {
+            return next;
+        }
+    }
+    if (!list_empty(&overflow)) {
+        int shift = LT_TIMER_WHEEL_LEVELS * LT_TIMER_WHEEL_BITS;
+        uint64_t t = ((now >> shift) + 1) << shift;
+        if (t < next) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+// Expired timers wait on the wheel's firing list, not a local one, so
+// if a callback raises an error the rest remain valid (and cancellable)
+// and are fired at the start of the next advance.
+void LTTimerWheel::fire_expired() {
+    while (!list_empty(&firing)) {
+        LTTimer *timer = (LTTimer*)firing.next;
+        list_remove(timer);
+        count--;
+        free_handle(timer->handle);
+        LTTimer fired = *timer;
+        delete timer;
+        handler->fire(&fired);
+    }
+}
+
+void LTTimerWheel::advance(LTfloat dt) {
+    fire_expired();
+    elapsed += (LTdouble)dt * LT_TIMER_TICKS_PER_SEC;
+    uint64_t target = (uint64_t)(elapsed + 1.0e-3);
+    if (count == 0) {
+        // Nothing to do, so skip straight to the target tick.
+        if (target > now) {
+            now = target;
+        }
+        return;
+    }
+    while (now < target) {
+        uint64_t next = next_tick();
+        if (next > target) {
+            now = target;
+            break;
+        }
+        now = next;
+        int index = now & LT_TIMER_WHEEL_MASK;
+        if (index == 0) {
+            // Pull timers down from the higher levels.
+            int level = 1;
+            uint64_t t = now >> LT_TIMER_WHEEL_BITS;
+            while (level < LT_TIMER_WHEEL_LEVELS) {
+                int i = t & LT_TIMER_WHEEL_MASK;
+                cascade(level, i);
+                if (i != 0) {
+                    break;
+                }
+                t >>= LT_TIMER_WHEEL_BITS;
+                level++;
+            }
+            if (level == LT_TIMER_WHEEL_LEVELS) {
+                cascade(&overflow);
+            }
+        }
+        // Detach the slot, so callbacks adding timers for this
+        // tick don't get run until the next advance.
+        occupied[0] &= ~((uint64_t)1 << index);
+        list_splice(&slots[0][index], &firing);
+        fire_expired();
+        if (count == 0) {
+            now = target;
+            break;
+        }
+    }
+}
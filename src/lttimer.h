@@ -0,0 +1,76 @@
+/* Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in lt.h. */
+LT_INIT_DECL(lttimer)
+
+// Hierarchical timing wheel.  Insert and cancel are O(1) and expiry
+// is amortised O(1).  Time is quantised to LT_TIMER_TICKS_PER_SEC ticks.
+// Each level has LT_TIMER_WHEEL_SIZE slots, each covering
+// LT_TIMER_WHEEL_SIZE times as many ticks as the level below.
+// Timers further out than the top level go on an overflow list.
+// Each level keeps a bitmap of the slots that may hold timers, so
+// advance skips straight over ticks with nothing to do.
+
+#define LT_TIMER_TICKS_PER_SEC  1000
+#define LT_TIMER_WHEEL_BITS     6
+#define LT_TIMER_WHEEL_SIZE     (1 << LT_TIMER_WHEEL_BITS)
+#define LT_TIMER_WHEEL_MASK     (LT_TIMER_WHEEL_SIZE - 1)
+#define LT_TIMER_WHEEL_LEVELS   4
+
+struct LTTimerWheel;
+
+struct LTTimerLink {
+    LTTimerLink *next;
+    LTTimerLink *prev;
+};
+
+struct LTTimer : LTTimerLink {
+    uint64_t expiry; // In ticks.
+    LTTimerWheel *wheel;
+    int handle;
+    int ref; // Owner-defined (usually a Lua reference to the callback).
+
+    LT_POOLED_ALLOC
+};
+
+struct LTTimerHandler {
+    virtual ~LTTimerHandler() {};
+    // Called when the timer expires.  The timer has already been
+    // removed from the wheel and freed, and fire is passed a copy,
+    // so fire may raise a Lua error.
+    virtual void fire(LTTimer *timer) = 0;
+    // Called when a pending timer is cancelled or cleared.
+    virtual void discard(LTTimer *timer) {};
+};
+
+struct LTTimerWheel {
+    LTTimerLink slots[LT_TIMER_WHEEL_LEVELS][LT_TIMER_WHEEL_SIZE];
+    // Bit s is set if slot s may be non-empty.  Cancelling doesn't
+    // clear bits; they're cleared when found to be stale.
+    uint64_t occupied[LT_TIMER_WHEEL_LEVELS];
+    LTTimerLink overflow;
+    LTTimerLink firing; // Expired timers not yet fired.
+    uint64_t now;       // Current tick.
+    LTdouble elapsed;   // Elapsed time in ticks (not rounded).
+    int count;
+    LTTimerHandler *handler;
+
+    LTTimerWheel(LTTimerHandler *handler);
+    // Pending timers are freed without notifying the handler.
+    virtual ~LTTimerWheel();
+
+    LTTimer *add(LTfloat secs, int ref);
+    void cancel(LTTimer *timer);
+    void clear();
+    void advance(LTfloat dt);
+
+private:
+    void insert(LTTimer *timer);
+    void cascade(LTTimerLink *slot);
+    void cascade(int level, int index);
+    uint64_t next_tick();
+    void fire_expired();
+};
+
+// Handles are small integers that are safe to keep after the timer
+// has fired or been cancelled (lookup then returns NULL).
+LTTimer *ltLookupTimer(int handle);
+int ltNumLiveTimers();
@@ -3,24 +3,408 @@
 
 LT_INIT_IMPL(lttween)
 
+/************************* Ease curves **************************/
+
+#define EASE_TABLE_SIZE 512
+
+struct LTEaseDef {
+    // Cubic bezier coefficients (only used for bezier curves).
+    LTfloat p1x, p1y, p2x, p2y;
+    LTfloat ax, bx, cx, ay, by, cy;
+    bool expensive;
+    LTfloat *table; // EASE_TABLE_SIZE + 1 samples, or NULL.
+};
+
+static const char *builtin_ease_names[LT_NUM_BUILTIN_EASES] = {
+    "linear", "in", "out", "inout", "backin", "backout", "elastic",
+    "bounce", "accel", "decel", "zoomin", "zoomout", "revolve",
+};
+
+static std::vector<LTEaseDef> ease_defs;
+static bool use_ease_tables = false;
+
+static void build_ease_table(int id);
+static void update_ease_funcs();
+
+static void init_ease_defs() {
+    if (ease_defs.empty()) {
+        ease_defs.resize(LT_NUM_BUILTIN_EASES);
+        for (int i = 0; i < LT_NUM_BUILTIN_EASES; i++) {
+            memset(&ease_defs[i], 0, sizeof(LTEaseDef));
+        }
+        ease_defs[LT_EASE_ELASTIC].expensive = true;
+        ease_defs[LT_EASE_REVOLVE].expensive = true;
+    }
+}
+
+const char *ltEaseName(int id) {
+    return builtin_ease_names[id];
+}
+
+int ltEaseId(const char *name) {
+    for (int i = 0; i < LT_NUM_BUILTIN_EASES; i++) {
+        if (strcmp(name, builtin_ease_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ltCubicBezierEaseId(LTfloat p1x, LTfloat p1y, LTfloat p2x, LTfloat p2y) {
+    init_ease_defs();
+    for (int i = LT_NUM_BUILTIN_EASES; i < (int)ease_defs.size(); i++) {
+        LTEaseDef *d = &ease_defs[i];
+        if (d->p1x == p1x && d->p1y == p1y && d->p2x == p2x && d->p2y == p2y) {
+            return i;
+        }
+    }
+    if (ease_defs.size() >= LT_MAX_EASES) {
+        return -1;
+    }
+    LTEaseDef d;
+    d.p1x = p1x;
+    d.p1y = p1y;
+    d.p2x = p2x;
+    d.p2y = p2y;
+    d.cx = 3.0f * p1x;
+    d.bx = 3.0f * (p2x - p1x) - d.cx;
+    d.ax = 1.0f - d.cx - d.bx;
+    d.cy = 3.0f * p1y;
+    d.by = 3.0f * (p2y - p1y) - d.cy;
+    d.ay = 1.0f - d.cy - d.by;
+    d.expensive = true;
+    d.table = NULL;
+    ease_defs.push_back(d);
+    int id = ease_defs.size() - 1;
+    if (use_ease_tables) {
+        build_ease_table(id);
+    }
+    return id;
+}
+
+bool ltValidEaseId(int id) {
+    init_ease_defs();
+    return id >= 0 && id < (int)ease_defs.size();
+}
+
+static inline LTfloat bezier_sample_x(const LTEaseDef *d, LTfloat t) {
+    return ((d->ax * t + d->bx) * t + d->cx) * t;
+}
+
+static LTfloat bezier_solve_x(const LTEaseDef *d, LTfloat x) {
+    static const LTfloat epsilon = 1.0e-5f;
+    // Try Newton's method first.
+    LTfloat t2 = x;
+    for (int i = 0; i < 8; i++) {
+        LTfloat x2 = bezier_sample_x(d, t2) - x;
+        if (fabsf(x2) < epsilon) {
+            return t2;
+        }
+        LTfloat d2 = (3.0f * d->ax * t2 + 2.0f * d->bx) * t2 + d->cx;
+        if (fabsf(d2) < 1.0e-6f) {
+            break;
+        }
+        t2 = t2 - x2 / d2;
+    }
+    // Fall back to bisection.
+    LTfloat t0 = 0.0f;
+    LTfloat t1 = 1.0f;
+    t2 = x;
+    if (t2 < t0) {
+        return t0;
+    }
+    if (t2 > t1) {
+        return t1;
+    }
+    for (int i = 0; i < 32 && t0 < t1; i++) {
+        LTfloat x2 = bezier_sample_x(d, t2);
+        if (fabsf(x2 - x) < epsilon) {
+            return t2;
+        }
+        if (x > x2) {
+            t0 = t2;
+        } else {
+            t1 = t2;
+        }
+        t2 = (t1 - t0) * 0.5f + t0;
+    }
+    return t2;
+}
+
+static LTfloat ease_exact(int id, LTfloat t) {
+    switch (id) {
+        case LT_EASE_LINEAR:  return t;
+        case LT_EASE_IN:      return ltEase_in(t);
+        case LT_EASE_OUT:     return ltEase_out(t);
+        case LT_EASE_INOUT:   return ltEase_inout(t);
+        case LT_EASE_BACKIN:  return ltEase_backin(t);
+        case LT_EASE_BACKOUT: return ltEase_backout(t);
+        case LT_EASE_ELASTIC: return ltEase_elastic(t);
+        case LT_EASE_BOUNCE:  return ltEase_bounce(t);
+        case LT_EASE_ACCEL:   return ltEase_accel(t);
+        case LT_EASE_DECEL:   return ltEase_decel(t);
+        case LT_EASE_ZOOMIN:  return ltEase_zoomin(t);
+        case LT_EASE_ZOOMOUT: return ltEase_zoomout(t);
+        case LT_EASE_REVOLVE: return ltEase_revolve(t);
+        default: {
+            const LTEaseDef *d = &ease_defs[id];
+            LTfloat t2 = bezier_solve_x(d, t);
+            return ((d->ay * t2 + d->by) * t2 + d->cy) * t2;
+        }
+    }
+}
+
+static void build_ease_table(int id) {
+    LTEaseDef *d = &ease_defs[id];
+    if (!d->expensive || d->table != NULL) {
+        return;
+    }
+    d->table = new LTfloat[EASE_TABLE_SIZE + 1];
+    for (int i = 0; i <= EASE_TABLE_SIZE; i++) {
+        d->table[i] = ease_exact(id, (LTfloat)i / (LTfloat)EASE_TABLE_SIZE);
+    }
+}
+
+LTfloat ltEase(int id, LTfloat t) {
+    if (use_ease_tables) {
+        const LTfloat *table = ease_defs[id].table;
+        if (table != NULL && t >= 0.0f && t <= 1.0f) {
+            LTfloat x = t * (LTfloat)EASE_TABLE_SIZE;
+            int i = (int)x;
+            if (i >= EASE_TABLE_SIZE) {
+                return table[EASE_TABLE_SIZE];
+            }
+            LTfloat f = x - (LTfloat)i;
+            return table[i] + (table[i + 1] - table[i]) * f;
+        }
+    }
+    return ease_exact(id, t);
+}
+
+void ltSetEaseTablesEnabled(bool enabled) {
+    init_ease_defs();
+    use_ease_tables = enabled;
+    if (enabled) {
+        for (int i = 0; i < (int)ease_defs.size(); i++) {
+            build_ease_table(i);
+        }
+    }
+    update_ease_funcs();
+}
+
+bool ltEaseTablesEnabled() {
+    return use_ease_tables;
+}
+
+/************************* Tween table **************************/
+
+struct LTTweenRecord {
+    LTTweenAction *action; // NULL once unscheduled (and then cancelled is true).
+    LTSceneNode *node;
+    LTFloatSetter setter;
+    LTIntSetter isetter;
+    LTEaseFunc ease_func;  // NULL if the curve is evaluated by ltEase.
+    LTfloat t;
+    LTfloat initial_val;
+    LTfloat distance;
+    LTfloat target_val;
+    LTfloat inv_time;
+    LTfloat delay;
+    int ease;
+    LTuint32 sequence;
+    bool cancelled;        // Copy of action->cancelled, to save a load.
+};
+
+static std::vector<LTTweenRecord> tweens;
+static int num_dead = 0;
+static bool advancing = false;
+static int pass_next = -1; // Next record to advance this pass, counting down.
+static LTfloat pass_dt = 0.0f;
+static int pass_advanced = 0;
+static LTdouble pass_secs = 0.0;
+static LTTweenStats tween_stats = {0, 0, 0.0};
+
+static const LTEaseFunc builtin_ease_funcs[LT_NUM_BUILTIN_EASES] = {
+    ltEase_linear, ltEase_in, ltEase_out, ltEase_inout, ltEase_backin,
+    ltEase_backout, ltEase_elastic, ltEase_bounce, ltEase_accel,
+    ltEase_decel, ltEase_zoomin, ltEase_zoomout, ltEase_revolve,
+};
+
+// Built-in curves not read from tables are called directly, which
+// is cheaper than dispatching on the id in ltEase.
+static LTEaseFunc direct_ease_func(int id) {
+    init_ease_defs();
+    if (id < LT_NUM_BUILTIN_EASES && !(use_ease_tables && ease_defs[id].expensive)) {
+        return builtin_ease_funcs[id];
+    }
+    return NULL;
+}
+
+static void update_ease_funcs() {
+    for (unsigned int i = 0; i < tweens.size(); i++) {
+        tweens[i].ease_func = direct_ease_func(tweens[i].ease);
+    }
+}
+
+// Removes unscheduled records, keeping the rest in order.
+static void compact_tweens() {
+    int j = 0;
+    int n = tweens.size();
+    for (int i = 0; i < n; i++) {
+        if (tweens[i].action != NULL) {
+            if (i != j) {
+                tweens[j] = tweens[i];
+                tweens[j].action->slot = j;
+            }
+            j++;
+        }
+    }
+    tweens.resize(j);
+    num_dead = 0;
+}
+
+void ltBeginTweens(LTfloat dt) {
+    // A Lua error in an on_done callback may have left us mid-pass.
+    advancing = false;
+    if (num_dead > 0) {
+        compact_tweens();
+    }
+    advancing = true;
+    pass_next = (int)tweens.size() - 1;
+    pass_dt = dt;
+    pass_advanced = 0;
+    pass_secs = 0.0;
+}
+
+// Advances records from pass_next down to the first one not scheduled
+// after the given sequence number, or to the start of the table if all
+// is true.  Tweens scheduled during the pass are appended to the table
+// and first run next pass.  The table may be reallocated by on_done
+// callbacks, so records are always accessed by index.
+static void advance_tweens(LTuint32 after, bool all) {
+    LT_PROFILE_SCOPE("tweens");
+    LTdouble t0 = ltGetTime();
+    LTfloat dt = pass_dt;
+    int i;
+    for (i = pass_next; i >= 0; i--) {
+        LTTweenRecord *r = &tweens[i];
+        if (!all && !ltActionSequenceAfter(r->sequence, after)) {
+            break;
+        }
+        if (r->cancelled) {
+            continue;
+        }
+        LTfloat speed = r->node->action_speed;
+        if (speed == 0.0f) {
+            continue;
+        }
+        pass_advanced++;
+        LTfloat sdt = dt * speed;
+        if (r->delay > 0.0f) {
+            r->delay -= sdt;
+            continue;
+        }
+        LTfloat inc = sdt * r->inv_time;
+        r->t += inc;
+        if (r->t < 1.0f - inc) {
+            LTfloat e = r->ease_func != NULL ? r->ease_func(r->t) : ltEase(r->ease, r->t);
+            LTfloat v = r->initial_val + r->distance * e;
+            if (r->setter != NULL) {
+                r->setter(r->node, v);
+            } else {
+                r->isetter(r->node, (LTint)roundf(v));
+            }
+            r->node->changed();
+        } else {
+            if (r->setter != NULL) {
+                r->setter(r->node, r->target_val);
+            } else {
+                r->isetter(r->node, (LTint)r->target_val);
+            }
+            r->node->changed();
+            pass_next = i - 1;
+            LTTweenAction *action = r->action;
+            if (action->on_done != NULL) {
+                action->on_done->done(action);
+            }
+            action->cancel();
+        }
+    }
+    pass_next = i;
+    pass_secs += ltGetTime() - t0;
+}
+
+void ltAdvanceTweens(LTuint32 after) {
+    if (pass_next >= 0 && ltActionSequenceAfter(tweens[pass_next].sequence, after)) {
+        advance_tweens(after, false);
+    }
+}
+
+void ltEndTweens() {
+    if (pass_next >= 0) {
+        advance_tweens(0, true);
+    }
+    advancing = false;
+    if (num_dead > 0) {
+        compact_tweens();
+    }
+    tween_stats.advanced = pass_advanced;
+    tween_stats.secs = pass_secs;
+}
+
+int ltNumActiveTweens() {
+    return tweens.size() - num_dead;
+}
+
+void ltGetTweenStats(LTTweenStats *stats) {
+    *stats = tween_stats;
+    stats->active = ltNumActiveTweens();
+}
+
+/************************* Tween actions **************************/
+
 LTTweenAction::LTTweenAction(LTSceneNode *node,
     LTFloatGetter getter, LTFloatSetter setter,
     LTfloat target_val, LTfloat time,
-    LTfloat delay, LTEaseFunc ease,
+    LTfloat delay, int ease,
     LTTweenOnDone *on_done) : LTAction(node)
 {
     LTTweenAction::getter = getter;
     LTTweenAction::setter = setter;
-    LTTweenAction::t = 0.0f;
+    LTTweenAction::igetter = NULL;
+    LTTweenAction::isetter = NULL;
     LTTweenAction::initial_val = getter(node);
+    LTTweenAction::action_id = (void*)getter;
+    init(target_val, time, delay, ease, on_done);
+}
+
+LTTweenAction::LTTweenAction(LTSceneNode *node,
+    LTIntGetter getter, LTIntSetter setter,
+    LTfloat target_val, LTfloat time,
+    LTfloat delay, int ease,
+    LTTweenOnDone *on_done) : LTAction(node)
+{
+    LTTweenAction::getter = NULL;
+    LTTweenAction::setter = NULL;
+    LTTweenAction::igetter = getter;
+    LTTweenAction::isetter = setter;
+    LTTweenAction::initial_val = (LTfloat)getter(node);
+    LTTweenAction::action_id = (void*)getter;
+    init(target_val, time, delay, ease, on_done);
+}
+
+void LTTweenAction::init(LTfloat target_val, LTfloat time, LTfloat delay, int ease,
+    LTTweenOnDone *on_done)
+{
+    LTTweenAction::t = 0.0f;
     LTTweenAction::target_val = target_val;
     LTTweenAction::time = time;
     LTTweenAction::delay = delay;
     LTTweenAction::ease = ease;
     LTTweenAction::on_done = on_done;
     LTTweenAction::distance = target_val - initial_val;
-    LTTweenAction::action_id = (void*)getter;
     LTTweenAction::no_dups = true;
+    LTTweenAction::slot = -1;
 }
 
 LTTweenAction::~LTTweenAction() {
@@ -30,81 +414,62 @@ LTTweenAction::~LTTweenAction() {
 }
 
 void LTTweenAction::on_cancel() {
+    if (scheduled) {
+        tweens[slot].cancelled = true;
+    }
     if (on_done != NULL) {
         on_done->on_cancel();
     }
 }
 
-bool LTTweenAction::doAction(LTfloat dt) {
-    if (delay > 0) {
-        delay -= dt;
-        return false;
-    }
-    LTfloat inc = dt / time;
-    t += inc;
-    if (t < 1.0f - inc) {
-        LTfloat v = initial_val + distance * ease(t);
-        setter(node, v);
-        return false;
-    } else {
-        setter(node, target_val);
-        if (on_done != NULL) {
-            on_done->done(this);
-        }
-        return true;
+void LTTweenAction::schedule() {
+    if (scheduled) {
+        ltLog("LTTweenAction::schedule: already scheduled");
+        ltAbort();
     }
+    LTTweenRecord r;
+    r.action = this;
+    r.node = node;
+    r.setter = setter;
+    r.isetter = isetter;
+    r.ease_func = direct_ease_func(ease);
+    r.t = t;
+    r.initial_val = initial_val;
+    r.distance = distance;
+    r.target_val = target_val;
+    r.inv_time = 1.0f / time;
+    r.delay = delay;
+    r.ease = ease;
+    sequence = ltNextActionSequence();
+    r.sequence = sequence;
+    r.cancelled = cancelled;
+    slot = tweens.size();
+    tweens.push_back(r);
+    scheduled = true;
 }
 
-LTIntTweenAction::LTIntTweenAction(LTSceneNode *node,
-    LTIntGetter getter, LTIntSetter setter,
-    LTfloat target_val, LTfloat time,
-    LTfloat delay, LTEaseFunc ease,
-    LTTweenOnDone *on_done) : LTAction(node)
-{
-    LTIntTweenAction::getter = getter;
-    LTIntTweenAction::setter = setter;
-    LTIntTweenAction::t = 0.0f;
-    LTIntTweenAction::initial_val = (LTfloat)getter(node);
-    LTIntTweenAction::target_val = target_val;
-    LTIntTweenAction::time = time;
-    LTIntTweenAction::delay = delay;
-    LTIntTweenAction::ease = ease;
-    LTIntTweenAction::on_done = on_done;
-    LTIntTweenAction::distance = target_val - initial_val;
-    LTIntTweenAction::action_id = (void*)getter;
-    LTIntTweenAction::no_dups = true;
-}
-
-LTIntTweenAction::~LTIntTweenAction() {
-    if (on_done != NULL) {
-        delete on_done;
+void LTTweenAction::unschedule() {
+    if (!scheduled) {
+        ltLog("LTTweenAction::unschedule: not scheduled");
+        ltAbort();
     }
-}
-
-void LTIntTweenAction::on_cancel() {
-    if (on_done != NULL) {
-        on_done->on_cancel();
+    // Save progress in case we're rescheduled.
+    LTTweenRecord *r = &tweens[slot];
+    t = r->t;
+    delay = r->delay;
+    // Records stay in scheduling order, so aren't moved here.
+    r->action = NULL;
+    r->cancelled = true;
+    num_dead++;
+    slot = -1;
+    scheduled = false;
+    if (!advancing && num_dead > (int)tweens.size() / 2) {
+        compact_tweens();
     }
 }
 
-bool LTIntTweenAction::doAction(LTfloat dt) {
-    if (delay > 0) {
-        delay -= dt;
-        return false;
-    }
-    LTfloat inc = dt / time;
-    t += inc;
-    if (t < 1.0f - inc) {
-        LTfloat v = initial_val + distance * ease(t);
-        setter(node, (LTint)roundf(v));
-        return false;
-    } else {
-        setter(node, (LTint)target_val);
-        if (on_done != NULL) {
-            on_done->done(this);
-        }
-        return true;
-    }
+bool LTTweenAction::doAction(LTfloat dt) {
+    return false;
 }
 
 LTTweenSet::LTTweenSet() {
@@ -161,9 +526,11 @@ bool ltAdvanceTween(LTTween *tween, LTfloat dt) {
         LTfloat v = v0 + (tween->v - v0) * tween->ease(t);
         tween->t = t + dt / tween->time;
         tween->setter(tween->owner, v);
+        tween->owner->changed();
         return false;
     } else {
         tween->setter(tween->owner, tween->v);
+        tween->owner->changed();
         return true;
     }
 }
@@ -9,52 +9,104 @@ struct LTTweenOnDone {
     virtual ~LTTweenOnDone() {};
     virtual void done(LTAction *action) = 0;
     virtual void on_cancel() {};
+
+    LT_POOLED_ALLOC
+};
+
+// Ease curves are referred to by id.  The built-in curves have fixed
+// ids; parametric curves (cubic bezier) are interned by their parameters
+// and get ids from LT_NUM_BUILTIN_EASES upwards.
+enum LTEaseId {
+    LT_EASE_LINEAR,
+    LT_EASE_IN,
+    LT_EASE_OUT,
+    LT_EASE_INOUT,
+    LT_EASE_BACKIN,
+    LT_EASE_BACKOUT,
+    LT_EASE_ELASTIC,
+    LT_EASE_BOUNCE,
+    LT_EASE_ACCEL,
+    LT_EASE_DECEL,
+    LT_EASE_ZOOMIN,
+    LT_EASE_ZOOMOUT,
+    LT_EASE_REVOLVE,
+    LT_NUM_BUILTIN_EASES,
 };
 
+#define LT_MAX_EASES 1024
+
+// Returns -1 if there is no curve with the given name.
+int ltEaseId(const char *name);
+// Name of a built-in curve.
+const char *ltEaseName(int id);
+// Returns -1 if there are too many distinct curves.
+int ltCubicBezierEaseId(LTfloat p1x, LTfloat p1y, LTfloat p2x, LTfloat p2y);
+bool ltValidEaseId(int id);
+LTfloat ltEase(int id, LTfloat t);
+
+// When enabled, expensive curves (elastic, revolve, bezier) are
+// evaluated by interpolating a precomputed table.
+void ltSetEaseTablesEnabled(bool enabled);
+bool ltEaseTablesEnabled();
+
+// Scheduled tweens don't go in the main action list.  Instead their
+// state is kept in a contiguous table, newest last, which is advanced in
+// batches as ltExecuteActions walks the list, so each tween still runs
+// at the point in the list where it would have been.  When no other
+// actions are scheduled after a tween, the whole table is one batch.
 struct LTTweenAction : LTAction {
-    LTFloatGetter getter;
+    LTFloatGetter getter;   // NULL for int tweens.
     LTFloatSetter setter;
+    LTIntGetter igetter;
+    LTIntSetter isetter;
     LTfloat t;
     LTfloat initial_val;
     LTfloat target_val;
     LTfloat distance;
     LTfloat time;
     LTfloat delay;
-    LTEaseFunc ease;
+    int ease;
     LTTweenOnDone *on_done;
+    int slot; // Position in tween table while scheduled.
 
     LTTweenAction(LTSceneNode *node, 
         LTFloatGetter getter, LTFloatSetter setter,
-        LTfloat target_val, LTfloat time, LTfloat delay, LTEaseFunc ease,
+        LTfloat target_val, LTfloat time, LTfloat delay, int ease,
+        LTTweenOnDone *on_done);
+    LTTweenAction(LTSceneNode *node, 
+        LTIntGetter getter, LTIntSetter setter,
+        LTfloat target_val, LTfloat time, LTfloat delay, int ease,
         LTTweenOnDone *on_done);
     virtual ~LTTweenAction();
     virtual void on_cancel();
+    virtual void schedule();
+    virtual void unschedule();
 
+    // Tweens are advanced by ltAdvanceTweens.
     virtual bool doAction(LTfloat dt);
-};
 
-struct LTIntTweenAction : LTAction {
-    LTIntGetter getter;
-    LTIntSetter setter;
-    LTfloat t;
-    LTfloat initial_val;
-    LTfloat target_val;
-    LTfloat distance;
-    LTfloat time;
-    LTfloat delay;
-    LTEaseFunc ease;
-    LTTweenOnDone *on_done;
-
-    LTIntTweenAction(LTSceneNode *node, 
-        LTIntGetter getter, LTIntSetter setter,
-        LTfloat target_val, LTfloat time, LTfloat delay, LTEaseFunc ease,
+private:
+    void init(LTfloat target_val, LTfloat time, LTfloat delay, int ease,
         LTTweenOnDone *on_done);
-    virtual ~LTIntTweenAction();
-    virtual void on_cancel();
+};
 
-    virtual bool doAction(LTfloat dt);
+// Called by ltExecuteActions.  ltAdvanceTweens advances, newest first,
+// the tweens scheduled after the given sequence number (see LTAction)
+// that haven't been advanced yet this pass.  ltEndTweens advances the
+// rest.
+void ltBeginTweens(LTfloat dt);
+void ltAdvanceTweens(LTuint32 after);
+void ltEndTweens();
+int ltNumActiveTweens();
+
+struct LTTweenStats {
+    int active;     // Tweens in the table.
+    int advanced;   // Tweens advanced in the last pass.
+    LTdouble secs;  // Time taken by the last pass.
 };
 
+void ltGetTweenStats(LTTweenStats *stats);
+
 struct LTTween {
     LTObject *owner;
     LTFloatGetter getter;
@@ -8,20 +8,221 @@ LTVector::LTVector(int capacity, int stride) {
     LTVector::capacity = capacity;
     LTVector::size = 0;
     data = new LTfloat[capacity * stride]();
+    touch();
 }
 
 LTVector::~LTVector() {
     delete[] data;
 }
 
+void LTVector::touch() {
+    static int last_version = 0;
+    version = ++last_version;
+}
+
 LT_REGISTER_TYPE(LTVector, "lt.VectorImpl", "lt.Object")
 
+// The loops below are kept free of branches and function calls so the
+// compiler can vectorise them.
+
+void ltVectorAdd(LTVector *v, int col, LTfloat c) {
+    int stride = v->stride;
+    int n = v->size;
+    LTfloat *p = v->data + col;
+    for (int i = 0; i < n; i++) {
+        p[i * stride] += c;
+    }
+    v->touch();
+}
+
+void ltVectorMultiply(LTVector *v, int col, LTfloat m) {
+    int stride = v->stride;
+    int n = v->size;
+    LTfloat *p = v->data + col;
+    for (int i = 0; i < n; i++) {
+        p[i * stride] *= m;
+    }
+    v->touch();
+}
+
+void ltVectorMultiplyAdd(LTVector *v, int dst, int src, LTfloat m) {
+    int stride = v->stride;
+    int n = v->size;
+    LTfloat *d = v->data + dst;
+    LTfloat *s = v->data + src;
+    for (int i = 0; i < n; i++) {
+        d[i * stride] += s[i * stride] * m;
+    }
+    v->touch();
+}
+
+void ltVectorClamp(LTVector *v, int col, LTfloat lo, LTfloat hi) {
+    int stride = v->stride;
+    int n = v->size;
+    LTfloat *p = v->data + col;
+    for (int i = 0; i < n; i++) {
+        LTfloat x = p[i * stride];
+        x = x < lo ? lo : x;
+        p[i * stride] = x > hi ? hi : x;
+    }
+    v->touch();
+}
+
+void ltVectorWrap(LTVector *v, int col, LTfloat lo, LTfloat hi) {
+    int stride = v->stride;
+    int n = v->size;
+    LTfloat *p = v->data + col;
+    LTfloat w = hi - lo;
+    if (w <= 0.0f) {
+        return;
+    }
+    LTfloat inv_w = 1.0f / w;
+    for (int i = 0; i < n; i++) {
+        LTfloat x = p[i * stride] - lo;
+        x -= w * floorf(x * inv_w);
+        // Rounding can leave x equal to w.
+        p[i * stride] = lo + (x >= w ? 0.0f : x);
+    }
+    v->touch();
+}
+
+void ltVectorLerp(LTVector *v, int dst, int a, int b, LTfloat t) {
+    int stride = v->stride;
+    int n = v->size;
+    LTfloat *d = v->data + dst;
+    LTfloat *pa = v->data + a;
+    LTfloat *pb = v->data + b;
+    for (int i = 0; i < n; i++) {
+        LTfloat x = pa[i * stride];
+        d[i * stride] = x + (pb[i * stride] - x) * t;
+    }
+    v->touch();
+}
+
+void ltVectorRandom(LTVector *v, int col, LTfloat lo, LTfloat hi, LTRandomGenerator *r) {
+    int stride = v->stride;
+    int n = v->size;
+    LTfloat *p = v->data + col;
+    if (r != NULL) {
+        LTfloat w = hi - lo;
+        for (int i = 0; i < n; i++) {
+            p[i * stride] = lo + r->nextFloat() * w;
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            p[i * stride] = ltRandBetween(lo, hi);
+        }
+    }
+    v->touch();
+}
+
+static bool indices_in_range(LTVector *index, int index_col, int n, int max) {
+    LTfloat *ip = index->data + index_col;
+    int stride = index->stride;
+    for (int i = 0; i < n; i++) {
+        int j = (int)ip[i * stride];
+        if (j < 1 || j > max) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ltVectorGather(LTVector *dst, int dst_col, LTVector *src, int src_col, int ncols,
+    LTVector *index, int index_col)
+{
+    int n = dst->size;
+    if (!indices_in_range(index, index_col, n, src->size)) {
+        return false;
+    }
+    LTfloat *ip = index->data + index_col;
+    for (int i = 0; i < n; i++) {
+        int j = (int)ip[i * index->stride] - 1;
+        LTfloat *d = dst->data + i * dst->stride + dst_col;
+        LTfloat *s = src->data + j * src->stride + src_col;
+        for (int k = 0; k < ncols; k++) {
+            d[k] = s[k];
+        }
+    }
+    dst->touch();
+    return true;
+}
+
+bool ltVectorScatter(LTVector *dst, int dst_col, LTVector *src, int src_col, int ncols,
+    LTVector *index, int index_col)
+{
+    int n = src->size;
+    if (!indices_in_range(index, index_col, n, dst->size)) {
+        return false;
+    }
+    LTfloat *ip = index->data + index_col;
+    for (int i = 0; i < n; i++) {
+        int j = (int)ip[i * index->stride] - 1;
+        LTfloat *d = dst->data + j * dst->stride + dst_col;
+        LTfloat *s = src->data + i * src->stride + src_col;
+        for (int k = 0; k < ncols; k++) {
+            d[k] = s[k];
+        }
+    }
+    dst->touch();
+    return true;
+}
+
+void ltVectorFillImageQuads(LTVector *v, int col, LTTexturedNode *img,
+    LTVector *offsets, int offsets_col, int verts_per_quad)
+{
+    // Corners of the quad as x, y, u, v, in the orders bottom left,
+    // bottom right, top left, top left, bottom right, top right for
+    // triangles and bottom left, bottom right, top left, top right for
+    // a strip.
+    static const int tri_corners[6] = {0, 1, 3, 3, 1, 2};
+    static const int strip_corners[4] = {0, 1, 3, 2};
+    const int *corners = verts_per_quad == 6 ? tri_corners : strip_corners;
+    LTfloat quad[6][4];
+    for (int i = 0; i < verts_per_quad; i++) {
+        int c = corners[i];
+        quad[i][0] = img->world_vertices[c * 2];
+        quad[i][1] = img->world_vertices[c * 2 + 1];
+        quad[i][2] = (LTfloat)img->tex_coords[c * 2] / (LTfloat)LT_MAX_TEX_COORD;
+        quad[i][3] = (LTfloat)img->tex_coords[c * 2 + 1] / (LTfloat)LT_MAX_TEX_COORD;
+    }
+    int n = offsets->size;
+    int stride = v->stride;
+    LTfloat *data = v->data + col;
+    LTfloat *os_data = offsets->data + offsets_col;
+    for (int i = 0; i < n; i++) {
+        LTfloat x = os_data[0];
+        LTfloat y = os_data[1];
+        for (int j = 0; j < verts_per_quad; j++) {
+            data[0] = quad[j][0] + x;
+            data[1] = quad[j][1] + y;
+            data[2] = quad[j][2];
+            data[3] = quad[j][3];
+            data += stride;
+        }
+        os_data += offsets->stride;
+    }
+    v->touch();
+}
+
 LTDrawVector::LTDrawVector() {
     mode = LT_DRAWMODE_TRIANGLES;
     dimensions = 2;
     vertex_offset = 1;
     color_offset = 0;
     texture_offset = 0;
+    vertbuf = 0;
+    vb_vector = NULL;
+    vb_version = 0;
+    vb_dynamic = false;
+    seen_vector = NULL;
+    seen_version = 0;
+}
+
+LTDrawVector::~LTDrawVector() {
+    if (vertbuf != 0) {
+        ltDeleteVertBuffer(vertbuf);
+    }
 }
 
 void LTDrawVector::init(lua_State *L) {
@@ -47,19 +248,56 @@ void LTDrawVector::init(lua_State *L) {
     }
 }
 
+void LTDrawVector::ensure_vb_uptodate() {
+    if (vertbuf == 0) {
+        vertbuf = ltGenVertBuffer();
+        vb_vector = NULL;
+    }
+    ltBindVertBuffer(vertbuf);
+    if (vb_vector != vector || vb_version != vector->version) {
+        int bytes = vector->size * vector->stride * sizeof(LTfloat);
+        if (vb_vector == vector) {
+            vb_dynamic = true;
+        }
+        if (vb_dynamic) {
+            ltDynamicVertBufferData(bytes, vector->data);
+        } else {
+            ltStaticVertBufferData(bytes, vector->data);
+        }
+        vb_vector = vector;
+        vb_version = vector->version;
+    }
+}
+
+int LTDrawVector::last_change() {
+    // The vector's data isn't a field, so check its version instead.
+    if (vector != seen_vector || (vector != NULL && vector->version != seen_version)) {
+        seen_vector = vector;
+        seen_version = vector != NULL ? vector->version : 0;
+        changed();
+    }
+    return change_stamp;
+}
+
 void LTDrawVector::draw() {
+    if (vector->size == 0) {
+        return;
+    }
     int stride = vector->stride * sizeof(LTfloat);
-    ltBindVertBuffer(0);
-    ltVertexPointer(dimensions, LT_VERT_DATA_TYPE_FLOAT, stride, vector->data + vertex_offset);
+    ensure_vb_uptodate();
+    ltVertexPointer(dimensions, LT_VERT_DATA_TYPE_FLOAT, stride,
+        (void*)(LTuintptr)(vertex_offset * sizeof(LTfloat)));
     if (texture_offset >= 0 && image != NULL) {
         ltEnableTexture(image->texture_id);
-        ltTexCoordPointer(2, LT_VERT_DATA_TYPE_FLOAT, stride, vector->data + texture_offset);
+        ltTexCoordPointer(2, LT_VERT_DATA_TYPE_FLOAT, stride,
+            (void*)(LTuintptr)(texture_offset * sizeof(LTfloat)));
     } else {
         ltDisableTextures();
     }
     if (color_offset >= 0) {
         ltEnableColorArrays();
-        ltColorPointer(4, LT_VERT_DATA_TYPE_FLOAT, stride, vector->data + color_offset);
+        ltColorPointer(4, LT_VERT_DATA_TYPE_FLOAT, stride,
+            (void*)(LTuintptr)(color_offset * sizeof(LTfloat)));
     }
     ltDrawArrays(mode, 0, vector->size);
     if (color_offset >= 0) {
@@ -6,13 +6,51 @@ struct LTVector : LTObject {
     int capacity; // In terms of records.
     int size;     // How many records are used.
 
+    // Changes whenever data is modified.  Versions are unique across
+    // all vectors, so a (vector, version) pair identifies some contents.
+    int version;
+
     LTfloat *data;
 
     LTVector() { ltAbort(); };
     LTVector(int capacity, int stride);
     virtual ~LTVector();
+
+    // Must be called after modifying data.
+    void touch();
 };
 
+// Column operations.  These work on all size records of a vector.
+// Columns are 0 based (the Lua bindings take 1 based columns) and are
+// not range checked.  They call touch() on the vector they modify.
+
+void ltVectorAdd(LTVector *v, int col, LTfloat c);                           // col += c
+void ltVectorMultiply(LTVector *v, int col, LTfloat m);                      // col *= m
+void ltVectorMultiplyAdd(LTVector *v, int dst, int src, LTfloat m);          // dst += src * m
+void ltVectorClamp(LTVector *v, int col, LTfloat lo, LTfloat hi);
+void ltVectorWrap(LTVector *v, int col, LTfloat lo, LTfloat hi);             // Into [lo, hi).
+void ltVectorLerp(LTVector *v, int dst, int a, int b, LTfloat t);            // dst = a + (b - a) * t
+// Uses r if given, otherwise ltRandBetween.
+void ltVectorRandom(LTVector *v, int col, LTfloat lo, LTfloat hi, LTRandomGenerator *r);
+
+// dst[i][dst_col + k] = src[index[i]][src_col + k] for each record i of
+// dst and k < ncols.  index holds 1 based record numbers in index_col
+// and must have at least dst->size records.  Returns false, without
+// changing dst, if an index is out of range.
+bool ltVectorGather(LTVector *dst, int dst_col, LTVector *src, int src_col, int ncols,
+    LTVector *index, int index_col);
+// dst[index[i]][dst_col + k] = src[i][src_col + k] for each record i of
+// src.  index must have at least src->size records.
+bool ltVectorScatter(LTVector *dst, int dst_col, LTVector *src, int src_col, int ncols,
+    LTVector *index, int index_col);
+
+// Writes x, y, u, v columns starting at col for one quad of img per
+// record of offsets, placed at the x, y in offsets_col.  With 6 records
+// per quad the quads are pairs of triangles, for LT_DRAWMODE_TRIANGLES.
+// With 4 they are in triangle strip order.
+void ltVectorFillImageQuads(LTVector *v, int col, LTTexturedNode *img,
+    LTVector *offsets, int offsets_col, int verts_per_quad);
+
 //struct LTEmitterColumnSpec {
 //    LTfloat value;
 //    LTfloat variance;
@@ -36,9 +74,25 @@ struct LTDrawVector : LTSceneNode {
     LTDrawMode mode;
     LTTexturedNode *image;
 
+    // A copy of the vector's data (all columns, so changing the offsets
+    // doesn't require a new copy).  Refilled when the vector or its
+    // version changes.
+    LTvertbuf vertbuf;
+    LTVector *vb_vector;
+    int vb_version;
+    bool vb_dynamic; // Set once the data has changed after the first upload.
+
+    // The vector and version last seen by last_change().
+    LTVector *seen_vector;
+    int seen_version;
+
     LTDrawVector();
+    virtual ~LTDrawVector();
     virtual void init(lua_State *L);
     virtual void draw();
+    virtual int last_change();
+
+    void ensure_vb_uptodate();
 };
 
 //struct LTDrawTexturedQuads : LTSceneNode {
@@ -10,6 +10,14 @@ struct t_face_component {
 
 typedef std::vector<t_face_component> t_face;
 
+struct t_face_component_less {
+    bool operator()(const t_face_component &a, const t_face_component &b) const {
+        if (a.v != b.v) return a.v < b.v;
+        if (a.t != b.t) return a.t < b.t;
+        return a.n < b.n;
+    }
+};
+
 char *skip_line(char *str) {
     while (*str != '\n' && *str != '\0') {
         str++;
@@ -23,7 +31,7 @@ char *skip_line(char *str) {
 
 bool ltReadWavefrontMesh(const char *filename, LTMesh *mesh) {
     // Init obj in case we return false.
-    new (mesh) LTMesh(0, false, false, false, NULL, LT_DRAWMODE_TRIANGLES, NULL, 0);
+    new (mesh) LTMesh(0, NULL, LT_DRAWMODE_TRIANGLES, 0);
 
     int len;
     char *str0 = ltReadTextResource(filename, &len);
@@ -94,6 +102,8 @@ bool ltReadWavefrontMesh(const char *filename, LTMesh *mesh) {
                 while (*str != '\n') {
                     t_face_component fc;
                     fc.v = strtol(str, &str, 10);
+                    fc.t = 0;
+                    fc.n = 0;
                     if (*str == '/') {
                         str++;
                         if (*str == '/') {
@@ -101,6 +111,9 @@ bool ltReadWavefrontMesh(const char *filename, LTMesh *mesh) {
                             str++;
                         } else {
                             fc.t = strtol(str, &str, 10);
+                            if (*str == '/') {
+                                str++;
+                            }
                         }
                         if (*str >= '0' && *str <= '9') {
                             fc.n = strtol(str, &str, 10);
@@ -143,47 +156,70 @@ bool ltReadWavefrontMesh(const char *filename, LTMesh *mesh) {
 
     bool has_normals = faces[0][0].n > 0;
     bool has_texture_coords = faces[0][0].t > 0;   
-    int stride = 4 * 3;
-    if (has_normals) {
-        stride += 4;
-    }
-    if (has_texture_coords) {
-        stride += 4;
-    }
 
-    LTVertData *vdata = new LTVertData[3 * num_faces];
-    int k = 0;
+    // Check all indices before touching the mesh.
     for (int i = 0; i < num_faces; i++) {
         for (int j = 0; j < 3; j++) {
-            int v = faces[i][j].v - 1;
-            if (v < 0) {
+            if (faces[i][j].v - 1 < 0 || faces[i][j].v > (long)vertices.size()) {
                 ltLog("%s: Error: missing vertex in face %d, vertex %d", filename, i, j);
                 return false;
             }
-            int n = faces[i][j].n - 1;
-            if (has_normals && n < 0) {
+            if (has_normals && (faces[i][j].n - 1 < 0 || faces[i][j].n > (long)normals.size())) {
                 ltLog("%s: Error: missing normal in face %d, t_vertex %d", filename, i, j);
                 return false;
             }
-            int t = faces[i][j].t - 1;
-            if (has_texture_coords && t < 0) {
+            if (has_texture_coords
+                && (faces[i][j].t - 1 < 0 || faces[i][j].t > (long)texture_coords.size()))
+            {
                 ltLog("%s: Error: missing texture coords in face %d, vertex %d", filename, i, j);
                 return false;
             }
+        }
+    }
 
-            vdata[k].xyz = vertices[v];
-            if (n >= 0) {
-                vdata[k].normal = normals[n];
-            }
-            if (t >= 0) {
-                vdata[k].uv = texture_coords[t];
+    // Face components that share the same vertex, texture coords and
+    // normal become one indexed vertex.
+    std::map<t_face_component, LTvertindex32, t_face_component_less> index_of;
+    std::vector<t_face_component> unique;
+    std::vector<LTvertindex32> indices;
+    for (int i = 0; i < num_faces; i++) {
+        for (int j = 0; j < 3; j++) {
+            t_face_component fc = faces[i][j];
+            if (!has_normals) fc.n = 0;
+            if (!has_texture_coords) fc.t = 0;
+            std::map<t_face_component, LTvertindex32, t_face_component_less>::iterator it =
+                index_of.find(fc);
+            if (it == index_of.end()) {
+                LTvertindex32 index = unique.size();
+                index_of[fc] = index;
+                unique.push_back(fc);
+                indices.push_back(index);
+            } else {
+                indices.push_back(it->second);
             }
-            k++;
         }
     }
-    assert(k == num_faces * 3);
 
+    int num_vertices = unique.size();
     mesh->~LTMesh(); // deconstruct before constructing again.
-    new (mesh) LTMesh(3, false, has_normals, has_texture_coords, NULL, LT_DRAWMODE_TRIANGLES, vdata, num_faces * 3);
+    new (mesh) LTMesh(3, NULL, LT_DRAWMODE_TRIANGLES, num_vertices);
+    if (has_normals) {
+        mesh->ensure_normals();
+    }
+    if (has_texture_coords) {
+        mesh->ensure_texture_coords();
+    }
+    for (int i = 0; i < num_vertices; i++) {
+        mesh->xyzs[i] = vertices[unique[i].v - 1];
+        if (has_normals) {
+            mesh->set_normal(i, normals[unique[i].n - 1]);
+        }
+        if (has_texture_coords) {
+            mesh->uvs[i] = texture_coords[unique[i].t - 1];
+        }
+    }
+    mesh->resize_indices(indices.size());
+    memcpy(mesh->indices, &indices[0], sizeof(LTvertindex32) * indices.size());
+
     return true;
 }
@@ -49,6 +49,8 @@ mt_add("lt.SceneNode", "Material", lt.Material)
 mt_add("lt.SceneNode", "CullFace", lt.CullFace)
 mt_add("lt.SceneNode", "Hidden", lt.Hidden)
 mt_add("lt.SceneNode", "RenderTarget", lt.RenderTarget)
+mt_add("lt.SceneNode", "Bake", lt.Bake)
+mt_add("lt.SceneNode", "RenderQueue", lt.RenderQueue)
 
 mt_add("lt.SceneNode", "Event", lt.AddEventHandler)
 mt_add("lt.SceneNode", "Mouse", lt.AddMouseHandler)
@@ -84,6 +86,14 @@ mt_add("lt.Layer", "Size", lt.LayerSize)
 
 mt_add("lt.VectorImpl", "GenerateColumn", lt.GenerateVectorColumn)
 mt_add("lt.VectorImpl", "FillWithImage", lt.FillVectorColumnsWithImageQuads)
+mt_add("lt.VectorImpl", "Add", lt.AddToVectorColumn)
+mt_add("lt.VectorImpl", "Multiply", lt.MultiplyVectorColumn)
+mt_add("lt.VectorImpl", "MultiplyAdd", lt.MultiplyAddVectorColumns)
+mt_add("lt.VectorImpl", "Clamp", lt.ClampVectorColumn)
+mt_add("lt.VectorImpl", "Wrap", lt.WrapVectorColumn)
+mt_add("lt.VectorImpl", "Lerp", lt.LerpVectorColumns)
+mt_add("lt.VectorImpl", "Gather", lt.GatherVectorColumns)
+mt_add("lt.VectorImpl", "Scatter", lt.ScatterVectorColumns)
 
 --lt.TweenSet_mt.Advance = lt.AdvanceTweens
 --lt.TweenSet_mt.Add = lt.AddTweens
@@ -9,72 +9,90 @@ function lt.SpriteSet()
     return sprites
 end
 
-local global_sprites = lt.SpriteSet()
-
-local
-function sprite_reset(sprite)
-    sprite.child = sprite.frames[1]
-    sprite.t_accum = 0
-    sprite.curr_frame = 1
-end
-
--- frames is an array of images.
-function lt.Sprite(frames, fps, spriteset)
-    if not spriteset then
-        spriteset = global_sprites
+-- frames is an array of images.  mode is "loop" (the default), "once"
+-- or "pingpong".  callback, if given, is called as callback(sprite, "loop")
+-- each time the animation wraps around and callback(sprite, "finish")
+-- when a "once" animation reaches its last frame.
+-- Sprites are advanced natively while they're in the scene graph,
+-- at the node's action_speed.
+-- Old code may instead pass a sprite set as the third argument, in which
+-- case the sprite is only advanced by lt.AdvanceSprites.
+function lt.Sprite(frames, fps, mode, callback)
+    local spriteset
+    if type(mode) == "table" then
+        spriteset = mode
+        mode = nil
+    elseif mode ~= nil and type(mode) ~= "string" then
+        error("lt.Sprite: argument 3 should be a mode string or a sprite set", 2)
     end
-    local n = #spriteset
-    local sprite = lt.Wrap(frames[1])
+    local sprite = lt.MakeSprite(frames, fps, callback)
     sprite.frames = frames
-    sprite.spf = 1 / fps -- secs per frame
-    sprite.t_accum = 0
-    sprite.curr_frame = 1
-    sprite.paused = false
-    sprite.loop = true
-    sprite.Reset = sprite_reset
-    spriteset[n + 1] = sprite
+    if mode then
+        sprite.mode = mode
+    end
+    if spriteset then
+        sprite.auto_advance = false
+        spriteset[#spriteset + 1] = sprite
+    end
     return sprite
 end
 
 function lt.AdvanceSprites(spriteset, step)
-    local t_accum
-    local spf -- secs per frame
-    local num_frames
-    local frames
-    local curr_frame
-    local prev_frame
     for _, sprite in pairs(spriteset) do
-        if not sprite.paused then
-            spf = sprite.spf
-            t_accum = sprite.t_accum + step
-            frames = sprite.frames
-            num_frames = #frames
-            curr_frame = sprite.curr_frame
-            prev_frame = curr_frame
-            while t_accum >= spf do
-                t_accum = t_accum - spf
-                curr_frame = curr_frame + 1
-                if curr_frame > num_frames then
-                    if sprite.loop then
-                        curr_frame = type(sprite.loop) == "number" and sprite.loop or 1
-                    else
-                        curr_frame = num_frames
-                    end
-                end
-            end
-            sprite.t_accum = t_accum
-            if prev_frame ~= curr_frame then
-                sprite.curr_frame = curr_frame
-                sprite.child = frames[curr_frame]
-            end
-        end
+        sprite:Advance(step)
     end
 end
 
+-- Sprites not in a sprite set advance themselves, so there is
+-- no global set any more.
 function lt.AdvanceGlobalSprites(dt)
-    lt.AdvanceSprites(global_sprites, dt or lt.secs_per_frame)
 end
 
 function lt.ClearGlobalSprites()
-    global_sprites = lt.SpriteSet()
+end
+
+-------------------------------------------------------------
+-- Old style sprites had a 'loop' field, which was true, false (stop on
+-- the last frame) or the frame to restart from, and a 'child' field
+-- holding the current frame.  Map these to the native fields.
+
+local sprite_mt = lt_metatables["lt.SpriteImpl"]
+local native_index = sprite_mt.__index
+local native_newindex = sprite_mt.__newindex
+
+sprite_mt.__index = function(sprite, field)
+    if field == "loop" then
+        local mode = sprite.mode
+        if mode == "once" then
+            return false
+        elseif mode == "loop" and sprite.loop_frame ~= 1 then
+            return sprite.loop_frame
+        else
+            return true
+        end
+    elseif field == "child" then
+        local frames = sprite.frames
+        return frames and frames[sprite.curr_frame]
+    end
+    return native_index(sprite, field)
+end
+
+sprite_mt.__newindex = function(sprite, field, value)
+    if field == "loop" then
+        if value == false or value == nil then
+            sprite.mode = "once"
+        elseif value == true then
+            sprite.mode = "loop"
+            sprite.loop_frame = 1
+        elseif type(value) == "number" then
+            sprite.mode = "loop"
+            sprite.loop_frame = value
+        else
+            error("sprite.loop should be a boolean or a frame number", 2)
+        end
+    elseif field == "child" then
+        error("sprite.child is read-only; set curr_frame instead", 2)
+    else
+        native_newindex(sprite, field, value)
+    end
 end
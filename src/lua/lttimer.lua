@@ -1,13 +1,25 @@
 -- Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in ../lt.h
-local global_timers = {}
+
+-- Timers are kept natively in a timing wheel (see lttimer.cpp).
+--
+-- lt.Timer(t, func) calls func after t seconds of lt.AdvanceGlobalTimers.
+-- lt.Timer(t, func, node) attaches the timer to a scene node instead.
+-- It is advanced with the node's actions, so it respects the node's
+-- action_speed and freezes while the node is paused or not in the scene.
+-- Both forms return a handle for lt.CancelTimer.
+--
+-- Passing a plain table as the third argument keeps the old behaviour
+-- of a timer set advanced by lt.AdvanceTimers.
 
 local insert = table.insert
+local add_timer = lt.AddTimer
 
 function lt.Timer(t, func, timers)
-    if timers == nil then
-        timers = global_timers
+    if type(timers) == "table" then
+        insert(timers, {action = func, t = t})
+    else
+        return add_timer(t, func, timers)
     end
-    insert(timers, {action = func, t = t})
 end
 
 function lt.AdvanceTimers(dt, timers)
@@ -22,13 +34,3 @@ function lt.AdvanceTimers(dt, timers)
         end
     end
 end
-
-local ad = lt.AdvanceTimers
-
-function lt.AdvanceGlobalTimers(dt)
-    ad(dt, global_timers)
-end
-
-function lt.ClearGlobalTimers()
-    global_timers = {}
-end
@@ -1,4 +1,7 @@
 -- Copyright (C) 2010-2013 Ian MacLarty. See Copyright Notice in ../lt.h
+-- Maps the ease functions below to their ease ids.
+local ease_func_ids = setmetatable({}, {__mode = "k"})
+
 function lt.Tween(node, tween_info)
     local fields = {}
     local time = 0
@@ -10,7 +13,14 @@ function lt.Tween(node, tween_info)
         if field == "time" then
             time = value
         elseif field == "easing" then
-            easing = value
+            if type(value) == "function" then
+                easing = ease_func_ids[value]
+                if not easing then
+                    error("easing function not created by lt.CubicBezierEase or one of the lt.*Ease functions", 2)
+                end
+            else
+                easing = value
+            end
         elseif field == "action" then
             action = value
         elseif field == "delay" then
@@ -43,144 +53,37 @@ end
 
 -------------------------------------------------------------
 
-function lt.LinearEase(t)
-    return t
-end
-
-function lt.EaseIn(t)
-    return math.pow(t, 3)
-end
-
-function lt.EaseOut(t)
-    return math.pow(t - 1, 3) + 1
-end
+-- The easing curves are implemented natively (see lttween.cpp).
+-- These wrappers are for evaluating them from Lua.  They may also be
+-- passed as the easing argument to lt.Tween.
+-- lt.CubicBezierEaseId(p1x, p1y, p2x, p2y) returns the id of a bezier
+-- curve, which lt.AddTween, lt.Tween and lt.Ease accept directly.
 
-function lt.EaseInOut(t)
-    t = t * 2
-    if t < 1 then
-        return math.pow(t, 3) / 2
+local
+function ease_func(id)
+    local f = function(t)
+        return lt.Ease(id, t)
     end
-    t = t - 2
-    return (math.pow(t, 3) + 2) / 2
-end
-
-function lt.BackInEase(t)
-    local s = 1.70158
-    return t * t * ((s + 1) * t - s)
-end
-
-function lt.BackOutEase(t)
-    t = t - 1
-    local s = 1.70158
-    return t * t * ((s + 1) * t + s) + 1
-end
-
-function lt.ElasticEase(t)
-    if t == 0 or t == 1 then
-        return t
-    end
-    local p = 0.3
-    local s = p / 4
-    return math.pow(2, -10 * t) * math.sin((t - s) * (2 * math.pi) / p) + 1
-end
-
-function lt.BounceEase(t)
-    local s = 7.5625
-    local p = 2.75
-    local l
-    if t < 1 / p then
-        l = s * t * t
-    else
-        if t < 2 / p then
-            t = t - 1.5 / p
-            l = s * t * t + 0.75
-        else
-            if t < 2.5 / p then
-                t = t - 2.25 / p
-                l = s * t * t + 0.9375
-            else
-                t = t - 2.625 / p
-                l = s * t * t + 0.984375
-            end
-        end
-    end
-    return l
-end
+    ease_func_ids[f] = id
+    return f
+end
+
+lt.LinearEase = ease_func(lt.EaseId("linear"))
+lt.EaseIn = ease_func(lt.EaseId("in"))
+lt.EaseOut = ease_func(lt.EaseId("out"))
+lt.EaseInOut = ease_func(lt.EaseId("inout"))
+lt.BackInEase = ease_func(lt.EaseId("backin"))
+lt.BackOutEase = ease_func(lt.EaseId("backout"))
+lt.ElasticEase = ease_func(lt.EaseId("elastic"))
+lt.BounceEase = ease_func(lt.EaseId("bounce"))
+lt.AccelEase = ease_func(lt.EaseId("accel"))
+lt.DeccelEase = ease_func(lt.EaseId("decel"))
+lt.ZoomInEase = ease_func(lt.EaseId("zoomin"))
+lt.ZoomOutEase = ease_func(lt.EaseId("zoomout"))
+lt.RevolveEase = ease_func(lt.EaseId("revolve"))
 
 function lt.CubicBezierEase(p1x, p1y, p2x, p2y)
-    return function(t)
-        local cx = 3 * p1x
-        local bx = 3 * (p2x - p1x) - cx
-        local ax = 1 - cx - bx
-        local cy = 3 * p1y
-        local by = 3 * (p2y - p1y) - cy
-        local ay = 1 - cy - by
-        local function sampleCurveX(t)
-            return ((ax * t + bx) * t + cx) * t
-        end
-        local function solveCurveX(x, epsilon)
-            local t0, t1, t2, x2, d2, i
-            t2 = x
-            for i = 0, 7 do
-                x2 = sampleCurveX(t2) - x
-                if math.abs(x2) < epsilon then
-                    return t2
-                end
-                d2 = (3 * ax * t2 + 2 * bx) * t2 + cx
-                if math.abs(d2) < 1e-6 then
-                    break
-                end
-                t2 = t2 - x2 / d2
-            end
-            t0 = 0
-            t1 = 1
-            t2 = x
-            if t2 < t0 then
-                return t0
-            end
-            if t2 > t1 then
-                return t1
-            end
-            while t0 < t1 do
-                x2 = sampleCurveX(t2)
-                if math.abs(x2 - x) < epsilon then
-                    return t2
-                end
-                if x > x2 then
-                    t0 = t2
-                else
-                    t1 = t2
-                end
-                t2 = (t1 - t0) / 2 + t0
-            end
-            return t2
-        end
-        local t2 = solveCurveX(t, 0.001)
-        return ((ay * t2 + by) * t2 + cy) * t2
-    end
-end
-
-function lt.AccelEase(t)
-    return t * t
-end
-
-function lt.DeccelEase(t)
-    local t1 = 1 - t
-    return 1 - (t1 * t1)
-end
-
-function lt.ZoomInEase(t)
-    local s = 0.05
-    return (1 / (1 + s - t) - 1) * s
-end
-
-function lt.ZoomOutEase(t)
-    local s = 0.05
-    return 1 + s - s / (s + t)
-end
-
-function lt.RevolveEase(t)
-    return (math.sin(math.pi * (t - 0.5)) + 1) * 0.5
+    return ease_func(lt.CubicBezierEaseId(p1x, p1y, p2x, p2y))
 end
 
 ease_func_table = {
@@ -0,0 +1,90 @@
+-- Render queue ordering.  Opaque meshes come first, grouped by
+-- material in scene order and front to back within each group, then
+-- everything else back to front.
+local function triangle()
+    local m = lt.Mesh()
+    m:SetXYZs{0, 0, 0,  1, 0, 0,  0, 1, 0}
+    return m
+end
+local function at(node, z)
+    return lt.Translate(node, 0, 0, z)
+end
+
+local m1, m2, m3, m4 = triangle(), triangle(), triangle(), triangle()
+local translucent = triangle()
+translucent:SetRGBAs{1, 1, 1, 0.5,  1, 1, 1, 1,  1, 1, 1, 1}
+local tinted = triangle()
+local added = triangle()
+local hidden = triangle()
+local rect = lt.Rect(0, 0, 1, 1)
+
+-- Layers draw their last argument first.
+local scene = lt.Layer(
+    at(rect, -2),
+    lt.DepthTest(lt.Layer(
+        lt.Tint(at(tinted, -8), 1, 1, 1, 0.5),
+        at(translucent, -4),
+        lt.BlendMode(at(added, -5), "add"),
+        lt.Hidden(hidden),
+        lt.Material(lt.Layer(at(m1, -10), at(m3, -6))),
+        lt.Material(lt.Layer(at(m2, -3), at(m4, -8))))),
+    at(triangle(), -1))
+local queue = lt.RenderQueue(scene)
+local names = {"m1", "m2", "m3", "m4", "translucent", "tinted", "added", "hidden", "rect"}
+local order = queue:DrawOrder(m1, m2, m3, m4, translucent, tinted, added, hidden, rect)
+for i, item in ipairs(order) do
+    print(i, names[item.node] or "other", item.depth, item.transparent)
+end
+print("items", queue.items)
+print("opaque", queue.opaque)
+print("transparent", queue.transparent)
+print("state changes", queue.state_changes, queue.unsorted_state_changes)
+print("sort time", queue.sort_time >= 0)
+
+-- Lit meshes are still sorted, grouped by light.
+local l1, l2, l3 = triangle(), triangle(), triangle()
+local lit = lt.RenderQueue(lt.DepthTest(lt.Layer(
+    lt.Light(lt.Layer(at(l1, -2), at(l2, -7))),
+    at(l3, -4))))
+local lit_names = {"l1", "l2", "l3"}
+for i, item in ipairs(lit:DrawOrder(l1, l2, l3)) do
+    print("lit", i, lit_names[item.node], item.depth, item.transparent)
+end
+print("lit state changes", lit.state_changes)
+
+-- Colour alpha is rescanned when the colours change.  Meshes can also
+-- be marked translucent, for textures with translucent texels.
+local fading = triangle()
+fading:SetRGBAs{1, 1, 1, 0.5,  1, 1, 1, 1,  1, 1, 1, 1}
+local flagged = triangle()
+flagged.translucent = true
+local function transparency()
+    local q = lt.RenderQueue(lt.DepthTest(lt.Layer(fading, flagged)))
+    local t = {}
+    for _, item in ipairs(q:DrawOrder(fading, flagged)) do
+        t[item.node] = item.transparent
+    end
+    return t[1], t[2]
+end
+print("fading, flagged", transparency())
+fading:SetRGBAs{1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1}
+print("fading, flagged", transparency())
+
+-- Tile maps
+local map = lt.TileMap(70, 40, 16, 16)
+print("map", map.width, map.height, map.chunks)
+map:Fill(3)
+map:Set(1, 1, 7)
+map:Set(70, 40, 0)
+print("tiles", map:Get(1, 1), map:Get(2, 1), map:Get(70, 40))
+local tiles = {}
+for i = 1, 6 do
+    tiles[i] = i
+end
+local small = lt.TileMap(3, 2, 8, 8)
+small:SetTiles(tiles)
+print("small", small:Get(1, 1), small:Get(3, 1), small:Get(1, 2), small:Get(3, 2))
+print("set outside", pcall(map.Set, map, 71, 1, 1))
+print("bad tile", pcall(map.Set, map, 1, 1, -1))
+print("too large", pcall(lt.TileMap, 65536, 65536, 1, 1))
+print("built", map.chunk_builds, map.vbo_bytes, map.cpu_bytes >= 70 * 40 * 2)
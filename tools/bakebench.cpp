@@ -0,0 +1,268 @@
+// Static layer baking benchmark: draws a 10k tile background directly
+// and through an lt.Bake node, and reports the time to traverse and
+// draw a frame each way, along with GL call counts.  Also checks the
+// baked frames are pixel for pixel the same as the direct ones, with
+// and without an outer tint and after moving a tile.
+//
+// Renders into a frame buffer object.  On Linux the GL context is a
+// surfaceless EGL one, so no display is needed.
+#include "lt.h"
+#ifdef LTLINUX
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#define FRAMES 20
+#define TILES_X 100
+#define TILES_Y 100
+#define TILE_SIZE 8
+#define WIDTH (TILES_X * TILE_SIZE)
+#define HEIGHT (TILES_Y * TILE_SIZE)
+#define NUM_TEXTURES 4
+#define TEXTURE_SIZE 64
+
+static bool create_context() {
+#ifdef LTLINUX
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_display == NULL) {
+        return false;
+    }
+    EGLDisplay display = get_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (!eglInitialize(display, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API)) {
+        return false;
+    }
+    EGLint attrs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint n = 0;
+    eglChooseConfig(display, attrs, &config, 1, &n);
+    EGLContext context = eglCreateContext(display, n > 0 ? config : NULL, EGL_NO_CONTEXT, NULL);
+    if (context == EGL_NO_CONTEXT) {
+        return false;
+    }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+#else
+    if (!glfwInit() || !glfwOpenWindow(64, 64, 8, 8, 8, 8, 0, 0, GLFW_WINDOW)) {
+        return false;
+    }
+#endif
+    return glewInit() == GLEW_OK;
+}
+
+// Scene nodes expect zeroed memory, as for Lua userdata.
+template <typename T> static T *new_node() {
+    return new (calloc(1, sizeof(T))) T();
+}
+
+static LTSceneNode *new_tile(LTtexid tex, int i) {
+    LTTexturedNode *img = new_node<LTTexturedNode>();
+    img->texture_id = tex;
+    LTfloat wv[8] = {0, 0, TILE_SIZE, 0, TILE_SIZE, TILE_SIZE, 0, TILE_SIZE};
+    // One of the 64 8x8 texel tiles in the texture, so texels map to
+    // whole pixels (or 2x2 pixels for the scaled tiles) and nearest
+    // filtering never samples exactly on a texel edge.
+    int tx = (i % 8) * LT_MAX_TEX_COORD / 8;
+    int ty = ((i / 8) % 8) * LT_MAX_TEX_COORD / 8;
+    int ts = LT_MAX_TEX_COORD / 8;
+    LTtexcoord tc[8] = {
+        (LTtexcoord)tx, (LTtexcoord)ty, (LTtexcoord)(tx + ts), (LTtexcoord)ty,
+        (LTtexcoord)(tx + ts), (LTtexcoord)(ty + ts), (LTtexcoord)tx, (LTtexcoord)(ty + ts)};
+    memcpy(img->world_vertices, wv, sizeof(wv));
+    memcpy(img->tex_coords, tc, sizeof(tc));
+    img->vertbuf = ltGenVertBuffer();
+    ltBindVertBuffer(img->vertbuf);
+    ltStaticVertBufferData(sizeof(wv), wv);
+    img->texbuf = ltGenVertBuffer();
+    ltBindVertBuffer(img->texbuf);
+    ltStaticVertBufferData(sizeof(tc), tc);
+    LTSceneNode *node = img;
+    if (i % 5 == 0) {
+        LTScaleNode *scale = new_node<LTScaleNode>();
+        scale->scale = 2.0f;
+        scale->child = node;
+        node = scale;
+    }
+    if (i % 7 == 0) {
+        LTTintNode *tint = new_node<LTTintNode>();
+        tint->red = 0.75f;
+        tint->blue = 0.5f;
+        tint->alpha = 0.5f;
+        tint->child = node;
+        node = tint;
+    }
+    return node;
+}
+
+// A layer of rows of translated tiles.  With interleaved set
+// neighbouring tiles use different textures, otherwise each quarter of
+// the rows shares one.
+static LTLayer *new_background(LTtexid *textures, bool interleaved, LTTranslateNode **some_tile) {
+    LTLayer *root = new_node<LTLayer>();
+    for (int y = 0; y < TILES_Y; y++) {
+        LTLayer *row = new_node<LTLayer>();
+        for (int x = 0; x < TILES_X; x++) {
+            int i = y * TILES_X + x;
+            int t = interleaved ? i % NUM_TEXTURES : y * NUM_TEXTURES / TILES_Y;
+            LTTranslateNode *tr = new_node<LTTranslateNode>();
+            tr->x = x * TILE_SIZE;
+            tr->y = y * TILE_SIZE;
+            tr->child = new_tile(textures[t], i);
+            row->insert_front(tr, 0);
+            if (i == TILES_X * TILES_Y / 2) {
+                *some_tile = tr;
+            }
+        }
+        root->insert_front(row, 0);
+    }
+    return root;
+}
+
+static void draw_frame(LTSceneNode *node) {
+    LTColor black(0, 0, 0, 1);
+    ltPrepareForRendering(0, 0, WIDTH, HEIGHT, 0, 0, WIDTH, HEIGHT, &black, false);
+    node->draw();
+    ltFinishRendering();
+}
+
+static void read_frame(std::vector<unsigned char> *pixels) {
+    pixels->resize(WIDTH * HEIGHT * 4);
+    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, &(*pixels)[0]);
+}
+
+static bool same_frame(LTSceneNode *direct, LTSceneNode *baked) {
+    std::vector<unsigned char> a, b;
+    draw_frame(direct);
+    read_frame(&a);
+    draw_frame(baked);
+    read_frame(&b);
+    return a == b;
+}
+
+struct Timing {
+    LTdouble submit;    // Traversal and GL calls.
+    LTdouble total;     // Including waiting for the GPU.
+    LTGLCounters counters;
+};
+
+static Timing time_frames(LTSceneNode *node) {
+    draw_frame(node); // Warm up (and bake).
+    glFinish();
+    Timing t;
+    t.submit = 0;
+    t.total = 0;
+    memset(&t.counters, 0, sizeof(t.counters));
+    for (int i = 0; i < FRAMES; i++) {
+        LTGLCounters before = lt_gl_counters;
+        LTdouble t0 = ltGetTime();
+        draw_frame(node);
+        LTdouble t1 = ltGetTime();
+        glFinish();
+        LTdouble t2 = ltGetTime();
+        t.submit += t1 - t0;
+        t.total += t2 - t0;
+        t.counters.draw_calls += lt_gl_counters.draw_calls - before.draw_calls;
+        t.counters.state_changes += lt_gl_counters.state_changes - before.state_changes;
+        t.counters.texture_binds += lt_gl_counters.texture_binds - before.texture_binds;
+    }
+    return t;
+}
+
+static void report(const char *name, Timing *t) {
+    printf("  %-8s submit %8.3f ms  total %8.3f ms  draws %6d  binds %5d  state %6d\n", name,
+        t->submit * 1000.0 / FRAMES, t->total * 1000.0 / FRAMES,
+        t->counters.draw_calls / FRAMES, t->counters.texture_binds / FRAMES,
+        t->counters.state_changes / FRAMES);
+}
+
+static int run(LTtexid *textures, bool interleaved) {
+    LTTranslateNode *tile = NULL;
+    LTLayer *bg = new_background(textures, interleaved, &tile);
+    LTBakeNode *bake = new_node<LTBakeNode>();
+    bake->child = bg;
+    int failures = 0;
+
+    printf("%s textures (%d tiles):\n", interleaved ? "interleaved" : "grouped", TILES_X * TILES_Y);
+    Timing direct = time_frames(bg);
+    Timing baked = time_frames(bake);
+    report("direct", &direct);
+    report("baked", &baked);
+    printf("  %d quads in %d draw calls, baked %d time(s)\n",
+        bake->num_quads, (int)bake->runs.size(), bake->bake_count);
+    if (!bake->baked) {
+        printf("  FAIL: background wasn't baked\n");
+        failures++;
+    }
+
+    if (!same_frame(bg, bake)) {
+        printf("  FAIL: baked frame differs\n");
+        failures++;
+    }
+
+    LTTintNode *outer_direct = new_node<LTTintNode>();
+    outer_direct->red = 0.5f;
+    outer_direct->child = bg;
+    LTTintNode *outer_baked = new_node<LTTintNode>();
+    outer_baked->red = 0.5f;
+    outer_baked->child = bake;
+    if (!same_frame(outer_direct, outer_baked)) {
+        printf("  FAIL: baked frame differs under a tint\n");
+        failures++;
+    }
+
+    int count = bake->bake_count;
+    tile->x += 3;
+    tile->changed();
+    if (!same_frame(bg, bake)) {
+        printf("  FAIL: baked frame differs after moving a tile\n");
+        failures++;
+    }
+    if (bake->bake_count != count + 1) {
+        printf("  FAIL: moving a tile didn't re-bake exactly once\n");
+        failures++;
+    }
+    draw_frame(bake);
+    if (bake->bake_count != count + 1) {
+        printf("  FAIL: re-baked without a change\n");
+        failures++;
+    }
+    return failures;
+}
+
+int main() {
+    if (!create_context()) {
+        fprintf(stderr, "Unable to create a GL context\n");
+        return 1;
+    }
+    ltInitGLState();
+    printf("%s\n", glGetString(GL_RENDERER));
+
+    LTtexid target = ltGenTexture();
+    ltBindTexture(target);
+    ltTexImage(WIDTH, HEIGHT, NULL);
+    LTframebuf fbo = ltGenFramebuffer();
+    ltBindFramebuffer(fbo);
+    ltFramebufferTexture(target);
+    if (!ltFramebufferComplete()) {
+        fprintf(stderr, "Unable to create frame buffer\n");
+        return 1;
+    }
+
+    LTtexid textures[NUM_TEXTURES];
+    std::vector<LTuint32> texels(TEXTURE_SIZE * TEXTURE_SIZE);
+    for (int t = 0; t < NUM_TEXTURES; t++) {
+        for (int i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++) {
+            // Opaque noise with some translucent texels.
+            LTuint32 r = (LTuint32)(i * 2654435761u + t * 40503u);
+            texels[i] = (r & 0x00FFFFFF) | ((r >> 28) < 4 ? 0x80000000 : 0xFF000000);
+        }
+        textures[t] = ltGenTexture();
+        ltBindTexture(textures[t]);
+        ltTextureMinFilter(LT_TEXTURE_FILTER_NEAREST);
+        ltTextureMagFilter(LT_TEXTURE_FILTER_NEAREST);
+        ltTexImage(TEXTURE_SIZE, TEXTURE_SIZE, &texels[0]);
+    }
+
+    int failures = run(textures, false) + run(textures, true);
+    printf(failures == 0 ? "pass\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
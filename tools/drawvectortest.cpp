@@ -0,0 +1,178 @@
+// lt.DrawVector check: draws particle style vectors through the current
+// LTDrawVector (a cached vertex buffer) and through the old code, which
+// pointed GL at the vector's client memory on every draw (copied below).
+// Checks that each frame draws the same vertices, colours and texture
+// coordinates both ways, and that the vector is only uploaded when its
+// data or the vector itself changes, not when the offsets do.
+//
+// Links the LTNULLGL build of liblt (see the drawvectortest rule in the
+// Makefile), which captures the arrays each draw reads.
+#include "lt.h"
+
+#define N 1000
+#define STRIDE 8    // x, y, r, g, b, a, u, v
+#define FRAMES 60
+
+enum {X, Y, R, G, B, A, U, V};
+
+// Scene nodes expect zeroed memory, as for Lua userdata.
+template <typename T> static T *new_node() {
+    return new (calloc(1, sizeof(T))) T();
+}
+
+static LTVector *new_vector(int seed) {
+    LTVector *v = new (calloc(1, sizeof(LTVector))) LTVector(N, STRIDE);
+    v->size = N;
+    for (int i = 0; i < N * STRIDE; i++) {
+        v->data[i] = (LTfloat)((i * 7919 + seed * 104729) % 1000) / 1000.0f;
+    }
+    v->touch();
+    return v;
+}
+
+// ------------------------------------------------------------------
+// The old LTDrawVector::draw.
+
+static void old_draw(LTDrawVector *dv) {
+    LTVector *vector = dv->vector;
+    int stride = vector->stride * sizeof(LTfloat);
+    ltBindVertBuffer(0);
+    ltVertexPointer(dv->dimensions, LT_VERT_DATA_TYPE_FLOAT, stride, vector->data + dv->vertex_offset);
+    if (dv->texture_offset >= 0 && dv->image != NULL) {
+        ltEnableTexture(dv->image->texture_id);
+        ltTexCoordPointer(2, LT_VERT_DATA_TYPE_FLOAT, stride, vector->data + dv->texture_offset);
+    } else {
+        ltDisableTextures();
+    }
+    if (dv->color_offset >= 0) {
+        ltEnableColorArrays();
+        ltColorPointer(4, LT_VERT_DATA_TYPE_FLOAT, stride, vector->data + dv->color_offset);
+    }
+    ltDrawArrays(dv->mode, 0, vector->size);
+    if (dv->color_offset >= 0) {
+        ltDisableColorArrays();
+        ltColorPointer(4, LT_VERT_DATA_TYPE_FLOAT, 0, 0);
+        ltRestoreTint();
+    }
+}
+
+// ------------------------------------------------------------------
+
+struct Capture {
+    int count;
+    int sizes[3];
+    std::vector<LTfloat> arrays[3];
+};
+
+static void capture(Capture *c) {
+    LTNullGLDraw d;
+    ltNullGLGetLastDraw(&d);
+    c->count = d.count;
+    c->sizes[0] = d.vertex_size;
+    c->sizes[1] = d.color_size;
+    c->sizes[2] = d.tex_coord_size;
+    const LTfloat *data[3] = {d.vertices, d.colors, d.tex_coords};
+    for (int i = 0; i < 3; i++) {
+        c->arrays[i].clear();
+        if (data[i] != NULL) {
+            c->arrays[i].assign(data[i], data[i] + d.count * c->sizes[i]);
+        }
+    }
+}
+
+static bool same(Capture *a, Capture *b) {
+    if (a->count != b->count) return false;
+    for (int i = 0; i < 3; i++) {
+        if (a->sizes[i] != b->sizes[i] || a->arrays[i] != b->arrays[i]) return false;
+    }
+    return true;
+}
+
+static int failures = 0;
+
+// Draws FRAMES frames both ways, calling update before each, and checks
+// the new path made expected_uploads uploads.
+static void run(const char *name, LTDrawVector *dv, void (*update)(LTDrawVector *dv, int frame),
+    int expected_uploads)
+{
+    Capture old_c, new_c;
+    int mismatches = 0;
+    int uploads = 0;
+    int client_bytes = 0;
+    for (int f = 0; f < FRAMES; f++) {
+        update(dv, f);
+        old_draw(dv);
+        capture(&old_c);
+        client_bytes += dv->vector->size * dv->vector->stride * sizeof(LTfloat);
+
+        LTNullGLStats before, after;
+        ltNullGLGetStats(&before);
+        dv->draw();
+        ltNullGLGetStats(&after);
+        capture(&new_c);
+        uploads += after.buffer_uploads - before.buffer_uploads;
+        if (!same(&old_c, &new_c) || new_c.sizes[0] <= 0) {
+            mismatches++;
+        }
+    }
+    printf("  %-14s old: %7d client bytes  new: %2d uploads, %7d bytes  mismatched frames: %d\n",
+        name, client_bytes, uploads, uploads * N * STRIDE * (int)sizeof(LTfloat), mismatches);
+    if (mismatches != 0) {
+        printf("  FAIL: the new path drew different data\n");
+        failures++;
+    }
+    if (uploads != expected_uploads) {
+        printf("  FAIL: expected %d uploads\n", expected_uploads);
+        failures++;
+    }
+}
+
+static LTVector *vectors[2];
+
+static void no_change(LTDrawVector *dv, int frame) {
+}
+
+static void move_particles(LTDrawVector *dv, int frame) {
+    ltVectorAdd(dv->vector, X, 0.01f);
+    ltVectorMultiply(dv->vector, A, 0.99f);
+}
+
+// Draws the same data as positions, colours and texture coordinates
+// in turn, with and without each array.
+static void change_offsets(LTDrawVector *dv, int frame) {
+    dv->vertex_offset = frame % 3 * 2;
+    dv->dimensions = 2 + frame % 2;
+    dv->color_offset = frame % 4 == 0 ? -1 : frame % 5;
+    dv->texture_offset = frame % 3 == 0 ? -1 : STRIDE - 2 - frame % 2;
+}
+
+static void swap_vectors(LTDrawVector *dv, int frame) {
+    dv->vector = vectors[frame / 20 % 2];
+}
+
+int main() {
+    ltInitGLState();
+    ltEnableVertexArrays(); // As at the start of each frame.
+    ltNullGLSetCapture(true);
+    vectors[0] = new_vector(0);
+    vectors[1] = new_vector(1);
+    LTTexturedNode *image = new_node<LTTexturedNode>();
+    image->texture_id = 1;
+
+    LTDrawVector *dv = new_node<LTDrawVector>();
+    dv->vector = vectors[0];
+    dv->image = image;
+    dv->vertex_offset = X;
+    dv->color_offset = R;
+    dv->texture_offset = U;
+
+    printf("%d records of %d floats, %d frames each\n", N, STRIDE, FRAMES);
+    run("static", dv, no_change, 1);
+    run("moving", dv, move_particles, FRAMES);
+    run("offsets", dv, change_offsets, 0);
+    // Frames 20 and 40 switch vectors.
+    run("swapped", dv, swap_vectors, 2);
+
+    printf(failures == 0 ? "pass\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
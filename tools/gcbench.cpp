@@ -0,0 +1,81 @@
+// GC benchmark: runs an allocation-heavy Lua "game" for a number of
+// frames, first with the default Lua collector and then with the
+// frame-budgeted collector, and compares per-frame times.  The game
+// keeps a large live set of tables (so a full mark is expensive) and
+// creates lots of short-lived garbage each frame.
+#include "lt.h"
+
+#define FRAMES 3000
+#define FRAME_SECS (1.0 / 60.0)
+
+static const char *game_script =
+    "local live = {}\n"
+    "for i = 1, 200000 do live[i] = {x = i, y = i, name = 'obj' .. i} end\n"
+    "local n = 0\n"
+    "function update()\n"
+    "    for i = 1, 3000 do\n"
+    "        local v = {x = i, y = i * 2, z = {i}}\n"
+    "        n = n + #v.z\n"
+    "    end\n"
+    "    for i = 1, 50 do\n"
+    "        live[math.random(#live)] = {x = n, s = tostring(n)}\n"
+    "    end\n"
+    "end\n";
+
+static int cmp_double(const void *a, const void *b) {
+    LTdouble x = *(const LTdouble*)a;
+    LTdouble y = *(const LTdouble*)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void run(bool managed) {
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    ltGCReset();
+    if (managed) {
+        ltGCSetBudget(L, 0.002);
+    }
+    if (luaL_dostring(L, game_script) != 0) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        exit(1);
+    }
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    static LTdouble times[FRAMES];
+    int max_heap = 0;
+    int over_budget = 0;
+    LTdouble total = 0.0;
+    for (int i = 0; i < FRAMES; i++) {
+        LTdouble t0 = ltGetTime();
+        lua_getglobal(L, "update");
+        lua_call(L, 0, 0);
+        if (managed) {
+            ltGCStep(L, FRAME_SECS - (ltGetTime() - t0));
+        }
+        times[i] = ltGetTime() - t0;
+        total += times[i];
+        if (times[i] > FRAME_SECS) {
+            over_budget++;
+        }
+        int heap = lua_gc(L, LUA_GCCOUNT, 0);
+        if (heap > max_heap) {
+            max_heap = heap;
+        }
+    }
+    qsort(times, FRAMES, sizeof(LTdouble), cmp_double);
+    LTGCStats stats;
+    ltGCGetStats(&stats);
+    printf("%-8s mean %6.3fms  p50 %6.3fms  p99 %6.3fms  max %6.3fms  >16.7ms %4d  peak heap %6dKB",
+        managed ? "managed" : "default", total / FRAMES * 1000.0, times[FRAMES / 2] * 1000.0,
+        times[FRAMES * 99 / 100] * 1000.0, times[FRAMES - 1] * 1000.0, over_budget, max_heap);
+    if (managed) {
+        printf("  cycles %d", stats.cycles);
+    }
+    printf("\n");
+    lua_close(L);
+}
+
+int main() {
+    run(false);
+    run(true);
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Lua load benchmark: compares compiling Lua source with loading
+// precompiled bytecode, for the engine scripts (../src/lua) and for a
+// generated game of several hundred KB of Lua.  Also times the chunk
+// cache used by import (ltluacache), cold (compile and cache) and warm
+// (hash and load bytecode).
+#include "lt.h"
+
+#define REPS 10
+#define GAME_MODULES 30
+
+struct Script {
+    char *name;
+    std::vector<char> src;
+    std::vector<char> bytecode;
+};
+
+static int writer(lua_State *L, const void *p, size_t sz, void *ud) {
+    std::vector<char> *buf = (std::vector<char>*)ud;
+    buf->insert(buf->end(), (const char*)p, (const char*)p + sz);
+    return 0;
+}
+
+static void gen_module(Script *s, int m) {
+    char line[256];
+    std::vector<char> &src = s->src;
+    const char *header = "local M = {}\n";
+    src.insert(src.end(), header, header + strlen(header));
+    for (int f = 0; f < 60; f++) {
+        int n = snprintf(line, sizeof(line),
+            "function M.func%d(a, b, c)\n"
+            "    local t = {x = a, y = b, name = \"func%d_%d\", list = {1, 2, 3, a * %d}}\n"
+            "    for i = 1, #t.list do t.x = t.x + t.list[i] * %d end\n"
+            "    if c then return M.func%d(t.x, t.y) else return t end\n"
+            "end\n", f, m, f, f, m, f > 0 ? f - 1 : 0);
+        src.insert(src.end(), line, line + n);
+    }
+    const char *footer = "return M\n";
+    src.insert(src.end(), footer, footer + strlen(footer));
+    s->name = new char[32];
+    snprintf(s->name, 32, "=game%d", m);
+}
+
+static bool read_script(Script *s, const char *path) {
+    FILE *in = fopen(path, "rb");
+    if (in == NULL) {
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        s->src.insert(s->src.end(), buf, buf + n);
+    }
+    fclose(in);
+    s->name = new char[strlen(path) + 2];
+    snprintf(s->name, strlen(path) + 2, "@%s", path);
+    return true;
+}
+
+static void compile_bytecode(lua_State *L, Script *s) {
+    if (luaL_loadbuffer(L, &s->src[0], s->src.size(), s->name) != 0) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        exit(1);
+    }
+    lua_dump(L, writer, &s->bytecode);
+    lua_pop(L, 1);
+}
+
+enum Mode {SOURCE, BYTECODE, CACHED};
+
+static LTdouble time_load(std::vector<Script> &scripts, Mode mode) {
+    LTdouble best = 1.0e9;
+    for (int r = 0; r < REPS; r++) {
+        lua_State *L = luaL_newstate();
+        LTdouble t0 = ltGetTime();
+        for (unsigned i = 0; i < scripts.size(); i++) {
+            Script *s = &scripts[i];
+            int status;
+            if (mode == SOURCE) {
+                status = luaL_loadbuffer(L, &s->src[0], s->src.size(), s->name);
+            } else if (mode == BYTECODE) {
+                status = luaL_loadbuffer(L, &s->bytecode[0], s->bytecode.size(), s->name);
+            } else {
+                status = ltLuaLoadCached(L, &s->src[0], s->src.size(), s->name);
+            }
+            if (status != 0) {
+                fprintf(stderr, "%s\n", lua_tostring(L, -1));
+                exit(1);
+            }
+            lua_pop(L, 1);
+        }
+        LTdouble t = ltGetTime() - t0;
+        if (t < best) {
+            best = t;
+        }
+        lua_close(L);
+    }
+    return best;
+}
+
+static void report(const char *name, std::vector<Script> &scripts) {
+    size_t src_bytes = 0;
+    size_t bc_bytes = 0;
+    lua_State *L = luaL_newstate();
+    for (unsigned i = 0; i < scripts.size(); i++) {
+        compile_bytecode(L, &scripts[i]);
+        src_bytes += scripts[i].src.size();
+        bc_bytes += scripts[i].bytecode.size();
+    }
+    lua_close(L);
+    LTdouble src = time_load(scripts, SOURCE);
+    LTdouble bc = time_load(scripts, BYTECODE);
+    // The first rep misses and fills the cache; the best is a warm load.
+    LTdouble cached = time_load(scripts, CACHED);
+    printf("%-7s %3d files %7dKB source %7dKB bytecode | compile %7.2fms  undump %7.2fms  cached %7.2fms (%.1fx)\n",
+        name, (int)scripts.size(), (int)(src_bytes / 1024), (int)(bc_bytes / 1024),
+        src * 1000.0, bc * 1000.0, cached * 1000.0, src / cached);
+}
+
+int main() {
+    std::vector<Script> engine;
+    const char *patterns[] = {"../src/lua/*.lua", NULL};
+    char *files = ltGlob(patterns);
+    for (char *f = files; *f != '\0'; f += strlen(f) + 1) {
+        engine.push_back(Script());
+        read_script(&engine.back(), f);
+    }
+    delete[] files;
+    if (engine.empty()) {
+        fprintf(stderr, "No engine scripts found (run from the tools directory)\n");
+    } else {
+        report("engine", engine);
+    }
+
+    std::vector<Script> game(GAME_MODULES);
+    for (int m = 0; m < GAME_MODULES; m++) {
+        gen_module(&game[m], m);
+    }
+    report("game", game);
+    return 0;
+}
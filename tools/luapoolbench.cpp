@@ -0,0 +1,85 @@
+// Lua allocator benchmark: simulates level transitions that create
+// and then drop tens of thousands of small scene nodes (with their
+// env tables and some per-node Lua state).  Compares the default
+// realloc-based allocator with the pooled one used by ltlua.cpp.
+#include "lt.h"
+
+#define LEVELS 20
+
+static const char *level_script =
+    "local nodes = {}\n"
+    "function build(n)\n"
+    "    for i = 1, n do\n"
+    "        local node = lt.Translate(lt.Tint(lt.SceneNode(), 1, 1, 1, 1), i, i)\n"
+    "        node.state = {x = i, y = i, vx = 0, vy = 0, name = 'n'}\n"
+    "        nodes[i] = node\n"
+    "    end\n"
+    "end\n"
+    "function teardown()\n"
+    "    nodes = {}\n"
+    "    collectgarbage()\n"
+    "end\n";
+
+static void *default_alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+    if (nsize == 0) {
+        free(ptr);
+        return NULL;
+    }
+    return realloc(ptr, nsize);
+}
+
+static void call(lua_State *L, const char *func, int n) {
+    lua_getglobal(L, func);
+    int nargs = 0;
+    if (n > 0) {
+        lua_pushinteger(L, n);
+        nargs = 1;
+    }
+    if (lua_pcall(L, nargs, 0, 0) != 0) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        exit(1);
+    }
+}
+
+static void run(const char *name, lua_Alloc alloc, void *ud, int nodes) {
+    lua_State *L = lua_newstate(alloc, ud);
+    luaL_openlibs(L);
+    ltLuaInitFFI(L);
+    if (luaL_dostring(L, level_script) != 0) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        exit(1);
+    }
+    LTdouble build = 0.0;
+    LTdouble teardown = 0.0;
+    for (int i = 0; i < LEVELS; i++) {
+        LTdouble t0 = ltGetTime();
+        call(L, "build", nodes);
+        LTdouble t1 = ltGetTime();
+        call(L, "teardown", 0);
+        LTdouble t2 = ltGetTime();
+        build += t1 - t0;
+        teardown += t2 - t1;
+    }
+    printf("%-8s %6d nodes/level: build %7.2fms  teardown %7.2fms  total %7.2fms per level\n",
+        name, nodes, build / LEVELS * 1000.0, teardown / LEVELS * 1000.0,
+        (build + teardown) / LEVELS * 1000.0);
+    lua_close(L);
+}
+
+int main() {
+    static LTPool pool;
+    int sizes[] = {10000, 50000};
+    for (int i = 0; i < 2; i++) {
+        run("default", default_alloc, NULL, sizes[i]);
+        run("pooled", ltPoolLuaAlloc, &pool, sizes[i]);
+    }
+    LTPoolStats *s = &pool.total_stats;
+    printf("pool: %d chunks, peak %d blocks, %d large allocs\n", s->chunks, s->peak, pool.large_stats.allocs);
+    for (int c = 0; c < LT_POOL_NUM_CLASSES; c++) {
+        s = &pool.class_stats[c];
+        if (s->allocs > 0) {
+            printf("  %3d bytes: %9d allocs, peak %7d\n", (c + 1) * LT_POOL_GRANULE, s->allocs, s->peak);
+        }
+    }
+    return 0;
+}
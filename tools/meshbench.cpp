@@ -0,0 +1,121 @@
+// Mesh vertex storage benchmark: reports the main memory and VBO
+// bytes per vertex and the time to generate the interleaved VBO data
+// for a lit, textured 3D terrain and a flat textured 2D grid->
+// Doesn't need a GL context.
+#include "lt.h"
+
+#define N 256
+#define RUNS 50
+#define FRAMES 200
+#define PATCHES 3   // Deformed per frame.
+#define PATCH 8     // Patch width and height in vertices.
+
+static void report(const char *name, LTMesh *mesh) {
+    LTMeshLayout layout = mesh->compute_layout();
+    LTdouble best = 1e9;
+    for (int r = 0; r < RUNS; r++) {
+        LTdouble t0 = ltGetTime();
+        void *data = mesh->generate_vbo_data(&layout, 0, mesh->size);
+        LTdouble t = ltGetTime() - t0;
+        free(data);
+        if (t < best) best = t;
+    }
+    printf("%-8s %6d verts: cpu %2d bytes/vert, vbo %2d bytes/vert (%s uvs), generate %.3fms\n",
+        name, mesh->size, mesh->cpu_bytes() / mesh->size, layout.stride,
+        layout.uv_type == LT_VERT_DATA_TYPE_SHORT ? "short" : "float", best * 1000.0);
+}
+
+// Scene nodes expect zeroed memory, as for Lua userdata.
+static LTMesh *new_mesh(int dims, int size) {
+    void *mem = calloc(1, sizeof(LTMesh));
+    return new (mem) LTMesh(dims, NULL, LT_DRAWMODE_TRIANGLES, size);
+}
+
+// Raises PATCHES random square patches of the terrain, touching each
+// patch row.
+static void deform(LTMesh *terrain) {
+    for (int p = 0; p < PATCHES; p++) {
+        int px = rand() % (N + 1 - PATCH);
+        int py = rand() % (N + 1 - PATCH);
+        for (int y = py; y < py + PATCH; y++) {
+            int row = y * (N + 1);
+            for (int x = px; x < px + PATCH; x++) {
+                terrain->xyzs[row + x].z += 0.1f;
+            }
+            terrain->touch(row + px, row + px + PATCH);
+        }
+    }
+}
+
+static void compare_updates(LTMesh *terrain) {
+    // As if just uploaded.
+    LTMeshLayout layout = terrain->compute_layout();
+    terrain->vb_dirty = false;
+    terrain->num_dirty_spans = 0;
+    long full_bytes = 0;
+    long span_bytes = 0;
+    int spans = 0;
+    LTdouble full_time = 0;
+    LTdouble span_time = 0;
+    srand(1);
+    for (int f = 0; f < FRAMES; f++) {
+        deform(terrain);
+
+        // What ensure_vb_uptodate did before: rebuild everything.
+        LTdouble t0 = ltGetTime();
+        void *data = terrain->generate_vbo_data(&layout, 0, terrain->size);
+        full_time += ltGetTime() - t0;
+        full_bytes += terrain->size * layout.stride;
+        free(data);
+
+        // Only the dirty spans.
+        t0 = ltGetTime();
+        for (int i = 0; i < terrain->num_dirty_spans; i++) {
+            LTMeshSpan *span = &terrain->dirty_spans[i];
+            data = terrain->generate_vbo_data(&layout, span->begin, span->end);
+            span_bytes += (span->end - span->begin) * layout.stride;
+            free(data);
+        }
+        span_time += ltGetTime() - t0;
+        spans += terrain->num_dirty_spans;
+        terrain->num_dirty_spans = 0;
+    }
+    printf("deform %d %dx%d patches/frame:\n", PATCHES, PATCH, PATCH);
+    printf("  full rebuild: %8.1f KB/frame, %.3fms/frame\n",
+        full_bytes / 1024.0 / FRAMES, full_time * 1000.0 / FRAMES);
+    printf("  dirty spans:  %8.1f KB/frame, %.3fms/frame, %.1f spans/frame\n",
+        span_bytes / 1024.0 / FRAMES, span_time * 1000.0 / FRAMES, spans / (double)FRAMES);
+}
+
+int main() {
+    int size = (N + 1) * (N + 1);
+
+    LTMesh *terrain = new_mesh(3, size);
+    terrain->ensure_normals();
+    terrain->ensure_texture_coords();
+    for (int i = 0; i < size; i++) {
+        int x = i % (N + 1);
+        int y = i / (N + 1);
+        terrain->xyzs[i] = LTVec3(x, y, sinf(i));
+        terrain->set_normal(i, LTVec3(0, 0, 1));
+        terrain->uvs[i] = LTTexCoord(x / (LTfloat)N, y / (LTfloat)N);
+    }
+    report("terrain", terrain);
+    compare_updates(terrain);
+
+    LTMesh *grid = new_mesh(2, size);
+    grid->ensure_texture_coords();
+    for (int i = 0; i < size; i++) {
+        grid->xyzs[i] = LTVec3(i % (N + 1), i / (N + 1), 0);
+        grid->uvs[i] = LTTexCoord(0.5f, 0.5f);
+    }
+    report("grid", grid);
+
+    // Tiled texture coords need floats in the VBO.
+    for (int i = 0; i < size; i++) {
+        grid->uvs[i] = LTTexCoord(i % (N + 1), i / (N + 1));
+    }
+    report("tiled", grid);
+
+    return 0;
+}
@@ -0,0 +1,284 @@
+// Bulk mesh operation benchmark: times LTMesh::grid, stretch, shift and
+// compute_normals at several grid sizes, on one worker thread and on
+// all of them, against the old single threaded code (copied below).
+// Also checks the results match the old code.  Doesn't need a GL
+// context.
+#include "lt.h"
+
+#define RUNS 10
+
+static const int sizes[] = {64, 256, 512, 1024};
+
+// Scene nodes expect zeroed memory, as for Lua userdata.
+static LTMesh *new_mesh(int dims, int size) {
+    void *mem = calloc(1, sizeof(LTMesh));
+    return new (mem) LTMesh(dims, NULL, LT_DRAWMODE_TRIANGLES, size);
+}
+
+static void delete_mesh(LTMesh *mesh) {
+    mesh->~LTMesh();
+    free(mesh);
+}
+
+// The grid only reads the texture's tex_coords.
+static LTTexturedNode *fake_texture() {
+    LTTexturedNode *tex = (LTTexturedNode*)calloc(1, sizeof(LTTexturedNode));
+    LTtexcoord c[8] = {0, 0, LT_MAX_TEX_COORD, 0, LT_MAX_TEX_COORD, LT_MAX_TEX_COORD, 0, LT_MAX_TEX_COORD};
+    for (int i = 0; i < 8; i++) tex->tex_coords[i] = c[i] / 3;
+    return tex;
+}
+
+static LTMesh *new_quad(LTTexturedNode *tex) {
+    LTMesh *mesh = new_mesh(2, 4);
+    mesh->ensure_texture_coords();
+    mesh->texture = tex;
+    mesh->xyzs[0] = LTVec3(-1.3f, -0.7f, 0);
+    mesh->xyzs[1] = LTVec3(2.9f, -0.7f, 0);
+    mesh->xyzs[2] = LTVec3(2.9f, 1.1f, 0);
+    mesh->xyzs[3] = LTVec3(-1.3f, 1.1f, 0);
+    return mesh;
+}
+
+// ------------------------------------------------------------------
+// The old implementations.
+
+static void old_grid(LTMesh *mesh, int rows, int columns) {
+    mesh->ensure_bb_uptodate();
+    int size = (rows + 1) * (columns + 1);
+    LTVec3 *xyzs = new LTVec3[size];
+    LTTexCoord *uvs = new LTTexCoord[size];
+    LTvertindex32 *indices = new LTvertindex32[6 * rows * columns];
+    LTTexturedNode *texture = mesh->texture;
+    LTfloat left = mesh->left, right = mesh->right, bottom = mesh->bottom, top = mesh->top;
+
+    LTfloat col_width = (right - left) / (LTfloat)columns;
+    LTfloat row_height = (top - bottom) / (LTfloat)rows;
+    LTfloat tex_left = (LTfloat)texture->tex_coords[0] / (LTfloat)LT_MAX_TEX_COORD;
+    LTfloat tex_right = (LTfloat)texture->tex_coords[2] / (LTfloat)LT_MAX_TEX_COORD;
+    LTfloat tex_bottom = (LTfloat)texture->tex_coords[1] / (LTfloat)LT_MAX_TEX_COORD;
+    LTfloat tex_top = (LTfloat)texture->tex_coords[5] / (LTfloat)LT_MAX_TEX_COORD;
+    LTfloat tex_col_width = (tex_right - tex_left) / (LTfloat)columns;
+    LTfloat tex_row_height = (tex_top - tex_bottom) / (LTfloat)rows;
+
+    LTfloat y = bottom;
+    LTfloat v = tex_bottom;
+    int i = 0;
+    int j = 0;
+    for (int row = 0; row <= rows; row++) {
+        LTfloat x = left;
+        LTfloat u = tex_left;
+        for (int col = 0; col <= columns; col++) {
+            xyzs[i].x = x;
+            xyzs[i].y = y;
+            uvs[i].u = u;
+            uvs[i].v = v;
+            if (col < columns && row < rows) {
+                indices[j + 0] = i;
+                indices[j + 1] = i + columns + 1;
+                indices[j + 2] = i + 1;
+                indices[j + 3] = i + 1;
+                indices[j + 4] = i + columns + 1;
+                indices[j + 5] = i + columns + 2;
+                j += 6;
+            }
+            i++;
+            x += col_width;
+            u += tex_col_width;
+            if (col == columns - 1) {
+                x = right;
+                u = tex_right;
+            }
+        }
+        y += row_height;
+        v += tex_row_height;
+        if (row == rows - 1) {
+            y = top;
+            v = tex_top;
+        }
+    }
+    delete[] mesh->xyzs;
+    delete[] mesh->uvs;
+    delete[] mesh->indices;
+    mesh->xyzs = xyzs;
+    mesh->uvs = uvs;
+    mesh->indices = indices;
+    mesh->size = size;
+    mesh->num_indices = j;
+    mesh->bb_dirty = true;
+}
+
+static void old_stretch(LTMesh *mesh, LTfloat px, LTfloat py, LTfloat pz,
+    LTfloat left, LTfloat right, LTfloat down, LTfloat up, LTfloat backward, LTfloat forward)
+{
+    for (int i = 0; i < mesh->size; i++) {
+        LTVec3 *p = &mesh->xyzs[i];
+        if (p->x < px) p->x -= left; else p->x += right;
+        if (p->y < py) p->y -= down; else p->y += up;
+        if (p->z < pz) p->z -= backward; else p->z += forward;
+    }
+}
+
+// Without the old bug of shifting x by sz.
+static void old_shift(LTMesh *mesh, LTfloat sx, LTfloat sy, LTfloat sz) {
+    for (int i = 0; i < mesh->size; i++) {
+        mesh->xyzs[i] += LTVec3(sx, sy, sz);
+    }
+}
+
+static void old_compute_normals(LTMesh *mesh) {
+    LTVec3 *accum = new LTVec3[mesh->size];
+    for (int i = 0; i < mesh->num_indices; i += 3) {
+        int i1 = mesh->indices[i + 0];
+        int i2 = mesh->indices[i + 1];
+        int i3 = mesh->indices[i + 2];
+        LTVec3 v1 = mesh->xyzs[i2] - mesh->xyzs[i1];
+        LTVec3 v2 = mesh->xyzs[i3] - mesh->xyzs[i1];
+        LTVec3 nm = v1.cross(v2);
+        accum[i1] += nm;
+        accum[i2] += nm;
+        accum[i3] += nm;
+    }
+    mesh->ensure_normals();
+    for (int i = 0; i < mesh->size; i++) {
+        accum[i].normalize();
+        mesh->set_normal(i, accum[i]);
+    }
+    delete[] accum;
+}
+
+// ------------------------------------------------------------------
+
+// Gives the flat grid some relief, so it has interesting normals.
+static void make_3d(LTMesh *mesh) {
+    mesh->dimensions = 3;
+    for (int i = 0; i < mesh->size; i++) {
+        LTVec3 *p = &mesh->xyzs[i];
+        p->z = sinf(p->x * 7.0f) * cosf(p->y * 5.0f);
+    }
+}
+
+static LTfloat max_xyz_diff(LTMesh *a, LTMesh *b) {
+    LTfloat d = 0.0f;
+    if (a->size != b->size) return 1e9f;
+    for (int i = 0; i < a->size; i++) {
+        d = fmaxf(d, fabsf(a->xyzs[i].x - b->xyzs[i].x));
+        d = fmaxf(d, fabsf(a->xyzs[i].y - b->xyzs[i].y));
+        d = fmaxf(d, fabsf(a->xyzs[i].z - b->xyzs[i].z));
+        if (a->uvs != NULL) {
+            d = fmaxf(d, fabsf(a->uvs[i].u - b->uvs[i].u));
+            d = fmaxf(d, fabsf(a->uvs[i].v - b->uvs[i].v));
+        }
+    }
+    return d;
+}
+
+static LTfloat max_normal_diff(LTMesh *a, LTMesh *b) {
+    LTfloat d = 0.0f;
+    for (int i = 0; i < a->size; i++) {
+        d = fmaxf(d, fabsf(a->normals[i].x - b->normals[i].x));
+        d = fmaxf(d, fabsf(a->normals[i].y - b->normals[i].y));
+        d = fmaxf(d, fabsf(a->normals[i].z - b->normals[i].z));
+    }
+    return d;
+}
+
+static bool same_indices(LTMesh *a, LTMesh *b) {
+    return a->num_indices == b->num_indices
+        && memcmp(a->indices, b->indices, a->num_indices * sizeof(LTvertindex32)) == 0;
+}
+
+enum op {GRID, STRETCH, SHIFT, NORMALS, NUM_OPS};
+static const char *op_names[] = {"grid", "stretch", "shift", "normals"};
+
+// Best time of RUNS for op on an n x n grid, old code or new.
+static LTdouble time_op(LTTexturedNode *tex, int n, int op, bool old) {
+    LTdouble best = 1e9;
+    for (int r = 0; r < RUNS; r++) {
+        LTMesh *mesh = new_quad(tex);
+        if (op != GRID) {
+            mesh->grid(n, n);
+            make_3d(mesh);
+        }
+        LTdouble t0 = ltGetTime();
+        switch (op) {
+            case GRID:
+                if (old) old_grid(mesh, n, n); else mesh->grid(n, n);
+                break;
+            case STRETCH:
+                if (old) old_stretch(mesh, 0.5f, 0.2f, 0.0f, 1, 2, 3, 4, 5, 6);
+                else mesh->stretch(0.5f, 0.2f, 0.0f, 1, 2, 3, 4, 5, 6);
+                break;
+            case SHIFT:
+                if (old) old_shift(mesh, 1, 2, 3); else mesh->shift(1, 2, 3);
+                break;
+            case NORMALS:
+                if (old) old_compute_normals(mesh); else mesh->compute_normals();
+                break;
+        }
+        LTdouble t = ltGetTime() - t0;
+        if (t < best) best = t;
+        delete_mesh(mesh);
+    }
+    return best;
+}
+
+static bool check(LTTexturedNode *tex, int n) {
+    LTMesh *a = new_quad(tex);
+    LTMesh *b = new_quad(tex);
+    old_grid(a, n, n);
+    b->grid(n, n);
+    LTfloat grid_diff = max_xyz_diff(a, b);
+    bool indices_ok = same_indices(a, b);
+    // Start the rest from the same positions, otherwise vertices
+    // near the stretch pivot can go either way.
+    memcpy(a->xyzs, b->xyzs, b->size * sizeof(LTVec3));
+    make_3d(a);
+    make_3d(b);
+    old_stretch(a, 0.5f, 0.2f, 0.0f, 1, 2, 3, 4, 5, 6);
+    b->stretch(0.5f, 0.2f, 0.0f, 1, 2, 3, 4, 5, 6);
+    old_shift(a, 1, 2, 3);
+    b->shift(1, 2, 3);
+    LTfloat xform_diff = max_xyz_diff(a, b);
+    old_compute_normals(a);
+    b->compute_normals();
+    LTfloat normal_diff = max_normal_diff(a, b);
+    bool ok = indices_ok && grid_diff < 1e-4f && xform_diff < 1e-4f && normal_diff < 1e-4f;
+    printf("%d threads, %4d x %-4d grid diff %.2g, indices %s, stretch+shift diff %.2g, normal diff %.2g: %s\n",
+        ltWorkerThreads(), n, n, grid_diff, indices_ok ? "same" : "DIFFERENT", xform_diff, normal_diff,
+        ok ? "ok" : "FAIL");
+    delete_mesh(a);
+    delete_mesh(b);
+    return ok;
+}
+
+int main() {
+    LTTexturedNode *tex = fake_texture();
+    int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+    int threads = ltWorkerThreads();
+    bool ok = true;
+
+    // Check the threaded code paths even on a single CPU.
+    for (int s = 0; s < nsizes; s++) {
+        ltSetWorkerThreads(1);
+        ok = check(tex, sizes[s]) && ok;
+        ltSetWorkerThreads(LT_MAX_WORKER_THREADS);
+        ok = check(tex, sizes[s]) && ok;
+    }
+    ltSetWorkerThreads(threads);
+    printf("\n%-8s %11s %10s %10s %10s %9s\n", "op", "grid", "old ms", "1 thread", "threads", "speedup");
+    for (int op = 0; op < NUM_OPS; op++) {
+        for (int s = 0; s < nsizes; s++) {
+            int n = sizes[s];
+            LTdouble old_t = time_op(tex, n, op, true);
+            ltSetWorkerThreads(1);
+            LTdouble one_t = time_op(tex, n, op, false);
+            ltSetWorkerThreads(threads);
+            LTdouble all_t = time_op(tex, n, op, false);
+            printf("%-8s %4d x %-4d %10.3f %10.3f %10.3f %8.1fx\n", op_names[op], n, n,
+                old_t * 1000.0, one_t * 1000.0, all_t * 1000.0, old_t / all_t);
+        }
+    }
+    printf("(%d worker threads)\n", threads);
+    free(tex);
+    return ok ? 0 : 1;
+}
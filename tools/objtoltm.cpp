@@ -0,0 +1,83 @@
+// Converts a wavefront .obj model to a binary .ltm mesh.  Duplicate
+// vertices are merged, triangles and vertices are reordered for the
+// vertex cache, and normals, uvs and indices are quantised.
+// Reports the vertex cache miss ratio before and after, and the load
+// time of both files.
+//
+// Usage: objtoltm [-p] model.obj model.ltm
+//   -p  also quantise positions to 16 bits.
+#include "lt.h"
+
+#define LOAD_RUNS 10
+
+static LTMesh *alloc_mesh() {
+    // Scene nodes expect zeroed memory, as for Lua userdata.
+    return (LTMesh*)calloc(1, sizeof(LTMesh));
+}
+
+static void free_mesh(LTMesh *mesh) {
+    mesh->~LTMesh();
+    free(mesh);
+}
+
+static LTdouble time_load(const char *path, bool binary) {
+    LTdouble best = 1e9;
+    for (int i = 0; i < LOAD_RUNS; i++) {
+        LTMesh *mesh = alloc_mesh();
+        LTdouble t0 = ltGetTime();
+        bool ok = binary ? ltReadMeshFile(path, mesh) : ltReadWavefrontMesh(path, mesh);
+        LTdouble t = ltGetTime() - t0;
+        free_mesh(mesh);
+        if (!ok) {
+            exit(1);
+        }
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+static long file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : 0;
+}
+
+static void print_acmr(const char *when, LTMesh *mesh) {
+    printf("%-7s cache miss ratio: %.3f (FIFO 16), %.3f (FIFO 32)\n", when,
+        ltVertexCacheMissRatio(mesh->indices, mesh->num_indices, 16),
+        ltVertexCacheMissRatio(mesh->indices, mesh->num_indices, 32));
+}
+
+int main(int argc, char **argv) {
+    bool quantise_positions = false;
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-p") == 0) {
+        quantise_positions = true;
+        arg++;
+    }
+    if (argc - arg != 2) {
+        fprintf(stderr, "Usage: %s [-p] model.obj model.ltm\n", argv[0]);
+        return 1;
+    }
+    const char *in = argv[arg];
+    const char *out = argv[arg + 1];
+
+    LTMesh *mesh = alloc_mesh();
+    if (!ltReadWavefrontMesh(in, mesh)) {
+        return 1;
+    }
+    printf("%d vertices, %d triangles\n", mesh->size, mesh->num_indices / 3);
+    print_acmr("before", mesh);
+    LTdouble t0 = ltGetTime();
+    ltOptimizeVertexCache(mesh);
+    LTdouble opt_time = ltGetTime() - t0;
+    print_acmr("after", mesh);
+    printf("optimised in %.1fms\n", opt_time * 1000.0);
+    if (!ltWriteMeshFile(out, mesh, quantise_positions)) {
+        return 1;
+    }
+    free_mesh(mesh);
+
+    printf("%s: %8ld bytes, load %7.3fms\n", in, file_size(in), time_load(in, false) * 1000.0);
+    printf("%s: %8ld bytes, load %7.3fms\n", out, file_size(out), time_load(out, true) * 1000.0);
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Allocation microbenchmark comparing the pool allocator used for
+// events, actions and tweens against the global heap.
+// Keeps a window of live objects and repeatedly replaces random
+// entries, which is roughly the churn pattern of a busy scene.
+#include <sys/time.h>
+#include "lt.h"
+
+#define WINDOW 4096
+#define ITERATIONS 10000000
+
+struct BenchAction : LTAction {
+    BenchAction() : LTAction(NULL) {}
+    virtual bool doAction(LTfloat dt) { return true; }
+};
+
+struct BenchOnDone : LTTweenOnDone {
+    virtual void done(LTAction *action) {}
+};
+
+static double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
+}
+
+static unsigned int rnd_state = 12345;
+static inline unsigned int rnd() {
+    rnd_state = rnd_state * 1103515245 + 12345;
+    return rnd_state >> 8;
+}
+
+struct Slot {
+    LTEvent *event;
+    LTAction *action;
+    LTTweenOnDone *on_done;
+};
+
+static Slot slots[WINDOW];
+
+template<bool pooled>
+static void fill(Slot *s, LTEvent *proto) {
+    if (pooled) {
+        s->event = new LTEvent(proto);
+        s->action = new BenchAction();
+        s->on_done = new BenchOnDone();
+    } else {
+        s->event = ::new LTEvent(proto);
+        s->action = ::new BenchAction();
+        s->on_done = ::new BenchOnDone();
+    }
+}
+
+template<bool pooled>
+static void clear(Slot *s) {
+    if (pooled) {
+        delete s->event;
+        delete s->action;
+        delete s->on_done;
+    } else {
+        ::delete s->event;
+        ::delete s->action;
+        ::delete s->on_done;
+    }
+}
+
+template<bool pooled>
+static double run() {
+    LTEvent proto;
+    rnd_state = 12345;
+    for (int i = 0; i < WINDOW; i++) {
+        fill<pooled>(&slots[i], &proto);
+    }
+    double t0 = now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        Slot *s = &slots[rnd() % WINDOW];
+        clear<pooled>(s);
+        fill<pooled>(s, &proto);
+    }
+    double t = now() - t0;
+    for (int i = 0; i < WINDOW; i++) {
+        clear<pooled>(&slots[i]);
+    }
+    return t;
+}
+
+int main() {
+    double heap_t = run<false>();
+    double pool_t = run<true>();
+    LTPoolStats stats;
+    ltPoolGetStats(&stats);
+    printf("%d object triples, %d live\n", ITERATIONS, WINDOW);
+    printf("heap: %6.3fs (%5.1f ns/object)\n", heap_t, heap_t * 1.0e9 / (ITERATIONS * 3.0));
+    printf("pool: %6.3fs (%5.1f ns/object)\n", pool_t, pool_t * 1.0e9 / (ITERATIONS * 3.0));
+    printf("speedup: %0.2fx\n", heap_t / pool_t);
+    printf("pool stats: %d live, %d peak, %d allocs, %d chunks\n",
+        stats.live, stats.peak, stats.allocs, stats.chunks);
+    return 0;
+}
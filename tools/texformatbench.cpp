@@ -0,0 +1,255 @@
+// Texture format benchmark: converts synthetic 512x512 atlases (opaque
+// gradients, flat opaque colours, sprites with 1 bit alpha and a
+// translucent glow) to 16 bit texture formats and reports the format
+// chosen for each, the conversion throughput and error with each kind
+// of dithering and the texture memory saved.  Also checks that
+// flat colours convert exactly, that fully transparent pixels stay
+// transparent black and that the atlases' uploads are half the size.
+//
+// Links the LTNULLGL build of liblt (see the texformatbench rule in the
+// Makefile), so no GPU or display is needed.  Pixels are laid out as
+// read by ltReadImage on desktop GL.
+#include "lt.h"
+
+#define ATLAS_SIZE 512
+#define SIZE (ATLAS_SIZE - 1) // Images are packed with a pixel of padding.
+#define REPS 10
+#define NUM_DITHERS 3
+
+static LTpixel make_pixel(int r, int g, int b, int a) {
+    return ((LTpixel)a << 24) | ((LTpixel)r << 16) | ((LTpixel)g << 8) | (LTpixel)b;
+}
+
+static int clamp8(int v) {
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static LTuint32 rnd = 1;
+
+static int noise(int amount) {
+    rnd = rnd * 1664525u + 1013904223u;
+    return (int)((rnd >> 16) % (2 * amount + 1)) - amount;
+}
+
+// Smooth gradients with a little noise, like photographic art.
+static void fill_gradients(LTpixel *p) {
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            *p++ = make_pixel(clamp8(x / 2 + noise(2)), clamp8(y / 2 + noise(2)),
+                clamp8((x + y) / 4 + noise(2)), 255);
+        }
+    }
+}
+
+// Blocks of a few colours that RGB565 represents exactly.
+static void fill_flat(LTpixel *p) {
+    static const int palette[4][3] = {{255, 0, 0}, {0, 130, 255}, {33, 93, 0}, {255, 255, 255}};
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            const int *c = palette[(x / 32 + y / 32) % 4];
+            *p++ = make_pixel(c[0], c[1], c[2], 255);
+        }
+    }
+}
+
+// Shaded discs on a transparent background.
+static void fill_sprites(LTpixel *p) {
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            int dx = x % 64 - 32, dy = y % 64 - 32;
+            if (dx * dx + dy * dy < 28 * 28) {
+                *p++ = make_pixel(clamp8(200 + dx * 2), clamp8(120 + dy * 2), 60, 255);
+            } else {
+                *p++ = 0;
+            }
+        }
+    }
+}
+
+// Soft radial falloff in alpha.
+static void fill_glow(LTpixel *p) {
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            int dx = x - SIZE / 2, dy = y - SIZE / 2;
+            int d = (int)sqrtf((LTfloat)(dx * dx + dy * dy));
+            int a = clamp8(255 - d);
+            *p++ = a == 0 ? 0 : make_pixel(255, clamp8(160 + d / 4), 40, a);
+        }
+    }
+}
+
+// Back to 8 bit channels, as GL would expand them.
+static void decode_texel(LTushort t, LTTextureFormat format, int *c) {
+    static const int bits[3][4] = {{5, 6, 5, 0}, {4, 4, 4, 4}, {5, 5, 5, 1}};
+    const int *b = bits[format - LT_TEXTURE_FORMAT_RGB565];
+    int shift = 16;
+    for (int i = 0; i < 4; i++) {
+        if (b[i] == 0) {
+            c[i] = 255;
+            continue;
+        }
+        shift -= b[i];
+        int max = (1 << b[i]) - 1;
+        c[i] = (((t >> shift) & max) * 255 + max / 2) / max;
+    }
+}
+
+static void source_channels(LTpixel p, int *c) {
+    c[0] = (p >> 16) & 0xFF;
+    c[1] = (p >> 8) & 0xFF;
+    c[2] = p & 0xFF;
+    c[3] = p >> 24;
+}
+
+struct Error {
+    LTdouble rms;       // Over the colour channels of visible pixels, in 8 bit levels.
+    LTdouble block_rms; // The same for the means of 4x4 blocks of visible pixels,
+                        // which is what dithering improves.
+    int alpha_flips;    // Visible pixels that became transparent.
+    int bleeds;         // Transparent pixels that didn't stay transparent black.
+};
+
+static Error measure_error(LTpixel *src, LTushort *texels, LTTextureFormat format) {
+    Error e;
+    LTdouble sum = 0.0, block_sum = 0.0;
+    int n = 0, block_n = 0;
+    e.alpha_flips = 0;
+    e.bleeds = 0;
+    for (int i = 0; i < SIZE * SIZE; i++) {
+        int s[4], c[4];
+        source_channels(src[i], s);
+        decode_texel(texels[i], format, c);
+        if (s[3] == 0) {
+            if (c[0] != 0 || c[1] != 0 || c[2] != 0 || (format != LT_TEXTURE_FORMAT_RGB565 && c[3] != 0)) {
+                e.bleeds++;
+            }
+            continue;
+        }
+        if (c[3] == 0) {
+            e.alpha_flips++;
+        }
+        for (int j = 0; j < 3; j++) {
+            sum += (LTdouble)(s[j] - c[j]) * (s[j] - c[j]);
+        }
+        n += 3;
+    }
+    for (int by = 0; by + 4 <= SIZE; by += 4) {
+        for (int bx = 0; bx + 4 <= SIZE; bx += 4) {
+            int diff[3] = {0, 0, 0};
+            bool visible = true;
+            for (int i = 0; i < 16 && visible; i++) {
+                int p = (by + i / 4) * SIZE + bx + i % 4;
+                int s[4], c[4];
+                source_channels(src[p], s);
+                decode_texel(texels[p], format, c);
+                visible = s[3] != 0;
+                for (int j = 0; j < 3; j++) {
+                    diff[j] += s[j] - c[j];
+                }
+            }
+            if (visible) {
+                for (int j = 0; j < 3; j++) {
+                    block_sum += (diff[j] / 16.0) * (diff[j] / 16.0);
+                }
+                block_n += 3;
+            }
+        }
+    }
+    e.rms = n > 0 ? sqrt(sum / n) : 0.0;
+    e.block_rms = block_n > 0 ? sqrt(block_sum / block_n) : 0.0;
+    return e;
+}
+
+struct TestImage {
+    const char *name;
+    void (*fill)(LTpixel *p);
+    LTTextureFormat expected;
+    bool expect_exact;
+};
+
+static TestImage images[] = {
+    {"gradients", fill_gradients, LT_TEXTURE_FORMAT_RGB565, false},
+    {"flat", fill_flat, LT_TEXTURE_FORMAT_RGB565, true},
+    {"sprites", fill_sprites, LT_TEXTURE_FORMAT_RGBA5551, false},
+    {"glow", fill_glow, LT_TEXTURE_FORMAT_RGBA4444, false},
+};
+
+int main() {
+    ltInitGLState();
+    int failures = 0;
+    int num_images = sizeof(images) / sizeof(images[0]);
+    LTushort *texels = new LTushort[SIZE * SIZE];
+    printf("%d %dx%d images, %d conversions of each\n", num_images, SIZE, SIZE, REPS);
+    for (int i = 0; i < num_images; i++) {
+        TestImage *ti = &images[i];
+        LTImageBuffer *buf = ltCreateEmptyImageBuffer(ti->name, SIZE, SIZE);
+        ti->fill(buf->bb_pixels);
+        LTImagePacker *packer = new LTImagePacker(0, 0, ATLAS_SIZE, ATLAS_SIZE, ATLAS_SIZE);
+        if (!ltPackImage(packer, buf)) {
+            printf("  FAIL: %s doesn't fit in a %dx%d atlas\n", ti->name, ATLAS_SIZE, ATLAS_SIZE);
+            return 1;
+        }
+
+        bool exact;
+        LTTextureFormat format = ltChooseTextureFormat(packer, &exact);
+        printf("  %-10s auto: %s%s\n", ti->name, ltTextureFormatName(format), exact ? " (exact)" : "");
+        if (format != ti->expected || exact != ti->expect_exact) {
+            printf("  FAIL: expected %s%s\n", ltTextureFormatName(ti->expected),
+                ti->expect_exact ? " (exact)" : "");
+            failures++;
+        }
+
+        for (int d = 0; d < NUM_DITHERS; d++) {
+            LTDither dither = (LTDither)d;
+            LTdouble t0 = ltGetTime();
+            for (int r = 0; r < REPS; r++) {
+                ltConvertPixels(buf->bb_pixels, texels, SIZE, SIZE, format, dither);
+            }
+            LTdouble t = (ltGetTime() - t0) / REPS;
+            Error e = measure_error(buf->bb_pixels, texels, format);
+            printf("    dither %-8s %8.1f Mpixels/s  rms error %.2f  4x4 block rms error %.2f\n",
+                ltDitherName(dither), SIZE * SIZE / t / 1e6, e.rms, e.block_rms);
+            if (exact && e.rms != 0.0) {
+                printf("  FAIL: exact conversion has error\n");
+                failures++;
+            }
+            if (e.bleeds != 0) {
+                printf("  FAIL: %d transparent pixels changed\n", e.bleeds);
+                failures++;
+            }
+            if (format == LT_TEXTURE_FORMAT_RGBA5551 && e.alpha_flips != 0) {
+                printf("  FAIL: %d opaque pixels became transparent\n", e.alpha_flips);
+                failures++;
+            }
+        }
+
+        // The atlas is uploaded at 2 bytes per texel.
+        LTTextureStats before, after;
+        ltGetTextureStats(&before);
+        ltNullGLResetStats();
+        LTAtlas *atlas = new LTAtlas(packer, LT_TEXTURE_FILTER_LINEAR, LT_TEXTURE_FILTER_LINEAR,
+            LT_TEXTURE_FORMAT_AUTO, LT_DITHER_DIFFUSE);
+        LTNullGLStats gl;
+        ltNullGLGetStats(&gl);
+        ltGetTextureStats(&after);
+        int saved = after.saved_bytes - before.saved_bytes;
+        printf("    atlas        %s, %d bytes uploaded, %d bytes saved\n",
+            ltTextureFormatName(atlas->format), gl.texture_bytes, saved);
+        int atlas_bytes = ATLAS_SIZE * ATLAS_SIZE * 2;
+        if (atlas->format != format || gl.texture_bytes != atlas_bytes || saved != atlas_bytes) {
+            printf("  FAIL: expected a %s upload of %d bytes\n", ltTextureFormatName(format), atlas_bytes);
+            failures++;
+        }
+        if (atlas->dither != (exact ? LT_DITHER_NONE : LT_DITHER_DIFFUSE)) {
+            printf("  FAIL: dithering %s\n", ltDitherName(atlas->dither));
+            failures++;
+        }
+        delete atlas;
+        packer->deleteOccupants();
+        delete packer;
+    }
+    delete[] texels;
+
+    printf(failures == 0 ? "pass\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// Tile map benchmark: builds a 1000x1000 lt.TileMap and reports the
+// time to build its chunks, the memory used per tile and the draw calls
+// per frame while scrolling a screen sized view across it.  Also checks
+// that only visible chunks are built and that changing a tile rebuilds
+// just its chunk.
+//
+// Links the LTNULLGL build of liblt (see the tilemapbench rule in the
+// Makefile), so no GPU or display is needed.  Times include the work
+// done by liblt on the CPU, but not by a GL driver.
+#include "lt.h"
+
+#define FRAMES 200
+#define MAP_W 1000
+#define MAP_H 1000
+#define TILE_SIZE 16
+#define VIEW_W 1024
+#define VIEW_H 768
+#define NUM_TEXTURES 4
+#define IMAGES_PER_TEXTURE 16
+
+// Scene nodes expect zeroed memory, as for Lua userdata.
+template <typename T> static T *new_node() {
+    return new (calloc(1, sizeof(T))) T();
+}
+
+// One of a 4x4 grid of images in the texture.
+static LTTexturedNode *new_image(LTtexid tex, int i) {
+    LTTexturedNode *img = new_node<LTTexturedNode>();
+    img->texture_id = tex;
+    LTtexcoord ts = LT_MAX_TEX_COORD / 4;
+    LTtexcoord x0 = (i % 4) * ts;
+    LTtexcoord y0 = (i / 4) * ts;
+    LTtexcoord x1 = x0 + ts;
+    LTtexcoord y1 = y0 + ts;
+    LTtexcoord tc[8] = {x0, y0, x1, y0, x1, y1, x0, y1};
+    memcpy(img->tex_coords, tc, sizeof(tc));
+    return img;
+}
+
+static void fill_map(LTTileMap *map) {
+    int num_images = map->images.size();
+    LTuint32 r = 1;
+    for (int y = 0; y < map->height; y++) {
+        for (int x = 0; x < map->width; x++) {
+            r = r * 1664525u + 1013904223u;
+            // About one tile in 8 is empty.
+            int tile = (r >> 16) % (num_images + num_images / 7);
+            map->set(x, y, tile < num_images ? tile + 1 : 0);
+        }
+    }
+}
+
+struct Frame {
+    LTNullGLStats gl;
+    int chunks_drawn;
+    int draw_calls;
+};
+
+static Frame draw_frame(LTTileMap *map, LTfloat left, LTfloat bottom) {
+    LTColor black(0, 0, 0, 1);
+    ltNullGLResetStats();
+    ltPrepareForRendering(0, 0, VIEW_W, VIEW_H, left, bottom, left + VIEW_W, bottom + VIEW_H, &black, false);
+    map->draw();
+    ltFinishRendering();
+    Frame f;
+    ltNullGLGetStats(&f.gl);
+    f.chunks_drawn = map->stats.chunks_drawn;
+    f.draw_calls = map->stats.draw_calls;
+    return f;
+}
+
+int main() {
+    ltInitGLState();
+    LTtexid textures[NUM_TEXTURES];
+    for (int t = 0; t < NUM_TEXTURES; t++) {
+        textures[t] = ltGenTexture();
+    }
+    int failures = 0;
+
+    LTTileMap *map = new (calloc(1, sizeof(LTTileMap))) LTTileMap(MAP_W, MAP_H, TILE_SIZE, TILE_SIZE);
+    for (int i = 0; i < NUM_TEXTURES * IMAGES_PER_TEXTURE; i++) {
+        map->add_image(new_image(textures[i % NUM_TEXTURES], i / NUM_TEXTURES));
+    }
+    int num_tiles = MAP_W * MAP_H;
+    printf("%dx%d map of %dx%d tiles, %d chunks of %dx%d, %d images in %d textures\n",
+        MAP_W, MAP_H, TILE_SIZE, TILE_SIZE, map->chunks_x * map->chunks_y,
+        LT_TILEMAP_CHUNK_SIZE, LT_TILEMAP_CHUNK_SIZE, (int)map->images.size(), NUM_TEXTURES);
+
+    LTdouble t0 = ltGetTime();
+    fill_map(map);
+    LTdouble fill_time = ltGetTime() - t0;
+    printf("  fill             %8.3f ms\n", fill_time * 1000.0);
+
+    // Only the chunks in view are built for the first frame.
+    Frame f = draw_frame(map, 0, 0);
+    int visible_builds = map->stats.chunk_builds;
+    printf("  first frame      %8.3f ms  %d chunks built\n", map->stats.build_time * 1000.0, visible_builds);
+    if (visible_builds != f.chunks_drawn) {
+        printf("  FAIL: built %d chunks for %d visible ones\n", visible_builds, f.chunks_drawn);
+        failures++;
+    }
+
+    LTdouble build_time = map->stats.build_time;
+    map->build_all();
+    build_time = map->stats.build_time - build_time;
+    printf("  build remaining  %8.3f ms  (%.1f ns per tile)\n", build_time * 1000.0,
+        build_time * 1e9 / (num_tiles - visible_builds * LT_TILEMAP_CHUNK_SIZE * LT_TILEMAP_CHUNK_SIZE));
+    if (map->stats.chunk_builds != map->chunks_x * map->chunks_y) {
+        printf("  FAIL: %d chunk builds for %d chunks\n", map->stats.chunk_builds,
+            map->chunks_x * map->chunks_y);
+        failures++;
+    }
+    printf("  memory           %8.2f cpu bytes per tile  %.2f vbo bytes per tile\n",
+        (double)map->cpu_bytes() / num_tiles, (double)map->vbo_bytes() / num_tiles);
+
+    // Scroll diagonally across the whole map.
+    int max_chunks = 0, max_calls = 0, max_vertices = 0, total_calls = 0;
+    t0 = ltGetTime();
+    for (int i = 0; i < FRAMES; i++) {
+        LTfloat x = (LTfloat)i / (FRAMES - 1) * (MAP_W * TILE_SIZE - VIEW_W);
+        LTfloat y = (LTfloat)i / (FRAMES - 1) * (MAP_H * TILE_SIZE - VIEW_H);
+        f = draw_frame(map, x, y);
+        max_chunks = f.chunks_drawn > max_chunks ? f.chunks_drawn : max_chunks;
+        max_calls = f.gl.draw_calls > max_calls ? f.gl.draw_calls : max_calls;
+        max_vertices = f.gl.vertices > max_vertices ? f.gl.vertices : max_vertices;
+        total_calls += f.gl.draw_calls;
+        if (f.gl.buffer_bytes != 0) {
+            printf("  FAIL: frame %d uploaded %d bytes without a change\n", i, f.gl.buffer_bytes);
+            failures++;
+        }
+    }
+    LTdouble frame_time = (ltGetTime() - t0) / FRAMES;
+    printf("  scrolling        %8.3f ms per frame  %.1f draws per frame (max %d, %d chunks, %d indices)\n",
+        frame_time * 1000.0, (double)total_calls / FRAMES, max_calls, max_chunks, max_vertices);
+    printf("  per-tile nodes would draw %d quads in as many calls\n",
+        (VIEW_W / TILE_SIZE + 1) * (VIEW_H / TILE_SIZE + 1));
+
+    // Changing a tile rebuilds only its chunk, at the next draw.
+    int builds = map->stats.chunk_builds;
+    map->set(MAP_W / 2, MAP_H / 2, map->get(MAP_W / 2, MAP_H / 2) % map->images.size() + 1);
+    LTfloat left = MAP_W / 2 * TILE_SIZE - VIEW_W / 2;
+    LTfloat bottom = MAP_H / 2 * TILE_SIZE - VIEW_H / 2;
+    f = draw_frame(map, left, bottom);
+    printf("  set tile         %d chunk(s) rebuilt, %d bytes uploaded\n",
+        map->stats.chunk_builds - builds, f.gl.buffer_bytes);
+    if (map->stats.chunk_builds != builds + 1) {
+        printf("  FAIL: changing a tile rebuilt %d chunks\n", map->stats.chunk_builds - builds);
+        failures++;
+    }
+    f = draw_frame(map, left, bottom);
+    if (map->stats.chunk_builds != builds + 1 || f.gl.buffer_bytes != 0) {
+        printf("  FAIL: rebuilt without a change\n");
+        failures++;
+    }
+
+    printf(failures == 0 ? "pass\n" : "FAIL\n");
+    return failures == 0 ? 0 : 1;
+}
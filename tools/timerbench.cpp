@@ -0,0 +1,141 @@
+// Timer benchmark: 100k timers with random delays, run at 60fps until
+// all have fired.  Compares the native timing wheel with the old
+// Lua implementation that scanned every pending timer each frame.
+// Also times hour long advances with only a few timers pending, as
+// after a resume from suspend.
+#include "lt.h"
+
+#define NUM_TIMERS 100000
+#define MAX_SECS 10.0f
+#define DT (1.0f / 60.0f)
+
+struct CountHandler : LTTimerHandler {
+    int fired;
+    int early;
+    int late;
+    LTTimerWheel *wheel;
+    CountHandler() { fired = 0; early = 0; late = 0; }
+    virtual void fire(LTTimer *timer) {
+        fired++;
+        // ref holds the expected expiry tick.
+        if (wheel->now < (uint64_t)timer->ref) {
+            early++;
+        } else if (wheel->now > (uint64_t)timer->ref + LT_TIMER_TICKS_PER_SEC / 60 + 1) {
+            late++;
+        }
+    }
+};
+
+static unsigned int rnd_state = 4321;
+static inline LTfloat rnd_secs() {
+    rnd_state = rnd_state * 1103515245 + 12345;
+    return (LTfloat)((rnd_state >> 8) & 0xFFFF) / 65535.0f * MAX_SECS;
+}
+
+static void bench_wheel() {
+    CountHandler h;
+    LTTimerWheel wheel(&h);
+    h.wheel = &wheel;
+    std::vector<int> handles;
+    LTdouble t0 = ltGetTime();
+    for (int i = 0; i < NUM_TIMERS; i++) {
+        LTfloat secs = rnd_secs();
+        LTTimer *timer = wheel.add(secs, (int)(secs * LT_TIMER_TICKS_PER_SEC));
+        handles.push_back(timer->handle);
+    }
+    LTdouble t_add = ltGetTime() - t0;
+    t0 = ltGetTime();
+    int cancelled = 0;
+    for (int i = 0; i < NUM_TIMERS; i += 10) {
+        LTTimer *timer = ltLookupTimer(handles[i]);
+        if (timer != NULL) {
+            wheel.cancel(timer);
+            cancelled++;
+        }
+    }
+    LTdouble t_cancel = ltGetTime() - t0;
+    t0 = ltGetTime();
+    int frames = 0;
+    while (wheel.count > 0) {
+        wheel.advance(DT);
+        frames++;
+    }
+    LTdouble t_run = ltGetTime() - t0;
+    printf("wheel: add %0.2fms, cancel %d %0.2fms, %d frames %0.2fms (%0.1fus/frame), fired %d, early %d, late %d\n",
+        t_add * 1000.0, cancelled, t_cancel * 1000.0, frames, t_run * 1000.0,
+        t_run * 1.0e6 / frames, h.fired, h.early, h.late);
+}
+
+static void bench_sparse() {
+    CountHandler h;
+    LTTimerWheel wheel(&h);
+    h.wheel = &wheel;
+    // One timer per hour, plus one that stays pending.
+    int hours = 100;
+    for (int i = 1; i <= hours; i++) {
+        wheel.add(i * 3600.0f - 1.0f, (i * 3600 - 1) * LT_TIMER_TICKS_PER_SEC);
+    }
+    wheel.add(1.0e7f, 0);
+    LTdouble t0 = ltGetTime();
+    for (int i = 0; i < hours; i++) {
+        wheel.advance(3600.0f);
+    }
+    LTdouble t_run = ltGetTime() - t0;
+    printf("sparse: %d one hour advances %0.2fms, fired %d\n",
+        hours, t_run * 1000.0, h.fired);
+}
+
+static const char *old_timers =
+    "local insert = table.insert\n"
+    "timers = {}\n"
+    "fired = 0\n"
+    "local function f() fired = fired + 1 end\n"
+    "function add(t) insert(timers, {action = f, t = t}) end\n"
+    "function advance(dt)\n"
+    "    for i, tmr in pairs(timers) do\n"
+    "        local t = tmr.t\n"
+    "        t = t - dt\n"
+    "        if t <= 0 then\n"
+    "            tmr.action()\n"
+    "            timers[i] = nil\n"
+    "        else\n"
+    "            tmr.t = t\n"
+    "        end\n"
+    "    end\n"
+    "end\n";
+
+static void bench_lua() {
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    if (luaL_dostring(L, old_timers) != 0) {
+        printf("%s\n", lua_tostring(L, -1));
+        return;
+    }
+    rnd_state = 4321;
+    LTdouble t0 = ltGetTime();
+    for (int i = 0; i < NUM_TIMERS; i++) {
+        lua_getglobal(L, "add");
+        lua_pushnumber(L, rnd_secs());
+        lua_call(L, 1, 0);
+    }
+    LTdouble t_add = ltGetTime() - t0;
+    t0 = ltGetTime();
+    int frames = (int)(MAX_SECS / DT) + 2;
+    for (int i = 0; i < frames; i++) {
+        lua_getglobal(L, "advance");
+        lua_pushnumber(L, DT);
+        lua_call(L, 1, 0);
+    }
+    LTdouble t_run = ltGetTime() - t0;
+    lua_getglobal(L, "fired");
+    printf("lua:   add %0.2fms, %d frames %0.2fms (%0.1fus/frame), fired %d\n",
+        t_add * 1000.0, frames, t_run * 1000.0, t_run * 1.0e6 / frames, (int)lua_tointeger(L, -1));
+    lua_close(L);
+}
+
+int main() {
+    bench_wheel();
+    bench_sparse();
+    bench_lua();
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Tween throughput benchmark.  Runs many concurrent tweens through the
+// action system and reports tweens advanced per millisecond from the
+// batched tween table, with and without ease lookup tables, against a
+// baseline action per tween that calls the ease function through a
+// pointer (how tweens used to be run).  Also checks that tweens run in
+// the same order relative to other actions as they did from the action
+// list.
+#include "lt.h"
+
+#define NUM_NODES 2000
+#define TWEENS_PER_NODE 4
+#define FRAMES 240
+#define REPS 5
+
+struct BenchNode : LTSceneNode {
+    LTfloat v[TWEENS_PER_NODE];
+};
+
+static LTfloat get_v0(LTObject *o) { return ((BenchNode*)o)->v[0]; }
+static LTfloat get_v1(LTObject *o) { return ((BenchNode*)o)->v[1]; }
+static LTfloat get_v2(LTObject *o) { return ((BenchNode*)o)->v[2]; }
+static LTfloat get_v3(LTObject *o) { return ((BenchNode*)o)->v[3]; }
+static void set_v0(LTObject *o, LTfloat x) { ((BenchNode*)o)->v[0] = x; }
+static void set_v1(LTObject *o, LTfloat x) { ((BenchNode*)o)->v[1] = x; }
+static void set_v2(LTObject *o, LTfloat x) { ((BenchNode*)o)->v[2] = x; }
+static void set_v3(LTObject *o, LTfloat x) { ((BenchNode*)o)->v[3] = x; }
+
+static LTFloatGetter getters[TWEENS_PER_NODE] = {get_v0, get_v1, get_v2, get_v3};
+static LTFloatSetter setters[TWEENS_PER_NODE] = {set_v0, set_v1, set_v2, set_v3};
+
+// The old scheme: one virtual doAction per tween per frame.
+struct OldTweenAction : LTAction {
+    LTFloatSetter setter;
+    LTfloat t, initial_val, distance, target_val, time;
+    LTEaseFunc ease;
+    OldTweenAction(LTSceneNode *n, LTFloatGetter g, LTFloatSetter s, LTfloat target, LTfloat time, LTEaseFunc ease)
+        : LTAction(n)
+    {
+        setter = s;
+        t = 0.0f;
+        initial_val = g(n);
+        target_val = target;
+        distance = target - initial_val;
+        OldTweenAction::time = time;
+        OldTweenAction::ease = ease;
+    }
+    virtual bool doAction(LTfloat dt) {
+        LTfloat inc = dt / time;
+        t += inc;
+        // Tweens now also notify the node of the change (for render
+        // targets), so the baseline does too.
+        if (t < 1.0f - inc) {
+            setter(node, initial_val + distance * ease(t));
+            node->changed();
+            return false;
+        }
+        setter(node, target_val);
+        node->changed();
+        return true;
+    }
+};
+
+static BenchNode nodes[NUM_NODES];
+
+static int ease_ids[TWEENS_PER_NODE];
+static LTEaseFunc ease_funcs[TWEENS_PER_NODE] = {
+    ltEase_inout, ltEase_elastic, ltEase_bounce, ltEase_revolve};
+
+static void add_tweens(bool old) {
+    for (int i = 0; i < NUM_NODES; i++) {
+        BenchNode *n = &nodes[i];
+        for (int j = 0; j < TWEENS_PER_NODE; j++) {
+            n->v[j] = 0.0f;
+            LTAction *a;
+            if (old) {
+                a = new OldTweenAction(n, getters[j], setters[j], 100.0f, 3.0f, ease_funcs[j]);
+            } else {
+                a = new LTTweenAction(n, getters[j], setters[j], 100.0f, 3.0f, 0.0f, ease_ids[j], NULL);
+            }
+            n->add_action(a);
+        }
+    }
+}
+
+// Best of REPS runs, since the timings are short.
+static double run(const char *name, bool old, bool tables) {
+    ltSetEaseTablesEnabled(tables);
+    double best = 0.0;
+    int advanced = 0;
+    LTdouble best_ms = 0.0;
+    LTTweenStats stats;
+    for (int rep = 0; rep < REPS; rep++) {
+        add_tweens(old);
+        advanced = 0;
+        LTdouble t0 = ltGetTime();
+        for (int f = 0; f < FRAMES; f++) {
+            advanced += ltNumScheduledActions();
+            ltExecuteActions(1.0f / 60.0f);
+            if (f == 0) {
+                ltGetTweenStats(&stats);
+            }
+        }
+        LTdouble ms = (ltGetTime() - t0) * 1000.0;
+        if (rep == 0 || advanced / ms > best) {
+            best = advanced / ms;
+            best_ms = ms;
+        }
+        // Everything should have finished on target.
+        for (int i = 0; i < NUM_NODES; i++) {
+            for (int j = 0; j < TWEENS_PER_NODE; j++) {
+                if (nodes[i].v[j] != 100.0f) {
+                    printf("  node %d field %d ended at %f\n", i, j, nodes[i].v[j]);
+                    return best;
+                }
+            }
+        }
+    }
+    printf("%-22s %8d tweens in %7.2fms  %8.0f tweens/ms", name, advanced, best_ms, best);
+    if (!old) {
+        // As reported by lt.TweenStats.
+        printf("  (first pass %0.3fms)", stats.secs * 1000.0);
+    }
+    printf("\n");
+    return best;
+}
+
+// Records the order in which actions and tweens run.
+static char order[16];
+static int order_len = 0;
+
+static void log_run(char c) {
+    if (order_len < (int)sizeof(order) - 1) {
+        order[order_len++] = c;
+    }
+}
+
+struct LogAction : LTAction {
+    char name;
+    LogAction(LTSceneNode *n, char name) : LTAction(n) {
+        LogAction::name = name;
+    }
+    virtual bool doAction(LTfloat dt) {
+        log_run(name);
+        return false;
+    }
+};
+
+static void log_v0(LTObject *o, LTfloat x) { log_run('0'); }
+static void log_v1(LTObject *o, LTfloat x) { log_run('1'); }
+
+static bool check_order() {
+    BenchNode *n = new (calloc(1, sizeof(BenchNode))) BenchNode();
+    n->active = 1;
+    n->add_action(new LogAction(n, 'a'));
+    n->add_action(new LTTweenAction(n, get_v0, log_v0, 1.0f, 10.0f, 0.0f, LT_EASE_LINEAR, NULL));
+    n->add_action(new LogAction(n, 'b'));
+    n->add_action(new LTTweenAction(n, get_v1, log_v1, 1.0f, 10.0f, 0.0f, LT_EASE_LINEAR, NULL));
+    n->add_action(new LogAction(n, 'c'));
+    ltExecuteActions(1.0f / 60.0f);
+    order[order_len] = '\0';
+    // Newest first, as in the action list.
+    bool ok = strcmp(order, "c1b0a") == 0;
+    printf("action order %s: %s\n", order, ok ? "ok" : "FAIL (expected c1b0a)");
+    return ok;
+}
+
+static void check_tables() {
+    int bez = ltCubicBezierEaseId(0.25f, 0.1f, 0.25f, 1.0f);
+    int ids[] = {LT_EASE_ELASTIC, LT_EASE_REVOLVE, bez};
+    const char *names[] = {"elastic", "revolve", "bezier"};
+    for (int k = 0; k < 3; k++) {
+        LTfloat max_err = 0.0f;
+        for (int i = 0; i <= 10000; i++) {
+            LTfloat t = (LTfloat)i / 10000.0f;
+            ltSetEaseTablesEnabled(false);
+            LTfloat exact = ltEase(ids[k], t);
+            ltSetEaseTablesEnabled(true);
+            LTfloat approx = ltEase(ids[k], t);
+            LTfloat err = fabsf(exact - approx);
+            if (err > max_err) max_err = err;
+        }
+        printf("table max error %-8s %g\n", names[k], max_err);
+    }
+}
+
+int main() {
+    ease_ids[0] = LT_EASE_INOUT;
+    ease_ids[1] = LT_EASE_ELASTIC;
+    ease_ids[2] = LT_EASE_BOUNCE;
+    ease_ids[3] = LT_EASE_REVOLVE;
+    for (int i = 0; i < NUM_NODES; i++) {
+        nodes[i].active = 1;
+    }
+    double old = run("per-action", true, false);
+    double batched = run("batched", false, false);
+    double tables = run("batched + tables", false, true);
+    printf("speedup: %0.2fx (%0.2fx with tables)\n", batched / old, tables / old);
+    check_tables();
+    return check_order() ? 0 : 1;
+}
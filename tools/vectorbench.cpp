@@ -0,0 +1,210 @@
+// LTVector column kernel benchmark: times the native column operations
+// on a particle-style vector against the equivalent Lua loops over a
+// flat Lua array laid out the same way, and checks they agree.
+#include "lt.h"
+
+#define N 100000
+#define STRIDE 8    // x, y, vx, vy, r, g, b, a
+#define RUNS 20
+
+enum {X, Y, VX, VY, R, G, B, A};
+
+static const char *lua_ops =
+    "local N, S = ...\n"
+    "local ops = {}\n"
+    "function ops.integrate(d, dt)\n"
+    "    for i = 0, N - 1 do\n"
+    "        local r = i * S\n"
+    "        d[r + 1] = d[r + 1] + d[r + 3] * dt\n"
+    "        d[r + 2] = d[r + 2] + d[r + 4] * dt\n"
+    "    end\n"
+    "end\n"
+    "function ops.gravity(d, g)\n"
+    "    for i = 0, N - 1 do\n"
+    "        local r = i * S + 4\n"
+    "        d[r] = d[r] + g\n"
+    "    end\n"
+    "end\n"
+    "function ops.clamp(d, lo, hi)\n"
+    "    for i = 0, N - 1 do\n"
+    "        local r = i * S + 3\n"
+    "        local x = d[r]\n"
+    "        if x < lo then d[r] = lo elseif x > hi then d[r] = hi end\n"
+    "    end\n"
+    "end\n"
+    "function ops.wrap(d, lo, hi)\n"
+    "    local w = hi - lo\n"
+    "    for i = 0, N - 1 do\n"
+    "        local r = i * S + 1\n"
+    "        d[r] = lo + (d[r] - lo) % w\n"
+    "    end\n"
+    "end\n"
+    "function ops.lerp(d, t)\n"
+    "    for i = 0, N - 1 do\n"
+    "        local r = i * S\n"
+    "        local a = d[r + 5]\n"
+    "        d[r + 8] = a + (d[r + 6] - a) * t\n"
+    "    end\n"
+    "end\n"
+    "function ops.random(d, lo, hi)\n"
+    "    local random = math.random\n"
+    "    for i = 0, N - 1 do\n"
+    "        d[i * S + 5] = lo + random() * (hi - lo)\n"
+    "    end\n"
+    "end\n"
+    "function ops.gather(dst, src, idx)\n"
+    "    for i = 0, N - 1 do\n"
+    "        local r = i * S\n"
+    "        local s = (idx[i + 1] - 1) * S\n"
+    "        dst[r + 1] = src[s + 1]\n"
+    "        dst[r + 2] = src[s + 2]\n"
+    "    end\n"
+    "end\n"
+    "return ops\n";
+
+static LTVector *new_vector(int size, int stride) {
+    void *mem = calloc(1, sizeof(LTVector));
+    LTVector *v = new (mem) LTVector(size, stride);
+    v->size = size;
+    return v;
+}
+
+static void fill(LTVector *v) {
+    srand(1);
+    for (int i = 0; i < v->size * v->stride; i++) {
+        v->data[i] = (LTfloat)(rand() % 2000 - 1000) / 10.0f;
+    }
+}
+
+// Copies v into a new flat Lua array, left on the stack.
+static void push_array(lua_State *L, LTVector *v) {
+    int n = v->size * v->stride;
+    lua_createtable(L, n, 0);
+    for (int i = 0; i < n; i++) {
+        lua_pushnumber(L, v->data[i]);
+        lua_rawseti(L, -2, i + 1);
+    }
+}
+
+// Largest relative difference between the Lua array and column col of
+// v.  For wrapped columns, values a period apart count as equal, as
+// rounding can put a value near one end of the range at the other.
+static LTfloat max_diff(lua_State *L, int arr, LTVector *v, int col, LTfloat period) {
+    LTfloat d = 0.0f;
+    for (int i = col; i < v->size * v->stride; i += v->stride) {
+        lua_rawgeti(L, arr, i + 1);
+        LTfloat x = (LTfloat)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+        LTfloat e = fabsf(x - v->data[i]);
+        if (period > 0.0f) {
+            e = fminf(e, fabsf(e - period));
+        }
+        e /= fmaxf(1.0f, fabsf(x));
+        if (e > d) d = e;
+    }
+    return d;
+}
+
+// Calls ops[name](array, a, b) RUNS times and returns the best time.
+static LTdouble time_lua(lua_State *L, const char *name, LTfloat a, LTfloat b) {
+    LTdouble best = 1e9;
+    for (int r = 0; r < RUNS; r++) {
+        lua_getfield(L, 1, name);
+        lua_pushvalue(L, 2);
+        lua_pushnumber(L, a);
+        lua_pushnumber(L, b);
+        LTdouble t0 = ltGetTime();
+        lua_call(L, 3, 0);
+        LTdouble t = ltGetTime() - t0;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+static void report(const char *name, LTdouble lua_t, LTdouble native_t, LTfloat diff) {
+    printf("%-10s lua %8.3fms, native %7.3fms, %6.1fx, %5.1f Mrecords/s, max rel diff %.2g\n",
+        name, lua_t * 1000.0, native_t * 1000.0, lua_t / native_t,
+        (LTdouble)N / native_t / 1e6, diff);
+}
+
+#define TIME_NATIVE(best, stmt) { \
+    best = 1e9; \
+    for (int r = 0; r < RUNS; r++) { \
+        LTdouble t0 = ltGetTime(); \
+        stmt; \
+        LTdouble t = ltGetTime() - t0; \
+        if (t < best) best = t; \
+    } \
+}
+
+int main() {
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+    if (luaL_loadstring(L, lua_ops) != 0) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        return 1;
+    }
+    lua_pushinteger(L, N);
+    lua_pushinteger(L, STRIDE);
+    lua_call(L, 2, 1); // ops at index 1
+
+    LTVector *v = new_vector(N, STRIDE);
+    fill(v);
+    push_array(L, v); // data at index 2
+    LTdouble lua_t, native_t;
+
+    // Each op is run RUNS times on both sides, so the results stay
+    // comparable.
+    lua_t = time_lua(L, "integrate", 0.016f, 0);
+    TIME_NATIVE(native_t, (ltVectorMultiplyAdd(v, X, VX, 0.016f), ltVectorMultiplyAdd(v, Y, VY, 0.016f)));
+    report("integrate", lua_t, native_t, fmaxf(max_diff(L, 2, v, X, 0), max_diff(L, 2, v, Y, 0)));
+
+    lua_t = time_lua(L, "gravity", -0.15f, 0);
+    TIME_NATIVE(native_t, ltVectorAdd(v, VY, -0.15f));
+    report("gravity", lua_t, native_t, max_diff(L, 2, v, VY, 0));
+
+    lua_t = time_lua(L, "clamp", -50.0f, 50.0f);
+    TIME_NATIVE(native_t, ltVectorClamp(v, VX, -50.0f, 50.0f));
+    report("clamp", lua_t, native_t, max_diff(L, 2, v, VX, 0));
+
+    lua_t = time_lua(L, "wrap", -64.0f, 64.0f);
+    TIME_NATIVE(native_t, ltVectorWrap(v, X, -64.0f, 64.0f));
+    report("wrap", lua_t, native_t, max_diff(L, 2, v, X, 128.0f));
+
+    lua_t = time_lua(L, "lerp", 0.25f, 0);
+    TIME_NATIVE(native_t, ltVectorLerp(v, A, R, G, 0.25f));
+    report("lerp", lua_t, native_t, max_diff(L, 2, v, A, 0));
+
+    // Random numbers differ, so only the time is compared.
+    void *mem = calloc(1, sizeof(LTRandomGenerator));
+    LTRandomGenerator *rng = new (mem) LTRandomGenerator();
+    rng->seed = 1;
+    rng->init(NULL); // Doesn't use L.
+    lua_t = time_lua(L, "random", 0.0f, 1.0f);
+    TIME_NATIVE(native_t, ltVectorRandom(v, R, 0.0f, 1.0f, rng));
+    report("random", lua_t, native_t, 0.0f);
+
+    // Reverse the records' positions through an index column.
+    LTVector *src = new_vector(N, STRIDE);
+    LTVector *idx = new_vector(N, 1);
+    fill(src);
+    for (int i = 0; i < N; i++) {
+        idx->data[i] = (LTfloat)(N - i);
+    }
+    lua_getfield(L, 1, "gather");
+    push_array(L, v);
+    lua_replace(L, 2);
+    lua_pushvalue(L, 2);
+    push_array(L, src);
+    push_array(L, idx);
+    LTdouble t0 = ltGetTime();
+    lua_call(L, 3, 0);
+    lua_t = ltGetTime() - t0;
+    t0 = ltGetTime();
+    ltVectorGather(v, X, src, X, 2, idx, 0);
+    native_t = ltGetTime() - t0;
+    report("gather", lua_t, native_t, fmaxf(max_diff(L, 2, v, X, 0), max_diff(L, 2, v, Y, 0)));
+
+    lua_close(L);
+    return 0;
+}